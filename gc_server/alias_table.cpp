@@ -0,0 +1,49 @@
+#include "stdafx.h"
+#include "alias_table.hpp"
+
+AliasTable::AliasTable(std::span<const double> weights) {
+  double total = 0.0;
+  for (double weight : weights) {
+    total += weight;
+  }
+
+  if (weights.empty() || weights.size() > UINT32_MAX || !(total > 0.0)) {
+    return;
+  }
+
+  size_t count = weights.size();
+  m_columns.resize(count);
+  m_probabilities.resize(count);
+
+  // scaled so the average column is exactly full
+  std::vector<double> scaled(count);
+  std::vector<uint32_t> small, large;
+  for (size_t i = 0; i < count; i++) {
+    m_probabilities[i] = weights[i] / total;
+    scaled[i] = m_probabilities[i] * count;
+    (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+  }
+
+  // top up each underfull column from an overfull one
+  while (!small.empty() && !large.empty()) {
+    uint32_t less = small.back();
+    small.pop_back();
+    uint32_t more = large.back();
+    large.pop_back();
+
+    m_columns[less].threshold =
+        static_cast<uint32_t>(scaled[less] * 4294967296.0);
+    m_columns[less].alias = more;
+
+    scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+    (scaled[more] < 1.0 ? small : large).push_back(more);
+  }
+
+  // whatever is left is full (or off by rounding), it always keeps itself
+  for (uint32_t i : large) {
+    m_columns[i] = {UINT32_MAX, i};
+  }
+  for (uint32_t i : small) {
+    m_columns[i] = {UINT32_MAX, i};
+  }
+}
@@ -0,0 +1,44 @@
+#pragma once
+/**
+ * alias_table.hpp - Constant time sampling from a fixed discrete distribution
+ *
+ * Vose's alias method: the weights are turned into equally likely columns
+ * once, after which every sample is a uniform column index plus one biased
+ * coin flip, no matter how many outcomes there are.
+ */
+
+#include "random.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class AliasTable {
+public:
+  AliasTable() = default;
+
+  // weights need not be normalized; zero weights are never drawn and an
+  // all zero (or empty) list gives an empty table
+  explicit AliasTable(std::span<const double> weights);
+
+  bool Empty() const { return m_columns.empty(); }
+  size_t Size() const { return m_columns.size(); }
+
+  // normalized chance of drawing index, for logging and checking the table
+  double Probability(size_t index) const { return m_probabilities[index]; }
+
+  // index of the drawn outcome, the table must not be empty
+  size_t Sample(Random &random) const {
+    size_t column = random.RandomIndex(m_columns.size());
+    const Column &entry = m_columns[column];
+    return (random.Uint32() < entry.threshold) ? column : entry.alias;
+  }
+
+private:
+  struct Column {
+    uint32_t threshold; // keep the column with threshold / 2^32
+    uint32_t alias;     // otherwise draw this one
+  };
+
+  std::vector<Column> m_columns;
+  std::vector<double> m_probabilities;
+};
@@ -0,0 +1,235 @@
+#pragma once
+/**
+ * csgo_item_insert.hpp - Column values for a new csgo_items row
+ *
+ * SaveNewItemToDatabase inserts these columns directly and the inventory
+ * stored procedures take them as IN parameters (p_<column>). Both bind from
+ * this struct and build their column lists from Columns, so the two paths
+ * can't drift apart.
+ */
+
+#include "csgo_item_row.hpp"
+#include "prepared_stmt.hpp"
+#include <cstdint>
+#include <iterator>
+#include <string>
+
+struct CsgoItemInsert {
+  static constexpr int STICKER_SLOTS = 5;
+
+  struct Column {
+    const char *name;
+    const char *sqlType; // procedure parameter type
+  };
+
+  // Bind order; Bind() must follow it
+  static constexpr Column Columns[] = {
+      {"owner_steamid2", "VARCHAR(64)"},
+      {"item_id", "VARCHAR(255)"},
+      {"name", "VARCHAR(255)"},
+      {"nametag", "VARCHAR(255)"},
+      {"weapon_type", "VARCHAR(255)"},
+      {"weapon_id", "VARCHAR(255)"},
+      {"weapon_slot", "VARCHAR(32)"},
+      {"wear", "VARCHAR(64)"},
+      {"floatval", "FLOAT"},
+      {"paint_index", "INT UNSIGNED"},
+      {"pattern_index", "INT UNSIGNED"},
+      {"rarity", "INT UNSIGNED"},
+      {"quality", "INT UNSIGNED"},
+      {"tradable", "INT UNSIGNED"},
+      {"commodity", "INT UNSIGNED"},
+      {"stattrak", "INT UNSIGNED"},
+      {"stattrak_kills", "INT UNSIGNED"},
+      {"sticker_slots", "INT UNSIGNED"},
+      {"sticker_1", "INT UNSIGNED"},
+      {"sticker_1_wear", "FLOAT"},
+      {"sticker_2", "INT UNSIGNED"},
+      {"sticker_2_wear", "FLOAT"},
+      {"sticker_3", "INT UNSIGNED"},
+      {"sticker_3_wear", "FLOAT"},
+      {"sticker_4", "INT UNSIGNED"},
+      {"sticker_4_wear", "FLOAT"},
+      {"sticker_5", "INT UNSIGNED"},
+      {"sticker_5_wear", "FLOAT"},
+      {"market_price", "FLOAT"},
+      {"equipped_ct", "INT UNSIGNED"},
+      {"equipped_t", "INT UNSIGNED"},
+      {"acquired_by", "VARCHAR(64)"},
+      {"acknowledged", "INT UNSIGNED"},
+      {"owner_account_id", "INT UNSIGNED"},
+  };
+  static constexpr size_t COLUMN_COUNT = std::size(Columns);
+
+  std::string owner_steamid2;
+  std::string item_id;
+  std::string name;
+  std::string nametag; // empty = NULL
+  std::string weapon_type;
+  std::string weapon_id;
+  std::string weapon_slot = "0";
+  std::string wear = "Factory New";
+  bool baseItem = false; // NULL floatval and rarity
+  float floatval = 0.0f;
+  uint32_t paint_index = 0;
+  uint32_t pattern_index = 0;
+  uint32_t rarity = 0;
+  uint32_t quality = 0;
+  uint32_t tradable = 1;
+  uint32_t commodity = 0;
+  uint32_t stattrak = 0;
+  uint32_t stattrak_kills = 0; // NULL unless stattrak
+  uint32_t sticker_slots = 0;
+  uint32_t stickers[STICKER_SLOTS] = {}; // 0 = NULL id and wear
+  float sticker_wears[STICKER_SLOTS] = {};
+  float market_price = 0.0f;
+  uint32_t equipped_ct = 0;
+  uint32_t equipped_t = 0;
+  std::string acquired_by = "0";
+  uint32_t acknowledged = 0;
+  uint32_t owner_account_id = 0;
+
+  /**
+   * Binds every column to parameters first .. first + COLUMN_COUNT - 1.
+   * The struct must stay alive and unmodified until the statement executes.
+   */
+  void Bind(PreparedStatement &stmt, size_t first) {
+    m_first = first;
+    size_t i = first;
+    bindString(stmt, i++, owner_steamid2);
+    bindString(stmt, i++, item_id);
+    bindString(stmt, i++, name);
+    if (nametag.empty()) {
+      stmt.bindNull(i++);
+    } else {
+      bindString(stmt, i++, nametag);
+    }
+    bindString(stmt, i++, weapon_type);
+    bindString(stmt, i++, weapon_id);
+    bindString(stmt, i++, weapon_slot);
+    bindString(stmt, i++, wear);
+    if (baseItem) {
+      stmt.bindNull(i++);
+    } else {
+      stmt.bindFloat(i++, &floatval);
+    }
+    stmt.bindUint32(i++, &paint_index);
+    stmt.bindUint32(i++, &pattern_index);
+    if (baseItem) {
+      stmt.bindNull(i++);
+    } else {
+      stmt.bindUint32(i++, &rarity);
+    }
+    stmt.bindUint32(i++, &quality);
+    stmt.bindUint32(i++, &tradable);
+    stmt.bindUint32(i++, &commodity);
+    stmt.bindUint32(i++, &stattrak);
+    if (stattrak) {
+      stmt.bindUint32(i++, &stattrak_kills);
+    } else {
+      stmt.bindNull(i++);
+    }
+    stmt.bindUint32(i++, &sticker_slots);
+    for (int slot = 0; slot < STICKER_SLOTS; slot++) {
+      if (stickers[slot] > 0) {
+        stmt.bindUint32(i++, &stickers[slot]);
+        stmt.bindFloat(i++, &sticker_wears[slot]);
+      } else {
+        stmt.bindNull(i++);
+        stmt.bindNull(i++);
+      }
+    }
+    stmt.bindFloat(i++, &market_price);
+    stmt.bindUint32(i++, &equipped_ct);
+    stmt.bindUint32(i++, &equipped_t);
+    bindString(stmt, i++, acquired_by);
+    stmt.bindUint32(i++, &acknowledged);
+    stmt.bindUint32(i++, &owner_account_id);
+  }
+
+  /**
+   * The row as a read of the inserted id returns it (NULLs included), so
+   * the inventory cache can be written through without reading it back.
+   */
+  CsgoItemRow ToRow(uint64_t id) const {
+    CsgoItemRow row;
+    row.id = id;
+    row.item_id.assign(item_id);
+    if (!baseItem) {
+      row.floatval.value = floatval;
+      row.floatval.isNull = 0;
+      row.rarity = static_cast<int32_t>(rarity);
+    }
+    row.quality = quality;
+    row.tradable = static_cast<int8_t>(tradable);
+    row.stattrak = static_cast<int8_t>(stattrak);
+    if (stattrak) {
+      row.stattrak_kills = stattrak_kills;
+    }
+    int32_t CsgoItemRow::*ids[STICKER_SLOTS] = {
+        &CsgoItemRow::sticker_1, &CsgoItemRow::sticker_2,
+        &CsgoItemRow::sticker_3, &CsgoItemRow::sticker_4,
+        &CsgoItemRow::sticker_5};
+    float CsgoItemRow::*wears[STICKER_SLOTS] = {
+        &CsgoItemRow::sticker_1_wear, &CsgoItemRow::sticker_2_wear,
+        &CsgoItemRow::sticker_3_wear, &CsgoItemRow::sticker_4_wear,
+        &CsgoItemRow::sticker_5_wear};
+    for (int slot = 0; slot < STICKER_SLOTS; slot++) {
+      if (stickers[slot] > 0) {
+        row.*ids[slot] = static_cast<int32_t>(stickers[slot]);
+        row.*wears[slot] = sticker_wears[slot];
+      }
+    }
+    row.nametag.assign(nametag);
+    row.pattern_index.value = static_cast<int32_t>(pattern_index);
+    row.pattern_index.isNull = 0;
+    row.equipped_ct = static_cast<int8_t>(equipped_ct);
+    row.equipped_t = static_cast<int8_t>(equipped_t);
+    row.acknowledged = acknowledged;
+    row.acquired_by.assign(acquired_by);
+    return row;
+  }
+
+  /**
+   * "owner_steamid2, item_id, ..." with every name prefixed by prefix.
+   */
+  static std::string ColumnList(const char *prefix = "") {
+    std::string list;
+    for (size_t i = 0; i < COLUMN_COUNT; i++) {
+      if (i > 0) {
+        list += ", ";
+      }
+      list += prefix;
+      list += Columns[i].name;
+    }
+    return list;
+  }
+
+  /**
+   * "IN p_owner_steamid2 VARCHAR(64), ..." for a procedure signature.
+   */
+  static std::string ParameterDeclarations() {
+    std::string list;
+    for (size_t i = 0; i < COLUMN_COUNT; i++) {
+      if (i > 0) {
+        list += ", ";
+      }
+      list += "IN p_";
+      list += Columns[i].name;
+      list += " ";
+      list += Columns[i].sqlType;
+    }
+    return list;
+  }
+
+private:
+  void bindString(PreparedStatement &stmt, size_t index,
+                  const std::string &value) {
+    unsigned long &length = m_lengths[index - m_first];
+    length = value.length();
+    stmt.bindString(index, value.c_str(), &length);
+  }
+
+  size_t m_first = 0;
+  unsigned long m_lengths[COLUMN_COUNT] = {};
+};
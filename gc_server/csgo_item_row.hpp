@@ -0,0 +1,87 @@
+#pragma once
+/**
+ * csgo_item_row.hpp - Typed view of a csgo_items row
+ *
+ * Shared by every query that turns inventory rows into CSOEconItems
+ * (SendSOCache, FetchItemFromDatabase, CheckAndSendNewItemsSince). Default
+ * member initializers double as the value used when a column is NULL.
+ */
+
+#include "db_row.hpp"
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+struct CsgoItemRow {
+  static constexpr int STICKER_SLOTS = 5;
+
+  uint64_t id = 0;
+  DbString<256> item_id;
+  DbNullable<float> floatval;
+  int32_t rarity = -1;
+  uint32_t quality = 0;
+  int8_t tradable = 1;
+  int8_t stattrak = 0;
+  uint32_t stattrak_kills = 0;
+  int32_t sticker_1 = 0;
+  float sticker_1_wear = 0.0f;
+  int32_t sticker_2 = 0;
+  float sticker_2_wear = 0.0f;
+  int32_t sticker_3 = 0;
+  float sticker_3_wear = 0.0f;
+  int32_t sticker_4 = 0;
+  float sticker_4_wear = 0.0f;
+  int32_t sticker_5 = 0;
+  float sticker_5_wear = 0.0f;
+  DbString<129> nametag;
+  DbNullable<int32_t> pattern_index;
+  int8_t equipped_ct = 0;
+  int8_t equipped_t = 0;
+  uint32_t acknowledged = 0;
+  DbString<32> acquired_by;
+
+  /**
+   * Sticker id and wear for slot 0-4.
+   */
+  std::pair<int32_t, float> sticker(int slot) const {
+    static constexpr int32_t CsgoItemRow::*ids[STICKER_SLOTS] = {
+        &CsgoItemRow::sticker_1, &CsgoItemRow::sticker_2,
+        &CsgoItemRow::sticker_3, &CsgoItemRow::sticker_4,
+        &CsgoItemRow::sticker_5};
+    static constexpr float CsgoItemRow::*wears[STICKER_SLOTS] = {
+        &CsgoItemRow::sticker_1_wear, &CsgoItemRow::sticker_2_wear,
+        &CsgoItemRow::sticker_3_wear, &CsgoItemRow::sticker_4_wear,
+        &CsgoItemRow::sticker_5_wear};
+    return {this->*ids[slot], this->*wears[slot]};
+  }
+};
+
+template <> struct DbRowTraits<CsgoItemRow> {
+  static constexpr auto Columns = std::make_tuple(
+      DbColumn("id", &CsgoItemRow::id),
+      DbColumn("item_id", &CsgoItemRow::item_id),
+      DbColumn("floatval", &CsgoItemRow::floatval),
+      DbColumn("rarity", &CsgoItemRow::rarity),
+      DbColumn("quality", &CsgoItemRow::quality),
+      DbColumn("tradable", &CsgoItemRow::tradable),
+      DbColumn("stattrak", &CsgoItemRow::stattrak),
+      DbColumn("stattrak_kills", &CsgoItemRow::stattrak_kills),
+      DbColumn("sticker_1", &CsgoItemRow::sticker_1),
+      DbColumn("sticker_1_wear", &CsgoItemRow::sticker_1_wear),
+      DbColumn("sticker_2", &CsgoItemRow::sticker_2),
+      DbColumn("sticker_2_wear", &CsgoItemRow::sticker_2_wear),
+      DbColumn("sticker_3", &CsgoItemRow::sticker_3),
+      DbColumn("sticker_3_wear", &CsgoItemRow::sticker_3_wear),
+      DbColumn("sticker_4", &CsgoItemRow::sticker_4),
+      DbColumn("sticker_4_wear", &CsgoItemRow::sticker_4_wear),
+      DbColumn("sticker_5", &CsgoItemRow::sticker_5),
+      DbColumn("sticker_5_wear", &CsgoItemRow::sticker_5_wear),
+      DbColumn("nametag", &CsgoItemRow::nametag),
+      DbColumn("pattern_index", &CsgoItemRow::pattern_index),
+      DbColumn("equipped_ct", &CsgoItemRow::equipped_ct),
+      DbColumn("equipped_t", &CsgoItemRow::equipped_t),
+      DbColumn("acknowledged", &CsgoItemRow::acknowledged),
+      DbColumn("acquired_by", &CsgoItemRow::acquired_by));
+};
+
+using CsgoItemRowBinder = DbRowBinder<CsgoItemRow>;
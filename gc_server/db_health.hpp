@@ -0,0 +1,428 @@
+#pragma once
+/**
+ * db_health.hpp - Circuit breakers, adaptive timeouts and request deadlines
+ *
+ * When a database host gets slow, every handler used to wait out the full
+ * pool and connect timeouts and the single-threaded main loop stalled for
+ * everyone. Three pieces keep the GC responsive instead:
+ *
+ * - DBCircuitBreaker, one per primary database, watches every statement's
+ *   outcome and latency over a rolling window (prepared statements, and
+ *   text queries and transaction control through RunDBCall). It opens when too many
+ *   statements fail with availability errors or p99 latency gets too high;
+ *   while open, statements and pool checkouts for that database fail
+ *   immediately and the dispatcher answers "try again". After a cool-down
+ *   one probe statement is let through to decide whether to close again.
+ * - TimeoutMs() derives a wait timeout from the observed p99, so pool
+ *   waits track how the database is actually behaving.
+ * - RequestDeadline carries the budget of the inbound message to every
+ *   statement it issues (thread-local; hand Current() to worker threads).
+ *   Once it has passed, further statements fail without a round trip.
+ *
+ * Header-only so prepared_stmt.hpp and db_pool.hpp stay usable from the
+ * offline tools; nothing is registered there, so nothing changes.
+ */
+
+#include "logger.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mariadb/mysql.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Errors that say the database is unreachable or overloaded, as opposed to
+ * errors about the statement itself (duplicate key, deadlock, ...).
+ */
+inline bool IsDBAvailabilityError(unsigned int error) {
+  switch (error) {
+  case 1040: // ER_CON_COUNT_ERROR
+  case 1203: // ER_TOO_MANY_USER_CONNECTIONS
+  case 1969: // ER_STATEMENT_TIMEOUT
+  case 2002: // CR_CONNECTION_ERROR
+  case 2003: // CR_CONN_HOST_ERROR
+  case 2006: // CR_SERVER_GONE_ERROR
+  case 2013: // CR_SERVER_LOST
+  case 2055: // CR_SERVER_LOST_EXTENDED
+    return true;
+  default:
+    return false;
+  }
+}
+
+class DBCircuitBreaker {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Config {
+    uint32_t minSamples = 20;      // don't judge a near-empty window
+    uint32_t errorPercent = 50;    // open at this share of failures
+    uint32_t latencyMs = 1000;     // ... or at this p99
+    uint32_t openMs = 5000;        // cool-down before the probe
+    uint32_t timeoutMinMs = 50;    // clamp for TimeoutMs()
+    uint32_t timeoutMaxMs = 5000;  //
+    uint32_t timeoutFactor = 3;    // TimeoutMs() = p99 * factor
+  };
+
+  DBCircuitBreaker(std::string name, Config config)
+      : m_name(std::move(name)), m_config(config) {}
+
+  const std::string &Name() const { return m_name; }
+
+  /**
+   * Whether a statement may run now. In the half-open state exactly one
+   * caller (the probe) gets true until its outcome is recorded.
+   */
+  bool Allow() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    switch (m_state) {
+    case State::Closed:
+      return true;
+    case State::Open:
+      if (Clock::now() - m_openedAt <
+          std::chrono::milliseconds(m_config.openMs)) {
+        return false;
+      }
+      m_state = State::HalfOpen;
+      m_probeInFlight = true;
+      logger::info("DBCircuitBreaker: %s half-open, probing",
+                   m_name.c_str());
+      return true;
+    case State::HalfOpen:
+      if (m_probeInFlight) {
+        return false;
+      }
+      m_probeInFlight = true;
+      return true;
+    }
+    return true;
+  }
+
+  /**
+   * Like Allow() but without claiming the probe; for callers that only
+   * decide whether to start work that will issue statements.
+   */
+  bool IsOpen() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state == State::Open) {
+      return Clock::now() - m_openedAt <
+             std::chrono::milliseconds(m_config.openMs);
+    }
+    return m_state == State::HalfOpen && m_probeInFlight;
+  }
+
+  /**
+   * Record one statement. failed should only be set for availability
+   * errors (IsDBAvailabilityError).
+   */
+  void Record(bool failed, std::chrono::microseconds latency) {
+    uint32_t latencyUs = static_cast<uint32_t>(
+        std::min<int64_t>(latency.count(), UINT32_MAX));
+    uint32_t thresholdUs = m_config.latencyMs * 1000;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state == State::HalfOpen) {
+      m_probeInFlight = false;
+      if (failed || latencyUs >= thresholdUs) {
+        Trip("probe failed");
+      } else {
+        m_state = State::Closed;
+        m_count = 0;
+        m_next = 0;
+        m_failures = 0;
+        logger::info("DBCircuitBreaker: %s closed", m_name.c_str());
+      }
+      return;
+    }
+
+    if (m_count == WINDOW) {
+      m_failures -= m_failed[m_next] ? 1 : 0;
+    } else {
+      m_count++;
+    }
+    m_latencyUs[m_next] = latencyUs;
+    m_failed[m_next] = failed;
+    m_failures += failed ? 1 : 0;
+    m_next = (m_next + 1) % WINDOW;
+
+    if (++m_sinceP99 >= P99_INTERVAL || m_count < P99_INTERVAL) {
+      m_p99Us = Percentile99();
+      m_sinceP99 = 0;
+    }
+
+    if (m_state != State::Closed || m_count < m_config.minSamples) {
+      return;
+    }
+    if (m_failures * 100 >= m_config.errorPercent * m_count) {
+      Trip("error rate");
+    } else if (m_p99Us >= thresholdUs) {
+      Trip("p99 latency");
+    }
+  }
+
+  /**
+   * Wait timeout derived from the observed p99, clamped to the configured
+   * range; the maximum until enough samples exist.
+   */
+  uint32_t TimeoutMs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_count < m_config.minSamples) {
+      return m_config.timeoutMaxMs;
+    }
+    uint64_t timeoutMs =
+        (uint64_t(m_p99Us) * m_config.timeoutFactor + 999) / 1000;
+    return static_cast<uint32_t>(std::clamp<uint64_t>(
+        timeoutMs, m_config.timeoutMinMs, m_config.timeoutMaxMs));
+  }
+
+  uint32_t P99Ms() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_p99Us / 1000;
+  }
+
+private:
+  enum class State { Closed, Open, HalfOpen };
+
+  static constexpr size_t WINDOW = 128;
+  static constexpr uint32_t P99_INTERVAL = 16; // recompute every N samples
+
+  void Trip(const char *reason) {
+    m_state = State::Open;
+    m_openedAt = Clock::now();
+    logger::warning("DBCircuitBreaker: %s open (%s: %u/%zu failed, p99 %u "
+                    "ms), failing fast for %u ms",
+                    m_name.c_str(), reason, m_failures, m_count,
+                    m_p99Us / 1000, m_config.openMs);
+  }
+
+  uint32_t Percentile99() const {
+    std::array<uint32_t, WINDOW> sorted;
+    std::copy_n(m_latencyUs.begin(), m_count, sorted.begin());
+    size_t rank = (m_count * 99) / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + rank,
+                     sorted.begin() + m_count);
+    return sorted[rank];
+  }
+
+  std::string m_name;
+  Config m_config;
+
+  mutable std::mutex m_mutex;
+  State m_state = State::Closed;
+  Clock::time_point m_openedAt;
+  bool m_probeInFlight = false;
+
+  std::array<uint32_t, WINDOW> m_latencyUs = {};
+  std::array<bool, WINDOW> m_failed = {};
+  size_t m_next = 0;
+  size_t m_count = 0;
+  uint32_t m_failures = 0;
+  uint32_t m_p99Us = 0;
+  uint32_t m_sinceP99 = 0;
+};
+
+/**
+ * Registry of the breakers for the primary databases. Connections are
+ * matched by host and schema, so replicas and unregistered hosts are never
+ * affected.
+ */
+class DBHealth {
+public:
+  enum Database : uint32_t {
+    DB_CLASSIC = 1 << 0,
+    DB_INVENTORY = 1 << 1,
+    DB_RANKED = 1 << 2,
+  };
+
+  static DBHealth &GetInstance() {
+    static DBHealth instance;
+    return instance;
+  }
+
+  // Startup only, before any statement runs
+  void Register(Database database, const std::string &host,
+                const std::string &schema, DBCircuitBreaker::Config config) {
+    if (Find(host, schema)) {
+      return;
+    }
+    m_entries.push_back(
+        {database, host, schema,
+         std::make_unique<DBCircuitBreaker>(schema, config)});
+  }
+
+  DBCircuitBreaker *Find(const std::string &host,
+                         const std::string &schema) const {
+    for (const auto &entry : m_entries) {
+      if (entry.host == host && entry.schema == schema) {
+        return entry.breaker.get();
+      }
+    }
+    return nullptr;
+  }
+
+  DBCircuitBreaker *ForConnection(MYSQL *conn) const {
+    if (m_entries.empty() || !conn) {
+      return nullptr;
+    }
+    const char *host = nullptr;
+    const char *schema = nullptr;
+    if (mariadb_get_infov(conn, MARIADB_CONNECTION_HOST, &host) != 0 ||
+        mariadb_get_infov(conn, MARIADB_CONNECTION_SCHEMA, &schema) != 0 ||
+        !host || !schema) {
+      return nullptr;
+    }
+    for (const auto &entry : m_entries) {
+      if (entry.host == host && entry.schema == schema) {
+        return entry.breaker.get();
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Socket-level timeouts in seconds for every connection opened from now
+   * on (0 = library default). The read timeout is the hard cap for a single
+   * statement; breakers and deadlines act between statements.
+   */
+  void SetConnectionTimeouts(unsigned int connectSeconds,
+                             unsigned int ioSeconds) {
+    m_connectTimeoutS = connectSeconds;
+    m_ioTimeoutS = ioSeconds;
+  }
+
+  // Call between mysql_init and mysql_real_connect
+  void ApplyConnectionTimeouts(MYSQL *conn) const {
+    unsigned int connectSeconds = m_connectTimeoutS;
+    unsigned int ioSeconds = m_ioTimeoutS;
+    if (connectSeconds > 0) {
+      mysql_options(conn, MYSQL_OPT_CONNECT_TIMEOUT, &connectSeconds);
+    }
+    if (ioSeconds > 0) {
+      mysql_options(conn, MYSQL_OPT_READ_TIMEOUT, &ioSeconds);
+      mysql_options(conn, MYSQL_OPT_WRITE_TIMEOUT, &ioSeconds);
+    }
+  }
+
+  /**
+   * False if any breaker in the databases mask is open.
+   */
+  bool Available(uint32_t databases) const {
+    for (const auto &entry : m_entries) {
+      if ((databases & entry.database) && entry.breaker->IsOpen()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  struct Entry {
+    Database database;
+    std::string host;
+    std::string schema;
+    std::unique_ptr<DBCircuitBreaker> breaker;
+  };
+
+  DBHealth() = default;
+
+  DBHealth(const DBHealth &) = delete;
+  DBHealth &operator=(const DBHealth &) = delete;
+
+  std::vector<Entry> m_entries;
+  unsigned int m_connectTimeoutS = 10;
+  unsigned int m_ioTimeoutS = 0;
+};
+
+/**
+ * Deadline of the request being handled on this thread. Scopes nest and an
+ * inner scope can only shorten the deadline; without a scope there is none.
+ */
+class RequestDeadline {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit RequestDeadline(std::chrono::milliseconds budget)
+      : RequestDeadline(std::optional<Clock::time_point>(Clock::now() +
+                                                         budget)) {}
+
+  // Adopts a deadline captured with Current() on another thread
+  explicit RequestDeadline(std::optional<Clock::time_point> deadline)
+      : m_previous(Slot()) {
+    if (deadline && (!m_previous || *deadline < *m_previous)) {
+      Slot() = deadline;
+    }
+  }
+
+  ~RequestDeadline() { Slot() = m_previous; }
+
+  RequestDeadline(const RequestDeadline &) = delete;
+  RequestDeadline &operator=(const RequestDeadline &) = delete;
+
+  static std::optional<Clock::time_point> Current() { return Slot(); }
+
+  static bool Expired() {
+    const auto &deadline = Slot();
+    return deadline && Clock::now() >= *deadline;
+  }
+
+  /**
+   * timeoutMs capped to the time left (0 = no limit, as in getConnection).
+   */
+  static uint32_t Clamp(uint32_t timeoutMs) {
+    const auto &deadline = Slot();
+    if (!deadline) {
+      return timeoutMs;
+    }
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    *deadline - Clock::now())
+                    .count();
+    uint32_t leftMs = static_cast<uint32_t>(std::max<int64_t>(left, 1));
+    return timeoutMs == 0 ? leftMs : std::min(timeoutMs, leftMs);
+  }
+
+private:
+  static std::optional<Clock::time_point> &Slot() {
+    thread_local std::optional<Clock::time_point> deadline;
+    return deadline;
+  }
+
+  std::optional<Clock::time_point> m_previous;
+};
+
+
+/**
+ * Runs a raw client call on conn (mysql_query, mysql_commit, ...; returns
+ * 0 on success) with the accounting PreparedStatement::execute does, so the
+ * breaker sees text queries and transaction control too. The call is
+ * skipped (returning false) once the request deadline has passed or the
+ * breaker is open. Rollbacks have to run regardless and don't use this;
+ * they only follow a statement that was already recorded.
+ */
+template <typename Call>
+bool RunDBCall(MYSQL *conn, const char *what, Call &&call) {
+  if (RequestDeadline::Expired()) {
+    logger::warning("%s: request deadline passed, skipped", what);
+    return false;
+  }
+  DBCircuitBreaker *breaker = DBHealth::GetInstance().ForConnection(conn);
+  if (breaker && !breaker->Allow()) {
+    logger::warning("%s: %s unavailable, skipped", what,
+                    breaker->Name().c_str());
+    return false;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  bool ok = call() == 0;
+  if (breaker) {
+    breaker->Record(!ok && IsDBAvailabilityError(mysql_errno(conn)),
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start));
+  }
+  return ok;
+}
@@ -6,9 +6,19 @@
  * - Thread-safe connection checkout/return
  * - Automatic reconnection on failure
  * - Connection health checks
+ * - Optional read replicas with per-session read-your-writes: a session
+ *   that wrote recently keeps reading from the primary until the
+ *   stickiness window passes. The window is a fixed bound, not measured
+ *   lag; it has to stay above the worst replication delay the replicas
+ *   show (db_replica_stickiness_ms), or reads can miss a recent write.
+ * - Fail-fast checkout while the database's circuit breaker is open, and
+ *   waits bounded by its adaptive timeout and the request deadline
  */
 
+#include "db_health.hpp"
 #include "logger.hpp"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <mariadb/mysql.h>
@@ -17,6 +27,8 @@
 #include <queue>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 class DBConnectionPool {
 public:
@@ -82,7 +94,8 @@ public:
                    const std::string &password, const std::string &database,
                    unsigned int port = 3306, size_t poolSize = 5)
       : m_host(host), m_user(user), m_password(password), m_database(database),
-        m_port(port), m_poolSize(poolSize), m_shutdown(false) {
+        m_port(port), m_poolSize(poolSize), m_shutdown(false),
+        m_breaker(DBHealth::GetInstance().Find(host, database)) {
     // Pre-create connections
     for (size_t i = 0; i < poolSize; ++i) {
       MYSQL *conn = createConnection();
@@ -112,6 +125,15 @@ public:
    * @return RAII connection wrapper
    */
   Connection getConnection(uint32_t timeoutMs = 5000) {
+    if (m_breaker) {
+      if (m_breaker->IsOpen()) {
+        return Connection(nullptr, nullptr);
+      }
+      uint32_t adaptiveMs = m_breaker->TimeoutMs();
+      timeoutMs = timeoutMs == 0 ? adaptiveMs : std::min(timeoutMs, adaptiveMs);
+    }
+    timeoutMs = RequestDeadline::Clamp(timeoutMs);
+
     std::unique_lock<std::mutex> lock(m_poolMutex);
 
     // Wait for a connection to become available
@@ -140,6 +162,9 @@ public:
       mysql_close(conn);
       conn = createConnection();
       if (!conn) {
+        if (m_breaker) {
+          m_breaker->Record(true, std::chrono::microseconds(0));
+        }
         logger::error("DBConnectionPool: Failed to reconnect");
         return Connection(nullptr, nullptr);
       }
@@ -148,6 +173,78 @@ public:
     return Connection(this, conn);
   }
 
+  /**
+   * Add a read replica endpoint. It uses the primary's credentials and
+   * database name. A replica that can't be reached is logged and skipped.
+   */
+  bool addReplica(const std::string &host, unsigned int port,
+                  size_t poolSize) {
+    try {
+      auto replica = std::make_unique<DBConnectionPool>(
+          host, m_user, m_password, m_database, port, poolSize);
+      std::lock_guard<std::mutex> lock(m_poolMutex);
+      m_replicas.push_back(std::move(replica));
+      return true;
+    } catch (const std::exception &e) {
+      logger::error("DBConnectionPool: Replica %s:%u for %s unavailable: %s",
+                    host.c_str(), port, m_database.c_str(), e.what());
+      return false;
+    }
+  }
+
+  /**
+   * How long a session reads from the primary after its last write. Lag
+   * beyond this window isn't detected.
+   */
+  void setReplicaStickiness(std::chrono::milliseconds window) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    m_stickiness = window;
+  }
+
+  /**
+   * Record that sessionKey just wrote, so its reads stay on the primary.
+   */
+  void noteWrite(uint64_t sessionKey) {
+    if (m_replicas.empty()) {
+      return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    m_lastWrite[sessionKey] = now;
+
+    // Drop expired entries once the map grows
+    if (m_lastWrite.size() > 4096) {
+      for (auto it = m_lastWrite.begin(); it != m_lastWrite.end();) {
+        it = (now - it->second >= m_stickiness) ? m_lastWrite.erase(it)
+                                                : std::next(it);
+      }
+    }
+  }
+
+  /**
+   * Get a connection for read-only statements on behalf of sessionKey.
+   * Uses a replica (round-robin) unless there are none or the session
+   * wrote within the stickiness window; falls back to the primary if the
+   * replica has no connection to give.
+   */
+  Connection getReadConnection(uint64_t sessionKey,
+                               uint32_t timeoutMs = 5000) {
+    if (m_replicas.empty() || recentlyWrote(sessionKey)) {
+      return getConnection(timeoutMs);
+    }
+
+    size_t index = m_nextReplica.fetch_add(1, std::memory_order_relaxed) %
+                   m_replicas.size();
+    Connection conn = m_replicas[index]->getConnection(timeoutMs);
+    if (!conn) {
+      return getConnection(timeoutMs);
+    }
+    return conn;
+  }
+
+  size_t replicaCount() const { return m_replicas.size(); }
+
   /**
    * Get the number of available connections.
    */
@@ -163,6 +260,10 @@ public:
     std::unique_lock<std::mutex> lock(m_poolMutex);
     m_shutdown = true;
 
+    for (auto &replica : m_replicas) {
+      replica->shutdown();
+    }
+
     while (!m_available.empty()) {
       MYSQL *conn = m_available.front();
       m_available.pop();
@@ -173,6 +274,19 @@ public:
   }
 
 private:
+  bool recentlyWrote(uint64_t sessionKey) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    auto it = m_lastWrite.find(sessionKey);
+    if (it == m_lastWrite.end()) {
+      return false;
+    }
+    if (std::chrono::steady_clock::now() - it->second >= m_stickiness) {
+      m_lastWrite.erase(it);
+      return false;
+    }
+    return true;
+  }
+
   void returnConnection(MYSQL *conn) {
     std::lock_guard<std::mutex> lock(m_poolMutex);
 
@@ -196,9 +310,8 @@ private:
     my_bool reconnect = 1;
     mysql_options(conn, MYSQL_OPT_RECONNECT, &reconnect);
 
-    // Set connection timeout
-    unsigned int timeout = 10;
-    mysql_options(conn, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+    // Set connect/read/write timeouts
+    DBHealth::GetInstance().ApplyConnectionTimeouts(conn);
 
     // Connect
     if (!mysql_real_connect(conn, m_host.c_str(), m_user.c_str(),
@@ -227,4 +340,16 @@ private:
   std::condition_variable m_cv;
   std::queue<MYSQL *> m_available;
   bool m_shutdown;
+
+  // Primary's breaker (registered in DBHealth); replicas have none
+  DBCircuitBreaker *m_breaker;
+
+  // Replicas are only added during startup, before any reads are routed
+  std::vector<std::unique_ptr<DBConnectionPool>> m_replicas;
+  std::atomic<size_t> m_nextReplica{0};
+
+  std::mutex m_writeMutex;
+  std::unordered_map<uint64_t, std::chrono::steady_clock::time_point>
+      m_lastWrite;
+  std::chrono::milliseconds m_stickiness{5000};
 };
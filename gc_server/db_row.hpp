@@ -0,0 +1,237 @@
+#pragma once
+/**
+ * db_row.hpp - Typed result row binding for prepared statements
+ *
+ * A row struct describes its columns once through a DbRowTraits
+ * specialization. DbRowBinder then binds native MYSQL_BIND buffers
+ * (LONGLONG, LONG, FLOAT, TINY, ...) directly onto the struct's members so
+ * the client library decodes each column in place, with no text round trip
+ * and no hand-maintained bind arrays at the call site.
+ *
+ * Example:
+ *   struct MyRow { uint64_t id = 0; DbString<64> name; };
+ *   template <> struct DbRowTraits<MyRow> {
+ *     static constexpr auto Columns = std::make_tuple(
+ *         DbColumn("id", &MyRow::id), DbColumn("name", &MyRow::name));
+ *   };
+ */
+
+#include "prepared_stmt.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <mariadb/mysql.h>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Fixed-capacity string column. NULL is decoded as an empty string.
+ */
+template <size_t N> struct DbString {
+  char data[N] = {};
+  unsigned long length = 0;
+
+  std::string_view view() const {
+    return std::string_view(data, std::min<size_t>(length, N));
+  }
+  bool empty() const { return length == 0; }
+
+  // Truncates to the capacity, like a fetched column
+  void assign(std::string_view value) {
+    length = static_cast<unsigned long>(std::min(value.size(), N));
+    memcpy(data, value.data(), length);
+  }
+};
+
+/**
+ * Column wrapper that keeps the NULL flag for callers that must tell NULL
+ * apart from the type's default value.
+ */
+template <typename T> struct DbNullable {
+  T value{};
+  my_bool isNull = 1;
+
+  bool has_value() const { return !isNull; }
+  T value_or(T fallback) const { return isNull ? fallback : value; }
+};
+
+/**
+ * One column of a row description: SQL column name and target member.
+ */
+template <typename Row, typename Field> struct DbColumn {
+  const char *name;
+  Field Row::*member;
+
+  constexpr DbColumn(const char *columnName, Field Row::*target)
+      : name(columnName), member(target) {}
+};
+
+/**
+ * Specialize with `static constexpr auto Columns = std::make_tuple(...)`.
+ */
+template <typename Row> struct DbRowTraits;
+
+namespace db_row_detail {
+
+inline void bindField(MYSQL_BIND &bind, uint64_t &value) {
+  bind.buffer_type = MYSQL_TYPE_LONGLONG;
+  bind.buffer = &value;
+  bind.is_unsigned = 1;
+}
+inline void bindField(MYSQL_BIND &bind, int64_t &value) {
+  bind.buffer_type = MYSQL_TYPE_LONGLONG;
+  bind.buffer = &value;
+}
+inline void bindField(MYSQL_BIND &bind, uint32_t &value) {
+  bind.buffer_type = MYSQL_TYPE_LONG;
+  bind.buffer = &value;
+  bind.is_unsigned = 1;
+}
+inline void bindField(MYSQL_BIND &bind, int32_t &value) {
+  bind.buffer_type = MYSQL_TYPE_LONG;
+  bind.buffer = &value;
+}
+inline void bindField(MYSQL_BIND &bind, uint16_t &value) {
+  bind.buffer_type = MYSQL_TYPE_SHORT;
+  bind.buffer = &value;
+  bind.is_unsigned = 1;
+}
+inline void bindField(MYSQL_BIND &bind, int16_t &value) {
+  bind.buffer_type = MYSQL_TYPE_SHORT;
+  bind.buffer = &value;
+}
+inline void bindField(MYSQL_BIND &bind, uint8_t &value) {
+  bind.buffer_type = MYSQL_TYPE_TINY;
+  bind.buffer = &value;
+  bind.is_unsigned = 1;
+}
+inline void bindField(MYSQL_BIND &bind, int8_t &value) {
+  bind.buffer_type = MYSQL_TYPE_TINY;
+  bind.buffer = &value;
+}
+inline void bindField(MYSQL_BIND &bind, float &value) {
+  bind.buffer_type = MYSQL_TYPE_FLOAT;
+  bind.buffer = &value;
+}
+inline void bindField(MYSQL_BIND &bind, double &value) {
+  bind.buffer_type = MYSQL_TYPE_DOUBLE;
+  bind.buffer = &value;
+}
+template <size_t N> void bindField(MYSQL_BIND &bind, DbString<N> &value) {
+  bind.buffer_type = MYSQL_TYPE_STRING;
+  bind.buffer = value.data;
+  bind.buffer_length = N;
+  bind.length = &value.length;
+}
+template <typename T> void bindField(MYSQL_BIND &bind, DbNullable<T> &value) {
+  bindField(bind, value.value);
+  bind.is_null = &value.isNull;
+}
+
+template <typename T> struct IsNullable : std::false_type {};
+template <typename T> struct IsNullable<DbNullable<T>> : std::true_type {};
+
+} // namespace db_row_detail
+
+/**
+ * Binds the result columns of a prepared statement onto a Row instance.
+ *
+ * The binder owns the row and the MYSQL_BIND array pointing into it, so it
+ * is neither copyable nor movable. Plain (non-DbNullable) members are reset
+ * to their default member initializer when the column is NULL.
+ */
+template <typename Row> class DbRowBinder {
+public:
+  static constexpr size_t ColumnCount =
+      std::tuple_size_v<std::remove_const_t<decltype(DbRowTraits<Row>::Columns)>>;
+
+  DbRowBinder() {
+    memset(m_binds.data(), 0, sizeof(MYSQL_BIND) * ColumnCount);
+    forEachColumn([this](auto index, const auto &column) {
+      MYSQL_BIND &bind = m_binds[index];
+      db_row_detail::bindField(bind, m_row.*(column.member));
+      if (!bind.is_null) {
+        bind.is_null = &m_isNull[index];
+      }
+    });
+  }
+
+  DbRowBinder(const DbRowBinder &) = delete;
+  DbRowBinder &operator=(const DbRowBinder &) = delete;
+
+  /**
+   * Attach the row buffers to an executed statement.
+   */
+  bool bind(PreparedStatement &stmt) {
+    return stmt.bindResult(m_binds.data());
+  }
+
+  /**
+   * Fetch the next row into row().
+   * Truncated string columns are accepted and clamped to their capacity.
+   * @return true if a row was fetched, false on end of data or error
+   */
+  bool fetch(PreparedStatement &stmt) {
+    int rc = stmt.fetch();
+    if (rc != 0 && rc != MYSQL_DATA_TRUNCATED) {
+      if (rc == 1) {
+        logger::error("DbRowBinder: fetch failed: %s", stmt.error());
+      }
+      return false;
+    }
+
+    applyNullDefaults();
+    return true;
+  }
+
+  const Row &row() const { return m_row; }
+
+  /**
+   * Comma separated column list for SELECT statements, in bind order.
+   */
+  static const std::string &selectList() {
+    static const std::string list = [] {
+      std::string result;
+      forEachColumn([&result](auto, const auto &column) {
+        if (!result.empty()) {
+          result += ", ";
+        }
+        result += column.name;
+      });
+      return result;
+    }();
+    return list;
+  }
+
+private:
+  template <typename F> static void forEachColumn(F &&func) {
+    forEachColumnImpl(func, std::make_index_sequence<ColumnCount>{});
+  }
+
+  template <typename F, size_t... I>
+  static void forEachColumnImpl(F &func, std::index_sequence<I...>) {
+    (func(std::integral_constant<size_t, I>{},
+          std::get<I>(DbRowTraits<Row>::Columns)),
+     ...);
+  }
+
+  void applyNullDefaults() {
+    static const Row defaults{};
+    forEachColumn([this](auto index, const auto &column) {
+      using Field = std::remove_reference_t<decltype(m_row.*(column.member))>;
+      if constexpr (!db_row_detail::IsNullable<Field>::value) {
+        if (m_isNull[index]) {
+          m_row.*(column.member) = defaults.*(column.member);
+        }
+      }
+    });
+  }
+
+  Row m_row{};
+  std::array<MYSQL_BIND, ColumnCount> m_binds;
+  std::array<my_bool, ColumnCount> m_isNull{};
+};
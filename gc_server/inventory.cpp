@@ -1,7 +1,9 @@
 #include "stdafx.h"
 #include "inventory.hpp"
 #include "gc_const.hpp"
+#include "item_schema_store.hpp"
 #include "keyvalue.hpp"
+#include "keyvalue_document.hpp"
 #include "random.hpp"
 
 // yea no
@@ -35,7 +37,15 @@ inline bool IsDefaultItemId(uint64_t itemId, uint32_t &defIndex, uint32_t &paint
 
 Inventory::Inventory(uint64_t steamId)
     : m_steamId{ steamId }
+    , m_itemSchema{ ItemSchemaStore::GetInstance().Get() }
 {
+    if (!m_itemSchema)
+    {
+        // first user parses it, everyone after shares the snapshot
+        ItemSchemaStore::GetInstance().Load();
+        m_itemSchema = ItemSchemaStore::GetInstance().Get();
+    }
+
     ReadFromFile();
 }
 
@@ -136,18 +146,18 @@ CSOEconItem &Inventory::CreateItem(uint32_t highItemId, CSOEconItem *copyFrom)
 
 void Inventory::ReadFromFile()
 {
-    KeyValue inventoryKey{ "inventory" };
+    KeyValueDocument inventoryKey;
     if (!inventoryKey.ParseFromFile(InventoryFilePath))
     {
         return;
     }
 
-    const KeyValue *itemsKey = inventoryKey.GetSubkey("items");
+    const KeyValueView *itemsKey = inventoryKey.GetSubkey("items");
     if (itemsKey)
     {
         m_items.reserve(itemsKey->SubkeyCount());
 
-        for (const KeyValue &itemKey : *itemsKey)
+        for (const KeyValueView &itemKey : *itemsKey)
         {
             uint32_t highItemId = FromString<uint32_t>(itemKey.Name());
             CSOEconItem &item = CreateItem(highItemId);
@@ -155,12 +165,12 @@ void Inventory::ReadFromFile()
         }
     }
 
-    const KeyValue *defaultEquipsKey = inventoryKey.GetSubkey("default_equips");
+    const KeyValueView *defaultEquipsKey = inventoryKey.GetSubkey("default_equips");
     if (defaultEquipsKey)
     {
         m_defaultEquips.reserve(defaultEquipsKey->SubkeyCount());
 
-        for (const KeyValue &defaultEquipKey : *defaultEquipsKey)
+        for (const KeyValueView &defaultEquipKey : *defaultEquipsKey)
         {
             CSOEconDefaultEquippedDefinitionInstanceClient &defaultEquip = m_defaultEquips.emplace_back();
             defaultEquip.set_account_id(AccountId());
@@ -171,7 +181,7 @@ void Inventory::ReadFromFile()
     }
 }
 
-void Inventory::ReadItem(const KeyValue &itemKey, CSOEconItem &item) const
+void Inventory::ReadItem(const KeyValueView &itemKey, CSOEconItem &item) const
 {
     // id and account_id were set by CreateItem
     item.set_inventory(itemKey.GetNumber<uint32_t>("inventory"));
@@ -200,23 +210,23 @@ void Inventory::ReadItem(const KeyValue &itemKey, CSOEconItem &item) const
     //item.set_original_id(itemKey.GetNumber<uint64_t>("original_id"));
     item.set_rarity(itemKey.GetNumber<uint32_t>("rarity"));
 
-    const KeyValue *attributesKey = itemKey.GetSubkey("attributes");
+    const KeyValueView *attributesKey = itemKey.GetSubkey("attributes");
     if (attributesKey)
     {
-        for (const KeyValue &attributeKey : *attributesKey)
+        for (const KeyValueView &attributeKey : *attributesKey)
         {
             CSOEconItemAttribute *attribute = item.add_attribute();
 
             uint32_t defIndex = FromString<uint32_t>(attributeKey.Name());
             attribute->set_def_index(defIndex);
-            m_itemSchema.SetAttributeString(attribute, attributeKey.String());
+            m_itemSchema->SetAttributeString(attribute, attributeKey.String());
         }
     }
 
-    const KeyValue *equippedStateKey = itemKey.GetSubkey("equipped_state");
+    const KeyValueView *equippedStateKey = itemKey.GetSubkey("equipped_state");
     if (equippedStateKey)
     {
-        for (const KeyValue &equippedKey : *equippedStateKey)
+        for (const KeyValueView &equippedKey : *equippedStateKey)
         {
             CSOEconItemEquipped *equipped = item.add_equipped_state();
             equipped->set_new_class(FromString<uint32_t>(equippedKey.Name()));
@@ -276,7 +286,7 @@ void Inventory::WriteItem(KeyValue &itemKey, const CSOEconItem &item) const
     for (const CSOEconItemAttribute &attribute : item.attribute())
     {
         std::string name = std::to_string(attribute.def_index());
-        std::string value = m_itemSchema.AttributeString(&attribute);
+        std::string value = m_itemSchema->AttributeString(&attribute);
         attributesKey.AddString(name, value);
     }
 
@@ -438,7 +448,7 @@ bool Inventory::UseItem(uint64_t itemId,
     // remove this to have unlimited sprays
     CSOEconItemAttribute *attribute = unsealed.add_attribute();
     attribute->set_def_index(ItemSchema::AttributeSpraysRemaining);
-    m_itemSchema.SetAttributeUint32(attribute, 50);
+    m_itemSchema->SetAttributeUint32(attribute, 50);
 
     return true;
 }
@@ -456,7 +466,7 @@ bool Inventory::UnlockCrate(uint64_t crateId,
     }
 
     CSOEconItem temp;
-    if (!m_itemSchema.SelectItemFromCrate(crate->second, temp))
+    if (!m_itemSchema->SelectItemFromCrate(crate->second, temp))
     {
         assert(false);
         return false;
@@ -526,134 +536,134 @@ void Inventory::ItemToPreviewDataBlock(const CSOEconItem &item, CEconItemPreview
         switch (defIndex)
         {
         case ItemSchema::AttributeTexturePrefab:
-            block.set_paintindex(m_itemSchema.AttributeUint32(&attribute));
+            block.set_paintindex(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeTextureSeed:
-            block.set_paintseed(m_itemSchema.AttributeUint32(&attribute));
+            block.set_paintseed(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeTextureWear:
         {
-            int wearLevel = ItemWearLevel(m_itemSchema.AttributeFloat(&attribute));
+            int wearLevel = ItemWearLevel(m_itemSchema->AttributeFloat(&attribute));
             block.set_paintwear(wearLevel);
             break;
         }
 
         case ItemSchema::AttributeKillEater:
-            block.set_killeatervalue(m_itemSchema.AttributeUint32(&attribute));
+            block.set_killeatervalue(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeKillEaterScoreType:
-            block.set_killeaterscoretype(m_itemSchema.AttributeUint32(&attribute));
+            block.set_killeaterscoretype(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeMusicId:
-            block.set_musicindex(m_itemSchema.AttributeUint32(&attribute));
+            block.set_musicindex(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeQuestId:
-            block.set_questid(m_itemSchema.AttributeUint32(&attribute));
+            block.set_questid(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeSprayTintId:
-            stickers[0].set_tint_id(m_itemSchema.AttributeUint32(&attribute));
+            stickers[0].set_tint_id(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeStickerId0:
-            stickers[0].set_sticker_id(m_itemSchema.AttributeUint32(&attribute));
+            stickers[0].set_sticker_id(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeStickerWear0:
-            stickers[0].set_wear(m_itemSchema.AttributeFloat(&attribute));
+            stickers[0].set_wear(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerScale0:
-            stickers[0].set_scale(m_itemSchema.AttributeFloat(&attribute));
+            stickers[0].set_scale(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerRotation0:
-            stickers[0].set_rotation(m_itemSchema.AttributeFloat(&attribute));
+            stickers[0].set_rotation(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerId1:
-            stickers[1].set_sticker_id(m_itemSchema.AttributeUint32(&attribute));
+            stickers[1].set_sticker_id(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeStickerWear1:
-            stickers[1].set_wear(m_itemSchema.AttributeFloat(&attribute));
+            stickers[1].set_wear(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerScale1:
-            stickers[1].set_scale(m_itemSchema.AttributeFloat(&attribute));
+            stickers[1].set_scale(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerRotation1:
-            stickers[1].set_rotation(m_itemSchema.AttributeFloat(&attribute));
+            stickers[1].set_rotation(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerId2:
-            stickers[2].set_sticker_id(m_itemSchema.AttributeUint32(&attribute));
+            stickers[2].set_sticker_id(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeStickerWear2:
-            stickers[2].set_wear(m_itemSchema.AttributeFloat(&attribute));
+            stickers[2].set_wear(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerScale2:
-            stickers[2].set_scale(m_itemSchema.AttributeFloat(&attribute));
+            stickers[2].set_scale(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerRotation2:
-            stickers[2].set_rotation(m_itemSchema.AttributeFloat(&attribute));
+            stickers[2].set_rotation(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerId3:
-            stickers[3].set_sticker_id(m_itemSchema.AttributeUint32(&attribute));
+            stickers[3].set_sticker_id(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeStickerWear3:
-            stickers[3].set_wear(m_itemSchema.AttributeFloat(&attribute));
+            stickers[3].set_wear(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerScale3:
-            stickers[3].set_scale(m_itemSchema.AttributeFloat(&attribute));
+            stickers[3].set_scale(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerRotation3:
-            stickers[3].set_rotation(m_itemSchema.AttributeFloat(&attribute));
+            stickers[3].set_rotation(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerId4:
-            stickers[4].set_sticker_id(m_itemSchema.AttributeUint32(&attribute));
+            stickers[4].set_sticker_id(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeStickerWear4:
-            stickers[4].set_wear(m_itemSchema.AttributeFloat(&attribute));
+            stickers[4].set_wear(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerScale4:
-            stickers[4].set_scale(m_itemSchema.AttributeFloat(&attribute));
+            stickers[4].set_scale(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerRotation4:
-            stickers[4].set_rotation(m_itemSchema.AttributeFloat(&attribute));
+            stickers[4].set_rotation(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerId5:
-            stickers[5].set_sticker_id(m_itemSchema.AttributeUint32(&attribute));
+            stickers[5].set_sticker_id(m_itemSchema->AttributeUint32(&attribute));
             break;
 
         case ItemSchema::AttributeStickerWear5:
-            stickers[5].set_wear(m_itemSchema.AttributeFloat(&attribute));
+            stickers[5].set_wear(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerScale5:
-            stickers[5].set_scale(m_itemSchema.AttributeFloat(&attribute));
+            stickers[5].set_scale(m_itemSchema->AttributeFloat(&attribute));
             break;
 
         case ItemSchema::AttributeStickerRotation5:
-            stickers[5].set_rotation(m_itemSchema.AttributeFloat(&attribute));
+            stickers[5].set_rotation(m_itemSchema->AttributeFloat(&attribute));
             break;
         }
     }
@@ -751,7 +761,7 @@ bool Inventory::ApplySticker(const CMsgApplySticker &message,
     {
         if (attribute.def_index() == ItemSchema::AttributeStickerId0)
         {
-            stickerKit = m_itemSchema.AttributeUint32(&attribute);
+            stickerKit = m_itemSchema->AttributeUint32(&attribute);
             break;
         }
     }
@@ -769,14 +779,14 @@ bool Inventory::ApplySticker(const CMsgApplySticker &message,
     // add the sticker id attribute
     CSOEconItemAttribute *attribute = item->add_attribute();
     attribute->set_def_index(attributeStickerId);
-    m_itemSchema.SetAttributeUint32(attribute, stickerKit);
+    m_itemSchema->SetAttributeUint32(attribute, stickerKit);
 
     // add the sticker wear attribute if this is not a patch (mikkotodo revisit...)
     if (sticker->second.def_index() != ItemSchema::ItemPatch)
     {
         attribute = item->add_attribute();
         attribute->set_def_index(attributeStickerWear);
-        m_itemSchema.SetAttributeFloat(attribute, 0);
+        m_itemSchema->SetAttributeFloat(attribute, 0);
     }
 
     ToSingleObject(update, *item);
@@ -840,7 +850,7 @@ bool Inventory::ScrapeSticker(const CMsgApplySticker &message,
     {
         // mikkotodo randomize
         float wearIncrement = 1.0f / 9;
-        wearLevel = m_itemSchema.AttributeFloat(wearAttribute) + wearIncrement;
+        wearLevel = m_itemSchema->AttributeFloat(wearAttribute) + wearIncrement;
     }
 
     // if the wear attribute is not present, remove it outright (patches)
@@ -864,7 +874,7 @@ bool Inventory::ScrapeSticker(const CMsgApplySticker &message,
     else
     {
         // just update the wear
-        m_itemSchema.SetAttributeFloat(wearAttribute, wearLevel);
+        m_itemSchema->SetAttributeFloat(wearAttribute, wearLevel);
 
         ToSingleObject(update, item);
     }
@@ -889,8 +899,8 @@ bool Inventory::IncrementKillCountAttribute(uint64_t itemId, uint32_t amount, CM
         CSOEconItemAttribute *attribute = item.mutable_attribute(i);
         if (attribute->def_index() == ItemSchema::AttributeKillEater)
         {
-            int value = m_itemSchema.AttributeUint32(attribute) + amount;
-            m_itemSchema.SetAttributeUint32(attribute, value);
+            int value = m_itemSchema->AttributeUint32(attribute) + amount;
+            m_itemSchema->SetAttributeUint32(attribute, value);
             incremented = true;
             break;
         }
@@ -8,7 +8,10 @@
 #include "item_schema.hpp"
 #include "gc_const_csgo.hpp"
 
+#include <memory>
+
 class KeyValue;
+class KeyValueView;
 
 using ItemMap = std::unordered_map<uint64_t, CSOEconItem>;
 
@@ -73,7 +76,7 @@ private:
     CSOEconItem &CreateItem(uint32_t highItemId, CSOEconItem *copyFrom = nullptr);
 
     void ReadFromFile();
-    void ReadItem(const KeyValue &itemKey, CSOEconItem &item) const;
+    void ReadItem(const KeyValueView &itemKey, CSOEconItem &item) const;
 
     void WriteToFile() const;
     void WriteItem(KeyValue &itemKey, const CSOEconItem &item) const;
@@ -113,7 +116,7 @@ private:
     }
 
     const uint64_t m_steamId;
-    ItemSchema m_itemSchema;
+    std::shared_ptr<const ItemSchema> m_itemSchema; // shared, see ItemSchemaStore
     uint32_t m_lastHighItemId{};
     ItemMap m_items;
     std::vector<CSOEconDefaultEquippedDefinitionInstanceClient> m_defaultEquips;
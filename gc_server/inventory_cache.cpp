@@ -0,0 +1,402 @@
+#include "inventory_cache.hpp"
+#include "inventory_versions.hpp"
+#include "logger.hpp"
+#include "prepared_stmt.hpp"
+#include "sql_transaction.hpp"
+#include "tunables_manager.hpp"
+
+InventoryCache &InventoryCache::GetInstance() {
+  static InventoryCache instance;
+  return instance;
+}
+
+// Row plus hash node and bucket, close enough to budget by
+size_t InventoryCache::EntryBytes(size_t itemCount) {
+  return sizeof(Entry) + sizeof(uint32_t) * 4 +
+         itemCount * (sizeof(Items::value_type) + sizeof(void *) * 3);
+}
+
+// Bytes plus the shared_ptr control block and the map node
+size_t InventoryCache::BlobBytes(const Blob &blob) {
+  size_t bytes = sizeof(std::map<uint64_t, Blob>::value_type) +
+                 sizeof(void *) * 4;
+  if (blob) {
+    bytes += blob->capacity() + sizeof(void *) * 4;
+  }
+  return bytes;
+}
+
+bool InventoryCache::Query(MYSQL *inventory_db, uint32_t accountId,
+                           std::optional<uint64_t> itemId, Items &items) {
+  static const std::string allQuery =
+      "SELECT " + CsgoItemRowBinder::selectList() +
+      " FROM csgo_items WHERE owner_account_id = ?";
+  static const std::string oneQuery = allQuery + " AND id = ?";
+
+  auto stmtOpt = createPreparedStatement(
+      inventory_db, itemId ? oneQuery.c_str() : allQuery.c_str());
+  if (!stmtOpt) {
+    logger::error("InventoryCache: Failed to prepare statement");
+    return false;
+  }
+
+  auto &stmt = *stmtOpt;
+  uint64_t idParam = itemId.value_or(0);
+  stmt.bindUint32(0, &accountId);
+  if (itemId) {
+    stmt.bindUint64(1, &idParam);
+  }
+
+  // Fetched unbuffered: rows go straight into the map instead of being
+  // held twice, once in the client-side result set
+  CsgoItemRowBinder rowBinder;
+  if (!stmt.execute() || !rowBinder.bind(stmt)) {
+    logger::error("InventoryCache: MySQL query failed: %s", stmt.error());
+    return false;
+  }
+
+  while (rowBinder.fetch(stmt)) {
+    if (rowBinder.row().item_id.empty()) {
+      continue; // unusable, same as the direct readers skip it
+    }
+    items[rowBinder.row().id] = rowBinder.row();
+  }
+  // A dropped connection mid-stream ends the fetch loop like end of data
+  if (mysql_stmt_errno(stmt.handle()) != 0) {
+    return false;
+  }
+  return true;
+}
+
+bool InventoryCache::Load(MYSQL *inventory_db, uint32_t accountId) {
+  if (!inventory_db || SQLTransaction::InTransaction(inventory_db)) {
+    return false;
+  }
+
+  Items items;
+  if (!Query(inventory_db, accountId, std::nullopt, items)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto existing = m_entries.find(accountId);
+  if (existing != m_entries.end()) {
+    EraseLocked(existing);
+  }
+
+  m_lru.push_front(accountId);
+  m_bytes += EntryBytes(items.size());
+  Entry entry;
+  entry.items = std::move(items);
+  entry.loaded = std::chrono::steady_clock::now();
+  entry.lruPos = m_lru.begin();
+  m_entries.emplace(accountId, std::move(entry));
+  EnforceBudgetLocked();
+  return true;
+}
+
+InventoryCache::Entry *InventoryCache::FreshLocked(uint32_t accountId) {
+  auto it = m_entries.find(accountId);
+  if (it == m_entries.end()) {
+    return nullptr;
+  }
+
+  int ttlSeconds =
+      TunablesManager::GetInstance().GetInt("inventory_cache_ttl_s", 300);
+  if (ttlSeconds > 0 && std::chrono::steady_clock::now() - it->second.loaded >=
+                            std::chrono::seconds(ttlSeconds)) {
+    EraseLocked(it);
+    return nullptr;
+  }
+
+  m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+  return &it->second;
+}
+
+bool InventoryCache::Read(MYSQL *load_db, uint32_t accountId,
+                          const std::function<void(const Items &)> &fn) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (Entry *entry = FreshLocked(accountId)) {
+      fn(entry->items);
+      return true;
+    }
+  }
+
+  if (!load_db || !Load(load_db, accountId)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Entry *entry = FreshLocked(accountId);
+  if (!entry) {
+    return false; // evicted straight away by the budget
+  }
+  fn(entry->items);
+  return true;
+}
+
+bool InventoryCache::ReadSerialized(
+    MYSQL *load_db, uint32_t accountId, const ItemSerializer &serializeItem,
+    uint32_t syntheticKey, const SyntheticSerializer &serializeSynthetic,
+    std::vector<Blob> &blobs) {
+  if (!Contains(accountId) && (!load_db || !Load(load_db, accountId))) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Entry *entry = FreshLocked(accountId);
+  if (!entry) {
+    return false; // expired or evicted since the load
+  }
+
+  if (entry->syntheticKey != syntheticKey) {
+    for (const Blob &blob : entry->synthetic) {
+      entry->blobBytes -= blob->capacity();
+      m_bytes -= blob->capacity();
+    }
+    std::vector<std::string> synthetic;
+    serializeSynthetic(synthetic);
+    entry->synthetic.clear();
+    for (std::string &bytes : synthetic) {
+      entry->synthetic.push_back(
+          std::make_shared<const std::string>(std::move(bytes)));
+      entry->blobBytes += entry->synthetic.back()->capacity();
+      m_bytes += entry->synthetic.back()->capacity();
+    }
+    entry->syntheticKey = syntheticKey;
+  }
+
+  size_t serialized = 0;
+  if (entry->blobs.size() != entry->items.size()) {
+    for (const auto &item : entry->items) {
+      BlobLocked(*entry, item.second, serializeItem, serialized);
+    }
+  }
+
+  blobs.clear();
+  blobs.reserve(entry->synthetic.size() + entry->blobs.size());
+  blobs.insert(blobs.end(), entry->synthetic.begin(), entry->synthetic.end());
+  for (const auto &[id, blob] : entry->blobs) {
+    if (blob) {
+      blobs.push_back(blob);
+    }
+  }
+
+  if (serialized > 0) {
+    logger::info("InventoryCache: Serialized %zu of %zu items for account %u",
+                 serialized, entry->items.size(), accountId);
+  }
+  // The caller holds its own references, so evicting this entry now
+  // doesn't cut its send short
+  EnforceBudgetLocked();
+  return true;
+}
+
+bool InventoryCache::ReadSerializedItems(
+    MYSQL *load_db, uint32_t accountId, const ItemSerializer &serializeItem,
+    const std::vector<uint64_t> &itemIds,
+    const std::function<void(uint64_t, const std::string *)> &emit) {
+  if (!Contains(accountId) && (!load_db || !Load(load_db, accountId))) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Entry *entry = FreshLocked(accountId);
+  if (!entry) {
+    return false;
+  }
+
+  size_t serialized = 0;
+  for (uint64_t id : itemIds) {
+    auto row = entry->items.find(id);
+    const std::string *blob = nullptr;
+    if (row != entry->items.end()) {
+      blob = BlobLocked(*entry, row->second, serializeItem, serialized).get();
+    }
+    emit(id, blob);
+  }
+  EnforceBudgetLocked();
+  return true;
+}
+
+const InventoryCache::Blob &
+InventoryCache::BlobLocked(Entry &entry, const CsgoItemRow &row,
+                           const ItemSerializer &serialize,
+                           size_t &serialized) {
+  auto [blob, inserted] = entry.blobs.try_emplace(row.id);
+  if (inserted) {
+    // Left null when it can't be sent: skipped on every send, not retried
+    std::string data;
+    if (serialize(row, data) && !data.empty()) {
+      blob->second = std::make_shared<const std::string>(std::move(data));
+    }
+    size_t bytes = BlobBytes(blob->second);
+    entry.blobBytes += bytes;
+    m_bytes += bytes;
+    serialized++;
+  }
+  return blob->second;
+}
+
+std::optional<CsgoItemRow> InventoryCache::Find(MYSQL *inventory_db,
+                                                uint32_t accountId,
+                                                uint64_t itemId) {
+  std::optional<CsgoItemRow> row;
+  bool cached = Read(inventory_db, accountId, [&](const Items &items) {
+    auto it = items.find(itemId);
+    if (it != items.end()) {
+      row = it->second;
+    }
+  });
+  if (row || !inventory_db) {
+    return row;
+  }
+
+  // Not cached, or written by someone else since the load
+  Items found;
+  if (!Query(inventory_db, accountId, itemId, found) || found.empty()) {
+    return std::nullopt;
+  }
+  row = found.begin()->second;
+  if (cached && !SQLTransaction::InTransaction(inventory_db)) {
+    Put(accountId, *row);
+  }
+  return row;
+}
+
+void InventoryCache::Put(uint32_t accountId, const CsgoItemRow &row,
+                         bool created) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(accountId);
+  if (created) {
+    InventoryVersions::GetInstance().Created(accountId, row.id);
+  } else if (it != m_entries.end() && it->second.items.count(row.id) == 0) {
+    // Read back from the database (Find, Refresh): new since the load
+    InventoryVersions::GetInstance().Created(accountId, row.id);
+  } else {
+    InventoryVersions::GetInstance().Modified(accountId, row.id);
+  }
+  if (it == m_entries.end()) {
+    return;
+  }
+
+  size_t before = it->second.items.size();
+  it->second.items[row.id] = row;
+  DropBlobLocked(it->second, row.id);
+  m_bytes += EntryBytes(it->second.items.size()) - EntryBytes(before);
+  EnforceBudgetLocked();
+}
+
+void InventoryCache::Erase(uint32_t accountId, uint64_t itemId) {
+  InventoryVersions::GetInstance().Removed(accountId, itemId);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(accountId);
+  if (it != m_entries.end() && it->second.items.erase(itemId) > 0) {
+    m_bytes -= EntryBytes(it->second.items.size() + 1) -
+               EntryBytes(it->second.items.size());
+    DropBlobLocked(it->second, itemId);
+  }
+}
+
+void InventoryCache::Update(uint32_t accountId, uint64_t itemId,
+                            const std::function<void(CsgoItemRow &)> &fn) {
+  InventoryVersions::GetInstance().Modified(accountId, itemId);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(accountId);
+  if (it == m_entries.end()) {
+    return;
+  }
+  auto item = it->second.items.find(itemId);
+  if (item != it->second.items.end()) {
+    fn(item->second);
+    DropBlobLocked(it->second, itemId);
+  }
+}
+
+void InventoryCache::Refresh(MYSQL *inventory_db, uint32_t accountId,
+                             uint64_t itemId) {
+  if (!Contains(accountId)) {
+    InventoryVersions::GetInstance().Modified(accountId, itemId);
+    return;
+  }
+  if (SQLTransaction::InTransaction(inventory_db)) {
+    Invalidate(accountId);
+    InventoryVersions::GetInstance().Truncate(accountId);
+    return;
+  }
+
+  Items found;
+  if (!Query(inventory_db, accountId, itemId, found)) {
+    Invalidate(accountId);
+    InventoryVersions::GetInstance().Truncate(accountId);
+  } else if (found.empty()) {
+    Erase(accountId, itemId);
+  } else {
+    Put(accountId, found.begin()->second);
+  }
+}
+
+void InventoryCache::Written(MYSQL *inventory_db, uint32_t accountId,
+                             const std::function<void()> &writeThrough) {
+  if (SQLTransaction::InTransaction(inventory_db)) {
+    // May still roll back; the next read after it ends loads again
+    Invalidate(accountId);
+    InventoryVersions::GetInstance().Truncate(accountId);
+  } else {
+    writeThrough();
+  }
+}
+
+void InventoryCache::Invalidate(uint32_t accountId) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(accountId);
+  if (it != m_entries.end()) {
+    EraseLocked(it);
+  }
+}
+
+bool InventoryCache::Contains(uint32_t accountId) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return FreshLocked(accountId) != nullptr;
+}
+
+size_t InventoryCache::MemoryBytes() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_bytes;
+}
+
+size_t InventoryCache::Accounts() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+void InventoryCache::DropBlobLocked(Entry &entry, uint64_t itemId) {
+  auto blob = entry.blobs.find(itemId);
+  if (blob == entry.blobs.end()) {
+    return;
+  }
+  size_t bytes = BlobBytes(blob->second);
+  entry.blobBytes -= bytes;
+  m_bytes -= bytes;
+  entry.blobs.erase(blob);
+}
+
+void InventoryCache::EraseLocked(
+    std::unordered_map<uint32_t, Entry>::iterator it) {
+  m_bytes -= EntryBytes(it->second.items.size()) + it->second.blobBytes;
+  m_lru.erase(it->second.lruPos);
+  m_entries.erase(it);
+}
+
+void InventoryCache::EnforceBudgetLocked() {
+  size_t budget =
+      static_cast<size_t>(TunablesManager::GetInstance().GetCacheSizeMB()) *
+      1024 * 1024;
+  while (m_bytes > budget && !m_lru.empty()) {
+    uint32_t victim = m_lru.back();
+    logger::info("InventoryCache: Evicting account %u (cache_size_mb)",
+                 victim);
+    EraseLocked(m_entries.find(victim));
+  }
+}
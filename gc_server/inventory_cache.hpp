@@ -0,0 +1,156 @@
+#pragma once
+/**
+ * inventory_cache.hpp - Write-through csgo_items cache for online players
+ *
+ * The GC is the only frequent writer of csgo_items, yet SendSOCache, item
+ * lookups, slot and position queries used to read the rows again on every
+ * request. The rows of each online player are loaded once at auth and kept
+ * here; every GC write path updates the cached rows after its database
+ * write, so reads are memory lookups.
+ *
+ * Consistency rules:
+ * - Writes inside an open transaction invalidate the account instead of
+ *   patching it, and reads on such a connection never load, so a rollback
+ *   can't leave uncommitted rows behind.
+ * - The new-item poller invalidates an account when it finds rows the GC
+ *   didn't write. Other writers' updates and deletes are picked up when the
+ *   entry is older than inventory_cache_ttl_s (default 300) seconds.
+ * - Entries are evicted when the session closes, and least-recently-used
+ *   beyond cache_size_mb.
+ *
+ * Cached rows are the table state plus the InventoryWriteQueue writes,
+ * which are applied here when they are queued.
+ *
+ * Each entry also keeps the serialized CSOEconItem bytes SendSOCache sends
+ * for every row. A blob is dropped whenever its row is written, so a
+ * reconnect re-serializes only the items that changed. Blobs are immutable
+ * and reference counted: a send takes references under the lock and
+ * streams the bytes after releasing it, without copying them.
+ *
+ * The write-through calls also record the change in InventoryVersions,
+ * whether or not the account is cached.
+ */
+
+#include "csgo_item_row.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mariadb/mysql.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class InventoryCache {
+public:
+  using Items = std::unordered_map<uint64_t, CsgoItemRow>;
+  // object_data bytes of one item, shared with sends still writing them
+  using Blob = std::shared_ptr<const std::string>;
+
+  // Serializes one row into object_data bytes; false if it can't be sent
+  using ItemSerializer =
+      std::function<bool(const CsgoItemRow &, std::string &)>;
+  // Builds the items that aren't rows (nametag, operation coin)
+  using SyntheticSerializer = std::function<void(std::vector<std::string> &)>;
+
+  static InventoryCache &GetInstance();
+
+  // (Re)loads every row of the account; false if the query failed
+  bool Load(MYSQL *inventory_db, uint32_t accountId);
+
+  /**
+   * Runs fn on the account's rows under the cache lock (fn must not call
+   * back into the cache). An account that isn't cached is loaded from
+   * load_db first when given; returns false if fn didn't run, in which case
+   * the caller reads the database itself.
+   */
+  bool Read(MYSQL *load_db, uint32_t accountId,
+            const std::function<void(const Items &)> &fn);
+
+  /**
+   * Fills blobs with the object_data of every item, synthetic items first
+   * and rows by ascending id. Only rows without cached bytes are
+   * serialized; the synthetic items are rebuilt when syntheticKey differs
+   * from the last call. The blobs are references into the cache, not
+   * copies. Loads like Read; false if the account couldn't be read.
+   */
+  bool ReadSerialized(MYSQL *load_db, uint32_t accountId,
+                      const ItemSerializer &serializeItem,
+                      uint32_t syntheticKey,
+                      const SyntheticSerializer &serializeSynthetic,
+                      std::vector<Blob> &blobs);
+
+  // ReadSerialized for the given rows only; emit gets nullptr for ids that
+  // have no row (or one that can't be sent)
+  bool ReadSerializedItems(
+      MYSQL *load_db, uint32_t accountId, const ItemSerializer &serializeItem,
+      const std::vector<uint64_t> &itemIds,
+      const std::function<void(uint64_t, const std::string *)> &emit);
+
+  // One row, falling back to the database (and caching the result) when
+  // the account is cached but the row isn't yet
+  std::optional<CsgoItemRow> Find(MYSQL *inventory_db, uint32_t accountId,
+                                  uint64_t itemId);
+
+  // Write-through after a committed write; no-ops for uncached accounts.
+  // Inserts pass created so the version log records them as added even
+  // when the account has been evicted.
+  void Put(uint32_t accountId, const CsgoItemRow &row, bool created = false);
+  void Erase(uint32_t accountId, uint64_t itemId);
+  void Update(uint32_t accountId, uint64_t itemId,
+              const std::function<void(CsgoItemRow &)> &fn);
+
+  // Re-reads one row after a write that is easier to read back than to
+  // replay (sticker slots); invalidates inside a transaction
+  void Refresh(MYSQL *inventory_db, uint32_t accountId, uint64_t itemId);
+
+  // A write on inventory_db touched the account: Put/Erase when fn can
+  // describe it and the connection is not in a transaction, else drop it
+  void Written(MYSQL *inventory_db, uint32_t accountId,
+               const std::function<void()> &writeThrough);
+
+  void Invalidate(uint32_t accountId);
+  bool Contains(uint32_t accountId);
+
+  size_t MemoryBytes() const;
+  size_t Accounts() const;
+
+private:
+  struct Entry {
+    Items items;
+    // Serialized rows by id; null marks a row that can't be sent
+    std::map<uint64_t, Blob> blobs;
+    std::vector<Blob> synthetic;
+    std::optional<uint32_t> syntheticKey;
+    size_t blobBytes = 0;
+    std::chrono::steady_clock::time_point loaded;
+    std::list<uint32_t>::iterator lruPos;
+  };
+
+  InventoryCache() = default;
+  ~InventoryCache() = default;
+
+  InventoryCache(const InventoryCache &) = delete;
+  InventoryCache &operator=(const InventoryCache &) = delete;
+
+  static bool Query(MYSQL *inventory_db, uint32_t accountId,
+                    std::optional<uint64_t> itemId, Items &items);
+  static size_t EntryBytes(size_t itemCount);
+  static size_t BlobBytes(const Blob &blob);
+
+  Entry *FreshLocked(uint32_t accountId);
+  const Blob &BlobLocked(Entry &entry, const CsgoItemRow &row,
+                         const ItemSerializer &serialize, size_t &serialized);
+  void DropBlobLocked(Entry &entry, uint64_t itemId);
+  void EraseLocked(std::unordered_map<uint32_t, Entry>::iterator it);
+  void EnforceBudgetLocked();
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<uint32_t, Entry> m_entries;
+  std::list<uint32_t> m_lru; // front = most recently used
+  size_t m_bytes = 0;
+};
@@ -0,0 +1,319 @@
+#include "inventory_procedures.hpp"
+#include "logger.hpp"
+#include "prepared_stmt.hpp"
+#include "sql_transaction.hpp"
+#include "tunables_manager.hpp"
+
+// Bump the suffix (and add the new name here) whenever a body or signature
+// changes; never redefine a deployed version
+static const char *const PROC_UNBOX_CRATE = "gc_unbox_crate_v1";
+static const char *const PROC_CRAFT = "gc_craft_v1";
+static const char *const PROC_APPLY_STICKER = "gc_apply_sticker_v1";
+
+InventoryProcedures &InventoryProcedures::GetInstance() {
+  static InventoryProcedures instance;
+  return instance;
+}
+
+/**
+ * CREATE statements for this build's procedures. IF NOT EXISTS leaves a
+ * deployed version alone, so GCs starting together can't race on it or
+ * drop a procedure another one is calling. Every procedure runs its
+ * own transaction; any error (including the SIGNALs for failed ownership
+ * checks) rolls it back and is re-raised to the caller unchanged, so
+ * deadlocks still arrive as ER_LOCK_DEADLOCK.
+ */
+std::vector<std::pair<std::string, std::string>>
+InventoryProcedures::Definitions() {
+  const std::string onError = "  DECLARE EXIT HANDLER FOR SQLEXCEPTION\n"
+                              "  BEGIN\n"
+                              "    ROLLBACK;\n"
+                              "    RESIGNAL;\n"
+                              "  END;\n";
+  const std::string insertNewItem =
+      "  INSERT INTO csgo_items (" + CsgoItemInsert::ColumnList() +
+      ")\n  VALUES (" + CsgoItemInsert::ColumnList("p_") + ");\n";
+
+  std::vector<std::pair<std::string, std::string>> definitions;
+
+  definitions.emplace_back(
+      PROC_UNBOX_CRATE, std::string("CREATE PROCEDURE IF NOT EXISTS ") + PROC_UNBOX_CRATE +
+      "(IN p_crate_id BIGINT UNSIGNED, " +
+      CsgoItemInsert::ParameterDeclarations() +
+      ")\n"
+      "MODIFIES SQL DATA\n"
+      "BEGIN\n"
+      "  DECLARE v_new_id BIGINT UNSIGNED;\n" +
+      onError +
+      "  START TRANSACTION;\n"
+      "  DELETE FROM csgo_items\n"
+      "   WHERE id = p_crate_id AND owner_account_id = p_owner_account_id;\n"
+      "  IF ROW_COUNT() <> 1 THEN\n"
+      "    SIGNAL SQLSTATE '45000' SET MESSAGE_TEXT = 'crate not owned';\n"
+      "  END IF;\n" +
+      insertNewItem +
+      "  SET v_new_id = LAST_INSERT_ID();\n"
+      "  COMMIT;\n"
+      "  SELECT v_new_id;\n"
+      "END");
+
+  std::string inputDeclarations;
+  std::string inputList;
+  for (int i = 1; i <= CRAFT_INPUTS; i++) {
+    std::string name = "p_input_" + std::to_string(i);
+    inputDeclarations += "IN " + name + " BIGINT UNSIGNED, ";
+    inputList += (i == 1 ? "" : ", ") + name;
+  }
+  definitions.emplace_back(
+      PROC_CRAFT, std::string("CREATE PROCEDURE IF NOT EXISTS ") + PROC_CRAFT + "(" +
+      inputDeclarations + CsgoItemInsert::ParameterDeclarations() +
+      ")\n"
+      "MODIFIES SQL DATA\n"
+      "BEGIN\n"
+      "  DECLARE v_new_id BIGINT UNSIGNED;\n" +
+      onError +
+      "  START TRANSACTION;\n"
+      "  DELETE FROM csgo_items\n"
+      "   WHERE owner_account_id = p_owner_account_id AND id IN (" +
+      inputList +
+      ");\n"
+      // Duplicate ids collapse in IN (...), so reused items fail this too
+      "  IF ROW_COUNT() <> " +
+      std::to_string(CRAFT_INPUTS) +
+      " THEN\n"
+      "    SIGNAL SQLSTATE '45000' SET MESSAGE_TEXT = 'inputs not owned';\n"
+      "  END IF;\n" +
+      insertNewItem +
+      "  SET v_new_id = LAST_INSERT_ID();\n"
+      "  COMMIT;\n"
+      "  SELECT v_new_id;\n"
+      "END");
+
+  // The kit id of a sticker item is stored in its paint_index
+  std::string stickerAssignments;
+  for (int slot = 0; slot < CsgoItemInsert::STICKER_SLOTS; slot++) {
+    std::string column = "sticker_" + std::to_string(slot + 1);
+    std::string when = "IF(p_slot = " + std::to_string(slot) + ", ";
+    stickerAssignments += (slot == 0 ? "      " : ",\n      ") + column +
+                          " = " + when + "v_kit, " + column + "),\n      " +
+                          column + "_wear = " + when + "0, " + column +
+                          "_wear)";
+  }
+  definitions.emplace_back(
+      PROC_APPLY_STICKER, std::string("CREATE PROCEDURE IF NOT EXISTS ") + PROC_APPLY_STICKER +
+      "(IN p_account_id INT UNSIGNED, IN p_sticker_id BIGINT UNSIGNED, "
+      "IN p_target_id BIGINT UNSIGNED, IN p_slot INT UNSIGNED)\n"
+      "MODIFIES SQL DATA\n"
+      "BEGIN\n"
+      "  DECLARE v_kit INT UNSIGNED DEFAULT NULL;\n"
+      "  DECLARE v_targets INT DEFAULT 0;\n" +
+      onError + "  IF p_slot >= " +
+      std::to_string(CsgoItemInsert::STICKER_SLOTS) +
+      " THEN\n"
+      "    SIGNAL SQLSTATE '45000' SET MESSAGE_TEXT = 'invalid slot';\n"
+      "  END IF;\n"
+      "  START TRANSACTION;\n"
+      "  SELECT paint_index INTO v_kit FROM csgo_items\n"
+      "   WHERE id = p_sticker_id AND owner_account_id = p_account_id\n"
+      "     AND item_id LIKE 'sticker-%' FOR UPDATE;\n"
+      "  SELECT COUNT(*) INTO v_targets FROM csgo_items\n"
+      "   WHERE id = p_target_id AND owner_account_id = p_account_id\n"
+      "     AND id <> p_sticker_id FOR UPDATE;\n"
+      "  IF v_kit IS NULL OR v_targets <> 1 THEN\n"
+      "    SIGNAL SQLSTATE '45000' SET MESSAGE_TEXT = 'items not owned';\n"
+      "  END IF;\n"
+      "  DELETE FROM csgo_items WHERE id = p_sticker_id;\n"
+      "  UPDATE csgo_items SET\n" +
+      stickerAssignments +
+      "\n   WHERE id = p_target_id;\n"
+      "  COMMIT;\n"
+      "END");
+
+  return definitions;
+}
+
+/**
+ * Names of this build's procedures present in the current schema, or
+ * nullopt if the check itself failed.
+ */
+std::optional<std::unordered_set<std::string>>
+InventoryProcedures::Deployed(MYSQL *inventory_db) {
+  std::string query = std::string("SELECT ROUTINE_NAME FROM "
+                                  "information_schema.ROUTINES "
+                                  "WHERE ROUTINE_SCHEMA = DATABASE() "
+                                  "AND ROUTINE_TYPE = 'PROCEDURE' "
+                                  "AND ROUTINE_NAME IN ('") +
+                      PROC_UNBOX_CRATE + "', '" + PROC_CRAFT + "', '" +
+                      PROC_APPLY_STICKER + "')";
+  if (!RunDBCall(inventory_db, "InventoryProcedures",
+                 [&] { return mysql_query(inventory_db, query.c_str()); })) {
+    logger::error("InventoryProcedures: Failed to list procedures: %s",
+                  mysql_error(inventory_db));
+    return std::nullopt;
+  }
+
+  MYSQL_RES *result = mysql_store_result(inventory_db);
+  if (!result) {
+    return std::nullopt;
+  }
+
+  std::unordered_set<std::string> names;
+  while (MYSQL_ROW row = mysql_fetch_row(result)) {
+    if (row[0]) {
+      names.insert(row[0]);
+    }
+  }
+  mysql_free_result(result);
+  return names;
+}
+
+bool InventoryProcedures::Init(MYSQL *inventory_db) {
+  m_available = false;
+
+  const auto &tunables = TunablesManager::GetInstance();
+  if (!tunables.GetBool("db_stored_procedures", true)) {
+    logger::info("InventoryProcedures: Disabled by db_stored_procedures");
+    return false;
+  }
+
+  auto deployed = Deployed(inventory_db);
+  auto definitions = Definitions();
+  if (deployed && deployed->size() != definitions.size() &&
+      tunables.GetBool("db_deploy_procedures", true)) {
+    // Only the missing ones; deployed versions are never redefined
+    for (const auto &[name, definition] : definitions) {
+      if (deployed->count(name)) {
+        continue;
+      }
+      logger::info("InventoryProcedures: Creating %s", name.c_str());
+      if (!RunDBCall(inventory_db, "InventoryProcedures", [&] {
+            return mysql_query(inventory_db, definition.c_str());
+          })) {
+        logger::error("InventoryProcedures: Failed to create %s: %s",
+                      name.c_str(), mysql_error(inventory_db));
+        continue;
+      }
+      deployed->insert(name);
+    }
+  }
+
+  if (!deployed || deployed->size() != definitions.size()) {
+    logger::warning("InventoryProcedures: Procedures unavailable, unbox/craft/"
+                    "sticker use client-side transactions");
+    return false;
+  }
+
+  logger::info("InventoryProcedures: %s, %s, %s ready", PROC_UNBOX_CRATE,
+               PROC_CRAFT, PROC_APPLY_STICKER);
+  m_available = true;
+  return true;
+}
+
+bool InventoryProcedures::CanCall(MYSQL *inventory_db) const {
+  return m_available && inventory_db &&
+         !SQLTransaction::InTransaction(inventory_db);
+}
+
+/**
+ * Runs one CALL, retrying it on deadlock / lock wait timeout like
+ * RunTransaction. bind(PreparedStatement &) binds the parameters. With
+ * returnsId the procedure's single-value result set is returned (0 if none).
+ */
+template <typename Bind>
+std::optional<uint64_t> InventoryProcedures::Call(MYSQL *inventory_db,
+                                                  const char *name,
+                                                  const std::string &query,
+                                                  bool returnsId, Bind &&bind) {
+  auto stmtOpt = createPreparedStatement(inventory_db, query.c_str());
+  if (!stmtOpt) {
+    return std::nullopt;
+  }
+  auto &stmt = *stmtOpt;
+  bind(stmt);
+
+  GetSQLTransactionStats().units++;
+
+  for (int attempt = 0;; attempt++) {
+    if (stmt.execute()) {
+      uint64_t value = 0;
+      if (returnsId) {
+        MYSQL_BIND result = {};
+        result.buffer_type = MYSQL_TYPE_LONGLONG;
+        result.buffer = &value;
+        result.is_unsigned = 1;
+        if (!stmt.bindResult(&result) || !stmt.storeResult() ||
+            stmt.fetch() != 0) {
+          logger::warning("%s: Committed, but the new id couldn't be read: %s",
+                          name, stmt.error());
+          value = 0;
+        }
+      }
+      stmt.drainResults();
+      return value;
+    }
+
+    unsigned int error = mysql_stmt_errno(stmt.handle());
+    logger::error("%s: CALL failed: %s", name, stmt.error());
+    stmt.drainResults();
+    if (!SQLRetryBackoff(name, error, attempt)) {
+      return std::nullopt;
+    }
+  }
+}
+
+InventoryProcedures::Inserted
+InventoryProcedures::UnboxCrate(MYSQL *inventory_db, uint64_t crateId,
+                                CsgoItemInsert &newItem) {
+  std::string query = std::string("CALL ") + PROC_UNBOX_CRATE +
+                      sqlPlaceholderList(1 + CsgoItemInsert::COLUMN_COUNT);
+  auto newId = Call(inventory_db, PROC_UNBOX_CRATE, query, true,
+                    [&](PreparedStatement &stmt) {
+                      stmt.bindUint64(0, &crateId);
+                      newItem.Bind(stmt, 1);
+                    });
+  if (!newId) {
+    return {};
+  }
+  return {true, *newId};
+}
+
+InventoryProcedures::Inserted
+InventoryProcedures::Craft(MYSQL *inventory_db,
+                           const std::vector<uint64_t> &inputIds,
+                           CsgoItemInsert &result) {
+  if (inputIds.size() != CRAFT_INPUTS) {
+    logger::error("%s: Expected %d inputs, got %zu", PROC_CRAFT, CRAFT_INPUTS,
+                  inputIds.size());
+    return {};
+  }
+
+  std::vector<uint64_t> inputs = inputIds;
+  std::string query =
+      std::string("CALL ") + PROC_CRAFT +
+      sqlPlaceholderList(CRAFT_INPUTS + CsgoItemInsert::COLUMN_COUNT);
+  auto newId = Call(inventory_db, PROC_CRAFT, query, true,
+                    [&](PreparedStatement &stmt) {
+                      stmt.bindUint64List(0, inputs.data(), CRAFT_INPUTS);
+                      result.Bind(stmt, CRAFT_INPUTS);
+                    });
+  if (!newId) {
+    return {};
+  }
+  return {true, *newId};
+}
+
+bool InventoryProcedures::ApplySticker(MYSQL *inventory_db, uint64_t steamId,
+                                       uint64_t stickerId, uint64_t targetId,
+                                       uint32_t slot) {
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  std::string query =
+      std::string("CALL ") + PROC_APPLY_STICKER + sqlPlaceholderList(4);
+  return Call(inventory_db, PROC_APPLY_STICKER, query, false,
+              [&](PreparedStatement &stmt) {
+                stmt.bindUint32(0, &accountId);
+                stmt.bindUint64(1, &stickerId);
+                stmt.bindUint64(2, &targetId);
+                stmt.bindUint32(3, &slot);
+              })
+      .has_value();
+}
@@ -0,0 +1,84 @@
+#pragma once
+/**
+ * inventory_procedures.hpp - Stored procedures for compound inventory writes
+ *
+ * Unboxing, crafting and applying a sticker each touch several csgo_items
+ * rows. Run from the GC that is one round trip per statement while the
+ * transaction holds its row locks; as stored procedures each operation is a
+ * single CALL that starts, checks and commits its own transaction on the
+ * server.
+ *
+ * The procedures are versioned by name (gc_unbox_crate_v1, ...). Init checks
+ * at startup that this build's versions exist and creates them when they
+ * don't (db_deploy_procedures, default true). A deployed version is never
+ * changed: a new body or signature gets the next suffix, so GCs of different
+ * builds can share a database. When the procedures are unavailable, or
+ * db_stored_procedures is false, callers use their client-side transaction
+ * instead.
+ */
+
+#include "csgo_item_insert.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mariadb/mysql.h>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class InventoryProcedures {
+public:
+  // Trade up contracts always consume exactly this many items
+  static constexpr int CRAFT_INPUTS = 10;
+
+  // Outcome of a CALL that inserts an item. The procedures SIGNAL on every
+  // refusal, so once the CALL succeeds its transaction has committed even
+  // if the new id can't be read back; itemId is 0 then.
+  struct Inserted {
+    bool committed = false;
+    uint64_t itemId = 0;
+  };
+
+  static InventoryProcedures &GetInstance();
+
+  // Verifies (and if allowed deploys) the procedures; false = not available
+  bool Init(MYSQL *inventory_db);
+
+  // Procedures commit their own transaction, so they can't be called while
+  // the connection is inside one
+  bool CanCall(MYSQL *inventory_db) const;
+
+  // Deletes the crate and inserts newItem
+  Inserted UnboxCrate(MYSQL *inventory_db, uint64_t crateId,
+                      CsgoItemInsert &newItem);
+
+  // Deletes the CRAFT_INPUTS inputs and inserts result
+  Inserted Craft(MYSQL *inventory_db, const std::vector<uint64_t> &inputIds,
+                 CsgoItemInsert &result);
+
+  // Consumes the sticker item and writes its kit into the target's slot
+  bool ApplySticker(MYSQL *inventory_db, uint64_t steamId, uint64_t stickerId,
+                    uint64_t targetId, uint32_t slot);
+
+private:
+  InventoryProcedures() = default;
+  ~InventoryProcedures() = default;
+
+  InventoryProcedures(const InventoryProcedures &) = delete;
+  InventoryProcedures &operator=(const InventoryProcedures &) = delete;
+
+  // (name, CREATE statement) for each of this build's procedures
+  static std::vector<std::pair<std::string, std::string>> Definitions();
+  static std::optional<std::unordered_set<std::string>>
+  Deployed(MYSQL *inventory_db);
+
+  // nullopt when the CALL failed; with returnsId, 0 when it committed but
+  // its result row couldn't be read
+  template <typename Bind>
+  std::optional<uint64_t> Call(MYSQL *inventory_db, const char *name,
+                               const std::string &query, bool returnsId,
+                               Bind &&bind);
+
+  std::atomic<bool> m_available{false};
+};
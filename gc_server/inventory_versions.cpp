@@ -0,0 +1,129 @@
+#include "inventory_versions.hpp"
+#include "tunables_manager.hpp"
+#include <algorithm>
+#include <map>
+
+InventoryVersions &InventoryVersions::GetInstance() {
+  static InventoryVersions instance;
+  return instance;
+}
+
+uint64_t InventoryVersions::StartVersion() {
+  auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+  return static_cast<uint64_t>(seconds) << 20;
+}
+
+InventoryVersions::History &
+InventoryVersions::HistoryLocked(uint32_t accountId) {
+  auto it = m_histories.find(accountId);
+  if (it != m_histories.end()) {
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+    return it->second;
+  }
+
+  size_t maxHistories = static_cast<size_t>(std::max(
+      1, TunablesManager::GetInstance().GetInt("inventory_versions_size",
+                                               16384)));
+  while (m_histories.size() >= maxHistories && !m_lru.empty()) {
+    m_histories.erase(m_lru.back());
+    m_lru.pop_back();
+  }
+
+  m_lru.push_front(accountId);
+  History &history = m_histories[accountId];
+  history.version = StartVersion();
+  history.oldest = history.version;
+  history.lruPos = m_lru.begin();
+  return history;
+}
+
+void InventoryVersions::RecordLocked(uint32_t accountId, uint64_t itemId,
+                                     ChangeKind kind) {
+  History &history = HistoryLocked(accountId);
+  history.version++;
+  history.log.push_back(Change{history.version, itemId, kind});
+
+  size_t maxLog = static_cast<size_t>(std::max(
+      0, TunablesManager::GetInstance().GetInt("inventory_changelog_size",
+                                               256)));
+  while (history.log.size() > maxLog) {
+    // Deltas must now start at or after the dropped change
+    history.oldest = history.log.front().version;
+    history.log.pop_front();
+  }
+}
+
+uint64_t InventoryVersions::Current(uint32_t accountId) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return HistoryLocked(accountId).version;
+}
+
+void InventoryVersions::Created(uint32_t accountId, uint64_t itemId) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  RecordLocked(accountId, itemId, ChangeKind::Created);
+}
+
+void InventoryVersions::Modified(uint32_t accountId, uint64_t itemId) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  RecordLocked(accountId, itemId, ChangeKind::Modified);
+}
+
+void InventoryVersions::Removed(uint32_t accountId, uint64_t itemId) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  RecordLocked(accountId, itemId, ChangeKind::Removed);
+}
+
+void InventoryVersions::Truncate(uint32_t accountId) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  History &history = HistoryLocked(accountId);
+  history.version++;
+  history.oldest = history.version;
+  history.log.clear();
+}
+
+std::optional<InventoryVersions::Delta>
+InventoryVersions::Since(uint32_t accountId, uint64_t knownVersion) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const History &history = HistoryLocked(accountId);
+  if (knownVersion < history.oldest || knownVersion > history.version) {
+    return std::nullopt;
+  }
+
+  // Net change per item, ordered by id like the snapshot
+  std::map<uint64_t, ChangeKind> net;
+  for (const Change &change : history.log) {
+    if (change.version <= knownVersion) {
+      continue;
+    }
+    auto it = net.find(change.itemId);
+    if (it == net.end()) {
+      net.emplace(change.itemId, change.kind);
+    } else if (change.kind == ChangeKind::Removed) {
+      if (it->second == ChangeKind::Created) {
+        net.erase(it); // never seen by the client
+      } else {
+        it->second = ChangeKind::Removed;
+      }
+    } else if (it->second == ChangeKind::Removed) {
+      it->second = ChangeKind::Modified;
+    }
+  }
+
+  Delta delta;
+  for (const auto &[itemId, kind] : net) {
+    switch (kind) {
+    case ChangeKind::Created:
+      delta.added.push_back(itemId);
+      break;
+    case ChangeKind::Modified:
+      delta.modified.push_back(itemId);
+      break;
+    case ChangeKind::Removed:
+      delta.removed.push_back(itemId);
+      break;
+    }
+  }
+  return delta;
+}
@@ -0,0 +1,91 @@
+#pragma once
+/**
+ * inventory_versions.hpp - Per-player inventory versions and change log
+ *
+ * Every inventory mutation the GC makes bumps the owner's version and is
+ * recorded in a short log of (version, item, kind). The version is sent as
+ * the SOCache version. When a client reconnects, the GC sends it a
+ * CMsgSOCacheSubscriptionCheck with the current version; a client holding
+ * another one answers with a CacheSubscriptionRefresh and gets only the
+ * items changed since the version last sent to its session.
+ *
+ * Versions only cover csgo_items rows. Default equips, persona data and the
+ * synthetic items (nametag, operation coin) aren't versioned; the GC never
+ * changes the first two, and the coin follows a global toggle, so a client
+ * only sees those change with a full SOCache.
+ *
+ * A client is sent a full snapshot instead when its version is older than
+ * the log reaches back: the log keeps inventory_changelog_size (default
+ * 256) entries per player, is reset by writes it can't describe (open
+ * transactions, rows from other writers), and histories are kept for
+ * inventory_versions_size (default 16384) players, least-recently-used.
+ *
+ * A new history starts at the current unix time shifted left 20 bits, so
+ * versions handed out before a GC restart or an eviction are below the new
+ * range and get a snapshot.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+class InventoryVersions {
+public:
+  // Items changed since a version, each in the list of its net change
+  struct Delta {
+    std::vector<uint64_t> added;
+    std::vector<uint64_t> modified;
+    std::vector<uint64_t> removed;
+  };
+
+  static InventoryVersions &GetInstance();
+
+  uint64_t Current(uint32_t accountId);
+
+  void Created(uint32_t accountId, uint64_t itemId);
+  void Modified(uint32_t accountId, uint64_t itemId);
+  void Removed(uint32_t accountId, uint64_t itemId);
+
+  // The account changed in ways the log can't describe; clients behind the
+  // new version get a snapshot
+  void Truncate(uint32_t accountId);
+
+  // Changes after knownVersion, or nullopt when a snapshot is needed
+  std::optional<Delta> Since(uint32_t accountId, uint64_t knownVersion);
+
+private:
+  enum class ChangeKind : uint8_t { Created, Modified, Removed };
+
+  struct Change {
+    uint64_t version;
+    uint64_t itemId;
+    ChangeKind kind;
+  };
+
+  struct History {
+    uint64_t version = 0;
+    uint64_t oldest = 0; // deltas can be built from this version on
+    std::deque<Change> log;
+    std::list<uint32_t>::iterator lruPos;
+  };
+
+  InventoryVersions() = default;
+  ~InventoryVersions() = default;
+
+  InventoryVersions(const InventoryVersions &) = delete;
+  InventoryVersions &operator=(const InventoryVersions &) = delete;
+
+  static uint64_t StartVersion();
+
+  History &HistoryLocked(uint32_t accountId);
+  void RecordLocked(uint32_t accountId, uint64_t itemId, ChangeKind kind);
+
+  std::mutex m_mutex;
+  std::unordered_map<uint32_t, History> m_histories;
+  std::list<uint32_t> m_lru; // front = most recently used
+};
@@ -0,0 +1,522 @@
+#include "inventory_write_queue.hpp"
+#include "inventory_cache.hpp"
+#include "logger.hpp"
+#include "prepared_stmt.hpp"
+#include "sql_transaction.hpp"
+#include "tunables_manager.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cinttypes>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static constexpr uint32_t UNACKNOWLEDGED_POSITION = 1073741824;
+
+InventoryWriteQueue &InventoryWriteQueue::GetInstance() {
+  static InventoryWriteQueue instance;
+  return instance;
+}
+
+InventoryWriteQueue::~InventoryWriteQueue() {
+  if (m_journal) {
+    fclose(m_journal);
+  }
+}
+
+bool InventoryWriteQueue::Init(MYSQL *inventory_db,
+                               const std::string &journalPath) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_journalPath = journalPath;
+  m_lastFlush = std::chrono::steady_clock::now();
+
+  bool replayed = ReplayJournal();
+  if (!m_items.empty()) {
+    logger::info("InventoryWriteQueue: Replaying %zu journaled item writes",
+                 m_items.size());
+    if (!FlushLocked(inventory_db, std::nullopt)) {
+      logger::error("InventoryWriteQueue: Journal replay failed, keeping %s",
+                    m_journalPath.c_str());
+    }
+  }
+
+  // Reopen for appending; FlushLocked truncates it once the queue is empty
+  if (!m_journal) {
+    m_journal = fopen(m_journalPath.c_str(), "a");
+  }
+  bool opened = (m_journal != nullptr);
+  if (!opened) {
+    logger::error("InventoryWriteQueue: Could not open journal %s",
+                  m_journalPath.c_str());
+  }
+
+  NotifyFlushed(lock);
+  return opened && replayed;
+}
+
+void InventoryWriteQueue::SetOnFlushed(
+    std::function<void(uint32_t)> callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_onFlushed = std::move(callback);
+}
+
+InventoryWriteQueue::PendingItem &
+InventoryWriteQueue::Entry(uint32_t accountId, uint64_t itemId) {
+  PendingItem &item = m_items[itemId];
+  if (item.accountId != accountId) {
+    // New entry, or the item changed hands; the old owner's writes would be
+    // rejected by the owner_account_id filter anyway
+    if (item.accountId != 0) {
+      m_itemsByUser[item.accountId].erase(itemId);
+    }
+    item = PendingItem{};
+    item.accountId = accountId;
+  }
+  m_itemsByUser[accountId].insert(itemId);
+  return item;
+}
+
+void InventoryWriteQueue::Journal(const std::string &record) {
+  if (!m_journal) {
+    return;
+  }
+  fputs(record.c_str(), m_journal);
+  fflush(m_journal);
+
+  // The write is acknowledged right after this, so it has to be on disk
+#ifdef _WIN32
+  _commit(_fileno(m_journal));
+#elif defined(__linux__)
+  fdatasync(fileno(m_journal));
+#else
+  fsync(fileno(m_journal));
+#endif
+}
+
+void InventoryWriteQueue::NotifyFlushed(std::unique_lock<std::mutex> &lock) {
+  std::vector<uint32_t> flushed;
+  flushed.swap(m_flushedAccounts);
+  std::function<void(uint32_t)> callback = m_onFlushed;
+  lock.unlock();
+
+  // The callback may call back into the queue or take other locks
+  if (callback) {
+    for (uint32_t accountId : flushed) {
+      callback(accountId);
+    }
+  }
+}
+
+void InventoryWriteQueue::AfterEnqueue(MYSQL *inventory_db, uint64_t steamId) {
+  if (!TunablesManager::GetInstance().GetBool("write_behind", true)) {
+    FlushLocked(inventory_db, static_cast<uint32_t>(steamId & 0xFFFFFFFF));
+  }
+}
+
+void InventoryWriteQueue::SetEquipped(MYSQL *inventory_db, uint64_t steamId,
+                                      uint64_t itemId, uint32_t defIndex,
+                                      bool ctSide, bool equipped) {
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  InventoryCache::GetInstance().Update(
+      accountId, itemId, [&](CsgoItemRow &row) {
+        (ctSide ? row.equipped_ct : row.equipped_t) = equipped ? 1 : 0;
+      });
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  PendingItem &item = Entry(accountId, itemId);
+  item.defIndex = defIndex;
+  (ctSide ? item.equippedCT : item.equippedT) = equipped ? 1 : 0;
+
+  char record[96];
+  snprintf(record, sizeof(record), "E %u %" PRIu64 " %u %d %d\n", accountId,
+           itemId, defIndex, ctSide ? 1 : 0, equipped ? 1 : 0);
+  Journal(record);
+  AfterEnqueue(inventory_db, steamId);
+  NotifyFlushed(lock);
+}
+
+void InventoryWriteQueue::SetAcknowledged(MYSQL *inventory_db,
+                                          uint64_t steamId, uint64_t itemId,
+                                          uint32_t position) {
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  InventoryCache::GetInstance().Update(
+      accountId, itemId,
+      [position](CsgoItemRow &row) { row.acknowledged = position; });
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  Entry(accountId, itemId).acknowledged = position;
+
+  char record[64];
+  snprintf(record, sizeof(record), "A %u %" PRIu64 " %u\n", accountId, itemId,
+           position);
+  Journal(record);
+  AfterEnqueue(inventory_db, steamId);
+  NotifyFlushed(lock);
+}
+
+void InventoryWriteQueue::SetNametag(MYSQL *inventory_db, uint64_t steamId,
+                                     uint64_t itemId,
+                                     const std::optional<std::string> &name) {
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  InventoryCache::GetInstance().Update(
+      accountId, itemId,
+      [&name](CsgoItemRow &row) { row.nametag.assign(name.value_or("")); });
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  PendingItem &item = Entry(accountId, itemId);
+  item.hasNametag = true;
+  item.nametag = name;
+
+  // Hex-encode the name so any byte survives the line based journal
+  std::string record = "N " + std::to_string(accountId) + " " +
+                       std::to_string(itemId) + " ";
+  if (name) {
+    static const char digits[] = "0123456789abcdef";
+    record += "=";
+    for (unsigned char c : *name) {
+      record += digits[c >> 4];
+      record += digits[c & 0xF];
+    }
+  } else {
+    record += "-";
+  }
+  record += "\n";
+  Journal(record);
+  AfterEnqueue(inventory_db, steamId);
+  NotifyFlushed(lock);
+}
+
+bool InventoryWriteQueue::ReplayJournal() {
+  FILE *file = fopen(m_journalPath.c_str(), "r");
+  if (!file) {
+    return true; // nothing to replay
+  }
+
+  // Names are hex encoded, so lines can be longer than any fixed buffer
+  std::string line;
+  auto readLine = [file, &line]() {
+    line.clear();
+    char chunk[512];
+    while (fgets(chunk, sizeof(chunk), file)) {
+      line += chunk;
+      if (!line.empty() && line.back() == '\n') {
+        break;
+      }
+    }
+    return !line.empty();
+  };
+
+  int lineNumber = 0;
+  bool ok = true;
+  while (readLine()) {
+    lineNumber++;
+    unsigned int accountId = 0, defIndex = 0, position = 0;
+    int ctSide = 0, equipped = 0;
+    uint64_t itemId = 0;
+    int nameOffset = 0;
+
+    if (sscanf(line.c_str(), "E %u %" SCNu64 " %u %d %d", &accountId, &itemId,
+               &defIndex, &ctSide, &equipped) == 5) {
+      PendingItem &item = Entry(accountId, itemId);
+      item.defIndex = defIndex;
+      (ctSide ? item.equippedCT : item.equippedT) = equipped ? 1 : 0;
+    } else if (sscanf(line.c_str(), "A %u %" SCNu64 " %u", &accountId,
+                      &itemId, &position) == 3) {
+      Entry(accountId, itemId).acknowledged = position;
+    } else if (sscanf(line.c_str(), "N %u %" SCNu64 " %n", &accountId,
+                      &itemId, &nameOffset) == 2 &&
+               nameOffset > 0 &&
+               (line[nameOffset] == '=' || line[nameOffset] == '-')) {
+      PendingItem &item = Entry(accountId, itemId);
+      item.hasNametag = true;
+      item.nametag.reset();
+      if (line[nameOffset] == '=') {
+        std::string decoded;
+        for (size_t i = nameOffset + 1;
+             i + 1 < line.size() &&
+             isxdigit(static_cast<unsigned char>(line[i])) &&
+             isxdigit(static_cast<unsigned char>(line[i + 1]));
+             i += 2) {
+          char hex[3] = {line[i], line[i + 1], 0};
+          decoded += static_cast<char>(strtoul(hex, nullptr, 16));
+        }
+        item.nametag = decoded;
+      }
+    } else if (line[0] != '\n') {
+      logger::warning("InventoryWriteQueue: Skipping malformed journal line "
+                      "%d",
+                      lineNumber);
+      ok = false;
+    }
+  }
+
+  fclose(file);
+  return ok;
+}
+
+void InventoryWriteQueue::Update(MYSQL *inventory_db) {
+  auto now = std::chrono::steady_clock::now();
+  int intervalMs =
+      TunablesManager::GetInstance().GetInt("write_behind_flush_ms", 5);
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_items.empty() ||
+      now - m_lastFlush < std::chrono::milliseconds(intervalMs)) {
+    return;
+  }
+
+  m_lastFlush = now;
+  FlushLocked(inventory_db, std::nullopt);
+  NotifyFlushed(lock);
+}
+
+bool InventoryWriteQueue::FlushAll(MYSQL *inventory_db) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  bool ok = FlushLocked(inventory_db, std::nullopt);
+  NotifyFlushed(lock);
+  return ok;
+}
+
+bool InventoryWriteQueue::FlushUser(MYSQL *inventory_db, uint64_t steamId) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  bool ok =
+      FlushLocked(inventory_db, static_cast<uint32_t>(steamId & 0xFFFFFFFF));
+  NotifyFlushed(lock);
+  return ok;
+}
+
+/**
+ * Applies pending writes in one transaction: a bulk UPDATE per numeric
+ * column plus one UPDATE per renamed item. Entries stay queued on failure
+ * and are retried on the next flush.
+ */
+bool InventoryWriteQueue::FlushLocked(MYSQL *inventory_db,
+                                      std::optional<uint32_t> accountId) {
+  std::vector<uint64_t> itemIds;
+  if (accountId) {
+    auto user = m_itemsByUser.find(*accountId);
+    if (user == m_itemsByUser.end() || user->second.empty()) {
+      return true;
+    }
+    itemIds.assign(user->second.begin(), user->second.end());
+  } else {
+    itemIds.reserve(m_items.size());
+    for (const auto &pair : m_items) {
+      itemIds.push_back(pair.first);
+    }
+  }
+
+  if (itemIds.empty()) {
+    return true;
+  }
+
+  if (!inventory_db) {
+    return false;
+  }
+
+  struct ColumnBatch {
+    std::vector<uint32_t> values;
+    std::vector<uint64_t> ids;
+    std::vector<uint32_t> owners;
+
+    void add(uint32_t value, uint64_t id, uint32_t owner) {
+      values.push_back(value);
+      ids.push_back(id);
+      owners.push_back(owner);
+    }
+  };
+
+  ColumnBatch equippedCT, equippedT, acknowledged;
+  for (uint64_t itemId : itemIds) {
+    const PendingItem &item = m_items[itemId];
+    if (item.equippedCT) {
+      equippedCT.add(*item.equippedCT, itemId, item.accountId);
+    }
+    if (item.equippedT) {
+      equippedT.add(*item.equippedT, itemId, item.accountId);
+    }
+    if (item.acknowledged) {
+      acknowledged.add(*item.acknowledged, itemId, item.accountId);
+    }
+  }
+
+  SQLTransaction transaction(inventory_db);
+
+  auto runBatch = [inventory_db](const char *query, ColumnBatch &batch) {
+    if (batch.ids.empty()) {
+      return true;
+    }
+    auto stmtOpt = createPreparedStatement(inventory_db, query);
+    if (!stmtOpt) {
+      return false;
+    }
+    auto &stmt = *stmtOpt;
+    stmt.bindUint32Array(0, batch.values.data());
+    stmt.bindUint64Array(1, batch.ids.data());
+    stmt.bindUint32Array(2, batch.owners.data());
+    return stmt.executeBatch(static_cast<unsigned int>(batch.ids.size()));
+  };
+
+  bool ok = runBatch("UPDATE csgo_items SET equipped_ct = ? "
+                     "WHERE id = ? AND owner_account_id = ?",
+                     equippedCT) &&
+            runBatch("UPDATE csgo_items SET equipped_t = ? "
+                     "WHERE id = ? AND owner_account_id = ?",
+                     equippedT) &&
+            runBatch("UPDATE csgo_items SET acknowledged = ? "
+                     "WHERE id = ? AND owner_account_id = ?",
+                     acknowledged);
+
+  bool hasNametags = std::any_of(
+      itemIds.begin(), itemIds.end(),
+      [this](uint64_t itemId) { return m_items[itemId].hasNametag; });
+
+  if (ok && hasNametags) {
+    auto nameStmt = createPreparedStatement(
+        inventory_db, "UPDATE csgo_items SET nametag = ? "
+                      "WHERE id = ? AND owner_account_id = ?");
+    ok = nameStmt.has_value();
+
+    for (uint64_t itemId : itemIds) {
+      PendingItem &item = m_items[itemId];
+      if (!ok) {
+        break;
+      }
+      if (!item.hasNametag) {
+        continue;
+      }
+
+      unsigned long nameLen = item.nametag ? item.nametag->length() : 0;
+      if (item.nametag) {
+        nameStmt->bindString(0, item.nametag->c_str(), &nameLen);
+      } else {
+        nameStmt->bindNull(0);
+      }
+      nameStmt->bindUint64(1, &itemId);
+      nameStmt->bindUint32(2, &item.accountId);
+      if (!nameStmt->execute()) {
+        ok = false;
+        break;
+      }
+    }
+  }
+
+  if (!ok || !transaction.Commit()) {
+    logger::error("InventoryWriteQueue: Flush of %zu items failed, will retry",
+                  itemIds.size());
+    return false;
+  }
+
+  // Reported by NotifyFlushed once the caller has released m_mutex
+  std::unordered_set<uint32_t> flushedAccounts;
+  for (uint64_t itemId : itemIds) {
+    auto it = m_items.find(itemId);
+    if (it == m_items.end()) {
+      continue;
+    }
+    flushedAccounts.insert(it->second.accountId);
+    auto user = m_itemsByUser.find(it->second.accountId);
+    if (user != m_itemsByUser.end()) {
+      user->second.erase(itemId);
+      if (user->second.empty()) {
+        m_itemsByUser.erase(user);
+      }
+    }
+    m_items.erase(it);
+  }
+
+  m_flushedAccounts.insert(m_flushedAccounts.end(), flushedAccounts.begin(),
+                           flushedAccounts.end());
+
+  // Everything in the journal is now in the database
+  if (m_items.empty() && !m_journalPath.empty()) {
+    if (m_journal) {
+      fclose(m_journal);
+    }
+    m_journal = fopen(m_journalPath.c_str(), "w");
+  }
+
+  return true;
+}
+
+std::optional<CsgoItemRow>
+InventoryWriteQueue::Patched(const CsgoItemRow &row, uint32_t accountId) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_items.find(row.id);
+  if (it == m_items.end() || it->second.accountId != accountId) {
+    return std::nullopt;
+  }
+
+  const PendingItem &item = it->second;
+  CsgoItemRow patched = row;
+  if (item.equippedCT) {
+    patched.equipped_ct = *item.equippedCT;
+  }
+  if (item.equippedT) {
+    patched.equipped_t = *item.equippedT;
+  }
+  if (item.acknowledged) {
+    patched.acknowledged = *item.acknowledged;
+  }
+  if (item.hasNametag) {
+    size_t length = item.nametag ? std::min(item.nametag->length(),
+                                            sizeof(patched.nametag.data))
+                                 : 0;
+    if (length > 0) {
+      memcpy(patched.nametag.data, item.nametag->data(), length);
+    }
+    patched.nametag.length = length;
+  }
+  return patched;
+}
+
+std::optional<uint32_t>
+InventoryWriteQueue::PendingAcknowledged(uint64_t itemId) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_items.find(itemId);
+  if (it == m_items.end()) {
+    return std::nullopt;
+  }
+  return it->second.acknowledged;
+}
+
+uint32_t InventoryWriteQueue::PendingMaxAcknowledged(uint32_t accountId) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  uint32_t maxPosition = 0;
+  auto user = m_itemsByUser.find(accountId);
+  if (user == m_itemsByUser.end()) {
+    return 0;
+  }
+  for (uint64_t itemId : user->second) {
+    const PendingItem &item = m_items.at(itemId);
+    if (item.acknowledged && *item.acknowledged < UNACKNOWLEDGED_POSITION) {
+      maxPosition = std::max(maxPosition, *item.acknowledged);
+    }
+  }
+  return maxPosition;
+}
+
+std::vector<InventoryWriteQueue::PendingEquip>
+InventoryWriteQueue::PendingEquipped(uint32_t accountId, bool ctSide) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<PendingEquip> result;
+  auto user = m_itemsByUser.find(accountId);
+  if (user == m_itemsByUser.end()) {
+    return result;
+  }
+  for (uint64_t itemId : user->second) {
+    const PendingItem &item = m_items.at(itemId);
+    const auto &value = ctSide ? item.equippedCT : item.equippedT;
+    if (value) {
+      result.push_back({itemId, item.defIndex, *value == 1});
+    }
+  }
+  return result;
+}
@@ -0,0 +1,103 @@
+#pragma once
+/**
+ * inventory_write_queue.hpp - Write-behind queue for low-value item updates
+ *
+ * Equip, unequip, acknowledge and rename only ever set a column to an
+ * absolute value, so they don't need their own commit before the client is
+ * answered. They are recorded here instead: repeated writes to the same
+ * item/column collapse into one, and everything pending is applied in a
+ * single transaction every write_behind_flush_ms (default 5 ms).
+ *
+ * Reads stay consistent because CreateItemFromDatabaseRow overlays pending
+ * values onto the rows it builds items from, and queued values are written
+ * through to InventoryCache. Every queued write is appended
+ * to a journal file and synced to disk before it is acknowledged, and the
+ * journal is replayed on startup, so a crash between enqueue and flush does
+ * not lose it.
+ */
+
+#include "csgo_item_row.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mariadb/mysql.h>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class InventoryWriteQueue {
+public:
+  static InventoryWriteQueue &GetInstance();
+
+  // Opens the journal and applies anything a previous run left behind
+  bool Init(MYSQL *inventory_db,
+            const std::string &journalPath = "inventory_writes.journal");
+
+  // Queue writes. With write_behind disabled they are flushed immediately.
+  void SetEquipped(MYSQL *inventory_db, uint64_t steamId, uint64_t itemId,
+                   uint32_t defIndex, bool ctSide, bool equipped);
+  void SetAcknowledged(MYSQL *inventory_db, uint64_t steamId, uint64_t itemId,
+                       uint32_t position);
+  void SetNametag(MYSQL *inventory_db, uint64_t steamId, uint64_t itemId,
+                  const std::optional<std::string> &name);
+
+  // Invoked with each account id whose writes a flush just committed, after
+  // the queue's lock has been released
+  void SetOnFlushed(std::function<void(uint32_t)> callback);
+
+  // Called every tick; flushes once the flush interval has elapsed
+  void Update(MYSQL *inventory_db);
+  bool FlushAll(MYSQL *inventory_db);
+  bool FlushUser(MYSQL *inventory_db, uint64_t steamId);
+
+  // Read-side overlay
+  std::optional<CsgoItemRow> Patched(const CsgoItemRow &row,
+                                     uint32_t accountId) const;
+  std::optional<uint32_t> PendingAcknowledged(uint64_t itemId) const;
+  uint32_t PendingMaxAcknowledged(uint32_t accountId) const;
+
+  struct PendingEquip {
+    uint64_t itemId;
+    uint32_t defIndex;
+    bool equipped;
+  };
+  std::vector<PendingEquip> PendingEquipped(uint32_t accountId,
+                                            bool ctSide) const;
+
+private:
+  struct PendingItem {
+    uint32_t accountId = 0;
+    uint32_t defIndex = 0;
+    std::optional<int8_t> equippedCT;
+    std::optional<int8_t> equippedT;
+    std::optional<uint32_t> acknowledged;
+    bool hasNametag = false;
+    std::optional<std::string> nametag;
+  };
+
+  InventoryWriteQueue() = default;
+  ~InventoryWriteQueue();
+
+  InventoryWriteQueue(const InventoryWriteQueue &) = delete;
+  InventoryWriteQueue &operator=(const InventoryWriteQueue &) = delete;
+
+  PendingItem &Entry(uint32_t accountId, uint64_t itemId);
+  void Journal(const std::string &record);
+  void NotifyFlushed(std::unique_lock<std::mutex> &lock);
+  bool ReplayJournal();
+  void AfterEnqueue(MYSQL *inventory_db, uint64_t steamId);
+  bool FlushLocked(MYSQL *inventory_db, std::optional<uint32_t> accountId);
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<uint64_t, PendingItem> m_items;
+  std::unordered_map<uint32_t, std::unordered_set<uint64_t>> m_itemsByUser;
+  std::string m_journalPath;
+  FILE *m_journal = nullptr;
+  std::chrono::steady_clock::time_point m_lastFlush;
+  std::function<void(uint32_t)> m_onFlushed;
+  std::vector<uint32_t> m_flushedAccounts; // waiting for NotifyFlushed
+};
@@ -0,0 +1,97 @@
+#pragma once
+/**
+ * item_id.hpp - Allocation-free decoding of csgo_items.item_id strings
+ *
+ * item_id names what a row is: "skin-<def>_<paint>_<...>" for weapons and
+ * knives, "sticker-<id>", "music_kit-<id>", "crate-<def>", "key-<def>" and
+ * "collectible-<def>". Every row of every inventory is decoded when it is
+ * turned into a CSOEconItem, so this works on a string_view with
+ * std::from_chars: no copies, no exceptions.
+ *
+ * Numbers are read like the std::stoi based decoder this replaces read
+ * them (leading digits, the rest ignored), except that signs and leading
+ * whitespace are rejected; neither appears in stored ids.
+ */
+
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+enum class ItemIdKind : uint8_t {
+  Invalid,
+  Skin,
+  Sticker,
+  MusicKit,
+  Crate,
+  Key,
+  Collectible,
+};
+
+struct DecodedItemId {
+  ItemIdKind kind = ItemIdKind::Invalid;
+  uint32_t defIndex = 0;
+  uint32_t paintIndex = 0; // sticker / music kit id for those kinds
+
+  explicit operator bool() const { return kind != ItemIdKind::Invalid; }
+};
+
+namespace item_id_detail {
+
+// Leading decimal digits of text
+inline std::optional<uint32_t> LeadingNumber(std::string_view text) {
+  uint32_t value = 0;
+  auto [ptr, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  if (ec != std::errc()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+} // namespace item_id_detail
+
+inline DecodedItemId DecodeItemId(std::string_view itemId) {
+  using item_id_detail::LeadingNumber;
+
+  size_t dash = itemId.find('-');
+  if (dash != std::string_view::npos) {
+    std::string_view type = itemId.substr(0, dash);
+    auto number = LeadingNumber(itemId.substr(dash + 1));
+    if (!number) {
+      return {};
+    }
+
+    if (type == "music_kit") {
+      return {ItemIdKind::MusicKit, 1314, *number};
+    } else if (type == "sticker") {
+      return {ItemIdKind::Sticker, 1209, *number};
+    } else if (type == "crate") {
+      return {ItemIdKind::Crate, *number, 0};
+    } else if (type == "key") {
+      return {ItemIdKind::Key, *number, 0};
+    } else if (type == "collectible") {
+      return {ItemIdKind::Collectible, *number, 0};
+    }
+  }
+
+  // weapon skins: 5 character prefix, then <def>_<paint>_
+  size_t firstUnderscore = itemId.find('_');
+  if (firstUnderscore == std::string_view::npos) {
+    return {};
+  }
+  size_t secondUnderscore = itemId.find('_', firstUnderscore + 1);
+  if (secondUnderscore == std::string_view::npos || itemId.size() < 5) {
+    return {};
+  }
+
+  // substr(5, first - 5) as before: a prefix that isn't 5 characters long
+  // wraps the length and reads on to the end
+  auto defIndex = LeadingNumber(itemId.substr(5, firstUnderscore - 5));
+  auto paintIndex = LeadingNumber(itemId.substr(
+      firstUnderscore + 1, secondUnderscore - firstUnderscore - 1));
+  if (!defIndex || !paintIndex) {
+    return {};
+  }
+  return {ItemIdKind::Skin, *defIndex, *paintIndex};
+}
@@ -1,6 +1,6 @@
 #include "item_schema.hpp"
 #include "gc_const_csgo.hpp" // mikkotodo remove?
-#include "keyvalue.hpp"
+#include "keyvalue_document.hpp"
 #include "random.hpp"
 #include "stdafx.h"
 
@@ -28,7 +28,7 @@ static uint32_t ItemRarityFromString(std::string_view name) {
   return ItemSchema::RarityCommon;
 }
 
-AttributeInfo::AttributeInfo(const KeyValue &key) {
+AttributeInfo::AttributeInfo(const KeyValueView &key) {
   std::string_view type = key.GetString("attribute_type");
 
   // Debug print to see full text and type
@@ -71,7 +71,7 @@ ItemInfo::ItemInfo(uint32_t defIndex)
   // RecursiveParseItem parses the rest
 }
 
-PaintKitInfo::PaintKitInfo(const KeyValue &key)
+PaintKitInfo::PaintKitInfo(const KeyValueView &key)
     : m_defIndex{FromString<uint32_t>(key.Name())},
       m_rarity{ItemSchema::RarityCommon}
 // rarity is not stored here, set it in ParsePaintKitRarities
@@ -84,7 +84,7 @@ PaintKitInfo::PaintKitInfo(const KeyValue &key)
   m_descriptionTag = key.GetString("description_tag");
 }
 
-StickerKitInfo::StickerKitInfo(const KeyValue &key)
+StickerKitInfo::StickerKitInfo(const KeyValueView &key)
     : m_defIndex{FromString<uint32_t>(key.Name())},
       m_rarity{ItemSchema::RarityDefault}
 // mikkotodo revisit... currently using item rarity if this is default
@@ -99,7 +99,7 @@ StickerKitInfo::StickerKitInfo(const KeyValue &key)
   }
 }
 
-MusicDefinitionInfo::MusicDefinitionInfo(const KeyValue &key)
+MusicDefinitionInfo::MusicDefinitionInfo(const KeyValueView &key)
     : m_defIndex{FromString<uint32_t>(key.Name())} {
   assert(m_defIndex);
 
@@ -109,46 +109,51 @@ MusicDefinitionInfo::MusicDefinitionInfo(const KeyValue &key)
 }
 
 ItemSchema::ItemSchema() {
-  KeyValue itemSchema{"root"};
-  if (!itemSchema.ParseFromFile("items/items_game.txt")) {
+  KeyValueDocument itemSchema;
+  // items_game.bin is a compiled copy, rebuilt when items_game.txt changes
+  if (!itemSchema.ParseFromFileCached("items/items_game.txt",
+                                      "items/items_game.bin")) {
     logger::info("Failed to load items_game.txt! OLLUM FIX IT");
     // assert(false);
     return;
   }
 
-  const KeyValue *itemsGame = itemSchema.GetSubkey("items_game");
+  const KeyValueView *itemsGame = itemSchema.GetSubkey("items_game");
   if (!itemsGame) {
     // assert(false);
     return;
   }
 
-  const KeyValue *itemsKey = itemsGame->GetSubkey("items");
+  m_loaded = true;
+
+  const KeyValueView *itemsKey = itemsGame->GetSubkey("items");
   if (itemsKey) {
     ParseItems(itemsKey, itemsGame->GetSubkey("prefabs"));
+    BuildItemNameIndex();
   }
 
-  const KeyValue *attributesKey = itemsGame->GetSubkey("attributes");
+  const KeyValueView *attributesKey = itemsGame->GetSubkey("attributes");
   if (attributesKey) {
     ParseAttributes(attributesKey);
   }
 
-  const KeyValue *stickerKitsKey = itemsGame->GetSubkey("sticker_kits");
+  const KeyValueView *stickerKitsKey = itemsGame->GetSubkey("sticker_kits");
   if (stickerKitsKey) {
     ParseStickerKits(stickerKitsKey);
   }
 
-  const KeyValue *paintKitsKey = itemsGame->GetSubkey("paint_kits");
+  const KeyValueView *paintKitsKey = itemsGame->GetSubkey("paint_kits");
   if (paintKitsKey) {
     ParsePaintKits(paintKitsKey);
   }
 
-  const KeyValue *paintKitsRarityKey =
+  const KeyValueView *paintKitsRarityKey =
       itemsGame->GetSubkey("paint_kits_rarity");
   if (paintKitsRarityKey) {
     ParsePaintKitRarities(paintKitsRarityKey);
   }
 
-  const KeyValue *musicDefinitionsKey =
+  const KeyValueView *musicDefinitionsKey =
       itemsGame->GetSubkey("music_definitions");
   if (musicDefinitionsKey) {
     ParseMusicDefinitions(musicDefinitionsKey);
@@ -158,25 +163,28 @@ ItemSchema::ItemSchema() {
   // we need to parse these after items and paint kits but before
   // client_loot_lists
   {
-    KeyValue unusualLootLists{"unusual_loot_lists"};
+    KeyValueDocument unusualLootLists;
 
     if (unusualLootLists.ParseFromFile("items/unusual_loot_lists.txt")) {
-      ParseLootLists(&unusualLootLists, true);
+      ParseLootLists(&unusualLootLists.Root(), true);
     } else {
       logger::info("Failed to load unusual_loot_lists.txt! OLLUM FIX IT");
     }
   }
 
-  const KeyValue *lootListsKey = itemsGame->GetSubkey("client_loot_lists");
+  const KeyValueView *lootListsKey = itemsGame->GetSubkey("client_loot_lists");
   if (lootListsKey) {
     ParseLootLists(lootListsKey, false);
   }
 
-  const KeyValue *revolvingLootListsKey =
+  const KeyValueView *revolvingLootListsKey =
       itemsGame->GetSubkey("revolving_loot_lists");
   if (revolvingLootListsKey) {
     ParseRevolvingLootLists(revolvingLootListsKey);
   }
+
+  BuildTradeUpIndexes();
+  BuildCrateDropTables();
 }
 
 // AttributeType ItemSchema::AttributeType(uint32_t defIndex) const
@@ -367,9 +375,9 @@ bool ItemSchema::SetAttributeString(CSOEconItemAttribute *attribute,
   return true;
 }
 
-bool ItemSchema::EconItemFromLootListItem(const LootListItem &lootListItem,
-                                          CSOEconItem &item,
-                                          GenerateStatTrak generateStatTrak) {
+bool ItemSchema::EconItemFromLootListItem(
+    const LootListItem &lootListItem, CSOEconItem &item,
+    GenerateStatTrak generateStatTrak) const {
   bool statTrak;
 
   switch (generateStatTrak) {
@@ -378,7 +386,7 @@ bool ItemSchema::EconItemFromLootListItem(const LootListItem &lootListItem,
     break;
 
   case GenerateStatTrak::Maybe:
-    statTrak = (g_random.Uint32(1, 10) == 1);
+    statTrak = (ThreadRandom().Uint32(1, 10) == 1);
     break;
 
   default:
@@ -432,7 +440,7 @@ bool ItemSchema::EconItemFromLootListItem(const LootListItem &lootListItem,
     attribute = item.add_attribute();
     attribute->set_def_index(AttributeSprayTintId);
     SetAttributeUint32(attribute,
-                       g_random.Uint32(GraffitiTintMin, GraffitiTintMax));
+                       ThreadRandom().Uint32(GraffitiTintMin, GraffitiTintMax));
   } else if (lootListItem.type == LootListItemPatch) {
     // mikkotodo anything else?
     CSOEconItemAttribute *attribute = item.add_attribute();
@@ -464,12 +472,12 @@ bool ItemSchema::EconItemFromLootListItem(const LootListItem &lootListItem,
     attribute = item.add_attribute();
     attribute->set_def_index(AttributeTextureSeed);
     // Seed is also a float in the schema.
-    SetAttributeFloat(attribute, (float)g_random.Uint32(0, 1000));
+    SetAttributeFloat(attribute, (float)ThreadRandom().Uint32(0, 1000));
 
     // mikkotodo how does the float distribution work?
     attribute = item.add_attribute();
     attribute->set_def_index(AttributeTextureWear);
-    SetAttributeFloat(attribute, g_random.Float(paintKitInfo->m_minFloat,
+    SetAttributeFloat(attribute, ThreadRandom().Float(paintKitInfo->m_minFloat,
                                                 paintKitInfo->m_maxFloat));
   } else {
     logger::info("EconItemFromLootListItem: No PaintKitInfo found for Item Def "
@@ -512,129 +520,153 @@ static bool GetLootListItems(const LootList &lootList,
   return unusuals;
 }
 
-bool ItemSchema::SelectItemFromCrate(const CSOEconItem &crate,
-                                     CSOEconItem &item) {
-  auto itemSearch = m_itemInfo.find(crate.def_index());
-  if (itemSearch == m_itemInfo.end()) {
-    // assert(false);
-    return false;
+// base odds of each rarity tier in a crate, rarities not listed never drop
+static uint32_t CrateRarityWeight(uint32_t rarity) {
+  const std::pair<uint32_t, uint32_t> rarityWeights[] = {
+      {ItemSchema::RarityDefault, 15625}, // Consumer (Gray)
+      {ItemSchema::RarityCommon, 3125},   // Industrial (Light Blue)
+      {ItemSchema::RarityUncommon, 625},  // Mil-Spec (Blue)
+      {ItemSchema::RarityRare, 125},      // Restricted (Purple)
+      {ItemSchema::RarityMythical, 25},   // Classified (Pink)
+      {ItemSchema::RarityLegendary, 5},   // Covert (Red)
+  };
+
+  for (const auto &pair : rarityWeights) {
+    if (pair.first == rarity) {
+      return pair.second;
+    }
   }
 
-  assert(itemSearch->second.m_supplyCrateSeries);
+  return 0;
+}
 
-  auto lootListSearch =
-      m_revolvingLootLists.find(itemSearch->second.m_supplyCrateSeries);
-  if (lootListSearch == m_revolvingLootLists.end()) {
-    // assert(false);
-    return false;
-  }
+// weight of the gold (unusual) tier next to the rarity weights above
+constexpr uint32_t CrateUnusualWeight = 2;
 
-  const LootList &lootList = lootListSearch->second;
-  assert(lootList.subLists.empty() != lootList.items.empty());
+void ItemSchema::BuildCrateDropTables() {
+  m_crateDropTables.clear();
+  m_crateDropTables.reserve(m_revolvingLootLists.size());
 
   std::vector<const LootListItem *> lootListItems;
-  lootListItems.reserve(32); // overkill
-  bool containsUnusuals = GetLootListItems(lootList, lootListItems);
+  std::vector<double> weights;
 
-  if (!lootListItems.size()) {
-    // assert(false);
-    return false;
-  }
+  for (const auto &[series, lootList] : m_revolvingLootLists) {
+    assert(lootList.subLists.empty() != lootList.items.empty());
 
-  // handle stattrak
-  GenerateStatTrak generateStatTrak = GenerateStatTrak::No;
-  if (lootList.willProduceStatTrak) {
-    generateStatTrak = GenerateStatTrak::Yes;
-  } else if (containsUnusuals) {
-    generateStatTrak = GenerateStatTrak::Maybe;
-  }
+    lootListItems.clear();
+    bool containsUnusuals = GetLootListItems(lootList, lootListItems);
 
-  // group items by rarity and map rarities to base weights
-  std::unordered_map<uint32_t, std::vector<const LootListItem *>> itemsByRarity;
-  std::unordered_map<uint32_t, uint32_t> rarityWeights;
-  uint32_t totalWeight = 0;
+    // each rarity tier's weight is split evenly between its items
+    std::unordered_map<uint32_t, uint32_t> rarityCounts;
+    uint32_t unusualCount = 0;
+    for (const LootListItem *lootItem : lootListItems) {
+      if (lootItem->quality == QualityUnusual) {
+        unusualCount++;
+      } else {
+        rarityCounts[lootItem->rarity]++;
+      }
+    }
 
-  // rarity weight map
-  const std::unordered_map<uint32_t, uint32_t> baseWeights = {
-      {RarityDefault, 15625}, // Consumer (Gray)
-      {RarityCommon, 3125},   // Industrial (Light Blue)
-      {RarityUncommon, 625},  // Mil-Spec (Blue)
-      {RarityRare, 125},      // Restricted (Purple)
-      {RarityMythical, 25},   // Classified (Pink)
-      {RarityLegendary, 5}    // Covert (Red)
-  };
+    double totalWeight = 0.0;
+    for (const auto &[rarity, count] : rarityCounts) {
+      totalWeight += CrateRarityWeight(rarity);
+    }
 
-  // group items by rarity and calculate total weight
-  for (const auto *lootItem : lootListItems) {
-    if (lootItem->quality != QualityUnusual) {
-      // if we find an item of this rarity, add its base weight to total
-      if (itemsByRarity[lootItem->rarity].empty() &&
-          baseWeights.count(lootItem->rarity)) {
-        rarityWeights[lootItem->rarity] = baseWeights.at(lootItem->rarity);
-        totalWeight += baseWeights.at(lootItem->rarity);
-      }
-      itemsByRarity[lootItem->rarity].push_back(lootItem);
+    bool dropsGolds = !lootList.isUnusual && containsUnusuals && unusualCount;
+    if (dropsGolds) {
+      totalWeight += CrateUnusualWeight;
     }
-  }
 
-  // check for industrial grade items (for souvenir packages)
-  bool hasIndustrialItems = false;
-  if (itemsByRarity.count(RarityCommon) > 0 &&
-      !itemsByRarity[RarityCommon].empty()) {
-    hasIndustrialItems = true;
-    logger::info("Found consumer grade items (%zu)",
-                 itemsByRarity[RarityCommon].size());
-  }
+    CrateDropTable drops;
+    weights.clear();
 
-  // check for golds
-  if (!lootList.isUnusual && containsUnusuals) {
-    std::vector<const LootListItem *> unusualItems;
-    if (g_random.Uint32(0, totalWeight + 2) < 2) // 2 weight
-    {
-      for (const auto *lootItem : lootListItems) {
-        if (lootItem->quality == QualityUnusual) {
-          unusualItems.push_back(lootItem);
+    for (const LootListItem *lootItem : lootListItems) {
+      double weight = 0.0;
+      if (lootItem->quality == QualityUnusual) {
+        if (dropsGolds) {
+          weight = CrateUnusualWeight / static_cast<double>(unusualCount);
         }
+      } else {
+        weight = CrateRarityWeight(lootItem->rarity) /
+                 static_cast<double>(rarityCounts[lootItem->rarity]);
       }
 
-      if (!unusualItems.empty()) {
-        size_t index = g_random.RandomIndex(unusualItems.size());
-        return EconItemFromLootListItem(*unusualItems[index], item,
-                                        generateStatTrak);
+      if (weight > 0.0) {
+        drops.outcomes.push_back(lootItem);
+        weights.push_back(weight / totalWeight);
       }
     }
+
+    drops.table = AliasTable{weights};
+    if (drops.table.Empty()) {
+      continue;
+    }
+
+    // handle stattrak
+    if (lootList.willProduceStatTrak) {
+      drops.statTrak = GenerateStatTrak::Yes;
+    } else if (containsUnusuals) {
+      drops.statTrak = GenerateStatTrak::Maybe;
+    }
+
+    drops.souvenirs = rarityCounts.count(RarityCommon) > 0;
+
+    m_crateDropTables.emplace(series, std::move(drops));
   }
 
-  uint32_t roll = g_random.Uint32(0, totalWeight);
-  uint32_t currentWeight = 0;
+  logger::info("Compiled drop tables for %zu crate series",
+               m_crateDropTables.size());
+}
 
-  for (const auto &[rarity, items] : itemsByRarity) {
-    if (rarityWeights.count(rarity)) {
-      currentWeight += rarityWeights[rarity];
-      if (roll < currentWeight) {
-        // random item from this rarity
-        size_t index = g_random.RandomIndex(items.size());
-        bool result =
-            EconItemFromLootListItem(*items[index], item, generateStatTrak);
+const CrateDropTable *ItemSchema::CrateDrops(uint32_t crateDefIndex) const {
+  auto itemSearch = m_itemInfo.find(crateDefIndex);
+  if (itemSearch == m_itemInfo.end()) {
+    // assert(false);
+    return nullptr;
+  }
 
-        // check if we need to make this a souvenir item
-        if (result && itemSearch->second.m_tournamentEventId != 0 &&
-            hasIndustrialItems) {
-          logger::info("Setting quality to Tournament");
-          item.set_quality(QualityTournament);
+  auto dropsSearch =
+      m_crateDropTables.find(itemSearch->second.m_supplyCrateSeries);
+  if (dropsSearch == m_crateDropTables.end()) {
+    // assert(false);
+    return nullptr;
+  }
 
-          // apply stickers based on tournament event ID
-          ApplySouvenirStickers(item, itemSearch->second.m_tournamentEventId,
-                                items[index]->itemInfo);
-        }
+  return &dropsSearch->second;
+}
 
-        return result;
-      }
-    }
+bool ItemSchema::SelectItemFromCrate(const CSOEconItem &crate,
+                                     CSOEconItem &item) const {
+  auto itemSearch = m_itemInfo.find(crate.def_index());
+  if (itemSearch == m_itemInfo.end()) {
+    // assert(false);
+    return false;
   }
 
-  // assert(false);
-  return false;
+  assert(itemSearch->second.m_supplyCrateSeries);
+
+  const CrateDropTable *drops = CrateDrops(crate.def_index());
+  if (!drops) {
+    // assert(false);
+    return false;
+  }
+
+  const LootListItem &lootItem =
+      *drops->outcomes[drops->table.Sample(ThreadRandom())];
+  bool result = EconItemFromLootListItem(lootItem, item, drops->statTrak);
+
+  // check if we need to make this a souvenir item
+  uint32_t tournamentEventId = itemSearch->second.m_tournamentEventId;
+  if (result && tournamentEventId != 0 && drops->souvenirs &&
+      lootItem.quality != QualityUnusual) {
+    logger::info("Setting quality to Tournament");
+    item.set_quality(QualityTournament);
+
+    // apply stickers based on tournament event ID
+    ApplySouvenirStickers(item, tournamentEventId, lootItem.itemInfo);
+  }
+
+  return result;
 }
 
 TournamentStickers
@@ -649,14 +681,14 @@ ItemSchema::GenerateTournamentStickers(uint32_t tournamentEventId,
     static const uint32_t rareStickers[] = {2, 4, 6, 8, 10, 12};
 
     // 75% chance for common, 25% for rare
-    bool useCommon = (g_random.Uint32(1, 100) <= 75);
+    bool useCommon = (ThreadRandom().Uint32(1, 100) <= 75);
     const uint32_t *stickerSet = useCommon ? commonStickers : rareStickers;
     uint32_t setSize = useCommon
                            ? sizeof(commonStickers) / sizeof(commonStickers[0])
                            : sizeof(rareStickers) / sizeof(rareStickers[0]);
 
     // Select one sticker
-    config.tournamentSticker = stickerSet[g_random.Uint32(0, setSize - 1)];
+    config.tournamentSticker = stickerSet[ThreadRandom().Uint32(0, setSize - 1)];
 
     // In this early tournament, only one sticker was applied
     return config;
@@ -672,19 +704,19 @@ ItemSchema::GenerateTournamentStickers(uint32_t tournamentEventId,
 
     // Choose two random team stickers
     size_t teamStickerCount = sizeof(teamStickers) / sizeof(teamStickers[0]);
-    uint32_t teamIndex1 = g_random.Uint32(0, teamStickerCount - 1);
-    uint32_t teamIndex2 = g_random.Uint32(0, teamStickerCount - 1);
+    uint32_t teamIndex1 = ThreadRandom().Uint32(0, teamStickerCount - 1);
+    uint32_t teamIndex2 = ThreadRandom().Uint32(0, teamStickerCount - 1);
 
     // Make sure they're different
     while (teamIndex1 == teamIndex2 && teamStickerCount > 1) {
-      teamIndex2 = g_random.Uint32(0, teamStickerCount - 1);
+      teamIndex2 = ThreadRandom().Uint32(0, teamStickerCount - 1);
     }
 
     config.teamSticker1 = teamStickers[teamIndex1];
     config.teamSticker2 = teamStickers[teamIndex2];
 
     // Choose tournament sticker
-    config.tournamentSticker = tournamentStickers[g_random.Uint32(
+    config.tournamentSticker = tournamentStickers[ThreadRandom().Uint32(
         0, sizeof(tournamentStickers) / sizeof(tournamentStickers[0]) - 1)];
 
     return config;
@@ -699,19 +731,19 @@ ItemSchema::GenerateTournamentStickers(uint32_t tournamentEventId,
 
     // Choose two random team stickers
     size_t teamStickerCount = sizeof(teamStickers) / sizeof(teamStickers[0]);
-    uint32_t teamIndex1 = g_random.Uint32(0, teamStickerCount - 1);
-    uint32_t teamIndex2 = g_random.Uint32(0, teamStickerCount - 1);
+    uint32_t teamIndex1 = ThreadRandom().Uint32(0, teamStickerCount - 1);
+    uint32_t teamIndex2 = ThreadRandom().Uint32(0, teamStickerCount - 1);
 
     // Make sure they're different
     while (teamIndex1 == teamIndex2 && teamStickerCount > 1) {
-      teamIndex2 = g_random.Uint32(0, teamStickerCount - 1);
+      teamIndex2 = ThreadRandom().Uint32(0, teamStickerCount - 1);
     }
 
     config.teamSticker1 = teamStickers[teamIndex1];
     config.teamSticker2 = teamStickers[teamIndex2];
 
     // Choose tournament sticker
-    config.tournamentSticker = tournamentStickers[g_random.Uint32(
+    config.tournamentSticker = tournamentStickers[ThreadRandom().Uint32(
         0, sizeof(tournamentStickers) / sizeof(tournamentStickers[0]) - 1)];
 
     return config;
@@ -726,19 +758,19 @@ ItemSchema::GenerateTournamentStickers(uint32_t tournamentEventId,
 
     // Choose two random team stickers
     size_t teamStickerCount = sizeof(teamStickers) / sizeof(teamStickers[0]);
-    uint32_t teamIndex1 = g_random.Uint32(0, teamStickerCount - 1);
-    uint32_t teamIndex2 = g_random.Uint32(0, teamStickerCount - 1);
+    uint32_t teamIndex1 = ThreadRandom().Uint32(0, teamStickerCount - 1);
+    uint32_t teamIndex2 = ThreadRandom().Uint32(0, teamStickerCount - 1);
 
     // Make sure they're different
     while (teamIndex1 == teamIndex2 && teamStickerCount > 1) {
-      teamIndex2 = g_random.Uint32(0, teamStickerCount - 1);
+      teamIndex2 = ThreadRandom().Uint32(0, teamStickerCount - 1);
     }
 
     config.teamSticker1 = teamStickers[teamIndex1];
     config.teamSticker2 = teamStickers[teamIndex2];
 
     // Choose tournament sticker
-    config.tournamentSticker = tournamentStickers[g_random.Uint32(
+    config.tournamentSticker = tournamentStickers[ThreadRandom().Uint32(
         0, sizeof(tournamentStickers) / sizeof(tournamentStickers[0]) - 1)];
 
     return config;
@@ -753,19 +785,19 @@ ItemSchema::GenerateTournamentStickers(uint32_t tournamentEventId,
 
     // Choose two random team stickers
     size_t teamStickerCount = sizeof(teamStickers) / sizeof(teamStickers[0]);
-    uint32_t teamIndex1 = g_random.Uint32(0, teamStickerCount - 1);
-    uint32_t teamIndex2 = g_random.Uint32(0, teamStickerCount - 1);
+    uint32_t teamIndex1 = ThreadRandom().Uint32(0, teamStickerCount - 1);
+    uint32_t teamIndex2 = ThreadRandom().Uint32(0, teamStickerCount - 1);
 
     // Make sure they're different
     while (teamIndex1 == teamIndex2 && teamStickerCount > 1) {
-      teamIndex2 = g_random.Uint32(0, teamStickerCount - 1);
+      teamIndex2 = ThreadRandom().Uint32(0, teamStickerCount - 1);
     }
 
     config.teamSticker1 = teamStickers[teamIndex1];
     config.teamSticker2 = teamStickers[teamIndex2];
 
     // Choose tournament sticker
-    config.tournamentSticker = tournamentStickers[g_random.Uint32(
+    config.tournamentSticker = tournamentStickers[ThreadRandom().Uint32(
         0, sizeof(tournamentStickers) / sizeof(tournamentStickers[0]) - 1)];
 
     return config;
@@ -780,19 +812,19 @@ ItemSchema::GenerateTournamentStickers(uint32_t tournamentEventId,
 
     // Choose two random team stickers
     size_t teamStickerCount = sizeof(teamStickers) / sizeof(teamStickers[0]);
-    uint32_t teamIndex1 = g_random.Uint32(0, teamStickerCount - 1);
-    uint32_t teamIndex2 = g_random.Uint32(0, teamStickerCount - 1);
+    uint32_t teamIndex1 = ThreadRandom().Uint32(0, teamStickerCount - 1);
+    uint32_t teamIndex2 = ThreadRandom().Uint32(0, teamStickerCount - 1);
 
     // Make sure they're different
     while (teamIndex1 == teamIndex2 && teamStickerCount > 1) {
-      teamIndex2 = g_random.Uint32(0, teamStickerCount - 1);
+      teamIndex2 = ThreadRandom().Uint32(0, teamStickerCount - 1);
     }
 
     config.teamSticker1 = teamStickers[teamIndex1];
     config.teamSticker2 = teamStickers[teamIndex2];
 
     // Choose tournament sticker
-    config.tournamentSticker = tournamentStickers[g_random.Uint32(
+    config.tournamentSticker = tournamentStickers[ThreadRandom().Uint32(
         0, sizeof(tournamentStickers) / sizeof(tournamentStickers[0]) - 1)];
 
     return config;
@@ -828,12 +860,12 @@ ItemSchema::GenerateTournamentStickers(uint32_t tournamentEventId,
 
     // Select two unique teams
     size_t teamCount = sizeof(teams) / sizeof(teams[0]);
-    uint32_t teamIndex1 = g_random.Uint32(0, teamCount - 1);
-    uint32_t teamIndex2 = g_random.Uint32(0, teamCount - 1);
+    uint32_t teamIndex1 = ThreadRandom().Uint32(0, teamCount - 1);
+    uint32_t teamIndex2 = ThreadRandom().Uint32(0, teamCount - 1);
 
     // Make sure they're different
     while (teamIndex1 == teamIndex2 && teamCount > 1) {
-      teamIndex2 = g_random.Uint32(0, teamCount - 1);
+      teamIndex2 = ThreadRandom().Uint32(0, teamCount - 1);
     }
 
     // Get team stickers
@@ -842,12 +874,12 @@ ItemSchema::GenerateTournamentStickers(uint32_t tournamentEventId,
 
     // Select player sticker from one of the teams (50/50 chance)
     uint32_t playerTeamIndex =
-        (g_random.Uint32(0, 1) == 0) ? teamIndex1 : teamIndex2;
+        (ThreadRandom().Uint32(0, 1) == 0) ? teamIndex1 : teamIndex2;
     config.playerSticker =
-        playerStickers[playerTeamIndex][g_random.Uint32(0, 4)];
+        playerStickers[playerTeamIndex][ThreadRandom().Uint32(0, 4)];
 
     // Choose tournament sticker
-    config.tournamentSticker = tournamentStickers[g_random.Uint32(
+    config.tournamentSticker = tournamentStickers[ThreadRandom().Uint32(
         0, sizeof(tournamentStickers) / sizeof(tournamentStickers[0]) - 1)];
 
     return config;
@@ -884,12 +916,12 @@ ItemSchema::GenerateTournamentStickers(uint32_t tournamentEventId,
 
     // Select two unique teams
     size_t teamCount = sizeof(teams) / sizeof(teams[0]);
-    uint32_t teamIndex1 = g_random.Uint32(0, teamCount - 1);
-    uint32_t teamIndex2 = g_random.Uint32(0, teamCount - 1);
+    uint32_t teamIndex1 = ThreadRandom().Uint32(0, teamCount - 1);
+    uint32_t teamIndex2 = ThreadRandom().Uint32(0, teamCount - 1);
 
     // Make sure they're different
     while (teamIndex1 == teamIndex2 && teamCount > 1) {
-      teamIndex2 = g_random.Uint32(0, teamCount - 1);
+      teamIndex2 = ThreadRandom().Uint32(0, teamCount - 1);
     }
 
     // Get team stickers
@@ -898,12 +930,12 @@ ItemSchema::GenerateTournamentStickers(uint32_t tournamentEventId,
 
     // Select player sticker from one of the teams (50/50 chance)
     uint32_t playerTeamIndex =
-        (g_random.Uint32(0, 1) == 0) ? teamIndex1 : teamIndex2;
+        (ThreadRandom().Uint32(0, 1) == 0) ? teamIndex1 : teamIndex2;
     config.playerSticker =
-        playerStickers[playerTeamIndex][g_random.Uint32(0, 4)];
+        playerStickers[playerTeamIndex][ThreadRandom().Uint32(0, 4)];
 
     // Choose tournament sticker
-    config.tournamentSticker = tournamentStickers[g_random.Uint32(
+    config.tournamentSticker = tournamentStickers[ThreadRandom().Uint32(
         0, sizeof(tournamentStickers) / sizeof(tournamentStickers[0]) - 1)];
 
     return config;
@@ -951,7 +983,7 @@ void ItemSchema::ApplySouvenirStickers(CSOEconItem &item,
 
   // Shuffle the available slots
   for (size_t i = availableSlots.size() - 1; i > 0; --i) {
-    size_t j = g_random.Uint32(0, i);
+    size_t j = ThreadRandom().Uint32(0, i);
     std::swap(availableSlots[i], availableSlots[j]);
   }
 
@@ -1016,11 +1048,11 @@ void ItemSchema::ApplySouvenirStickers(CSOEconItem &item,
   }
 }
 
-void ItemSchema::ParseItems(const KeyValue *itemsKey,
-                            const KeyValue *prefabsKey) {
+void ItemSchema::ParseItems(const KeyValueView *itemsKey,
+                            const KeyValueView *prefabsKey) {
   m_itemInfo.reserve(itemsKey->SubkeyCount());
 
-  for (const KeyValue &itemKey : *itemsKey) {
+  for (const KeyValueView &itemKey : *itemsKey) {
     if (itemKey.Name() == "default") {
       // ignore this
       continue;
@@ -1061,12 +1093,12 @@ static uint32_t ItemQualityFromString(std::string_view name) {
   return ItemSchema::QualityUnique; // i guess???
 }
 
-void ItemSchema::ParseItemRecursive(ItemInfo &info, const KeyValue &itemKey,
-                                    const KeyValue *prefabsKey) {
+void ItemSchema::ParseItemRecursive(ItemInfo &info, const KeyValueView &itemKey,
+                                    const KeyValueView *prefabsKey) {
   // Process prefabs first so they can be overridden by the current item
   std::string_view prefabName = itemKey.GetString("prefab");
   if (prefabName.size() && prefabsKey) {
-    const KeyValue *prefabKey = prefabsKey->GetSubkey(prefabName);
+    const KeyValueView *prefabKey = prefabsKey->GetSubkey(prefabName);
     if (prefabKey) {
       ParseItemRecursive(info, *prefabKey, prefabsKey);
     }
@@ -1092,16 +1124,16 @@ void ItemSchema::ParseItemRecursive(ItemInfo &info, const KeyValue &itemKey,
     info.m_rarity = ItemRarityFromString(rarity);
   }
 
-  const KeyValue *attributes = itemKey.GetSubkey("attributes");
+  const KeyValueView *attributes = itemKey.GetSubkey("attributes");
   if (attributes) {
-    const KeyValue *supplyCrateSeries =
+    const KeyValueView *supplyCrateSeries =
         attributes->GetSubkey("set supply crate series");
     if (supplyCrateSeries) {
       info.m_supplyCrateSeries =
           supplyCrateSeries->GetNumber<uint32_t>("value");
     }
 
-    const KeyValue *tournamentEventId =
+    const KeyValueView *tournamentEventId =
         attributes->GetSubkey("tournament event id");
     if (tournamentEventId) {
       info.m_tournamentEventId =
@@ -1110,20 +1142,20 @@ void ItemSchema::ParseItemRecursive(ItemInfo &info, const KeyValue &itemKey,
   }
 }
 
-void ItemSchema::ParseAttributes(const KeyValue *attributesKey) {
+void ItemSchema::ParseAttributes(const KeyValueView *attributesKey) {
   m_attributeInfo.reserve(attributesKey->SubkeyCount());
 
-  for (const KeyValue &attributeKey : *attributesKey) {
+  for (const KeyValueView &attributeKey : *attributesKey) {
     uint32_t defIndex = FromString<uint32_t>(attributeKey.Name());
     assert(defIndex);
     m_attributeInfo.try_emplace(defIndex, attributeKey);
   }
 }
 
-void ItemSchema::ParseStickerKits(const KeyValue *stickerKitsKey) {
+void ItemSchema::ParseStickerKits(const KeyValueView *stickerKitsKey) {
   m_stickerKitInfo.reserve(stickerKitsKey->SubkeyCount());
 
-  for (const KeyValue &stickerKitKey : *stickerKitsKey) {
+  for (const KeyValueView &stickerKitKey : *stickerKitsKey) {
     std::string_view name = stickerKitKey.GetString("name");
 
     auto pair = m_stickerKitInfo.emplace(std::piecewise_construct,
@@ -1140,10 +1172,10 @@ void ItemSchema::ParseStickerKits(const KeyValue *stickerKitsKey) {
   }
 }
 
-void ItemSchema::ParsePaintKits(const KeyValue *paintKitsKey) {
+void ItemSchema::ParsePaintKits(const KeyValueView *paintKitsKey) {
   m_paintKitInfo.reserve(paintKitsKey->SubkeyCount());
 
-  for (const KeyValue &paintKitKey : *paintKitsKey) {
+  for (const KeyValueView &paintKitKey : *paintKitsKey) {
     std::string_view name = paintKitKey.GetString("name");
 
     auto pair = m_paintKitInfo.emplace(std::piecewise_construct,
@@ -1159,8 +1191,8 @@ void ItemSchema::ParsePaintKits(const KeyValue *paintKitsKey) {
   }
 }
 
-void ItemSchema::ParsePaintKitRarities(const KeyValue *raritiesKey) {
-  for (const KeyValue &key : *raritiesKey) {
+void ItemSchema::ParsePaintKitRarities(const KeyValueView *raritiesKey) {
+  for (const KeyValueView &key : *raritiesKey) {
     PaintKitInfo *paintKitInfo = PaintKitInfoByName(key.Name());
     if (!paintKitInfo) {
       ////assert(false);
@@ -1174,10 +1206,10 @@ void ItemSchema::ParsePaintKitRarities(const KeyValue *raritiesKey) {
   }
 }
 
-void ItemSchema::ParseMusicDefinitions(const KeyValue *musicDefinitionsKey) {
+void ItemSchema::ParseMusicDefinitions(const KeyValueView *musicDefinitionsKey) {
   m_musicDefinitionInfo.reserve(musicDefinitionsKey->SubkeyCount());
 
-  for (const KeyValue &musicDefinitionKey : *musicDefinitionsKey) {
+  for (const KeyValueView &musicDefinitionKey : *musicDefinitionsKey) {
     std::string_view name = musicDefinitionKey.GetString("name");
 
     auto pair = m_musicDefinitionInfo.emplace(
@@ -1237,11 +1269,11 @@ LootListItemTypeFromName(std::string_view name,
   return LootListItemPaintable;
 }
 
-void ItemSchema::ParseLootLists(const KeyValue *lootListsKey,
+void ItemSchema::ParseLootLists(const KeyValueView *lootListsKey,
                                 bool parentIsUnusual) {
   m_lootLists.reserve(lootListsKey->SubkeyCount());
 
-  for (const KeyValue &lootListKey : *lootListsKey) {
+  for (const KeyValueView &lootListKey : *lootListsKey) {
     std::string_view listName = lootListKey.Name();
 
     // check if this list should be treated as unusual
@@ -1256,7 +1288,7 @@ void ItemSchema::ParseLootLists(const KeyValue *lootListsKey,
     lootList.isUnusual = isUnusual; // only set unusual if parent is unusual AND
                                     // name contains "unusual"
 
-    for (const KeyValue &entryKey : lootListKey) {
+    for (const KeyValueView &entryKey : lootListKey) {
       std::string_view entryName = entryKey.Name();
 
       // check for options that we ignore
@@ -1385,10 +1417,10 @@ bool ItemSchema::ParseLootListItem(LootListItem &item, std::string_view name) {
 }
 
 void ItemSchema::ParseRevolvingLootLists(
-    const KeyValue *revolvingLootListsKey) {
+    const KeyValueView *revolvingLootListsKey) {
   m_revolvingLootLists.reserve(revolvingLootListsKey->SubkeyCount());
 
-  for (const KeyValue &revolvingLootListKey : *revolvingLootListsKey) {
+  for (const KeyValueView &revolvingLootListKey : *revolvingLootListsKey) {
     uint32_t index = FromString<uint32_t>(revolvingLootListKey.Name());
     assert(index);
 
@@ -1405,16 +1437,25 @@ void ItemSchema::ParseRevolvingLootLists(
   }
 }
 
-ItemInfo *ItemSchema::ItemInfoByName(std::string_view name) {
+void ItemSchema::BuildItemNameIndex() {
+  m_itemInfoByName.clear();
+  m_itemInfoByName.reserve(m_itemInfo.size());
+
+  // names should be unique, if not the first one in m_itemInfo wins like it
+  // did with the linear search this replaced
   for (auto &pair : m_itemInfo) {
-    const ItemInfo &info = pair.second;
-    if (info.m_name == name) {
-      return &pair.second;
-    }
+    m_itemInfoByName.try_emplace(pair.second.m_name, &pair.second);
   }
+}
 
-  // assert(false);
-  return nullptr;
+ItemInfo *ItemSchema::ItemInfoByName(std::string_view name) {
+  auto it = m_itemInfoByName.find(name);
+  if (it == m_itemInfoByName.end()) {
+    // assert(false);
+    return nullptr;
+  }
+
+  return it->second;
 }
 
 StickerKitInfo *ItemSchema::StickerKitInfoByName(std::string_view name) {
@@ -1452,92 +1493,121 @@ ItemSchema::MusicDefinitionInfoByName(std::string_view name) {
 // TRADE UP CONTRACT LOGIC
 // -----------------------------------------------------------------------------
 
-// Helper to recursively search a LootList
-static bool IsItemInLootList(const LootList &list, uint32_t defIndex,
-                             uint32_t paintKitId) {
-  // Check items in this list
+// every item in a loot list and its sublists, depth first
+static void CollectLootListItems(const LootList &list,
+                                 std::vector<const LootListItem *> &items) {
   for (const auto &item : list.items) {
-    // Match DefIndex
-    if (!item.itemInfo || item.itemInfo->m_defIndex != defIndex)
-      continue;
-
-    // Match PaintKit
-    uint32_t itemPaintKit =
-        item.paintKitInfo ? item.paintKitInfo->m_defIndex : 0;
-    if (itemPaintKit == paintKitId)
-      return true;
+    items.push_back(&item);
   }
 
-  // Check sublists
   for (const LootList *subList : list.subLists) {
-    if (IsItemInLootList(*subList, defIndex, paintKitId))
-      return true;
+    CollectLootListItems(*subList, items);
   }
-
-  return false;
 }
 
-const LootList *ItemSchema::FindCollectionForItem(uint32_t defIndex,
-                                                  int32_t paintKitId) const {
-  // We accept paintKitId as signed, but treat -1 or <0 as 0 if needed, usually
-  // it's >0 for skins
-  uint32_t pkId = (paintKitId < 0) ? 0 : static_cast<uint32_t>(paintKitId);
+static uint64_t CollectionKey(uint32_t defIndex, uint32_t paintKitId) {
+  return (static_cast<uint64_t>(defIndex) << 32) | paintKitId;
+}
 
-  // Iterate all loot lists.
-  // Note: CS:GO collections are typically top-level loot lists or part of
-  // "sets". In this schema, we likely look at m_lootLists.
-  // Performance note: This is linear search over all collections.
-  // For production with thousands of simultaneous crafts, this should be
-  // cached. For this server, it's fine.
+void ItemSchema::BuildTradeUpIndexes() {
+  m_collectionByItem.clear();
+  m_tradeUpOutputs.clear();
 
-  const LootList *fallback = nullptr;
+  // CS:GO collections are typically top-level loot lists or part of "sets".
+  // An item can be in several lists: the first set_/collection_ list that
+  // contains it wins, crate_ lists (wrappers around a set) only if nothing
+  // else has it
+  std::unordered_map<uint64_t, bool> fromCrate;
+  std::vector<const LootListItem *> items;
 
   for (const auto &[name, list] : m_lootLists) {
-    if (IsItemInLootList(list, defIndex, pkId)) {
-      if (name.find("crate_") != 0) {
-        // High confidence match (likely set_ or collection_)
-        return &list;
+    bool isCrate = (name.find("crate_") == 0);
+
+    items.clear();
+    CollectLootListItems(list, items);
+
+    for (const LootListItem *item : items) {
+      if (!item->itemInfo) {
+        continue;
       }
-      // Possible match, but might be a crate wrapper (keep looking for better)
-      if (!fallback) {
-        fallback = &list;
+
+      uint32_t paintKitId =
+          item->paintKitInfo ? item->paintKitInfo->m_defIndex : 0;
+      uint64_t key = CollectionKey(item->itemInfo->m_defIndex, paintKitId);
+
+      auto [it, added] = m_collectionByItem.try_emplace(key, &list);
+      if (added) {
+        fromCrate[key] = isCrate;
+      } else if (fromCrate[key] && !isCrate) {
+        it->second = &list;
+        fromCrate[key] = false;
       }
     }
   }
 
-  return fallback;
-}
+  // outputs only matter for lists that are some item's collection
+  for (const auto &[key, collection] : m_collectionByItem) {
+    auto [it, added] = m_tradeUpOutputs.try_emplace(collection);
+    if (!added) {
+      continue;
+    }
 
-static void
-CollectPotentialOutputs(const LootList &list, uint32_t targetRarity,
-                        std::vector<const LootListItem *> &candidates) {
-  // Check items
-  for (const auto &item : list.items) {
-    if (item.rarity == targetRarity) {
-      candidates.push_back(&item);
+    items.clear();
+    CollectLootListItems(*collection, items);
+
+    for (const LootListItem *item : items) {
+      it->second[item->rarity].push_back(item);
     }
   }
 
-  // Check sublists
-  for (const LootList *subList : list.subLists) {
-    CollectPotentialOutputs(*subList, targetRarity, candidates);
+  logger::info("Indexed %zu trade up inputs in %zu collections",
+               m_collectionByItem.size(), m_tradeUpOutputs.size());
+}
+
+const LootList *ItemSchema::FindCollectionForItem(uint32_t defIndex,
+                                                  int32_t paintKitId) const {
+  // We accept paintKitId as signed, but treat -1 or <0 as 0 if needed, usually
+  // it's >0 for skins
+  uint32_t pkId = (paintKitId < 0) ? 0 : static_cast<uint32_t>(paintKitId);
+
+  auto it = m_collectionByItem.find(CollectionKey(defIndex, pkId));
+  if (it == m_collectionByItem.end()) {
+    return nullptr;
+  }
+
+  return it->second;
+}
+
+std::span<const LootListItem *const>
+ItemSchema::TradeUpOutputs(const LootList *collection, uint32_t rarity) const {
+  auto collectionSearch = m_tradeUpOutputs.find(collection);
+  if (collectionSearch == m_tradeUpOutputs.end()) {
+    return {};
   }
+
+  auto raritySearch = collectionSearch->second.find(rarity);
+  if (raritySearch == collectionSearch->second.end()) {
+    return {};
+  }
+
+  return raritySearch->second;
 }
 
-bool ItemSchema::SelectTradeUpResult(const std::vector<CSOEconItem> &inputs,
-                                     CSOEconItem &output) {
+bool ItemSchema::SelectTradeUpResult(
+    const std::vector<const CSOEconItem *> &inputs,
+    CSOEconItem &output) const {
   if (inputs.empty())
     return false;
 
   // 1. Calculate Average Float
   double floatSum = 0.0;
-  for (const auto &input : inputs) {
+  for (const CSOEconItem *input : inputs) {
     // Locate Wear attribute
     float wear = 0.0f; // Default factory new-ish if missing?
                        // Or should we fail? Standard is roughly 0.
-    for (int i = 0; i < input.attribute_size(); i++) {
-      if (input.attribute(i).def_index() == AttributeTextureWear) {
-        wear = AttributeFloat(&input.attribute(i));
+    for (int i = 0; i < input->attribute_size(); i++) {
+      if (input->attribute(i).def_index() == AttributeTextureWear) {
+        wear = AttributeFloat(&input->attribute(i));
         break;
       }
     }
@@ -1551,8 +1621,8 @@ bool ItemSchema::SelectTradeUpResult(const std::vector<CSOEconItem> &inputs,
   // Because if you have 8 items from Col A and 2 from Col B,
   // there's an 80% chance we pick an input from Col A.
 
-  size_t luckyInputIdx = g_random.RandomIndex(inputs.size());
-  const CSOEconItem &luckyInput = inputs[luckyInputIdx];
+  size_t luckyInputIdx = ThreadRandom().RandomIndex(inputs.size());
+  const CSOEconItem &luckyInput = *inputs[luckyInputIdx];
 
   // Get DefIndex and PaintKit for this input to find its source collection
   uint32_t defIndex = luckyInput.def_index();
@@ -1576,8 +1646,8 @@ bool ItemSchema::SelectTradeUpResult(const std::vector<CSOEconItem> &inputs,
 
   // 3. Find Candidates in Collection with Rarity + 1
   uint32_t nextRarity = luckyInput.rarity() + 1;
-  std::vector<const LootListItem *> candidates;
-  CollectPotentialOutputs(*collection, nextRarity, candidates);
+  std::span<const LootListItem *const> candidates =
+      TradeUpOutputs(collection, nextRarity);
 
   if (candidates.empty()) {
     logger::error("TradeUp: Collection '%s' has no items of rarity %u",
@@ -1588,7 +1658,7 @@ bool ItemSchema::SelectTradeUpResult(const std::vector<CSOEconItem> &inputs,
   }
 
   // 4. Select Output Item
-  size_t winnerIdx = g_random.RandomIndex(candidates.size());
+  size_t winnerIdx = ThreadRandom().RandomIndex(candidates.size());
   const LootListItem *winner = candidates[winnerIdx];
 
   // 5. Generate Output Item Object
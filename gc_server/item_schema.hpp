@@ -4,9 +4,11 @@
 #include "cstrike15_gcmessages.pb.h"
 #include "econ_gcmessages.pb.h"
 #include "gcsdk_gcmessages.pb.h"
+#include "alias_table.hpp"
 #include "keyvalue_english.hpp"
+#include <span>
 
-class KeyValue;
+class KeyValueView;
 
 struct TournamentStickers {
   uint32_t teamSticker1;
@@ -19,7 +21,7 @@ enum class AttributeType { Float, Uint32, String };
 
 class AttributeInfo {
 public:
-  AttributeInfo(const KeyValue &key);
+  AttributeInfo(const KeyValueView &key);
 
   AttributeType m_type;
 };
@@ -53,7 +55,7 @@ public:
 
 class PaintKitInfo {
 public:
-  PaintKitInfo(const KeyValue &key);
+  PaintKitInfo(const KeyValueView &key);
 
   uint32_t m_defIndex;
   uint32_t m_rarity;
@@ -78,7 +80,7 @@ public:
 
 class StickerKitInfo {
 public:
-  StickerKitInfo(const KeyValue &key);
+  StickerKitInfo(const KeyValueView &key);
 
   uint32_t m_defIndex;
   uint32_t m_rarity;
@@ -109,7 +111,7 @@ public:
 
 class MusicDefinitionInfo {
 public:
-  MusicDefinitionInfo(const KeyValue &key);
+  MusicDefinitionInfo(const KeyValueView &key);
 
   uint32_t m_defIndex;
   std::string m_name;    // Internal name (e.g., "bladee_01")
@@ -171,10 +173,24 @@ struct LootList {
 // mikkotodo unfuck
 enum class GenerateStatTrak { No, Yes, Maybe };
 
+// everything a crate series can drop and how likely each item is, compiled
+// from its revolving loot list when the schema loads
+struct CrateDropTable {
+  std::vector<const LootListItem *> outcomes;
+  AliasTable table; // indexes outcomes
+  GenerateStatTrak statTrak{GenerateStatTrak::No};
+  // souvenir packages only drop souvenirs if the list has industrial grade
+  // items (golds never do)
+  bool souvenirs{};
+};
+
 class ItemSchema {
 public:
   ItemSchema();
 
+  // false if items_game.txt couldn't be read
+  bool Loaded() const { return m_loaded; }
+
   float AttributeFloat(const CSOEconItemAttribute *attribute) const;
   uint32_t AttributeUint32(const CSOEconItemAttribute *attribute) const;
   std::string AttributeString(const CSOEconItemAttribute *attribute) const;
@@ -186,13 +202,18 @@ public:
                           std::string_view value) const;
 
   // case opening
-  bool SelectItemFromCrate(const CSOEconItem &crate, CSOEconItem &item);
+  bool SelectItemFromCrate(const CSOEconItem &crate, CSOEconItem &item) const;
+  // nullptr if the crate doesn't exist or can't drop anything
+  const CrateDropTable *CrateDrops(uint32_t crateDefIndex) const;
 
   // trade up contract
   const LootList *FindCollectionForItem(uint32_t defIndex,
                                         int32_t paintKitId) const;
-  bool SelectTradeUpResult(const std::vector<CSOEconItem> &inputs,
-                           CSOEconItem &output);
+  // items of that rarity the collection can trade up into, in loot list order
+  std::span<const LootListItem *const>
+  TradeUpOutputs(const LootList *collection, uint32_t rarity) const;
+  bool SelectTradeUpResult(const std::vector<const CSOEconItem *> &inputs,
+                           CSOEconItem &output) const;
 
 public:
   // these could be parsed from the item schema but reduce code complexity by
@@ -275,19 +296,24 @@ public:
   };
 
 private:
-  void ParseItems(const KeyValue *itemsKey, const KeyValue *prefabsKey);
-  void ParseItemRecursive(ItemInfo &info, const KeyValue &itemKey,
-                          const KeyValue *prefabsKey);
-  void ParseAttributes(const KeyValue *attributesKey);
-  void ParseStickerKits(const KeyValue *stickerKitsKey);
-  void ParsePaintKits(const KeyValue *paintKitsKey);
-  void ParsePaintKitRarities(const KeyValue *raritiesKey);
-  void ParseMusicDefinitions(const KeyValue *musicDefinitionsKey);
-  void ParseLootLists(const KeyValue *lootListsKey, bool unusual);
-  void ParseRevolvingLootLists(const KeyValue *revolvingLootListsKey);
+  void ParseItems(const KeyValueView *itemsKey, const KeyValueView *prefabsKey);
+  void ParseItemRecursive(ItemInfo &info, const KeyValueView &itemKey,
+                          const KeyValueView *prefabsKey);
+  void ParseAttributes(const KeyValueView *attributesKey);
+  void ParseStickerKits(const KeyValueView *stickerKitsKey);
+  void ParsePaintKits(const KeyValueView *paintKitsKey);
+  void ParsePaintKitRarities(const KeyValueView *raritiesKey);
+  void ParseMusicDefinitions(const KeyValueView *musicDefinitionsKey);
+  void ParseLootLists(const KeyValueView *lootListsKey, bool unusual);
+  void ParseRevolvingLootLists(const KeyValueView *revolvingLootListsKey);
 
   bool ParseLootListItem(LootListItem &item, std::string_view name);
 
+  // lookup tables, built once the lists they index are parsed
+  void BuildItemNameIndex();
+  void BuildTradeUpIndexes();
+  void BuildCrateDropTables();
+
   // internal slop
   ItemInfo *ItemInfoByName(std::string_view name);
   StickerKitInfo *StickerKitInfoByName(std::string_view name);
@@ -296,7 +322,8 @@ private:
 
   // case opening
   bool EconItemFromLootListItem(const LootListItem &lootListItem,
-                                CSOEconItem &item, GenerateStatTrak statTrak);
+                                CSOEconItem &item,
+                                GenerateStatTrak statTrak) const;
 
   // tournament stickers
   TournamentStickers GenerateTournamentStickers(uint32_t tournamentEventId,
@@ -314,4 +341,22 @@ public:
   std::unordered_map<std::string, LootList> m_lootLists;
 
   std::unordered_map<uint32_t, const LootList &> m_revolvingLootLists;
+
+private:
+  bool m_loaded{};
+
+  // names point into m_itemInfo
+  std::unordered_map<std::string_view, ItemInfo *> m_itemInfoByName;
+
+  // (defIndex << 32 | paint kit) -> collection a trade up input came from
+  std::unordered_map<uint64_t, const LootList *> m_collectionByItem;
+
+  // collection -> rarity -> trade up candidates
+  std::unordered_map<
+      const LootList *,
+      std::unordered_map<uint32_t, std::vector<const LootListItem *>>>
+      m_tradeUpOutputs;
+
+  // supply crate series -> drop table
+  std::unordered_map<uint32_t, CrateDropTable> m_crateDropTables;
 };
@@ -0,0 +1,95 @@
+#include "item_schema_store.hpp"
+#include "tunables_manager.hpp"
+
+ItemSchemaStore &ItemSchemaStore::GetInstance() {
+  static ItemSchemaStore instance;
+  return instance;
+}
+
+ItemSchemaStore::~ItemSchemaStore() {
+  if (m_reloadThread.joinable()) {
+    m_reloadThread.join();
+  }
+}
+
+ItemSchemaStore::FileTimes ItemSchemaStore::CurrentFileTimes() {
+  // a missing file reads as the epoch; it changes again once it's back
+  std::error_code ec;
+  FileTimes times;
+  times.itemsGame =
+      std::filesystem::last_write_time("items/items_game.txt", ec);
+  times.unusualLootLists =
+      std::filesystem::last_write_time("items/unusual_loot_lists.txt", ec);
+  return times;
+}
+
+bool ItemSchemaStore::Load() {
+  m_fileTimes = CurrentFileTimes();
+  m_lastCheck = std::chrono::steady_clock::now();
+
+  auto schema = std::make_shared<const ItemSchema>();
+  bool loaded = schema->Loaded();
+  m_schema.store(std::move(schema));
+  return loaded;
+}
+
+std::shared_ptr<const ItemSchema> ItemSchemaStore::Get() const {
+  return m_schema.load();
+}
+
+void ItemSchemaStore::RequestReload() { m_reloadRequested = true; }
+
+void ItemSchemaStore::Update() {
+  bool reload = m_reloadRequested.exchange(false);
+
+  int checkSeconds =
+      TunablesManager::GetInstance().GetInt("schema_reload_check_s", 5);
+  auto now = std::chrono::steady_clock::now();
+  if (!reload && checkSeconds > 0 &&
+      now - m_lastCheck >= std::chrono::seconds(checkSeconds)) {
+    m_lastCheck = now;
+    if (CurrentFileTimes() != m_fileTimes) {
+      logger::info("ItemSchemaStore: item schema files changed, reloading");
+      reload = true;
+    }
+  }
+
+  if (reload) {
+    StartReload();
+  }
+}
+
+void ItemSchemaStore::StartReload() {
+  if (m_reloading) {
+    // pick it up again once the running parse is done
+    m_reloadRequested = true;
+    return;
+  }
+
+  if (m_reloadThread.joinable()) {
+    m_reloadThread.join();
+  }
+
+  // taken before parsing, so a write during the parse triggers another one
+  m_fileTimes = CurrentFileTimes();
+  m_reloading = true;
+
+  m_reloadThread = std::thread([this] {
+    auto start = std::chrono::steady_clock::now();
+    auto schema = std::make_shared<const ItemSchema>();
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    if (schema->Loaded()) {
+      m_schema.store(std::move(schema));
+      logger::info("ItemSchemaStore: item schema reloaded in %lld ms",
+                   static_cast<long long>(elapsedMs));
+    } else {
+      logger::error("ItemSchemaStore: reload failed, keeping the current "
+                    "item schema");
+    }
+
+    m_reloading = false;
+  });
+}
@@ -0,0 +1,68 @@
+#pragma once
+/**
+ * item_schema_store.hpp - Shared, hot-reloadable ItemSchema snapshot
+ *
+ * items_game.txt is parsed once into an immutable ItemSchema that every
+ * user shares. Callers take a snapshot with Get() at the start of an
+ * operation and use it throughout, so a reload never changes the schema
+ * under a running unbox or trade up.
+ *
+ * Reloads parse a new schema on a worker thread and publish it atomically
+ * when it parsed; a schema that failed to load keeps the current one live.
+ * They are started from the main loop when items_game.txt or
+ * unusual_loot_lists.txt changed (checked every schema_reload_check_s
+ * seconds, default 5, 0 = off) or when RequestReload() was called (the
+ * main loop does on SIGHUP, on Linux).
+ */
+
+#include "item_schema.hpp"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <thread>
+
+class ItemSchemaStore {
+public:
+  static ItemSchemaStore &GetInstance();
+
+  // Parses the schema on the calling thread and publishes it even when
+  // items_game.txt failed to load (false), so Get() is never null after it
+  bool Load();
+
+  // Current snapshot, nullptr before Load
+  std::shared_ptr<const ItemSchema> Get() const;
+
+  // Reload on the next Update; only sets a flag
+  void RequestReload();
+
+  // Main loop: starts requested or file-triggered reloads
+  void Update();
+
+private:
+  struct FileTimes {
+    std::filesystem::file_time_type itemsGame;
+    std::filesystem::file_time_type unusualLootLists;
+
+    bool operator==(const FileTimes &) const = default;
+  };
+
+  ItemSchemaStore() = default;
+  ~ItemSchemaStore();
+
+  ItemSchemaStore(const ItemSchemaStore &) = delete;
+  ItemSchemaStore &operator=(const ItemSchemaStore &) = delete;
+
+  static FileTimes CurrentFileTimes();
+
+  void StartReload();
+
+  std::atomic<std::shared_ptr<const ItemSchema>> m_schema;
+  std::atomic<bool> m_reloadRequested{false};
+  std::atomic<bool> m_reloading{false};
+
+  // main thread only
+  std::thread m_reloadThread;
+  FileTimes m_fileTimes;
+  std::chrono::steady_clock::time_point m_lastCheck;
+};
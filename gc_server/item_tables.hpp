@@ -0,0 +1,246 @@
+#pragma once
+/**
+ * item_tables.hpp - Compile-time defindex lookup tables
+ *
+ * Loadout slot, weapon display name / class name and the defindexes of
+ * each slot are needed per item when building SOCaches and on every equip.
+ * They are fixed for this game version, so they are listed once below and
+ * expanded at compile time into dense arrays indexed by defindex: lookups
+ * are a bounds check and a load, and return string_views and spans into
+ * static storage.
+ *
+ * Anything not listed falls back to the item schema where the callers
+ * already did so (weapon info), or to slot 55 (collectibles and the rest).
+ */
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace ItemTables {
+
+inline constexpr uint32_t SlotKnife = 0;
+inline constexpr uint32_t SlotMusicKit = 54;
+inline constexpr uint32_t SlotOther = 55; // probably a collectible
+
+struct WeaponInfo {
+  uint32_t defIndex;
+  std::string_view name; // display name
+  std::string_view id;   // class name
+};
+
+namespace detail {
+
+struct SlotEntry {
+  uint32_t defIndex;
+  uint32_t slot;
+};
+
+inline constexpr SlotEntry SlotEntries[] = {
+    {42, 0},   {59, 0},   // Default knives (custom knives 500-552 below)
+    {49, 1},              // C4
+    {4, 2},    {32, 2},   {61, 2}, // Glock / P2000 / USP-S
+    {2, 3},               // Dual Berettas
+    {36, 4},              // P250
+    {3, 5},    {30, 5},   {63, 5}, // Five-SeveN / Tec-9 / CZ75
+    {1, 6},    {64, 6},   // Deagle / R8
+    {34, 8},   {17, 8},   // MP9 / MAC-10
+    {33, 9},   {23, 9},   // MP7 / MP5-SD
+    {24, 10},             // UMP-45
+    {19, 11},             // P90
+    {26, 12},             // PP-Bizon
+    {10, 14},  {13, 14},  // FAMAS / Galil AR
+    {7, 15},   {16, 15},  {60, 15}, // AK-47 / M4A4 / M4A1-S
+    {40, 16},             // SSG 08 (Scout)
+    {39, 17},  {8, 17},   // SG 553 / AUG
+    {9, 18},              // AWP
+    {11, 19},  {38, 19},  // G3SG1 / SCAR-20
+    {35, 20},             // Nova
+    {25, 21},             // XM1014
+    {29, 22},  {27, 22},  // Sawed-Off / MAG-7
+    {14, 23},             // M249
+    {28, 24},             // Negev
+    // no gloves cuz its classiccounter
+    {1314, SlotMusicKit}, // Music kits
+};
+
+inline constexpr uint32_t CustomKnifeFirst = 500;
+inline constexpr uint32_t CustomKnifeLast = 552;
+
+// Slot 55 lists this range (the generic catch-all), not every defindex
+inline constexpr uint32_t OtherFirst = 1000;
+inline constexpr uint32_t OtherLast = 5000;
+
+inline constexpr WeaponInfo Weapons[] = {
+    // Pistols
+    {1, "Desert Eagle", "weapon_deagle"},
+    {2, "Dual Berettas", "weapon_elite"},
+    {3, "Five-SeveN", "weapon_fiveseven"},
+    {4, "Glock-18", "weapon_glock"},
+    {30, "Tec-9", "weapon_tec9"},
+    {32, "P2000", "weapon_hkp2000"},
+    {36, "P250", "weapon_p250"},
+    {61, "USP-S", "weapon_usp_silencer"},
+    {63, "CZ75-Auto", "weapon_cz75a"},
+    {64, "R8 Revolver", "weapon_revolver"},
+
+    // Rifles
+    {7, "AK-47", "weapon_ak47"},
+    {8, "AUG", "weapon_aug"},
+    {9, "AWP", "weapon_awp"},
+    {10, "FAMAS", "weapon_famas"},
+    {11, "G3SG1", "weapon_g3sg1"},
+    {13, "Galil AR", "weapon_galilar"},
+    {16, "M4A4", "weapon_m4a1"},
+    {38, "SCAR-20", "weapon_scar20"},
+    {39, "SG 553", "weapon_sg556"},
+    {40, "SSG 08", "weapon_ssg08"},
+    {60, "M4A1-S", "weapon_m4a1_silencer"},
+
+    // SMGs
+    {17, "MAC-10", "weapon_mac10"},
+    {19, "P90", "weapon_p90"},
+    {23, "MP5-SD", "weapon_mp5sd"},
+    {24, "UMP-45", "weapon_ump45"},
+    {26, "PP-Bizon", "weapon_bizon"},
+    {33, "MP7", "weapon_mp7"},
+    {34, "MP9", "weapon_mp9"},
+
+    // Heavy
+    {14, "M249", "weapon_m249"},
+    {25, "XM1014", "weapon_xm1014"},
+    {27, "MAG-7", "weapon_mag7"},
+    {28, "Negev", "weapon_negev"},
+    {29, "Sawed-Off", "weapon_sawedoff"},
+    {35, "Nova", "weapon_nova"},
+
+    // Knives
+    {42, "Knife (CT)", "weapon_knife"},
+    {59, "Knife (T)", "weapon_knife_t"},
+    {500, "Bayonet", "weapon_bayonet"},
+    {503, "Classic Knife", "weapon_knife_css"},
+    {505, "Flip Knife", "weapon_knife_flip"},
+    {506, "Gut Knife", "weapon_knife_gut"},
+    {507, "Karambit", "weapon_knife_karambit"},
+    {508, "M9 Bayonet", "weapon_knife_m9_bayonet"},
+    {509, "Huntsman Knife", "weapon_knife_tactical"},
+    {512, "Falchion Knife", "weapon_knife_falchion"},
+    {514, "Bowie Knife", "weapon_knife_survival_bowie"},
+    {515, "Butterfly Knife", "weapon_knife_butterfly"},
+    {516, "Shadow Daggers", "weapon_knife_push"},
+    {517, "Paracord Knife", "weapon_knife_cord"},
+    {518, "Survival Knife", "weapon_knife_canis"},
+    {519, "Ursus Knife", "weapon_knife_ursus"},
+    {520, "Navaja Knife", "weapon_knife_gypsy_jackknife"},
+    {521, "Nomad Knife", "weapon_knife_outdoor"},
+    {522, "Stiletto Knife", "weapon_knife_stiletto"},
+    {523, "Talon Knife", "weapon_knife_widowmaker"},
+    {525, "Skeleton Knife", "weapon_knife_skeleton"},
+
+    // Equipment
+    {31, "Zeus x27", "weapon_taser"},
+    {49, "C4", "weapon_c4"},
+
+    // Other special items
+    {1209, "Sticker", "sticker"},
+    {1314, "Music Kit", "music_kit"},
+};
+
+// One past the highest listed defindex; everything above is SlotOther
+inline constexpr uint32_t DefIndexLimit = 1315;
+inline constexpr uint32_t SlotCount = SlotOther + 1;
+inline constexpr size_t SlotMemberCount =
+    std::size(SlotEntries) + (CustomKnifeLast - CustomKnifeFirst + 1);
+
+inline constexpr auto SlotByDefIndex = [] {
+  std::array<uint8_t, DefIndexLimit> table{};
+  table.fill(SlotOther);
+  for (const SlotEntry &entry : SlotEntries) {
+    table[entry.defIndex] = static_cast<uint8_t>(entry.slot);
+  }
+  for (uint32_t i = CustomKnifeFirst; i <= CustomKnifeLast; i++) {
+    table[i] = SlotKnife;
+  }
+  return table;
+}();
+
+// 1-based index into Weapons, 0 = not listed
+inline constexpr auto WeaponByDefIndex = [] {
+  static_assert(std::size(Weapons) < 255);
+  std::array<uint8_t, DefIndexLimit> table{};
+  for (size_t i = 0; i < std::size(Weapons); i++) {
+    table[Weapons[i].defIndex] = static_cast<uint8_t>(i + 1);
+  }
+  return table;
+}();
+
+// Members of every slot but SlotOther, grouped by slot in listing order
+struct SlotMemberTable {
+  std::array<uint32_t, SlotMemberCount> defIndexes{};
+  std::array<uint32_t, SlotCount + 1> offsets{}; // slot s: [s, s + 1)
+};
+
+inline constexpr SlotMemberTable Members = [] {
+  SlotMemberTable members;
+  size_t next = 0;
+  for (uint32_t slot = 0; slot < SlotCount; slot++) {
+    members.offsets[slot] = static_cast<uint32_t>(next);
+    if (slot == SlotOther) {
+      continue;
+    }
+    for (const SlotEntry &entry : SlotEntries) {
+      if (entry.slot == slot) {
+        members.defIndexes[next++] = entry.defIndex;
+      }
+    }
+    if (slot == SlotKnife) {
+      for (uint32_t i = CustomKnifeFirst; i <= CustomKnifeLast; i++) {
+        members.defIndexes[next++] = i;
+      }
+    }
+  }
+  members.offsets[SlotCount] = static_cast<uint32_t>(next);
+  return members;
+}();
+
+inline constexpr auto OtherMembers = [] {
+  std::array<uint32_t, OtherLast - OtherFirst + 1> range{};
+  for (uint32_t i = 0; i < range.size(); i++) {
+    range[i] = OtherFirst + i;
+  }
+  return range;
+}();
+
+} // namespace detail
+
+// Loadout slot a defindex is equipped in
+constexpr uint32_t ItemSlot(uint32_t defIndex) {
+  return defIndex < detail::DefIndexLimit ? detail::SlotByDefIndex[defIndex]
+                                          : SlotOther;
+}
+
+// Display and class name of a known weapon or special item, else nullptr
+constexpr const WeaponInfo *FindWeapon(uint32_t defIndex) {
+  if (defIndex >= detail::DefIndexLimit ||
+      detail::WeaponByDefIndex[defIndex] == 0) {
+    return nullptr;
+  }
+  return &detail::Weapons[detail::WeaponByDefIndex[defIndex] - 1];
+}
+
+// Defindexes equipped in a slot (the reverse of ItemSlot)
+constexpr std::span<const uint32_t> SlotMembers(uint32_t slotId) {
+  if (slotId == SlotOther) {
+    return detail::OtherMembers;
+  }
+  if (slotId >= detail::SlotCount) {
+    return {};
+  }
+  return std::span<const uint32_t>(detail::Members.defIndexes)
+      .subspan(detail::Members.offsets[slotId],
+               detail::Members.offsets[slotId + 1] -
+                   detail::Members.offsets[slotId]);
+}
+
+} // namespace ItemTables
@@ -1,8 +1,6 @@
 #include "stdafx.h"
 #include "keyvalue.hpp"
 
-constexpr auto SubkeyReserveCount = 8;
-
 // for writing binary keyvalues
 enum class BinaryCommand : uint8_t
 {
@@ -20,143 +18,11 @@ enum class BinaryCommand : uint8_t
     Terminate
 };
 
-class KeyValueParser
-{
-public:
-    KeyValueParser(std::string_view str)
-        : m_ptr{ str.begin() }
-        , m_end{ str.end() }
-        , m_lineNumber{ 1 }
-    {
-    }
-
-    // skips whitespace, returns false on eof
-    [[nodiscard]] bool NextToken()
-    {
-    start:
-        while (true)
-        {
-            if (IsEndOfFile())
-            {
-                return false;
-            }
-
-            if (*m_ptr > ' ')
-            {
-                break;
-            }
-
-            if (*m_ptr == '\n')
-            {
-                m_lineNumber++;
-            }
-
-            m_ptr++;
-        }
-
-        if (m_ptr[0] != '/' || m_ptr[1] != '/')
-        {
-            return true;
-        }
-
-        m_ptr += 2;
-
-        while (*m_ptr != '\n')
-        {
-            if (IsEndOfFile())
-            {
-                return false;
-            }
-
-            m_ptr++;
-        }
-
-        goto start;
-    }
-
-    std::string_view ParseString()
-    {
-        m_ptr++; // skip the start quote
-
-        auto start = m_ptr;
-
-        while (!IsEndOfFile() && *m_ptr != '"')
-        {
-            m_ptr++;
-        }
-
-        size_t length = m_ptr - start;
-
-        m_ptr++; // skip the end quote
-
-        return { &start[0], length };
-    }
-
-    char PeekCharacter() const
-    {
-        assert(!IsEndOfFile());
-        return m_ptr[0];
-    }
-
-    void SkipCharacter()
-    {
-        assert(!IsEndOfFile());
-        m_ptr++;
-    }
-
-private:
-    bool IsEndOfFile() const { return m_ptr >= m_end; }
-
-    std::string_view::const_iterator m_ptr;
-    std::string_view::const_iterator m_end;
-
-    // for error reports
-    int m_lineNumber;
-};
-
-static std::string LoadFile(const char* path)
-{
-    FILE* f = fopen(path, "rb");
-    if (!f)
-    {
-        return {};
-    }
-
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-
-    std::string buffer;
-    buffer.resize(size);
-    long bytesRead = static_cast<long>(fread(buffer.data(), 1, size, f));
-
-    fclose(f);
-
-    if (bytesRead != size)
-    {
-        return {};
-    }
-
-    return buffer;
-}
-
 KeyValue::KeyValue(std::string_view name)
     : m_name{ name }
 {
 }
 
-bool KeyValue::ParseFromFile(const char* path)
-{
-    std::string data = LoadFile(path);
-    if (data.empty())
-    {
-        return false;
-    }
-
-    KeyValueParser parser{ data };
-    return Parse(parser);
-}
-
 bool KeyValue::WriteToFile(const char* path)
 {
     FILE* f = fopen(path, "wb");
@@ -208,71 +74,6 @@ void KeyValue::BinaryWriteToString(std::string& buffer)
     BinaryWriteCommand(buffer, BinaryCommand::Terminate);
 }
 
-bool KeyValue::Parse(KeyValueParser& parser)
-{
-    m_subkeys.reserve(SubkeyReserveCount);
-
-    while (true)
-    {
-        if (!parser.NextToken())
-        {
-            return true;
-        }
-
-        KeyValue* current;
-
-        switch (parser.PeekCharacter())
-        {
-        case '"':
-            current = FindOrCreateSubkey(parser.ParseString());
-            break;
-
-        case '}':
-            parser.SkipCharacter();
-            return true;
-
-        default:
-            return false;
-        }
-
-        if (!parser.NextToken())
-        {
-            return false;
-        }
-
-        switch (parser.PeekCharacter())
-        {
-        case '"':
-            current->m_string = parser.ParseString();
-            break;
-
-        case '{':
-            parser.SkipCharacter();
-            if (!current->Parse(parser))
-            {
-                return false;
-            }
-            break;
-
-        default:
-            return false;
-        }
-    }
-}
-
-KeyValue* KeyValue::FindOrCreateSubkey(std::string_view name)
-{
-    for (KeyValue& subkey : m_subkeys)
-    {
-        if (subkey.m_name == name)
-        {
-            return &subkey;
-        }
-    }
-
-    return &m_subkeys.emplace_back(name);
-}
-
 void KeyValue::WriteToFile(FILE* f, int indent)
 {
     if (indent)
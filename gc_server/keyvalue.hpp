@@ -1,6 +1,5 @@
 #pragma once
 
-class KeyValueParser;
 
 // not really the right place for this...
 template<typename T>
@@ -27,12 +26,12 @@ inline float FromString(std::string_view string)
 }
 #endif
 
+// builds and writes keyvalue files, see KeyValueDocument for reading them
 class KeyValue
 {
 public:
     KeyValue(std::string_view name);
 
-    bool ParseFromFile(const char* path);
     bool WriteToFile(const char* path);
 
     void BinaryWriteToString(std::string& buffer);
@@ -75,8 +74,6 @@ public:
     }
 
 private:
-    bool Parse(KeyValueParser& parser);
-    KeyValue* FindOrCreateSubkey(std::string_view name);
     void WriteToFile(FILE* f, int indent);
 
     std::string m_name;
@@ -0,0 +1,643 @@
+#include "stdafx.h"
+#include "keyvalue_document.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <deque>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define KEYVALUE_SSE2 1
+#endif
+
+// subkey lists at least this long get a hash index
+constexpr uint32_t IndexThreshold = 16;
+
+constexpr size_t ArenaBlockSize = 256 * 1024;
+
+// first byte that isn't whitespace: like the old parser anything up to ' '
+// counts as whitespace, and so do bytes >= 0x80 (signed char), which skips
+// a utf-8 bom
+static const char* SkipWhitespace(const char* ptr, const char* end)
+{
+#ifdef KEYVALUE_SSE2
+    const __m128i space = _mm_set1_epi8(' ');
+    while (end - ptr >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, space)));
+        if (mask)
+        {
+            return ptr + std::countr_zero(mask);
+        }
+
+        ptr += 16;
+    }
+#endif
+
+    while (ptr < end && static_cast<signed char>(*ptr) <= ' ')
+    {
+        ptr++;
+    }
+
+    return ptr;
+}
+
+// next quote, or end
+static const char* FindQuote(const char* ptr, const char* end)
+{
+#ifdef KEYVALUE_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    while (end - ptr >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)));
+        if (mask)
+        {
+            return ptr + std::countr_zero(mask);
+        }
+
+        ptr += 16;
+    }
+#endif
+
+    while (ptr < end && *ptr != '"')
+    {
+        ptr++;
+    }
+
+    return ptr;
+}
+
+static size_t HashName(std::string_view name)
+{
+    return std::hash<std::string_view>{}(name);
+}
+
+// compiled keyvalues: header, a flat node array in breadth first order (so
+// the children of a node are contiguous) and a deduplicated string table
+constexpr uint32_t CompiledMagic = 0x3143564b; // "KVC1"
+constexpr uint32_t CompiledVersion = 1;
+
+struct CompiledHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceSize;
+    uint64_t sourceHash;
+    uint32_t nodeCount;
+    uint32_t stringBytes;
+};
+
+struct CompiledNode
+{
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t valueOffset;
+    uint32_t valueLength;
+    uint32_t firstChild;
+    uint32_t childCount;
+};
+
+static_assert(sizeof(CompiledHeader) == 32);
+static_assert(sizeof(CompiledNode) == 24);
+
+class KeyValueCompiled
+{
+public:
+    // false if data is not a compiled copy of this source, or is damaged
+    bool Open(std::string_view data, uint64_t sourceSize, uint64_t sourceHash)
+    {
+        CompiledHeader header;
+        if (data.size() < sizeof(header))
+        {
+            return false;
+        }
+
+        memcpy(&header, data.data(), sizeof(header));
+
+        if (header.magic != CompiledMagic
+            || header.version != CompiledVersion
+            || header.sourceSize != sourceSize
+            || header.sourceHash != sourceHash
+            || !header.nodeCount)
+        {
+            return false;
+        }
+
+        uint64_t nodeBytes = uint64_t{ header.nodeCount } * sizeof(CompiledNode);
+        if (data.size() != sizeof(header) + nodeBytes + header.stringBytes)
+        {
+            return false;
+        }
+
+        // the header keeps the nodes 8 byte aligned in the (page aligned) mapping
+        m_nodes = reinterpret_cast<const CompiledNode*>(data.data() + sizeof(header));
+        m_nodeCount = header.nodeCount;
+        m_strings = data.substr(sizeof(header) + nodeBytes);
+
+        for (uint32_t i = 0; i < m_nodeCount; i++)
+        {
+            const CompiledNode& node = m_nodes[i];
+
+            if (uint64_t{ node.nameOffset } + node.nameLength > m_strings.size()
+                || uint64_t{ node.valueOffset } + node.valueLength > m_strings.size())
+            {
+                return false;
+            }
+
+            // children always come after their parent, so there are no cycles
+            if (node.childCount
+                && (node.firstChild <= i
+                    || uint64_t{ node.firstChild } + node.childCount > m_nodeCount))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    const CompiledNode& Node(uint32_t index) const
+    {
+        assert(index < m_nodeCount);
+        return m_nodes[index];
+    }
+
+    std::string_view String(uint32_t offset, uint32_t length) const
+    {
+        return m_strings.substr(offset, length);
+    }
+
+private:
+    const CompiledNode* m_nodes{};
+    uint32_t m_nodeCount{};
+    std::string_view m_strings;
+};
+
+static bool CompileKeyValues(const KeyValueView& root,
+    uint64_t sourceSize,
+    uint64_t sourceHash,
+    std::string& buffer)
+{
+    std::vector<const KeyValueView*> order{ &root };
+    std::vector<CompiledNode> nodes;
+    std::string strings;
+
+    // names repeat a lot ("name", "item_name", ...), store each string once
+    std::unordered_map<std::string_view, uint32_t> stringOffsets;
+    auto addString = [&](std::string_view string) -> uint32_t
+    {
+        auto it = stringOffsets.find(string);
+        if (it != stringOffsets.end())
+        {
+            return it->second;
+        }
+
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(string);
+        stringOffsets.emplace(string, offset);
+        return offset;
+    };
+
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const KeyValueView* keyValue = order[i];
+
+        CompiledNode node{};
+        node.nameOffset = addString(keyValue->Name());
+        node.nameLength = static_cast<uint32_t>(keyValue->Name().size());
+        node.valueOffset = addString(keyValue->String());
+        node.valueLength = static_cast<uint32_t>(keyValue->String().size());
+        node.firstChild = static_cast<uint32_t>(order.size());
+        node.childCount = static_cast<uint32_t>(keyValue->SubkeyCount());
+        nodes.push_back(node);
+
+        for (const KeyValueView& subkey : *keyValue)
+        {
+            order.push_back(&subkey);
+        }
+
+        if (order.size() > UINT32_MAX || strings.size() > UINT32_MAX)
+        {
+            return false;
+        }
+    }
+
+    CompiledHeader header{};
+    header.magic = CompiledMagic;
+    header.version = CompiledVersion;
+    header.sourceSize = sourceSize;
+    header.sourceHash = sourceHash;
+    header.nodeCount = static_cast<uint32_t>(nodes.size());
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+
+    buffer.reserve(sizeof(header) + nodes.size() * sizeof(CompiledNode) + strings.size());
+    buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    buffer.append(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(CompiledNode));
+    buffer.append(strings);
+    return true;
+}
+
+class KeyValueDocumentParser
+{
+public:
+    KeyValueDocumentParser(KeyValueDocument& document, std::string_view text)
+        : m_document{ document }
+        , m_begin{ text.data() }
+        , m_ptr{ text.data() }
+        , m_end{ text.data() + text.size() }
+    {
+    }
+
+    // parses subkeys into node until its closing brace (or eof)
+    bool Parse(KeyValueView& node, size_t depth)
+    {
+        if (depth == m_levels.size())
+        {
+            m_levels.emplace_back();
+        }
+
+        // deque: references stay valid while deeper levels are added
+        Level& level = m_levels[depth];
+        level.subkeys.clear();
+        level.index.clear();
+
+        // a repeated block merges into the first one
+        for (const KeyValueView& subkey : node)
+        {
+            level.subkeys[FindOrAdd(level, subkey.m_name)] = subkey;
+        }
+
+        while (NextToken())
+        {
+            uint32_t current;
+
+            switch (*m_ptr)
+            {
+            case '"':
+                current = FindOrAdd(level, ParseString());
+                break;
+
+            case '}':
+                m_ptr++;
+                Finish(node, level);
+                return true;
+
+            default:
+                return false;
+            }
+
+            if (!NextToken())
+            {
+                return false;
+            }
+
+            switch (*m_ptr)
+            {
+            case '"':
+                level.subkeys[current].m_string = ParseString();
+                break;
+
+            case '{':
+            {
+                m_ptr++;
+                KeyValueView subkey = level.subkeys[current];
+                if (!Parse(subkey, depth + 1))
+                {
+                    return false;
+                }
+                level.subkeys[current] = subkey;
+                break;
+            }
+
+            default:
+                return false;
+            }
+        }
+
+        Finish(node, level);
+        return true;
+    }
+
+    size_t LineNumber() const
+    {
+        return 1 + std::count(m_begin, std::min(m_ptr, m_end), '\n');
+    }
+
+private:
+    // subkeys of the block being parsed at one depth, reused between blocks
+    struct Level
+    {
+        std::vector<KeyValueView> subkeys;
+        std::vector<uint32_t> index; // like KeyValueView::m_index once there are many subkeys
+    };
+
+    // skips whitespace and comments, returns false on eof
+    bool NextToken()
+    {
+        while (true)
+        {
+            m_ptr = SkipWhitespace(m_ptr, m_end);
+            if (m_ptr >= m_end)
+            {
+                return false;
+            }
+
+            if (m_ptr[0] != '/' || m_end - m_ptr < 2 || m_ptr[1] != '/')
+            {
+                return true;
+            }
+
+            const void* newline = memchr(m_ptr + 2, '\n', m_end - m_ptr - 2);
+            if (!newline)
+            {
+                m_ptr = m_end;
+                return false;
+            }
+
+            m_ptr = static_cast<const char*>(newline);
+        }
+    }
+
+    std::string_view ParseString()
+    {
+        const char* start = m_ptr + 1; // skip the start quote
+        const char* quote = FindQuote(start, m_end);
+
+        m_ptr = (quote < m_end) ? quote + 1 : m_end; // skip the end quote
+
+        return { start, static_cast<size_t>(quote - start) };
+    }
+
+    uint32_t FindOrAdd(Level& level, std::string_view name)
+    {
+        if (level.index.empty())
+        {
+            for (uint32_t i = 0; i < level.subkeys.size(); i++)
+            {
+                if (level.subkeys[i].m_name == name)
+                {
+                    return i;
+                }
+            }
+        }
+        else
+        {
+            size_t mask = level.index.size() - 1;
+            for (size_t slot = HashName(name) & mask; level.index[slot]; slot = (slot + 1) & mask)
+            {
+                uint32_t i = level.index[slot] - 1;
+                if (level.subkeys[i].m_name == name)
+                {
+                    return i;
+                }
+            }
+        }
+
+        uint32_t added = static_cast<uint32_t>(level.subkeys.size());
+        level.subkeys.emplace_back().m_name = name;
+
+        if (level.subkeys.size() >= IndexThreshold)
+        {
+            if (level.subkeys.size() * 2 > level.index.size())
+            {
+                Rehash(level);
+            }
+            else
+            {
+                Insert(level.index, name, added);
+            }
+        }
+
+        return added;
+    }
+
+    static void Insert(std::vector<uint32_t>& index, std::string_view name, uint32_t subkey)
+    {
+        size_t mask = index.size() - 1;
+        size_t slot = HashName(name) & mask;
+        while (index[slot])
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        index[slot] = subkey + 1;
+    }
+
+    static void Rehash(Level& level)
+    {
+        level.index.assign(std::bit_ceil(level.subkeys.size() * 4), 0);
+        for (uint32_t i = 0; i < level.subkeys.size(); i++)
+        {
+            Insert(level.index, level.subkeys[i].m_name, i);
+        }
+    }
+
+    // moves the finished subkeys into the arena
+    void Finish(KeyValueView& node, const Level& level)
+    {
+        KeyValueView* subkeys = m_document.AllocateArray<KeyValueView>(level.subkeys.size());
+        std::uninitialized_copy(level.subkeys.begin(), level.subkeys.end(), subkeys);
+
+        node.m_subkeys = subkeys;
+        node.m_subkeyCount = static_cast<uint32_t>(level.subkeys.size());
+        m_document.BuildIndex(node);
+    }
+
+    KeyValueDocument& m_document;
+    const char* m_begin;
+    const char* m_ptr;
+    const char* m_end;
+    std::deque<Level> m_levels;
+};
+
+const KeyValueView* KeyValueView::GetSubkey(std::string_view name) const
+{
+    if (m_index)
+    {
+        for (size_t slot = HashName(name) & m_indexMask; m_index[slot]; slot = (slot + 1) & m_indexMask)
+        {
+            const KeyValueView& subkey = m_subkeys[m_index[slot] - 1];
+            if (subkey.m_name == name)
+            {
+                return &subkey;
+            }
+        }
+
+        return nullptr;
+    }
+
+    for (const KeyValueView& subkey : *this)
+    {
+        if (subkey.m_name == name)
+        {
+            return &subkey;
+        }
+    }
+
+    return nullptr;
+}
+
+std::string_view KeyValueView::GetString(std::string_view name, std::string_view fallback) const
+{
+    const KeyValueView* subkey = GetSubkey(name);
+    if (!subkey)
+    {
+        return fallback;
+    }
+
+    return subkey->m_string;
+}
+
+KeyValueDocument::KeyValueDocument() = default;
+KeyValueDocument::~KeyValueDocument() = default;
+
+bool KeyValueDocument::ParseFromFile(const char* path)
+{
+    Reset();
+
+    if (!m_source.Open(path))
+    {
+        return false;
+    }
+
+    return ParseText(m_source.Data(), path);
+}
+
+bool KeyValueDocument::ParseFromFileCached(const char* path, const char* compiledPath)
+{
+    Reset();
+
+    if (!m_source.Open(path))
+    {
+        return false;
+    }
+
+    std::string_view data = m_source.Data();
+    uint64_t sourceHash = Fnv1a(data);
+
+    if (m_compiled.Open(compiledPath))
+    {
+        KeyValueCompiled compiled;
+        if (compiled.Open(m_compiled.Data(), data.size(), sourceHash))
+        {
+            // everything points into the compiled copy from here on
+            Build(compiled, m_root, 0);
+            m_source.Close();
+            return true;
+        }
+
+        logger::info("KeyValue: %s is out of date, recompiling %s", compiledPath, path);
+        m_compiled.Close();
+    }
+
+    if (!ParseText(data, path))
+    {
+        return false;
+    }
+
+    std::string buffer;
+    if (!CompileKeyValues(m_root, data.size(), sourceHash, buffer)
+        || !WriteFileReplace(compiledPath, buffer))
+    {
+        // not fatal, the next start parses the text again
+        logger::warning("KeyValue: could not write %s", compiledPath);
+    }
+
+    return true;
+}
+
+void KeyValueDocument::Reset()
+{
+    m_root = {};
+    m_blocks.clear();
+    m_blockUsed = 0;
+    m_source.Close();
+    m_compiled.Close();
+}
+
+bool KeyValueDocument::ParseText(std::string_view text, const char* path)
+{
+    KeyValueDocumentParser parser{ *this, text };
+    if (!parser.Parse(m_root, 0))
+    {
+        logger::error("KeyValue: syntax error in %s on line %zu", path, parser.LineNumber());
+        return false;
+    }
+
+    return true;
+}
+
+void KeyValueDocument::Build(const KeyValueCompiled& compiled, KeyValueView& node, uint32_t index)
+{
+    const CompiledNode& source = compiled.Node(index);
+    KeyValueView* subkeys = AllocateArray<KeyValueView>(source.childCount);
+
+    for (uint32_t i = 0; i < source.childCount; i++)
+    {
+        uint32_t childIndex = source.firstChild + i;
+        const CompiledNode& child = compiled.Node(childIndex);
+
+        KeyValueView* subkey = new (&subkeys[i]) KeyValueView{};
+        subkey->m_name = compiled.String(child.nameOffset, child.nameLength);
+        subkey->m_string = compiled.String(child.valueOffset, child.valueLength);
+        Build(compiled, *subkey, childIndex);
+    }
+
+    node.m_subkeys = subkeys;
+    node.m_subkeyCount = source.childCount;
+    BuildIndex(node);
+}
+
+void* KeyValueDocument::Allocate(size_t size, size_t alignment)
+{
+    if (!m_blocks.empty())
+    {
+        Block& block = m_blocks.back();
+        size_t offset = (m_blockUsed + alignment - 1) & ~(alignment - 1);
+        if (offset + size <= block.size)
+        {
+            m_blockUsed = offset + size;
+            return block.data.get() + offset;
+        }
+    }
+
+    // operator new aligns for any fundamental type
+    size_t blockSize = std::max(ArenaBlockSize, size);
+    m_blocks.push_back({ std::unique_ptr<std::byte[]>{ new std::byte[blockSize] }, blockSize });
+    m_blockUsed = size;
+    return m_blocks.back().data.get();
+}
+
+void KeyValueDocument::BuildIndex(KeyValueView& node)
+{
+    node.m_index = nullptr;
+    node.m_indexMask = 0;
+
+    if (node.m_subkeyCount < IndexThreshold)
+    {
+        return;
+    }
+
+    size_t slots = std::bit_ceil(size_t{ node.m_subkeyCount } * 2);
+    uint32_t* index = AllocateArray<uint32_t>(slots);
+    std::fill_n(index, slots, 0);
+
+    size_t mask = slots - 1;
+    for (uint32_t i = 0; i < node.m_subkeyCount; i++)
+    {
+        size_t slot = HashName(node.m_subkeys[i].m_name) & mask;
+        while (index[slot])
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        index[slot] = i + 1;
+    }
+
+    node.m_index = index;
+    node.m_indexMask = static_cast<uint32_t>(mask);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "keyvalue.hpp"
+#include "mapped_file.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class KeyValueCompiled;
+class KeyValueDocument;
+class KeyValueDocumentParser;
+
+// read only node of a KeyValueDocument, same accessors as KeyValue
+// names and strings point into the mapped file, subkeys into the document's arena
+class KeyValueView
+{
+public:
+    std::string_view Name() const { return m_name; }
+    size_t SubkeyCount() const { return m_subkeyCount; }
+    std::string_view String() const { return m_string; }
+
+    // range based for loops for subkeys
+    const KeyValueView* begin() const { return m_subkeys; }
+    const KeyValueView* end() const { return m_subkeys + m_subkeyCount; }
+
+    // hashed when there are many subkeys
+    const KeyValueView* GetSubkey(std::string_view name) const;
+    std::string_view GetString(std::string_view name, std::string_view fallback = {}) const;
+
+    template<typename T>
+    T GetNumber(std::string_view name, T fallback = 0) const
+    {
+        const KeyValueView* subkey = GetSubkey(name);
+        if (!subkey)
+        {
+            return fallback;
+        }
+
+        return FromString<T>(subkey->m_string);
+    }
+
+private:
+    friend class KeyValueDocument;
+    friend class KeyValueDocumentParser;
+
+    std::string_view m_name;
+    std::string_view m_string;
+    const KeyValueView* m_subkeys{};
+    uint32_t m_subkeyCount{};
+    uint32_t m_indexMask{}; // m_index has m_indexMask + 1 slots
+    const uint32_t* m_index{}; // subkey index + 1, 0 = empty slot
+};
+
+// parses keyvalue text without copying it: the file is mapped and stays
+// mapped for the lifetime of the document, nodes live in a bump arena
+// (KeyValue is still what builds and writes files)
+class KeyValueDocument
+{
+public:
+    KeyValueDocument();
+    ~KeyValueDocument();
+
+    KeyValueDocument(const KeyValueDocument&) = delete;
+    KeyValueDocument& operator=(const KeyValueDocument&) = delete;
+
+    // replaces whatever the document held before
+    bool ParseFromFile(const char* path);
+
+    // ParseFromFile through a compiled binary copy at compiledPath (flat
+    // nodes + string table), rebuilt when the source file's hash changes
+    bool ParseFromFileCached(const char* path, const char* compiledPath);
+
+    const KeyValueView& Root() const { return m_root; }
+
+    // shortcut for Root().GetSubkey
+    const KeyValueView* GetSubkey(std::string_view name) const { return m_root.GetSubkey(name); }
+
+private:
+    friend class KeyValueDocumentParser;
+
+    void Reset();
+    bool ParseText(std::string_view text, const char* path);
+    void Build(const KeyValueCompiled& compiled, KeyValueView& node, uint32_t index);
+
+    // arena
+    void* Allocate(size_t size, size_t alignment);
+
+    template<typename T>
+    T* AllocateArray(size_t count)
+    {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void BuildIndex(KeyValueView& node);
+
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_blockUsed{};
+
+    MappedFile m_source;
+    MappedFile m_compiled;
+    KeyValueView m_root;
+};
@@ -2,9 +2,108 @@
 #include "keyvalue_english.hpp"
 #include "keyvalue.hpp"
 
+#include <bit>
+#include <cstring>
+#include <unordered_set>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LOCALIZATION_SSE2 1
+#endif
+
+// compiled table: header, entries, hash slots, then the string arena
+constexpr uint32_t CacheMagic = 0x31434f4c; // "LOC1"
+constexpr uint32_t CacheVersion = 1;
+
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceSize;
+    uint64_t sourceHash;
+    uint32_t entryCount;
+    uint32_t slotCount;
+    uint32_t stringBytes;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(CacheHeader) == 40);
+
+// utf-16 le to utf-8, appended to out. runs of ascii (most of the file) are
+// narrowed 8 code units at a time, everything else goes through the scalar path
+static void Utf16ToUtf8(const unsigned char* data, size_t units, std::string& out)
+{
+    // at most 3 bytes per code unit (a surrogate pair is 2 units, 4 bytes)
+    size_t start = out.size();
+    out.resize(start + units * 3);
+    char* dest = out.data() + start;
+
+    auto unitAt = [data](size_t i) -> uint32_t
+    {
+        return data[i * 2] | (data[i * 2 + 1] << 8);
+    };
+
+    size_t i = 0;
+    while (i < units)
+    {
+#ifdef LOCALIZATION_SSE2
+        if (units - i >= 8)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2));
+            __m128i high = _mm_and_si128(chunk, _mm_set1_epi16(static_cast<short>(0xff80)));
+            uint32_t ascii = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())));
+            if (ascii == 0xffff)
+            {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), _mm_packus_epi16(chunk, chunk));
+                dest += 8;
+                i += 8;
+                continue;
+            }
+
+            // copy the ascii prefix, two mask bits per unit
+            size_t prefix = std::countr_one(ascii) / 2;
+            for (size_t j = 0; j < prefix; j++)
+            {
+                *dest++ = static_cast<char>(data[(i + j) * 2]);
+            }
+            i += prefix;
+        }
+#endif
+
+        uint32_t c = unitAt(i++);
+        if (c < 0x80)
+        {
+            *dest++ = static_cast<char>(c);
+        }
+        else if (c < 0x800)
+        {
+            *dest++ = static_cast<char>(0xc0 | (c >> 6));
+            *dest++ = static_cast<char>(0x80 | (c & 0x3f));
+        }
+        else if (c >= 0xd800 && c < 0xdc00 && i < units
+            && unitAt(i) >= 0xdc00 && unitAt(i) < 0xe000)
+        {
+            c = 0x10000 + ((c - 0xd800) << 10) + (unitAt(i++) - 0xdc00);
+            *dest++ = static_cast<char>(0xf0 | (c >> 18));
+            *dest++ = static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+            *dest++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            *dest++ = static_cast<char>(0x80 | (c & 0x3f));
+        }
+        else
+        {
+            // unpaired surrogates are encoded as they are, like before
+            *dest++ = static_cast<char>(0xe0 | (c >> 12));
+            *dest++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            *dest++ = static_cast<char>(0x80 | (c & 0x3f));
+        }
+    }
+
+    out.resize(dest - out.data());
+}
+
 LocalizationSystem::LocalizationSystem()
 {
-    LoadLocalizationFile("items/csgo_english.txt");
+    LoadLocalizationFile("items/csgo_english.txt", "items/csgo_english.bin");
 }
 
 LocalizationSystem& LocalizationSystem::GetInstance() {
@@ -15,96 +114,113 @@ LocalizationSystem& LocalizationSystem::GetInstance() {
 std::string_view LocalizationSystem::GetLocalizedString(std::string_view token, std::string_view fallback) const
 {
     // Remove the # prefix if present
-    std::string tokenStr;
     if (!token.empty() && token[0] == '#')
     {
-        tokenStr = std::string(token.substr(1));
+        token.remove_prefix(1);
     }
-    else
+
+    if (m_slots.empty())
     {
-        tokenStr = std::string(token);
+        return fallback;
     }
 
-    auto it = m_localizationStrings.find(tokenStr);
-    if (it != m_localizationStrings.end())
+    size_t mask = m_slots.size() - 1;
+    for (size_t slot = Fnv1a(token) & mask; ; slot = (slot + 1) & mask)
     {
-        return it->second;
+        uint32_t index = m_slots[slot];
+        if (!index)
+        {
+            return fallback;
+        }
+
+        const Entry& entry = m_entries[index - 1];
+        if (Key(entry) == token)
+        {
+            return Value(entry);
+        }
     }
-    return fallback;
 }
 
-bool LocalizationSystem::LoadLocalizationFile(const char *path)
+bool LocalizationSystem::LoadLocalizationFile(const char *path, const char *cachePath)
 {
-    logger::info("Starting to load localization file with direct parsing: %s", path);
+    m_entries = {};
+    m_slots = {};
+    m_strings = {};
+    m_ownedEntries.clear();
+    m_ownedSlots.clear();
+    m_ownedStrings.clear();
+    m_cache.Close();
 
-    // Open file
-    FILE *f = fopen(path, "rb");
-    if (!f)
+    MappedFile source;
+    if (!source.Open(path))
     {
         logger::info("File %s does not exist or cannot be opened", path);
         return false;
     }
 
-    // Get file size
-    fseek(f, 0, SEEK_END);
-    long fileSize = ftell(f);
-    fseek(f, 0, SEEK_SET);
+    uint64_t sourceSize = source.Data().size();
+    uint64_t sourceHash = Fnv1a(source.Data());
 
-    // Read entire file content
-    std::vector<unsigned char> buffer(fileSize);
-    fread(buffer.data(), 1, fileSize, f);
-    fclose(f);
+    if (cachePath && m_cache.Open(cachePath))
+    {
+        if (OpenCache(m_cache.Data(), sourceSize, sourceHash))
+        {
+            logger::info("Loaded %zu localized strings from %s", m_entries.size(), cachePath);
+            return !m_entries.empty();
+        }
 
-    // Check for UTF-16 BOM
-    bool isUTF16 = false;
-    if (fileSize >= 2 && buffer[0] == 0xFF && buffer[1] == 0xFE)
+        m_cache.Close();
+    }
+
+    if (!ParseFile(source.Data()))
     {
-        isUTF16 = true;
-        logger::info("UTF-16 LE encoding detected");
+        logger::error("Localization file %s is too large", path);
+        return false;
     }
 
-    // Convert to string (handle UTF-16 if needed)
-    std::string fileContent;
-    if (isUTF16)
+    BuildSlots();
+
+    if (cachePath && !m_entries.empty())
     {
-        // Skip BOM
-        for (size_t i = 2; i < buffer.size(); i += 2)
-        {
-            if (i + 1 >= buffer.size())
-                break;
+        WriteCache(cachePath, sourceSize, sourceHash);
+    }
 
-            // Get UTF-16 character (little endian)
-            uint16_t utf16Char = buffer[i] | (buffer[i + 1] << 8);
+    logger::info("Loaded %zu localized strings from %s", m_entries.size(), path);
+    return !m_entries.empty();
+}
 
-            // Convert to UTF-8
-            if (utf16Char < 128)
-            {
-                fileContent.push_back(static_cast<char>(utf16Char));
-            }
-            else if (utf16Char < 2048)
-            {
-                fileContent.push_back(static_cast<char>(192 | (utf16Char >> 6)));
-                fileContent.push_back(static_cast<char>(128 | (utf16Char & 63)));
-            }
-            else
-            {
-                fileContent.push_back(static_cast<char>(224 | (utf16Char >> 12)));
-                fileContent.push_back(static_cast<char>(128 | ((utf16Char >> 6) & 63)));
-                fileContent.push_back(static_cast<char>(128 | (utf16Char & 63)));
-            }
-        }
+bool LocalizationSystem::ParseFile(std::string_view data)
+{
+    // Check for UTF-16 BOM
+    std::string converted;
+    std::string_view fileContent = data;
+    if (data.size() >= 2 && static_cast<unsigned char>(data[0]) == 0xFF
+        && static_cast<unsigned char>(data[1]) == 0xFE)
+    {
+        Utf16ToUtf8(reinterpret_cast<const unsigned char*>(data.data()) + 2, (data.size() - 2) / 2, converted);
+        fileContent = converted;
     }
-    else
+
+    if (fileContent.size() > UINT32_MAX)
     {
-        fileContent.assign(reinterpret_cast<char *>(buffer.data()), buffer.size());
+        return false;
     }
 
+    // keys and values are copied into one arena; the first value for a key
+    // wins and identical values are stored once
+    std::unordered_set<std::string_view> keys;
+    std::unordered_map<std::string_view, uint32_t> valueOffsets;
+    m_ownedStrings.reserve(fileContent.size() / 2);
+
+    auto intern = [this](std::string_view string) -> uint32_t
+    {
+        uint32_t offset = static_cast<uint32_t>(m_ownedStrings.size());
+        m_ownedStrings.append(string);
+        return offset;
+    };
+
     // More aggressive direct parsing - looking for any "key" "value" pattern in the file
     size_t pos = 0;
-    size_t tokenCount = 0;
-
-    // Log some debugging info
-    //logger::info("Converted file size: %zu bytes", fileContent.size());
 
     // Directly scan through the entire file for "key" "value" patterns
     while (pos < fileContent.size())
@@ -124,7 +240,7 @@ bool LocalizationSystem::LoadLocalizationFile(const char *path)
             if (pos + 1 < fileContent.size() && fileContent[pos] == '/' && fileContent[pos + 1] == '/')
             {
                 pos = fileContent.find('\n', pos);
-                if (pos == std::string::npos)
+                if (pos == std::string_view::npos)
                     break;
                 pos++;
                 continue;
@@ -140,25 +256,21 @@ bool LocalizationSystem::LoadLocalizationFile(const char *path)
         if (fileContent[pos] != '"')
         {
             // Not a key - skip until next quote or newline
-            size_t nextQuote = fileContent.find('"', pos);
-            size_t nextNewline = fileContent.find('\n', pos);
-
-            if (nextQuote == std::string::npos && nextNewline == std::string::npos)
+            size_t next = fileContent.find_first_of("\"\n", pos);
+            if (next == std::string_view::npos)
                 break;
 
-            pos = std::min(
-                nextQuote != std::string::npos ? nextQuote : fileContent.size(),
-                nextNewline != std::string::npos ? nextNewline : fileContent.size());
+            pos = next;
             continue;
         }
 
         // Extract key
         size_t keyStart = pos + 1;
         size_t keyEnd = fileContent.find('"', keyStart);
-        if (keyEnd == std::string::npos)
+        if (keyEnd == std::string_view::npos)
             break;
 
-        std::string key = fileContent.substr(keyStart, keyEnd - keyStart);
+        std::string_view key = fileContent.substr(keyStart, keyEnd - keyStart);
         pos = keyEnd + 1;
 
         // Skip whitespace to value
@@ -176,35 +288,151 @@ bool LocalizationSystem::LoadLocalizationFile(const char *path)
 
         size_t valueStart = pos + 1;
         size_t valueEnd = fileContent.find('"', valueStart);
-        if (valueEnd == std::string::npos)
+        if (valueEnd == std::string_view::npos)
             break;
 
-        std::string value = fileContent.substr(valueStart, valueEnd - valueStart);
+        std::string_view value = fileContent.substr(valueStart, valueEnd - valueStart);
         pos = valueEnd + 1;
 
-        // Store in map - only if key seems like a token (no spaces, reasonable length)
-        if (key.find(' ') == std::string::npos && key.size() < 100 &&
-            key != "lang" && key != "Language" && key != "Tokens")
+        // Store - only if key seems like a token (no spaces, reasonable length)
+        if (key.find(' ') == std::string_view::npos && key.size() < 100 &&
+            key != "lang" && key != "Language" && key != "Tokens"
+            && keys.insert(key).second)
         {
-            m_localizationStrings.emplace(key, value);
-            tokenCount++;
+            Entry entry{};
+            entry.keyOffset = intern(key);
+            entry.keyLength = static_cast<uint32_t>(key.size());
 
-            // Debug: log some example tokens
-            /*if (tokenCount <= 5 || (tokenCount % 1000 == 0))
+            auto [it, added] = valueOffsets.emplace(value, 0);
+            if (added)
             {
-                logger::info("Token %zu: \"%s\" = \"%s\"",
-                            tokenCount, key.c_str(),
-                            value.size() > 30 ? (value.substr(0, 30) + "...").c_str() : value.c_str());
-            }*/
+                it->second = intern(value);
+            }
+            entry.valueOffset = it->second;
+            entry.valueLength = static_cast<uint32_t>(value.size());
+
+            m_ownedEntries.push_back(entry);
+        }
+    }
+
+    m_ownedStrings.shrink_to_fit();
+    m_entries = m_ownedEntries;
+    m_strings = m_ownedStrings;
+    return true;
+}
+
+void LocalizationSystem::BuildSlots()
+{
+    // at most half full
+    size_t slotCount = std::bit_ceil(std::max<size_t>(m_entries.size() * 2, 16));
+    m_ownedSlots.assign(slotCount, 0);
+
+    size_t mask = slotCount - 1;
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        size_t slot = Fnv1a(Key(m_entries[i])) & mask;
+        while (m_ownedSlots[slot])
+        {
+            slot = (slot + 1) & mask;
         }
+
+        m_ownedSlots[slot] = static_cast<uint32_t>(i + 1);
     }
 
-    logger::info("Loaded %zu localized strings from %s", tokenCount, path);
-    return tokenCount > 0;
+    m_slots = m_ownedSlots;
+}
+
+bool LocalizationSystem::OpenCache(std::string_view data, uint64_t sourceSize, uint64_t sourceHash)
+{
+    CacheHeader header;
+    if (data.size() < sizeof(header))
+    {
+        return false;
+    }
+
+    memcpy(&header, data.data(), sizeof(header));
+
+    if (header.magic != CacheMagic
+        || header.version != CacheVersion
+        || header.sourceSize != sourceSize
+        || header.sourceHash != sourceHash
+        || !std::has_single_bit(header.slotCount)
+        || header.slotCount <= header.entryCount)
+    {
+        return false;
+    }
+
+    uint64_t entryBytes = uint64_t{ header.entryCount } * sizeof(Entry);
+    uint64_t slotBytes = uint64_t{ header.slotCount } * sizeof(uint32_t);
+    if (data.size() != sizeof(header) + entryBytes + slotBytes + header.stringBytes)
+    {
+        return false;
+    }
+
+    // the header keeps everything 4 byte aligned in the (page aligned) mapping
+    const char* ptr = data.data() + sizeof(header);
+    std::span<const Entry> entries{ reinterpret_cast<const Entry*>(ptr), header.entryCount };
+    std::span<const uint32_t> slots{ reinterpret_cast<const uint32_t*>(ptr + entryBytes), header.slotCount };
+    std::string_view strings = data.substr(sizeof(header) + entryBytes + slotBytes);
+
+    for (const Entry& entry : entries)
+    {
+        if (uint64_t{ entry.keyOffset } + entry.keyLength > strings.size()
+            || uint64_t{ entry.valueOffset } + entry.valueLength > strings.size())
+        {
+            return false;
+        }
+    }
+
+    // every entry in exactly one slot, so lookups always reach an empty slot
+    size_t used = 0;
+    for (uint32_t index : slots)
+    {
+        if (index > header.entryCount)
+        {
+            return false;
+        }
+
+        used += (index != 0);
+    }
+
+    if (used != header.entryCount)
+    {
+        return false;
+    }
+
+    m_entries = entries;
+    m_slots = slots;
+    m_strings = strings;
+    return true;
+}
+
+void LocalizationSystem::WriteCache(const char *cachePath, uint64_t sourceSize, uint64_t sourceHash) const
+{
+    CacheHeader header{};
+    header.magic = CacheMagic;
+    header.version = CacheVersion;
+    header.sourceSize = sourceSize;
+    header.sourceHash = sourceHash;
+    header.entryCount = static_cast<uint32_t>(m_entries.size());
+    header.slotCount = static_cast<uint32_t>(m_slots.size());
+    header.stringBytes = static_cast<uint32_t>(m_strings.size());
+
+    std::string buffer;
+    buffer.reserve(sizeof(header) + m_entries.size_bytes() + m_slots.size_bytes() + m_strings.size());
+    buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    buffer.append(reinterpret_cast<const char*>(m_entries.data()), m_entries.size_bytes());
+    buffer.append(reinterpret_cast<const char*>(m_slots.data()), m_slots.size_bytes());
+    buffer.append(m_strings);
+
+    if (!WriteFileReplace(cachePath, buffer))
+    {
+        logger::warning("Could not write localization cache %s", cachePath);
+    }
 }
 
 // helper
 std::string_view LocalizeToken(std::string_view token, std::string_view fallback)
 {
     return LocalizationSystem::GetInstance().GetLocalizedString(token, fallback);
-}
\ No newline at end of file
+}
@@ -1,7 +1,10 @@
 #pragma once
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <span>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <vector>
 class KeyValue;
 class LocalizationSystem
 {
@@ -11,14 +14,44 @@ public:
     LocalizationSystem(const LocalizationSystem&) = delete;
     LocalizationSystem& operator=(const LocalizationSystem&) = delete;
     
+    // no allocation, the returned view lives as long as the loaded table
     std::string_view GetLocalizedString(std::string_view token, std::string_view fallback = {}) const;
     
-    bool LoadLocalizationFile(const char* path);
+    // replaces the loaded table; with a cachePath the parsed table is kept
+    // there and mapped directly next time, as long as the source is unchanged
+    bool LoadLocalizationFile(const char* path, const char* cachePath = nullptr);
     
 private:
     LocalizationSystem();
-    
-    std::unordered_map<std::string, std::string> m_localizationStrings;
+
+    // offsets into m_strings
+    struct Entry
+    {
+        uint32_t keyOffset;
+        uint32_t keyLength;
+        uint32_t valueOffset;
+        uint32_t valueLength;
+    };
+
+    bool ParseFile(std::string_view data);
+    void BuildSlots();
+    bool OpenCache(std::string_view data, uint64_t sourceSize, uint64_t sourceHash);
+    void WriteCache(const char* cachePath, uint64_t sourceSize, uint64_t sourceHash) const;
+
+    std::string_view Key(const Entry& entry) const { return m_strings.substr(entry.keyOffset, entry.keyLength); }
+    std::string_view Value(const Entry& entry) const { return m_strings.substr(entry.valueOffset, entry.valueLength); }
+
+    // open addressing on Fnv1a(key), m_slots.size() is a power of two
+    // entry index + 1, 0 = empty slot
+    std::span<const Entry> m_entries;
+    std::span<const uint32_t> m_slots;
+    std::string_view m_strings;
+
+    // what the views point into: either these or the mapped cache
+    std::vector<Entry> m_ownedEntries;
+    std::vector<uint32_t> m_ownedSlots;
+    std::string m_ownedStrings;
+    MappedFile m_cache;
 };
 
-std::string_view LocalizeToken(std::string_view token, std::string_view fallback = {});
\ No newline at end of file
+std::string_view LocalizeToken(std::string_view token, std::string_view fallback = {});
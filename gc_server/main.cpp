@@ -1,5 +1,7 @@
 #include "main.hpp"
+#include "item_schema_store.hpp"
 #include "platform.hpp"
+#include "random.hpp"
 #include "safe_parse.hpp"
 #include "stdafx.h"
 #include "tunables_manager.hpp"
@@ -9,6 +11,9 @@
 #include <cstdlib> // for getenv, atoi
 #include <cstring>
 #include <dlfcn.h>
+#ifndef _WIN32
+#include <csignal>
+#endif
 #include <steam/steam_gameserver.h>
 
 // Configuration - Can be overridden by environment variables GC_BIND_IP and
@@ -27,6 +32,12 @@ uint16 get_game_port() {
 const char *BIND_IP = get_bind_ip();
 const uint16 GAME_PORT = get_game_port();
 
+#ifndef _WIN32
+// Set by the SIGHUP handler, polled by the main loop; a handler can't
+// safely do more than this
+static volatile std::sig_atomic_t s_reloadRequested = 0;
+#endif
+
 // Convert IP string to uint32 in host byte order
 uint32 ip_string_to_uint32(const char *ip_str) {
   if (strcmp(ip_str, "0.0.0.0") == 0) {
@@ -60,6 +71,11 @@ int main() {
   setenv("SteamAppId", "730", 0);
 #endif
 
+#ifndef _WIN32
+  // kill -HUP reloads items_game.txt without a restart
+  signal(SIGHUP, [](int) { s_reloadRequested = 1; });
+#endif
+
   uint32 bind_ip = ip_string_to_uint32(BIND_IP);
 
   logger::info("Initializing Steam Game Server on %s:%d", BIND_IP, GAME_PORT);
@@ -81,11 +97,24 @@ int main() {
                (publicIP.m_unIPv4 >> 16) & 0xFF,
                (publicIP.m_unIPv4 >> 8) & 0xFF, publicIP.m_unIPv4 & 0xFF);
 
+  // fixed seed so unboxes and trade ups can be replayed, 0 = random
+  int randomSeed = TunablesManager::GetInstance().GetInt("random_seed", 0);
+  if (randomSeed) {
+    logger::info("Using fixed random seed %d", randomSeed);
+    SeedRandom(static_cast<uint64_t>(randomSeed));
+  }
+
   m_network.Init(BIND_IP, GAME_PORT);
 
   logger::info("GC Server initialized successfully. Starting main loop...");
 
   while (true) {
+#ifndef _WIN32
+    if (s_reloadRequested) {
+      s_reloadRequested = 0;
+      ItemSchemaStore::GetInstance().RequestReload();
+    }
+#endif
     m_network.Update();
     // Use Tunables for optimization control
     // Optimized: 50ms sleep (approx 20Hz) - "Spread like jam"
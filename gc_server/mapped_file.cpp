@@ -0,0 +1,147 @@
+#include "mapped_file.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() { Close(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    Close();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+    m_file = std::exchange(other.m_file, nullptr);
+    m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+  }
+  return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char *path) {
+  Close();
+
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    CloseHandle(file);
+    return false;
+  }
+
+  void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!data) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  m_file = file;
+  m_mapping = mapping;
+  m_data = static_cast<const char *>(data);
+  m_size = static_cast<size_t>(size.QuadPart);
+  return true;
+}
+
+void MappedFile::Close() {
+  if (m_data) {
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    CloseHandle(m_file);
+  }
+  m_data = nullptr;
+  m_size = 0;
+  m_file = nullptr;
+  m_mapping = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const char *path) {
+  Close();
+
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+
+  void *data =
+      mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE,
+           fd, 0);
+  close(fd); // the mapping keeps the file alive
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  // read front to back once
+  madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+  m_data = static_cast<const char *>(data);
+  m_size = static_cast<size_t>(st.st_size);
+  return true;
+}
+
+void MappedFile::Close() {
+  if (m_data) {
+    munmap(const_cast<char *>(m_data), m_size);
+  }
+  m_data = nullptr;
+  m_size = 0;
+}
+
+#endif
+
+bool WriteFileReplace(const char *path, std::string_view data) {
+  std::string tempPath = std::string{path} + ".tmp";
+
+  FILE *f = fopen(tempPath.c_str(), "wb");
+  if (!f) {
+    return false;
+  }
+
+  bool written = fwrite(data.data(), 1, data.size(), f) == data.size();
+  written &= (fclose(f) == 0);
+
+  std::error_code ec;
+  if (written) {
+    std::filesystem::rename(tempPath, path, ec);
+  }
+
+  if (!written || ec) {
+    std::filesystem::remove(tempPath, ec);
+    return false;
+  }
+
+  return true;
+}
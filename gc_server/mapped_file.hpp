@@ -0,0 +1,55 @@
+#pragma once
+/**
+ * mapped_file.hpp - Read-only memory mapping of a whole file
+ *
+ * For large data files that are read once at startup (items_game.txt,
+ * csgo_english.txt and their compiled caches): the pages come straight from
+ * the page cache instead of being copied into a heap buffer first.
+ *
+ * Also the two helpers those caches share: a stable hash to tell whether a
+ * cache still matches its source, and a write that never leaves half a file.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // false if the file can't be opened or is empty
+  bool Open(const char *path);
+  void Close();
+
+  std::string_view Data() const { return {m_data, m_size}; }
+  bool IsOpen() const { return m_data != nullptr; }
+
+private:
+  const char *m_data = nullptr;
+  size_t m_size = 0;
+#ifdef _WIN32
+  void *m_file = nullptr;
+  void *m_mapping = nullptr;
+#endif
+};
+
+// FNV-1a, stable across builds and platforms (usable in files on disk)
+inline uint64_t Fnv1a(std::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// Writes path.tmp and renames it over path; false (and no file) on failure
+bool WriteFileReplace(const char *path, std::string_view data);
@@ -3,12 +3,13 @@
 #include "gameserver_manager.hpp"
 #include "logger.hpp"
 #include "networking.hpp"
+#include "player_profile_cache.hpp"
+#include "random.hpp"
 #include "tunables_manager.hpp"
 #include "web_api_client.hpp"
 #include <algorithm>
 #include <iomanip>
 #include <numeric>
-#include <random>
 #include <sstream>
 
 // Initialize static global instance pointer
@@ -282,7 +283,10 @@ bool MatchmakingManager::UpdatePlayerRating(
   }
 
   try {
-    return m_database->UpdatePlayerRating(steamId, newRating);
+    bool updated = m_database->UpdatePlayerRating(steamId, newRating);
+    GCNetwork::GetInstance()->NoteWrite(steamId);
+    PlayerProfileCache::GetInstance().Invalidate(steamId & 0xFFFFFFFF);
+    return updated;
   } catch (const std::exception &e) {
     logger::error("Failed to update player rating for %llu: %s", steamId,
                   e.what());
@@ -558,23 +562,18 @@ std::optional<std::string> MatchmakingManager::SelectMapForMatch(
 
   // Random selection among top weighted maps
   if (!topMaps.empty()) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, topMaps.size() - 1);
-    return topMaps[dis(gen)];
+    return topMaps[ThreadRandom().RandomIndex(topMaps.size())];
   }
 
   return std::nullopt;
 }
 
 std::string MatchmakingManager::GenerateMatchToken() const {
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<> dis(0, 15);
+  Random &random = ThreadRandom();
 
   std::stringstream ss;
   for (int i = 0; i < 16; ++i) {
-    ss << std::hex << dis(gen);
+    ss << std::hex << random.Uint32(0, 15);
   }
 
   return ss.str();
@@ -1,15 +1,25 @@
 #include "networking.hpp"
 #include "cstrike15_gcmessages.pb.h"
+#include "db_health.hpp"
+#include "econ_gcmessages.pb.h"
 #include "gc_const_csgo.hpp"
+#include "gcsystemmsgs.pb.h"
+#include "inventory_cache.hpp"
+#include "inventory_procedures.hpp"
+#include "inventory_write_queue.hpp"
+#include "item_schema_store.hpp"
 #include "matchmaking_manager.hpp"
 #include "networking_inventory.hpp"
 #include "networking_matchmaking.hpp"
 #include "networking_users.hpp"
+#include "request_arena.hpp"
 #include "stdafx.h"
 #include <chrono>
 #include <sstream>
 
 #include "logger.hpp"
+#include "safe_parse.hpp"
+#include "sql_transaction.hpp"
 #include "steam_network_message.hpp"
 #include "tunables_manager.hpp"
 #include "web_api_client.hpp"
@@ -64,11 +74,25 @@ GCNetwork::~GCNetwork() {
     m_matchmakingManager = nullptr;
   }
 
+  // Write out queued equip/ack/rename updates before the connection goes
+  if (!InventoryWriteQueue::GetInstance().FlushAll(m_mysql2)) {
+    logger::error("Inventory write queue not fully flushed, journal kept");
+  }
+
   CloseDatabases();
   SteamGameServerNetworking()->DestroyListenSocket(listen_socket, true);
 }
 
+// Host of the three primary schemas; breakers match connections on it
+static std::string PrimaryDBHost() {
+  return TunablesManager::GetInstance().GetString("db_host", "89.117.56.19");
+}
+
 bool GCNetwork::InitDatabases() {
+  // Breakers and timeouts first; pools pick them up as they connect
+  InitDBHealth();
+  std::string host = PrimaryDBHost();
+
   // Create connection pools (#6 enhancement)
   try {
     // Determine pool size based on threading mode
@@ -83,13 +107,13 @@ bool GCNetwork::InitDatabases() {
     }
 
     m_classicPool = std::make_shared<DBConnectionPool>(
-        "89.117.56.19", "classiccounter_user", "ClassicC0unter!DB2025",
+        host, "classiccounter_user", "ClassicC0unter!DB2025",
         "classiccounter", 3306, poolSizeClassic);
     m_inventoryPool = std::make_shared<DBConnectionPool>(
-        "89.117.56.19", "classiccounter_user", "ClassicC0unter!DB2025",
+        host, "classiccounter_user", "ClassicC0unter!DB2025",
         "ollum_inventory", 3306, poolSizeInventory);
     m_rankedPool = std::make_shared<DBConnectionPool>(
-        "89.117.56.19", "classiccounter_user", "ClassicC0unter!DB2025",
+        host, "classiccounter_user", "ClassicC0unter!DB2025",
         "ollum_ranked", 3306, poolSizeRanked);
     logger::info("Connection pools created successfully");
   } catch (const std::exception &e) {
@@ -97,6 +121,8 @@ bool GCNetwork::InitDatabases() {
     return false;
   }
 
+  InitReplicas();
+
   // Initialize legacy MySQL objects (backward compatibility - will be phased
   // out)
   m_mysql1 = mysql_init(NULL);
@@ -108,8 +134,12 @@ bool GCNetwork::InitDatabases() {
     return false;
   }
 
+  DBHealth::GetInstance().ApplyConnectionTimeouts(m_mysql1);
+  DBHealth::GetInstance().ApplyConnectionTimeouts(m_mysql2);
+  DBHealth::GetInstance().ApplyConnectionTimeouts(m_mysql3);
+
   // 1ST DB CONNECTION (legacy)
-  if (!mysql_real_connect(m_mysql1, "89.117.56.19", "classiccounter_user",
+  if (!mysql_real_connect(m_mysql1, host.c_str(), "classiccounter_user",
                           "ClassicC0unter!DB2025", "classiccounter", 3306, NULL,
                           0)) {
     logger::error("Failed to connect to database1: %s", mysql_error(m_mysql1));
@@ -118,7 +148,7 @@ bool GCNetwork::InitDatabases() {
   logger::info("Connected to classiccounter DB successfully!");
 
   // 2ND DB CONNECTION (legacy)
-  if (!mysql_real_connect(m_mysql2, "89.117.56.19", "classiccounter_user",
+  if (!mysql_real_connect(m_mysql2, host.c_str(), "classiccounter_user",
                           "ClassicC0unter!DB2025", "ollum_inventory", 3306,
                           NULL, 0)) {
     logger::error("Failed to connect to database2: %s", mysql_error(m_mysql2));
@@ -128,7 +158,7 @@ bool GCNetwork::InitDatabases() {
   logger::info("Connected to ollum_inventory DB successfully!");
 
   // 3RD DB CONNECTION (legacy)
-  if (!mysql_real_connect(m_mysql3, "89.117.56.19", "classiccounter_user",
+  if (!mysql_real_connect(m_mysql3, host.c_str(), "classiccounter_user",
                           "ClassicC0unter!DB2025", "ollum_ranked", 3306, NULL,
                           0)) {
     logger::error("Failed to connect to database3: %s", mysql_error(m_mysql3));
@@ -138,11 +168,126 @@ bool GCNetwork::InitDatabases() {
   }
   logger::info("Connected to ollum_ranked DB successfully!");
 
+  // Inventory queries filter on owner_account_id; running against a table
+  // that hasn't been migrated/backfilled would serve empty inventories.
+  if (mysql_query(m_mysql2, "SELECT id FROM csgo_items "
+                            "WHERE owner_account_id IS NULL "
+                            "AND owner_steamid2 LIKE 'STEAM\\_%:%:%' "
+                            "LIMIT 1") != 0) {
+    logger::error("csgo_items.owner_account_id is missing (%s) - apply "
+                  "sql/001_csgo_items_owner_account_id.sql",
+                  mysql_error(m_mysql2));
+    return false;
+  }
+  MYSQL_RES *pending = mysql_store_result(m_mysql2);
+  bool backfilled = pending && mysql_num_rows(pending) == 0;
+  if (pending) {
+    mysql_free_result(pending);
+  }
+  if (!backfilled) {
+    logger::error("csgo_items.owner_account_id is not fully backfilled - run "
+                  "account-id-backfill before starting the GC");
+    return false;
+  }
+
   return true;
 }
 
+/**
+ * Registers a circuit breaker for each primary database and sets the
+ * connection timeouts, all from tunables (db_host, db_breaker_*,
+ * db_timeout_*).
+ */
+void GCNetwork::InitDBHealth() {
+  const auto &tunables = TunablesManager::GetInstance();
+
+  DBCircuitBreaker::Config config;
+  config.minSamples =
+      std::max(1, tunables.GetInt("db_breaker_min_samples", 20));
+  config.errorPercent =
+      std::clamp(tunables.GetInt("db_breaker_error_pct", 50), 1, 100);
+  config.latencyMs =
+      std::max(1, tunables.GetInt("db_breaker_latency_ms", 1000));
+  config.openMs = std::max(0, tunables.GetInt("db_breaker_open_ms", 5000));
+  config.timeoutMinMs = std::max(1, tunables.GetInt("db_timeout_min_ms", 50));
+  config.timeoutMaxMs = std::max<uint32_t>(
+      config.timeoutMinMs, tunables.GetInt("db_timeout_max_ms", 5000));
+  config.timeoutFactor = std::max(1, tunables.GetInt("db_timeout_factor", 3));
+
+  std::string host = PrimaryDBHost();
+  auto &health = DBHealth::GetInstance();
+  health.SetConnectionTimeouts(
+      std::max(0, tunables.GetInt("db_connect_timeout_s", 3)),
+      std::max(0, tunables.GetInt("db_io_timeout_s", 10)));
+  health.Register(DBHealth::DB_CLASSIC, host, "classiccounter", config);
+  health.Register(DBHealth::DB_INVENTORY, host, "ollum_inventory", config);
+  health.Register(DBHealth::DB_RANKED, host, "ollum_ranked", config);
+}
+
+/**
+ * Attaches read replicas from the db_replicas tunable
+ * ("host[:port],host[:port]") to all three pools; the schemas share one
+ * primary, so every replica carries all of them.
+ */
+void GCNetwork::InitReplicas() {
+  const auto &tunables = TunablesManager::GetInstance();
+  std::string replicas = tunables.GetString("db_replicas", "");
+  if (replicas.empty()) {
+    return;
+  }
+
+  size_t poolSize = tunables.IsSingleThreaded()
+                        ? 1
+                        : static_cast<size_t>(std::max(
+                              1, tunables.GetInt("db_replica_pool_size", 2)));
+  auto stickiness = std::chrono::milliseconds(
+      tunables.GetInt("db_replica_stickiness_ms", 5000));
+
+  std::stringstream list(replicas);
+  std::string endpoint;
+  while (std::getline(list, endpoint, ',')) {
+    if (endpoint.empty()) {
+      continue;
+    }
+
+    std::string host = endpoint;
+    unsigned int port = 3306;
+    size_t colon = endpoint.find(':');
+    if (colon != std::string::npos) {
+      host = endpoint.substr(0, colon);
+      port = SafeParse::toUint16(endpoint.substr(colon + 1).c_str())
+                 .value_or(3306);
+    }
+
+    m_classicPool->addReplica(host, port, poolSize);
+    m_inventoryPool->addReplica(host, port, poolSize);
+    m_rankedPool->addReplica(host, port, poolSize);
+  }
+
+  m_classicPool->setReplicaStickiness(stickiness);
+  m_inventoryPool->setReplicaStickiness(stickiness);
+  m_rankedPool->setReplicaStickiness(stickiness);
+
+  logger::info("Read replicas: classic=%zu inventory=%zu ranked=%zu "
+               "(stickiness %d ms)",
+               m_classicPool->replicaCount(), m_inventoryPool->replicaCount(),
+               m_rankedPool->replicaCount(),
+               static_cast<int>(stickiness.count()));
+}
+
+void GCNetwork::NoteWrite(uint64_t steamId) {
+  if (steamId == 0 || !HasConnectionPools()) {
+    return;
+  }
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  m_classicPool->noteWrite(accountId);
+  m_inventoryPool->noteWrite(accountId);
+  m_rankedPool->noteWrite(accountId);
+}
+
 bool GCNetwork::ExecuteQuery(MYSQL *connection, const char *query) {
-  if (mysql_query(connection, query) != 0) {
+  if (!RunDBCall(connection, "ExecuteQuery",
+                 [&] { return mysql_query(connection, query); })) {
     logger::error("Query execution failed: %s", mysql_error(connection));
     return false;
   }
@@ -232,6 +377,13 @@ void GCNetwork::Init(const char *bind_ip, uint16 port) {
   // init db connections
   if (!InitDatabases()) {
     logger::error("Failed to initialize databases");
+  } else {
+    // Flushes commit well after the request that queued them; keep the
+    // player's reads on the primary from the commit on as well
+    InventoryWriteQueue::GetInstance().SetOnFlushed(
+        [this](uint32_t accountId) { NoteWrite(accountId); });
+    InventoryWriteQueue::GetInstance().Init(m_mysql2);
+    InventoryProcedures::GetInstance().Init(m_mysql2);
   }
 }
 
@@ -300,11 +452,13 @@ void GCNetwork::ReadAuthTicket(SNetSocket_t p2psocket, void *message,
     logger::info("Auth accepted for user %llu (whitelist disabled)", steamID);
 
     // find/create session - thread safe
+    bool resumed = false;
     {
       std::unique_lock<std::shared_mutex> lock(m_sessionsMutex);
       auto it = m_activeSessions.find(steamID);
       if (it != m_activeSessions.end()) {
         // update existing one
+        resumed = it->second.soCacheVersion != 0;
         SNetSocket_t oldSocket = it->second.socket;
         it->second.isAuthenticated = true;
         it->second.socket = p2psocket;
@@ -342,6 +496,21 @@ void GCNetwork::ReadAuthTicket(SNetSocket_t p2psocket, void *message,
                    m_activeSessions.size());
     }
 
+    // Fresh copy of the inventory for this session; SendSOCache and the
+    // inventory handlers read it from memory from now on
+    if (!InventoryCache::GetInstance().Load(inventory_db,
+                                            steamID & 0xFFFFFFFF)) {
+      logger::warning("Could not cache inventory for %llu, reading it from "
+                      "the database",
+                      steamID);
+    }
+
+    // A client that already got an SOCache from this session checks its
+    // copy against the current version and asks for a refresh if it's stale
+    if (resumed) {
+      GCNetwork_Inventory::SendSubscriptionCheck(p2psocket, steamID);
+    }
+
     // Process Alerts & Cooldowns
     auto alerts = WebAPIClient::GetInstance().GetAlertsForUser(steamID);
     for (const auto &alert : alerts) {
@@ -412,6 +581,7 @@ void GCNetwork::CleanupSessions() {
   for (auto &id : sessionsToRemove) {
     logger::info("Removing expired session for %llu", id);
     m_activeSessions.erase(id);
+    InventoryCache::GetInstance().Invalidate(id & 0xFFFFFFFF);
   }
   for (auto &socket : socketsToRemove) {
     m_socketToSteamId.erase(socket);
@@ -425,6 +595,23 @@ uint64_t GCNetwork::GetSessionSteamId(SNetSocket_t socket) {
   return (it != m_socketToSteamId.end()) ? it->second : 0;
 }
 
+uint64_t GCNetwork::GetSessionSOCacheVersion(uint64_t steamId) {
+  std::shared_lock<std::shared_mutex> lock(m_sessionsMutex);
+  auto it = m_activeSessions.find(steamId);
+  return (it != m_activeSessions.end()) ? it->second.soCacheVersion : 0;
+}
+
+void GCNetwork::SetSessionSOCacheVersion(uint64_t steamId, uint64_t version) {
+  if (version == 0) {
+    return; // nothing was sent
+  }
+  std::unique_lock<std::shared_mutex> lock(m_sessionsMutex);
+  auto it = m_activeSessions.find(steamId);
+  if (it != m_activeSessions.end()) {
+    it->second.soCacheVersion = version;
+  }
+}
+
 void GCNetwork::CheckNewItemsForActiveSessions() {
   // Thread-safe session check - use shared lock for reading
   std::shared_lock<std::shared_mutex> lock(m_sessionsMutex);
@@ -453,6 +640,77 @@ void SendHeartbeat(SNetSocket_t p2psocket) {
   message.WriteToSocket(p2psocket, true);
 }
 
+// Messages whose handlers never write to the databases
+static bool IsReadOnlyMessage(uint32_t type) {
+  switch (type) {
+  case k_EMsgGC_CC_GCConfirmAuth:
+  case k_EMsgGC_CC_CL2GC_BuildMatchmakingHelloRequest:
+  case k_EMsgGC_CC_CL2GC_SOCacheSubscribedRequest:
+  case k_ESOMsg_CacheSubscriptionRefresh:
+  case k_EMsgGC_CC_GCHeartbeat:
+  case k_EMsgGC_CC_CL2GC_ClientCommendPlayerQuery:
+  case k_EMsgGC_CC_CL2GC_ViewPlayersProfileRequest:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Databases a message's handler needs (DBHealth masks); 0 = none
+static uint32_t MessageDatabases(uint32_t type) {
+  switch (type) {
+  case k_EMsgGC_CC_GCWelcome:
+  case k_EMsgGC_CC_CL2GC_BuildMatchmakingHelloRequest:
+  case k_EMsgGC_CC_CL2GC_ViewPlayersProfileRequest:
+    return DBHealth::DB_CLASSIC | DBHealth::DB_INVENTORY | DBHealth::DB_RANKED;
+  case k_EMsgGC_CC_GCConfirmAuth:
+  case k_EMsgGC_CC_GCHeartbeat:
+    return 0;
+  default:
+    // SOCache, every inventory action, commends and reports
+    return DBHealth::DB_INVENTORY;
+  }
+}
+
+/**
+ * Answers a message that was turned away because a database it needs is
+ * unavailable. Only messages with a result code can say "try again"; for
+ * the rest nothing is sent and the client re-requests as it does after a
+ * lost reply.
+ */
+static void SendTryAgain(SNetSocket_t p2psocket, uint32_t type,
+                         const std::vector<uint8_t> &buffer) {
+  NetworkMessage netMsg(buffer.data(), static_cast<uint32_t>(buffer.size()));
+  switch (type) {
+  case k_EMsgGC_CC_CL2GC_Craft: {
+    CMsgGC_CC_CL2GC_Craft request;
+    if (netMsg.ParseTo(&request)) {
+      CMsgGC_CC_GC2CL_CraftResponse response;
+      response.set_response_index(request.recipe_defindex());
+      response.set_response_code(k_EGCMsgResponseTimeout);
+      NetworkMessage::FromProto(response, k_EMsgGC_CC_GC2CL_CraftResponse)
+          .WriteToSocket(p2psocket, true);
+    }
+    break;
+  }
+  case k_EMsgGC_CC_CL2GC_ClientReportPlayer: {
+    CMsgGC_CC_CL2GC_ClientReportPlayer request;
+    if (netMsg.ParseTo(&request)) {
+      CMsgGC_CC_GC2CL_ClientReportResponse response;
+      response.set_account_id(request.account_id());
+      response.set_response_type(0);   // Error
+      response.set_response_result(1); // General error
+      NetworkMessage::FromProto(response,
+                                k_EMsgGC_CC_GC2CL_ClientReportResponse)
+          .WriteToSocket(p2psocket, true);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
 void GCNetwork::Update() {
   // Time-based periodic updates
   // cleanup sessions every 60 seconds
@@ -463,6 +721,22 @@ void GCNetwork::Update() {
           .count() >= 60) {
     CleanupSessions();
 
+    auto &txnStats = GetSQLTransactionStats();
+    if (txnStats.units > 0) {
+      logger::info("SQL transactions: %llu units, %llu retries, %llu "
+                   "deadlocks, %llu lock wait timeouts, %llu exhausted",
+                   (unsigned long long)txnStats.units.load(),
+                   (unsigned long long)txnStats.retries.load(),
+                   (unsigned long long)txnStats.deadlocks.load(),
+                   (unsigned long long)txnStats.lockWaitTimeouts.load(),
+                   (unsigned long long)txnStats.exhausted.load());
+    }
+
+    auto &inventoryCache = InventoryCache::GetInstance();
+    logger::info("Inventory cache: %zu accounts, %zu KB",
+                 inventoryCache.Accounts(),
+                 inventoryCache.MemoryBytes() / 1024);
+
     // Enforce Tunable Cache Size (Session Limit)
     // Heuristic: 1MB per session (roughly)
     int maxSessions = TunablesManager::GetInstance().GetCacheSizeMB();
@@ -490,6 +764,7 @@ void GCNetwork::Update() {
           SteamGameServerNetworking()->DestroySocket(socket, true);
         }
         m_activeSessions.erase(oldestIt);
+        InventoryCache::GetInstance().Invalidate(steamId & 0xFFFFFFFF);
         logger::info("Evicted session %llu (Cache Limit: %d MB)", steamId,
                      maxSessions);
       } else {
@@ -502,12 +777,25 @@ void GCNetwork::Update() {
 
   // check for new items every 5 seconds
   static auto lastItemCheck = std::chrono::steady_clock::now();
+  bool inventoryAvailable =
+      DBHealth::GetInstance().Available(DBHealth::DB_INVENTORY);
   if (std::chrono::duration_cast<std::chrono::seconds>(now - lastItemCheck)
           .count() >= 5) {
-    CheckNewItemsForActiveSessions();
+    if (inventoryAvailable) {
+      CheckNewItemsForActiveSessions();
+    }
     lastItemCheck = now;
   }
 
+  // Flush queued inventory writes (write_behind_flush_ms); they stay queued
+  // and journaled while the inventory database is unavailable
+  if (inventoryAvailable) {
+    InventoryWriteQueue::GetInstance().Update(m_mysql2);
+  }
+
+  // Pick up item schema changes (parsed off-thread, swapped in atomically)
+  ItemSchemaStore::GetInstance().Update();
+
   // Update WebAPI
   WebAPIClient::GetInstance().Update();
 
@@ -559,6 +847,26 @@ void GCNetwork::Update() {
     logger::info("Received message - Raw: %08X, Unmasked: %u (0x%X)", raw_type,
                  real_type, real_type);
 
+    // Fail fast instead of stalling the loop on a database that is down
+    uint32_t databases = MessageDatabases(real_type);
+    if (databases != 0 && !DBHealth::GetInstance().Available(databases)) {
+      logger::warning("Message %u rejected: database unavailable", real_type);
+      SendTryAgain(p2psocket, real_type, buffer);
+      continue;
+    }
+
+    // Anything but a pure read may write this player's rows; pin their
+    // reads to the primary until replicas have caught up
+    if (!IsReadOnlyMessage(real_type)) {
+      NoteWrite(GetSessionSteamId(p2psocket));
+    }
+
+    // Every statement the handler issues shares this message's budget
+    RequestDeadline deadline(std::chrono::milliseconds(
+        TunablesManager::GetInstance().GetInt("request_deadline_ms", 3000)));
+    // Per-message protobuf arena, reset when the handler returns
+    RequestArena::Scope arenaScope;
+
     switch (real_type) {
     case k_EMsgGC_CC_GCWelcome:
       logger::info("Received GCWelcome");
@@ -592,9 +900,36 @@ void GCNetwork::Update() {
         NetworkMessage netMsg(buffer.data(), msgsize);
         CMsgGC_CC_CL2GC_SOCacheSubscribedRequest request;
         if (netMsg.ParseTo(&request)) {
-          GCNetwork_Inventory::SendSOCache(p2psocket, request.steam_id(),
-                                           m_mysql2);
+          auto readConn = HasConnectionPools()
+                              ? GetInventoryReadConnection(request.steam_id(),
+                                                           50)
+                              : DBConnectionPool::Connection(nullptr, nullptr);
+          SetSessionSOCacheVersion(
+              request.steam_id(),
+              GCNetwork_Inventory::SendSOCache(p2psocket, request.steam_id(),
+                                               m_mysql2, readConn.get()));
+        }
+      }
+      break;
+
+    case k_ESOMsg_CacheSubscriptionRefresh:
+      logger::info("Received CacheSubscriptionRefresh");
+      {
+        // The owner is always the session's player; the message carries
+        // nothing else
+        uint64_t steamId = GetSessionSteamId(p2psocket);
+        if (steamId == 0) {
+          logger::error(
+              "CacheSubscriptionRefresh: No valid session for this socket");
+          break;
         }
+        auto readConn = HasConnectionPools()
+                            ? GetInventoryReadConnection(steamId, 50)
+                            : DBConnectionPool::Connection(nullptr, nullptr);
+        SetSessionSOCacheVersion(
+            steamId, GCNetwork_Inventory::HandleSubscriptionRefresh(
+                         p2psocket, steamId, GetSessionSOCacheVersion(steamId),
+                         m_mysql2, readConn.get()));
       }
       break;
 
@@ -27,10 +27,14 @@ public:
   time_t lastActivity;
   uint64_t lastCheckedItemId;
   bool itemIdInitialized;
+  // SOCache version last sent in full or as a refresh; the client has at
+  // least this one (0 = nothing sent yet)
+  uint64_t soCacheVersion;
 
   ClientSessions(CSteamID id)
       : steamID(id), isAuthenticated(false), lastCheckedItemId(0),
-        itemIdInitialized(false), socket(k_HSteamNetConnection_Invalid) {
+        itemIdInitialized(false), soCacheVersion(0),
+        socket(k_HSteamNetConnection_Invalid) {
     time(&lastActivity);
   }
 
@@ -50,6 +54,7 @@ private:
   std::unordered_map<SNetSocket_t, uint64_t>
       m_socketToSteamId; // O(1) reverse lookup
   uint64_t GetSessionSteamId(SNetSocket_t socket);
+  uint64_t GetSessionSOCacheVersion(uint64_t steamId);
 
   // Database connection pools (#6 fix)
   std::shared_ptr<DBConnectionPool> m_classicPool;   // classiccounter
@@ -81,21 +86,49 @@ public:
 
   // db methods
   bool InitDatabases();
+  void InitDBHealth();
+  void InitReplicas();
   bool ExecuteQuery(MYSQL *connection, const char *query);
   void CloseDatabases();
 
   // Connection pool accessors (new API)
-  DBConnectionPool::Connection GetClassicConnection() {
-    return m_classicPool->getConnection();
+  bool HasConnectionPools() const {
+    return m_classicPool && m_inventoryPool && m_rankedPool;
   }
-  DBConnectionPool::Connection GetInventoryConnection() {
-    return m_inventoryPool->getConnection();
+  DBConnectionPool::Connection GetClassicConnection(uint32_t timeoutMs = 5000) {
+    return m_classicPool->getConnection(timeoutMs);
   }
-  DBConnectionPool::Connection GetRankedConnection() {
-    return m_rankedPool->getConnection();
+  DBConnectionPool::Connection
+  GetInventoryConnection(uint32_t timeoutMs = 5000) {
+    return m_inventoryPool->getConnection(timeoutMs);
   }
+  DBConnectionPool::Connection GetRankedConnection(uint32_t timeoutMs = 5000) {
+    return m_rankedPool->getConnection(timeoutMs);
+  }
+
+  // Read-only connections for data owned by steamId; replicas when
+  // configured (db_replicas), the primary right after that player wrote
+  DBConnectionPool::Connection GetClassicReadConnection(uint64_t steamId,
+                                                        uint32_t timeoutMs) {
+    return m_classicPool->getReadConnection(steamId & 0xFFFFFFFF, timeoutMs);
+  }
+  DBConnectionPool::Connection GetInventoryReadConnection(uint64_t steamId,
+                                                          uint32_t timeoutMs) {
+    return m_inventoryPool->getReadConnection(steamId & 0xFFFFFFFF,
+                                              timeoutMs);
+  }
+  DBConnectionPool::Connection GetRankedReadConnection(uint64_t steamId,
+                                                       uint32_t timeoutMs) {
+    return m_rankedPool->getReadConnection(steamId & 0xFFFFFFFF, timeoutMs);
+  }
+  // Call for every account whose rows a write changed, before dropping its
+  // cached data: reloads within the stickiness window then come from the
+  // primary, so the caches never keep a replica read older than the write
+  void NoteWrite(uint64_t steamId);
 
   // client sessions
+  // The SOCache version last sent to the player's session (0 = none)
+  void SetSessionSOCacheVersion(uint64_t steamId, uint64_t version);
   void CleanupSessions();
   void CheckNewItemsForActiveSessions();
 
@@ -5,154 +5,102 @@
 #include "econ_gcmessages.pb.h"
 #include "gc_const_csgo.hpp"
 #include "gcsystemmsgs.pb.h"
+#include "inventory_cache.hpp"
+#include "inventory_versions.hpp"
+#include "inventory_write_queue.hpp"
+#include "item_schema_store.hpp"
 #include "keyvalue_english.hpp"
 #include "logger.hpp"
 #include "networking_users.hpp"
 #include "prepared_stmt.hpp"
+#include "request_arena.hpp"
 #include "safe_parse.hpp"
 #include "tunables_manager.hpp"
+#include <algorithm>
 #include <cctype>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <google/protobuf/io/coded_stream.h>
 #include <memory>
 #include <regex>
 #include <sstream>
 #include <string>
-
-// Global ItemSchema - now RAII managed with unique_ptr (#3 fix)
-std::unique_ptr<ItemSchema> g_itemSchema;
+#include <unordered_map>
 
 bool GCNetwork_Inventory::Init() {
-  if (g_itemSchema != nullptr) {
+  auto &schemaStore = ItemSchemaStore::GetInstance();
+  if (schemaStore.Get() != nullptr) {
     return true;
   }
 
   // note: localization initializes on first use through
   // LocalizationSystem::GetInstance()
 
-  // init ItemSchema - using make_unique for exception safety
-  g_itemSchema = std::make_unique<ItemSchema>();
-  if (g_itemSchema) {
+  // init ItemSchema; later changes are reloaded by ItemSchemaStore::Update
+  if (!schemaStore.Load()) {
+    logger::warning("GCNetwork_Inventory::Init: ItemSchema initialized "
+                    "without items_game.txt");
+  } else {
     logger::info(
         "GCNetwork_Inventory::Init: ItemSchema initialized successfully");
-
-    // Verify that localization system is working
-    std::string_view testString = LocalizeToken("SFUI_WPNHUD_SSG08", "Scout");
-    logger::info(
-        "GCNetwork_Inventory::Init: Localization test - SSG08 resolves to '%s'",
-        std::string{testString}.c_str());
-    return true;
-  } else {
-    logger::error(
-        "GCNetwork_Inventory::Init: Failed to create ItemSchema instance");
-    return false;
   }
+
+  // Verify that localization system is working
+  std::string_view testString = LocalizeToken("SFUI_WPNHUD_SSG08", "Scout");
+  logger::info(
+      "GCNetwork_Inventory::Init: Localization test - SSG08 resolves to '%s'",
+      std::string{testString}.c_str());
+  return true;
 }
 
 void GCNetwork_Inventory::Cleanup() {
-  // unique_ptr handles deletion automatically, but we can still reset
-  // explicitly
-  g_itemSchema.reset();
+  // the schema snapshot is owned by ItemSchemaStore (and whoever still holds
+  // it), nothing to release here
 }
 
 /**
  * Parses an item ID string to extract definition index and paint index
  *
- * @param item_id String representation of the item ID (e.g. "skin_123_456")
+ * @param item_id String representation of the item ID (e.g. "skin-7_44_0"),
+ * see DecodeItemId
  * @param def_index Output parameter for the definition index
  * @param paint_index Output parameter for the paint index
  * @return True if parsing was successful, false otherwise
  */
-bool GCNetwork_Inventory::ParseItemId(const std::string &item_id,
+bool GCNetwork_Inventory::ParseItemId(std::string_view item_id,
                                       uint32_t &def_index,
                                       uint32_t &paint_index) {
-  try {
-    size_t dash_pos = item_id.find('-');
-    if (dash_pos != std::string::npos) {
-      std::string type = item_id.substr(0, dash_pos);
-      std::string number_part = item_id.substr(dash_pos + 1);
-      uint32_t item_number = std::stoi(number_part);
-
-      if (type == "music_kit") {
-        def_index = 1314;
-        paint_index = item_number; // just reusing paint_index cause uhhh yes
-        return true;
-      } else if (type == "sticker") {
-        def_index = 1209;
-        paint_index = item_number;
-        return true;
-      } else if (type == "crate") {
-        def_index = item_number;
-        paint_index = 0;
-        return true;
-      } else if (type == "key") {
-        def_index = item_number;
-        paint_index = 0;
-        return true;
-      } else if (type == "collectible") {
-        def_index = item_number;
-        paint_index = 0;
-        return true;
-      }
-    }
-
-    // weapon skins:
-    size_t first_underscore = item_id.find('_');
-    size_t second_underscore = item_id.find('_', first_underscore + 1);
-    if (first_underscore == std::string::npos ||
-        second_underscore == std::string::npos) {
-      logger::error("ParseItemId: Failed to find required underscores");
-      return false;
-    }
-
-    std::string def_index_str = item_id.substr(5, first_underscore - 5);
-    std::string paint_index_str = item_id.substr(
-        first_underscore + 1, second_underscore - first_underscore - 1);
-    def_index = std::stoi(def_index_str);
-    paint_index = std::stoi(paint_index_str);
-
-    // logger::info("ParseItemId: parsed item def_index: %u, paint_index: %u",
-    // def_index, paint_index);
-    return true;
-  } catch (const std::exception &e) {
-    logger::error("ParseItemId: Exception caught: %s", e.what());
-    return false;
-  } catch (...) {
-    logger::error("ParseItemId: Unknown exception caught");
+  DecodedItemId decoded = DecodeItemId(item_id);
+  if (!decoded) {
+    logger::error("ParseItemId: Failed to parse item_id: %.*s",
+                  static_cast<int>(item_id.size()), item_id.data());
     return false;
   }
+
+  def_index = decoded.defIndex;
+  paint_index = decoded.paintIndex;
+  return true;
 }
 
 /**
  * Adds sticker attributes to an item based on database values
  *
  * @param item Pointer to the CSOEconItem to modify
- * @param row MySQL row containing sticker data
+ * @param row Typed csgo_items row containing sticker data
  * @param sticker_index Index of the sticker position (0-4)
  */
 void GCNetwork_Inventory::AddStickerAttributes(CSOEconItem *item,
-                                               MYSQL_ROW &row,
+                                               const CsgoItemRow &row,
                                                int sticker_index) {
-  int sticker_col = 8 + (sticker_index * 2);
-  int sticker_wear_col = sticker_col + 1;
-
-  auto stickerVal = SafeParse::toInt(row[sticker_col]);
-  if (row[sticker_col] && stickerVal.value_or(0) > 0) {
+  auto [stickerId, stickerWear] = row.sticker(sticker_index);
+  if (stickerId > 0) {
     uint32_t sticker_id_attr = 113 + (sticker_index * 4);
     uint32_t sticker_wear_attr = sticker_id_attr + 1;
 
-    // sticker_id
-    AddUint32Attribute(item, sticker_id_attr, stickerVal.value());
-
-    // sticker_wear
-    if (row[sticker_wear_col] && strlen(row[sticker_wear_col]) > 0) {
-      AddFloatAttribute(item, sticker_wear_attr,
-                        std::stof(row[sticker_wear_col]));
-    } else {
-      AddFloatAttribute(item, sticker_wear_attr, 0.0f);
-    }
+    AddUint32Attribute(item, sticker_id_attr, stickerId);
+    AddFloatAttribute(item, sticker_wear_attr, stickerWear);
   }
 }
 
@@ -181,209 +129,166 @@ void GCNetwork_Inventory::AddEquippedState(CSOEconItem *item, bool equipped,
  * @return The slot ID where this item should be equipped
  */
 uint32_t GCNetwork_Inventory::GetItemSlot(uint32_t defIndex) {
-  if (defIndex >= 500 && defIndex <= 552)
-    return 0; // Custom Knives
-  if (defIndex == 42 || defIndex == 59)
-    return 0; // Default knives
-
-  if (defIndex == 49)
-    return 1; // C4
-
-  // Pistols
-  if (defIndex == 4 || defIndex == 32 || defIndex == 61)
-    return 2; // Glock / P2000 / USP-S
-  if (defIndex == 2)
-    return 3; // Dual Berettas
-  if (defIndex == 36)
-    return 4; // P250
-  if (defIndex == 3 || defIndex == 30 || defIndex == 63)
-    return 5; // Five-SeveN / Tec-9 / CZ75
-  if (defIndex == 1 || defIndex == 64)
-    return 6; // Deagle / R8
-
-  // SMGs
-  if (defIndex == 34 || defIndex == 17)
-    return 8; // MP9 / MAC-10
-  if (defIndex == 33 || defIndex == 23)
-    return 9; // MP7 / MP5-SD
-  if (defIndex == 24)
-    return 10; // UMP-45
-  if (defIndex == 19)
-    return 11; // P90
-  if (defIndex == 26)
-    return 12; // PP-Bizon
-
-  // Rifles
-  if (defIndex == 10 || defIndex == 13)
-    return 14; // FAMAS / Galil AR
-  if (defIndex == 7 || defIndex == 16 || defIndex == 60)
-    return 15; // AK-47 / M4A4 / M4A1-S
-  if (defIndex == 40)
-    return 16; // SSG 08 (Scout)
-  if (defIndex == 39 || defIndex == 8)
-    return 17; // SG 553 / AUG
-  if (defIndex == 9)
-    return 18; // AWP
-  if (defIndex == 11 || defIndex == 38)
-    return 19; // G3SG1 / SCAR-20
-
-  // Heavy
-  if (defIndex == 35)
-    return 20; // Nova
-  if (defIndex == 25)
-    return 21; // XM1014
-  if (defIndex == 29 || defIndex == 27)
-    return 22; // Sawed-Off / MAG-7
-  if (defIndex == 14)
-    return 23; // M249
-  if (defIndex == 28)
-    return 24; // Negev
-
-  // no gloves cuz its classiccounter
-
-  if (defIndex == 1314)
-    return 54; // Music kits
-
-  return 55; // probably a collectible
+  return ItemTables::ItemSlot(defIndex);
 }
 
 /**
- * Returns a vector of defindexes that correspond to the given item slot
+ * Returns the defindexes that correspond to the given item slot
  * This is the reverse of GetItemSlot
  *
  * @param slotId The slot ID to look up
- * @return Vector of definition indexes that would be equipped in this slot
+ * @return Definition indexes that would be equipped in this slot (static
+ *         storage, empty for unknown slots)
  */
-std::vector<uint32_t>
+std::span<const uint32_t>
 GCNetwork_Inventory::GetDefindexFromItemSlot(uint32_t slotId) {
-  std::vector<uint32_t> result;
-
-  switch (slotId) {
-  case 0: // Knives
-    // Default knives
-    result.push_back(42); // Default CT Knife
-    result.push_back(59); // Default T Knife
+  return ItemTables::SlotMembers(slotId);
+}
 
-    // Custom knives (500-552)
-    for (uint32_t i = 500; i <= 552; i++) {
-      result.push_back(i);
-    }
-    break;
-
-  case 1: // C4
-    result.push_back(49);
-    break;
-
-  case 2:                 // Glock / P2000 / USP-S
-    result.push_back(4);  // Glock-18
-    result.push_back(32); // P2000
-    result.push_back(61); // USP-S
-    break;
-
-  case 3: // Dual Berettas
-    result.push_back(2);
-    break;
-
-  case 4: // P250
-    result.push_back(36);
-    break;
-
-  case 5:                 // Five-SeveN / Tec-9 / CZ75
-    result.push_back(3);  // Five-SeveN
-    result.push_back(30); // Tec-9
-    result.push_back(63); // CZ75-Auto
-    break;
-
-  case 6:                 // Deagle / R8
-    result.push_back(1);  // Desert Eagle
-    result.push_back(64); // R8 Revolver
-    break;
-
-  case 8:                 // MP9 / MAC-10
-    result.push_back(34); // MP9
-    result.push_back(17); // MAC-10
-    break;
-
-  case 9:                 // MP7 / MP5-SD
-    result.push_back(33); // MP7
-    result.push_back(23); // MP5-SD
-    break;
-
-  case 10: // UMP-45
-    result.push_back(24);
-    break;
-
-  case 11: // P90
-    result.push_back(19);
-    break;
-
-  case 12: // PP-Bizon
-    result.push_back(26);
-    break;
-
-  case 14:                // FAMAS / Galil AR
-    result.push_back(10); // FAMAS
-    result.push_back(13); // Galil AR
-    break;
-
-  case 15:                // AK-47 / M4A4 / M4A1-S
-    result.push_back(7);  // AK-47
-    result.push_back(16); // M4A4
-    result.push_back(60); // M4A1-S
-    break;
-
-  case 16: // SSG 08 (Scout)
-    result.push_back(40);
-    break;
-
-  case 17:                // SG 553 / AUG
-    result.push_back(39); // SG 553
-    result.push_back(8);  // AUG
-    break;
-
-  case 18: // AWP
-    result.push_back(9);
-    break;
-
-  case 19:                // G3SG1 / SCAR-20
-    result.push_back(11); // G3SG1
-    result.push_back(38); // SCAR-20
-    break;
-
-  case 20: // Nova
-    result.push_back(35);
-    break;
-
-  case 21: // XM1014
-    result.push_back(25);
-    break;
-
-  case 22:                // Sawed-Off / MAG-7
-    result.push_back(29); // Sawed-Off
-    result.push_back(27); // MAG-7
-    break;
-
-  case 23: // M249
-    result.push_back(14);
-    break;
-
-  case 24: // Negev
-    result.push_back(28);
-    break;
-
-  case 54: // Music kits
-    result.push_back(1314);
-    break;
-
-  case 55: // Collectibles (Generic catch-all)
-    // bruh
-    for (uint32_t i = 1000; i <= 5000; i++) {
-      result.push_back(i);
+// Serializes rows for the inventory cache's per-item bytes; the serializer
+// lives on the request arena, so only use it inside a RequestArena::Scope
+InventoryCache::ItemSerializer
+GCNetwork_Inventory::MakeItemSerializer(uint64_t steamId) {
+  // One message reused for every row: Clear() keeps the attribute elements
+  // and their strings, so rows after the first allocate nothing
+  CSOEconItem *scratch = RequestArena::Create<CSOEconItem>();
+  return [steamId, scratch](const CsgoItemRow &row, std::string &out) {
+    try {
+      scratch->Clear();
+      return BuildItemFromDatabaseRow(scratch, steamId, row) &&
+             scratch->SerializeToString(&out);
+    } catch (const std::exception &e) {
+      logger::error("SendSOCache: Exception while processing item: %s",
+                    e.what());
+      return false;
     }
-    break;
+  };
+}
+
+/**
+ * Tells a reconnecting client the current SOCache version. A client whose
+ * cached copy has another version answers with a CacheSubscriptionRefresh
+ * (HandleSubscriptionRefresh); an up to date one doesn't answer at all.
+ *
+ * @param p2psocket The socket to send the check on
+ * @param steamId The steam ID of the session
+ * @return True if the message was sent
+ */
+bool GCNetwork_Inventory::SendSubscriptionCheck(SNetSocket_t p2psocket,
+                                                uint64_t steamId) {
+  CMsgSOCacheSubscriptionCheck check;
+  check.set_version(
+      InventoryVersions::GetInstance().Current(steamId & 0xFFFFFFFF));
+  check.mutable_owner_soid()->set_type(SoIdTypeSteamId);
+  check.mutable_owner_soid()->set_id(steamId);
+
+  NetworkMessage message = NetworkMessage::FromProto(
+      check, k_ESOMsg_CacheSubscriptionCheck | ProtobufMask);
+  if (!message.WriteToSocket(p2psocket, true)) {
+    logger::error("SendSubscriptionCheck: Failed to send check to %llu",
+                  steamId);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Answers a CacheSubscriptionRefresh. Clients the change log still covers
+ * get the items changed since knownVersion in one CMsgSOMultipleObjects,
+ * everyone else the full SOCache.
+ *
+ * @param p2psocket The socket to answer on
+ * @param steamId The steam ID of the session
+ * @param knownVersion The last version sent to the session in full or as a
+ * refresh; the client has at least that one (0 if none)
+ * @param inventory_db Database connection for the full SOCache fallback
+ * @param read_db Replica for item reads, may be null
+ * @return The version sent, 0 if nothing was
+ */
+uint64_t GCNetwork_Inventory::HandleSubscriptionRefresh(SNetSocket_t p2psocket,
+                                                        uint64_t steamId,
+                                                        uint64_t knownVersion,
+                                                        MYSQL *inventory_db,
+                                                        MYSQL *read_db) {
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  RequestArena::Scope arenaScope;
+  auto serializeItem = MakeItemSerializer(steamId);
+
+  // Version first, as in SendSOCache
+  CMsgSOMultipleObjects update;
+  InitMultipleObjectsMessage(update, steamId);
+
+  // An empty delta means the client is out of date in a way the log doesn't
+  // describe, so it gets a snapshot as well
+  auto delta = knownVersion != 0
+                   ? InventoryVersions::GetInstance().Since(accountId,
+                                                            knownVersion)
+                   : std::nullopt;
+  if (!delta || (delta->added.empty() && delta->modified.empty() &&
+                 delta->removed.empty())) {
+    logger::info("HandleSubscriptionRefresh: Version %llu of %llu not in "
+                 "the change log, sending full SOCache",
+                 knownVersion, steamId);
+    return SendSOCache(p2psocket, steamId, inventory_db, read_db);
+  }
+
+  auto addItems = [&](const std::vector<uint64_t> &itemIds, bool added) {
+    return InventoryCache::GetInstance().ReadSerializedItems(
+        read_db ? read_db : inventory_db, accountId, serializeItem, itemIds,
+        [&](uint64_t itemId, const std::string *blob) {
+          CMsgSOMultipleObjects::SingleObject *single;
+          if (!blob) {
+            // Gone again since the change was logged
+            CSOEconItem removed;
+            removed.set_id(itemId);
+            single = update.add_objects_removed();
+            single->set_object_data(removed.SerializeAsString());
+          } else {
+            single = added ? update.add_objects_added()
+                           : update.add_objects_modified();
+            single->set_object_data(*blob);
+          }
+          single->set_type_id(SOTypeItem);
+        });
+  };
+
+  if (!addItems(delta->added, true) || !addItems(delta->modified, false)) {
+    logger::error("HandleSubscriptionRefresh: Failed to load inventory for "
+                  "%llu, sending full SOCache",
+                  steamId);
+    return SendSOCache(p2psocket, steamId, inventory_db, read_db);
   }
 
-  return result;
+  for (uint64_t itemId : delta->removed) {
+    CSOEconItem removed;
+    removed.set_id(itemId);
+    AddToMultipleObjectsMessage(update, SOTypeItem, removed, "removed");
+  }
+
+  logger::info("HandleSubscriptionRefresh: %llu is %zu changes behind",
+               steamId,
+               delta->added.size() + delta->modified.size() +
+                   delta->removed.size());
+  return SendSOMultipleObjects(p2psocket, update) ? update.version() : 0;
+}
+
+/**
+ * Drops what the GC holds for the account and sends the full SOCache again,
+ * for writes that committed without telling us what they did
+ *
+ * @param p2psocket The socket to send the cache to
+ * @param steamId The steam ID of the player
+ * @param inventory_db Database connection to fetch inventory data
+ */
+void GCNetwork_Inventory::ResendSOCache(SNetSocket_t p2psocket,
+                                        uint64_t steamId,
+                                        MYSQL *inventory_db) {
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  GCNetwork::GetInstance()->NoteWrite(steamId);
+  InventoryCache::GetInstance().Invalidate(accountId);
+  InventoryVersions::GetInstance().Truncate(accountId);
+  GCNetwork::GetInstance()->SetSessionSOCacheVersion(
+      steamId, SendSOCache(p2psocket, steamId, inventory_db));
 }
 
 /**
@@ -394,309 +299,21 @@ GCNetwork_Inventory::GetDefindexFromItemSlot(uint32_t slotId) {
  * @param p2psocket The socket to send the cache to
  * @param steamId The steam ID of the player
  * @param inventory_db Database connection to fetch inventory data
+ * @return The version sent, 0 if the cache wasn't sent
  */
-void GCNetwork_Inventory::SendSOCache(SNetSocket_t p2psocket, uint64_t steamId,
-                                      MYSQL *inventory_db) {
+uint64_t GCNetwork_Inventory::SendSOCache(SNetSocket_t p2psocket,
+                                          uint64_t steamId,
+                                          MYSQL *inventory_db,
+                                          MYSQL *read_db) {
+  RequestArena::Scope arenaScope;
   CMsgSOCacheSubscribed cacheMsg;
 
-  cacheMsg.set_version(InventoryVersion);
+  // Read first, so no change recorded after it can be missing from the rows
+  cacheMsg.set_version(
+      InventoryVersions::GetInstance().Current(steamId & 0xFFFFFFFF));
   cacheMsg.mutable_owner_soid()->set_type(SoIdTypeSteamId);
   cacheMsg.mutable_owner_soid()->set_id(steamId);
 
-  // CSOEconItem
-  {
-    CMsgSOCacheSubscribed_SubscribedType *object = cacheMsg.add_objects();
-    object->set_type_id(SOTypeItem);
-
-    // everyone gets a nametag
-    {
-      auto nametag = CSOEconItem();
-      nametag.set_id(1);
-      nametag.set_account_id(steamId & 0xFFFFFFFF);
-      nametag.set_def_index(1200);
-      nametag.set_inventory(1);
-      nametag.set_level(1);
-      nametag.set_quality(0);
-      nametag.set_flags(0);
-      nametag.set_origin(kEconItemOrigin_Purchased);
-      nametag.set_rarity(1);
-
-      object->add_object_data(nametag.SerializeAsString());
-    }
-
-    // Inject Operation Coin if enabled
-    if (TunablesManager::GetInstance().IsOperationActive()) {
-      auto coin = CSOEconItem();
-      // Use a unique ID high enough to avoid collision with real items
-      // We can use steamId + constant to make it deterministic per user
-      uint64_t spoofId =
-          0xF000000000000000ULL | (steamId & 0x0FFFFFFFFFFFFFFFULL);
-
-      coin.set_id(spoofId);
-      coin.set_account_id(steamId & 0xFFFFFFFF);
-      // coin.set_def_index(4354); // Wildfire
-      coin.set_def_index(1021); // Operation Bravo Coin (Reliable fallback)
-      coin.set_inventory(4000); // High slot to avoid collision with real items
-      coin.set_level(1);
-      coin.set_quality(4);
-      coin.set_flags(0);
-      coin.set_origin(kEconItemOrigin_Purchased);
-      coin.set_rarity(1);
-
-      // Attribute 80 (Killeater Score) triggers the journal/stats?
-      // Not strictly necessary for the coin itself to appear.
-
-      object->add_object_data(coin.SerializeAsString());
-    }
-
-    // SQL injection safe: using prepared statement to fetch item IDs first
-    // and then re-querying or just doing it all in one if we can.
-    // However, to keep CreateItemFromDatabaseRow working without a massive
-    // refactor, we use the parameterized query for security.
-    std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
-    auto stmtOpt = createPreparedStatement(
-        inventory_db,
-        "SELECT id, item_id, floatval, rarity, quality, tradable, "
-        "stattrak, stattrak_kills, "
-        "sticker_1, sticker_1_wear, sticker_2, sticker_2_wear, "
-        "sticker_3, sticker_3_wear, sticker_4, sticker_4_wear, "
-        "sticker_5, sticker_5_wear, nametag, pattern_index, "
-        "equipped_ct, equipped_t, acknowledged, acquired_by "
-        "FROM csgo_items "
-        "WHERE owner_steamid2 = ?");
-
-    if (!stmtOpt) {
-      logger::error("SendSOCache: Failed to prepare statement");
-      return;
-    }
-
-    auto &stmt = *stmtOpt;
-    unsigned long steamIdLen = steamId2.length();
-    stmt.bindString(0, steamId2.c_str(), &steamIdLen);
-
-    if (!stmt.execute()) {
-      logger::error("SendSOCache: MySQL query failed: %s", stmt.error());
-      return;
-    }
-
-    // Use the validated steamId2 to populate the cache.
-    // This avoids a massive refactor of CreateItemFromDatabaseRow.
-
-    MYSQL_STMT *stmtHandle = stmt.handle();
-    mysql_stmt_store_result(stmtHandle);
-
-    // Bind results for all 24 columns
-    MYSQL_BIND binds[24];
-    memset(binds, 0, sizeof(binds));
-
-    char id_buf[21], item_id_buf[256], floatval_buf[32], rarity_buf[11],
-        quality_buf[11], tradable_buf[2], stattrak_buf[2],
-        stattrak_kills_buf[11];
-    char sticker_1_buf[11], sticker_1_wear_buf[32], sticker_2_buf[11],
-        sticker_2_wear_buf[32], sticker_3_buf[11], sticker_3_wear_buf[32];
-    char sticker_4_buf[11], sticker_4_wear_buf[32], sticker_5_buf[11],
-        sticker_5_wear_buf[32], nametag_buf[129], pattern_index_buf[11];
-    char equipped_ct_buf[2], equipped_t_buf[2], acknowledged_buf[11],
-        acquired_by_buf[32];
-
-    unsigned long id_len, item_id_len, floatval_len, rarity_len, quality_len,
-        tradable_len, stattrak_len, stattrak_kills_len;
-    unsigned long sticker_1_len, sticker_1_wear_len, sticker_2_len,
-        sticker_2_wear_len, sticker_3_len, sticker_3_wear_len;
-    unsigned long sticker_4_len, sticker_4_wear_len, sticker_5_len,
-        sticker_5_wear_len, nametag_len, pattern_index_len;
-    unsigned long equipped_ct_len, equipped_t_len, acknowledged_len,
-        acquired_by_len;
-
-    my_bool id_is_null, item_id_is_null, floatval_is_null, rarity_is_null,
-        quality_is_null, tradable_is_null, stattrak_is_null,
-        stattrak_kills_is_null;
-    my_bool sticker_1_is_null, sticker_1_wear_is_null, sticker_2_is_null,
-        sticker_2_wear_is_null, sticker_3_is_null, sticker_3_wear_is_null;
-    my_bool sticker_4_is_null, sticker_4_wear_is_null, sticker_5_is_null,
-        sticker_5_wear_is_null, nametag_is_null, pattern_index_is_null;
-    my_bool equipped_ct_is_null, equipped_t_is_null, acknowledged_is_null,
-        acquired_by_is_null;
-
-    binds[0].buffer_type = MYSQL_TYPE_STRING;
-    binds[0].buffer = id_buf;
-    binds[0].buffer_length = sizeof(id_buf);
-    binds[0].length = &id_len;
-    binds[0].is_null = &id_is_null;
-    binds[1].buffer_type = MYSQL_TYPE_STRING;
-    binds[1].buffer = item_id_buf;
-    binds[1].buffer_length = sizeof(item_id_buf);
-    binds[1].length = &item_id_len;
-    binds[1].is_null = &item_id_is_null;
-    binds[2].buffer_type = MYSQL_TYPE_STRING;
-    binds[2].buffer = floatval_buf;
-    binds[2].buffer_length = sizeof(floatval_buf);
-    binds[2].length = &floatval_len;
-    binds[2].is_null = &floatval_is_null;
-    binds[3].buffer_type = MYSQL_TYPE_STRING;
-    binds[3].buffer = rarity_buf;
-    binds[3].buffer_length = sizeof(rarity_buf);
-    binds[3].length = &rarity_len;
-    binds[3].is_null = &rarity_is_null;
-    binds[4].buffer_type = MYSQL_TYPE_STRING;
-    binds[4].buffer = quality_buf;
-    binds[4].buffer_length = sizeof(quality_buf);
-    binds[4].length = &quality_len;
-    binds[4].is_null = &quality_is_null;
-    binds[5].buffer_type = MYSQL_TYPE_STRING;
-    binds[5].buffer = tradable_buf;
-    binds[5].buffer_length = sizeof(tradable_buf);
-    binds[5].length = &tradable_len;
-    binds[5].is_null = &tradable_is_null;
-    binds[6].buffer_type = MYSQL_TYPE_STRING;
-    binds[6].buffer = stattrak_buf;
-    binds[6].buffer_length = sizeof(stattrak_buf);
-    binds[6].length = &stattrak_len;
-    binds[6].is_null = &stattrak_is_null;
-    binds[7].buffer_type = MYSQL_TYPE_STRING;
-    binds[7].buffer = stattrak_kills_buf;
-    binds[7].buffer_length = sizeof(stattrak_kills_buf);
-    binds[7].length = &stattrak_kills_len;
-    binds[7].is_null = &stattrak_kills_is_null;
-    binds[8].buffer_type = MYSQL_TYPE_STRING;
-    binds[8].buffer = sticker_1_buf;
-    binds[8].buffer_length = sizeof(sticker_1_buf);
-    binds[8].length = &sticker_1_len;
-    binds[8].is_null = &sticker_1_is_null;
-    binds[9].buffer_type = MYSQL_TYPE_STRING;
-    binds[9].buffer = sticker_1_wear_buf;
-    binds[9].buffer_length = sizeof(sticker_1_wear_buf);
-    binds[9].length = &sticker_1_wear_len;
-    binds[9].is_null = &sticker_1_wear_is_null;
-    binds[10].buffer_type = MYSQL_TYPE_STRING;
-    binds[10].buffer = sticker_2_buf;
-    binds[10].buffer_length = sizeof(sticker_2_buf);
-    binds[10].length = &sticker_2_len;
-    binds[10].is_null = &sticker_2_is_null;
-    binds[11].buffer_type = MYSQL_TYPE_STRING;
-    binds[11].buffer = sticker_2_wear_buf;
-    binds[11].buffer_length = sizeof(sticker_2_wear_buf);
-    binds[11].length = &sticker_2_wear_len;
-    binds[11].is_null = &sticker_2_wear_is_null;
-    binds[12].buffer_type = MYSQL_TYPE_STRING;
-    binds[12].buffer = sticker_3_buf;
-    binds[12].buffer_length = sizeof(sticker_3_buf);
-    binds[12].length = &sticker_3_len;
-    binds[12].is_null = &sticker_3_is_null;
-    binds[13].buffer_type = MYSQL_TYPE_STRING;
-    binds[13].buffer = sticker_3_wear_buf;
-    binds[13].buffer_length = sizeof(sticker_3_wear_buf);
-    binds[13].length = &sticker_3_wear_len;
-    binds[13].is_null = &sticker_3_wear_is_null;
-    binds[14].buffer_type = MYSQL_TYPE_STRING;
-    binds[14].buffer = sticker_4_buf;
-    binds[14].buffer_length = sizeof(sticker_4_buf);
-    binds[14].length = &sticker_4_len;
-    binds[14].is_null = &sticker_4_is_null;
-    binds[15].buffer_type = MYSQL_TYPE_STRING;
-    binds[15].buffer = sticker_4_wear_buf;
-    binds[15].buffer_length = sizeof(sticker_4_wear_buf);
-    binds[15].length = &sticker_4_wear_len;
-    binds[15].is_null = &sticker_4_wear_is_null;
-    binds[16].buffer_type = MYSQL_TYPE_STRING;
-    binds[16].buffer = sticker_5_buf;
-    binds[16].buffer_length = sizeof(sticker_5_buf);
-    binds[16].length = &sticker_5_len;
-    binds[16].is_null = &sticker_5_is_null;
-    binds[17].buffer_type = MYSQL_TYPE_STRING;
-    binds[17].buffer = sticker_5_wear_buf;
-    binds[17].buffer_length = sizeof(sticker_5_wear_buf);
-    binds[17].length = &sticker_5_wear_len;
-    binds[17].is_null = &sticker_5_wear_is_null;
-    binds[18].buffer_type = MYSQL_TYPE_STRING;
-    binds[18].buffer = nametag_buf;
-    binds[18].buffer_length = sizeof(nametag_buf);
-    binds[18].length = &nametag_len;
-    binds[18].is_null = &nametag_is_null;
-    binds[19].buffer_type = MYSQL_TYPE_STRING;
-    binds[19].buffer = pattern_index_buf;
-    binds[19].buffer_length = sizeof(pattern_index_buf);
-    binds[19].length = &pattern_index_len;
-    binds[19].is_null = &pattern_index_is_null;
-    binds[20].buffer_type = MYSQL_TYPE_STRING;
-    binds[20].buffer = equipped_ct_buf;
-    binds[20].buffer_length = sizeof(equipped_ct_buf);
-    binds[20].length = &equipped_ct_len;
-    binds[20].is_null = &equipped_ct_is_null;
-    binds[21].buffer_type = MYSQL_TYPE_STRING;
-    binds[21].buffer = equipped_t_buf;
-    binds[21].buffer_length = sizeof(equipped_t_buf);
-    binds[21].length = &equipped_t_len;
-    binds[21].is_null = &equipped_t_is_null;
-    binds[22].buffer_type = MYSQL_TYPE_STRING;
-    binds[22].buffer = acknowledged_buf;
-    binds[22].buffer_length = sizeof(acknowledged_buf);
-    binds[22].length = &acknowledged_len;
-    binds[22].is_null = &acknowledged_is_null;
-    binds[23].buffer_type = MYSQL_TYPE_STRING;
-    binds[23].buffer = acquired_by_buf;
-    binds[23].buffer_length = sizeof(acquired_by_buf);
-    binds[23].length = &acquired_by_len;
-    binds[23].is_null = &acquired_by_is_null;
-
-    if (mysql_stmt_bind_result(stmtHandle, binds)) {
-      logger::error(
-          "SendSOCache: Failed to bind result for prepared statement: %s",
-          mysql_stmt_error(stmtHandle));
-      return;
-    }
-
-    // Simulate MYSQL_ROW for CreateItemFromDatabaseRow
-    const char *row_data[24];
-    my_bool row_is_null[24];
-
-    while (mysql_stmt_fetch(stmtHandle) == 0) {
-      row_data[0] = id_is_null ? nullptr : id_buf;
-      row_data[1] = item_id_is_null ? nullptr : item_id_buf;
-      row_data[2] = floatval_is_null ? nullptr : floatval_buf;
-      row_data[3] = rarity_is_null ? nullptr : rarity_buf;
-      row_data[4] = quality_is_null ? nullptr : quality_buf;
-      row_data[5] = tradable_is_null ? nullptr : tradable_buf;
-      row_data[6] = stattrak_is_null ? nullptr : stattrak_buf;
-      row_data[7] = stattrak_kills_is_null ? nullptr : stattrak_kills_buf;
-      row_data[8] = sticker_1_is_null ? nullptr : sticker_1_buf;
-      row_data[9] = sticker_1_wear_is_null ? nullptr : sticker_1_wear_buf;
-      row_data[10] = sticker_2_is_null ? nullptr : sticker_2_buf;
-      row_data[11] = sticker_2_wear_is_null ? nullptr : sticker_2_wear_buf;
-      row_data[12] = sticker_3_is_null ? nullptr : sticker_3_buf;
-      row_data[13] = sticker_3_wear_is_null ? nullptr : sticker_3_wear_buf;
-      row_data[14] = sticker_4_is_null ? nullptr : sticker_4_buf;
-      row_data[15] = sticker_4_wear_is_null ? nullptr : sticker_4_wear_buf;
-      row_data[16] = sticker_5_is_null ? nullptr : sticker_5_buf;
-      row_data[17] = sticker_5_wear_is_null ? nullptr : sticker_5_wear_buf;
-      row_data[18] = nametag_is_null ? nullptr : nametag_buf;
-      row_data[19] = pattern_index_is_null ? nullptr : pattern_index_buf;
-      row_data[20] = equipped_ct_is_null ? nullptr : equipped_ct_buf;
-      row_data[21] = equipped_t_is_null ? nullptr : equipped_t_buf;
-      row_data[22] = acknowledged_is_null ? nullptr : acknowledged_buf;
-      row_data[23] = acquired_by_is_null ? nullptr : acquired_by_buf;
-
-      if (!row_data[1]) {
-        logger::error("SendSOCache: Item ID is NULL in database row");
-        continue;
-      }
-
-      try {
-        auto item = CreateItemFromDatabaseRow(steamId, (MYSQL_ROW)row_data);
-        if (item) {
-          object->add_object_data(item->SerializeAsString());
-          // Smart pointer automatically cleans up
-        }
-      } catch (const std::exception &e) {
-        logger::error("SendSOCache: Exception while processing item: %s",
-                      e.what());
-        continue;
-      }
-    }
-
-    mysql_stmt_free_result(stmtHandle);
-  }
-
   // SOTypeDefaultEquippedDefinitionInstanceClient
   {
     // Ensure the row exists - SQL injection safe
@@ -726,7 +343,7 @@ void GCNetwork_Inventory::SendSOCache(SNetSocket_t p2psocket, uint64_t steamId,
 
     if (!selectStmtOpt) {
       logger::error("SendSOCache: Failed to prepare default equips select");
-      return;
+      return 0;
     }
 
     auto &selectStmt = *selectStmtOpt;
@@ -737,7 +354,7 @@ void GCNetwork_Inventory::SendSOCache(SNetSocket_t p2psocket, uint64_t steamId,
         selectStmt.numRows() == 0) {
       logger::warning(
           "SendSOCache: No default equips row found for player %llu", steamId);
-      return;
+      return 0;
     }
 
     // Bind results for the 6 columns
@@ -759,7 +376,7 @@ void GCNetwork_Inventory::SendSOCache(SNetSocket_t p2psocket, uint64_t steamId,
 
     if (!selectStmt.bindResult(binds) || selectStmt.fetch() != 0) {
       logger::error("SendSOCache: Failed to fetch default equips");
-      return;
+      return 0;
     }
 
     {
@@ -860,58 +477,154 @@ void GCNetwork_Inventory::SendSOCache(SNetSocket_t p2psocket, uint64_t steamId,
     object->add_object_data(accountClient.SerializeAsString());
   }
 
-  NetworkMessage responseMsg =
-      NetworkMessage::FromProto(cacheMsg, k_EMsgGC_CC_GC2CL_SOCacheSubscribed);
+  // CSOEconItem. Streamed from the inventory cache's per-item bytes as one
+  // encoded SubscribedType, ahead of the other types (a repeated field
+  // appended after the rest of the message parses the same), so the items
+  // are never parsed back into a message.
+  std::string rest = cacheMsg.SerializeAsString();
 
-  // Log total objects and serialized size of cached objects
-  logger::info("SendSOCache: Sending SOCache - Total objects: %d",
-               cacheMsg.objects_size());
+  // Synthetic items only change with the operation toggle
+  bool operationActive = TunablesManager::GetInstance().IsOperationActive();
+  auto serializeSynthetic = [steamId, operationActive](
+                                std::vector<std::string> &out) {
+    // everyone gets a nametag
+    {
+      auto nametag = CSOEconItem();
+      nametag.set_id(1);
+      nametag.set_account_id(steamId & 0xFFFFFFFF);
+      nametag.set_def_index(1200);
+      nametag.set_inventory(1);
+      nametag.set_level(1);
+      nametag.set_quality(0);
+      nametag.set_flags(0);
+      nametag.set_origin(kEconItemOrigin_Purchased);
+      nametag.set_rarity(1);
 
-  // Log individual object details
-  for (int i = 0; i < cacheMsg.objects_size(); i++) {
-    const auto &obj = cacheMsg.objects(i);
-    logger::info("Object %d - Type: %u, Data count: %d, Object size: %d", i,
-                 obj.type_id(), obj.object_data_size(), obj.ByteSizeLong());
-  }
+      out.push_back(nametag.SerializeAsString());
+    }
 
-  uint32_t totalSize = responseMsg.GetTotalSize();
-  logger::info("SendSOCache: Total message size: %u bytes", totalSize);
+    // Inject Operation Coin if enabled
+    if (operationActive) {
+      auto coin = CSOEconItem();
+      // Use a unique ID high enough to avoid collision with real items
+      // We can use steamId + constant to make it deterministic per user
+      uint64_t spoofId =
+          0xF000000000000000ULL | (steamId & 0x0FFFFFFFFFFFFFFFULL);
 
-  responseMsg.WriteToSocket(p2psocket, true);
+      coin.set_id(spoofId);
+      coin.set_account_id(steamId & 0xFFFFFFFF);
+      // coin.set_def_index(4354); // Wildfire
+      coin.set_def_index(1021); // Operation Bravo Coin (Reliable fallback)
+      coin.set_inventory(4000); // High slot to avoid collision with real items
+      coin.set_level(1);
+      coin.set_quality(4);
+      coin.set_flags(0);
+      coin.set_origin(kEconItemOrigin_Purchased);
+      coin.set_rarity(1);
+
+      // Attribute 80 (Killeater Score) triggers the journal/stats?
+      // Not strictly necessary for the coin itself to appear.
+
+      out.push_back(coin.SerializeAsString());
+    }
+  };
+
+  // References to the cached bytes, taken under the cache lock; the socket
+  // writes happen after it has been released, straight from the blobs
+  std::vector<InventoryCache::Blob> blobs;
+  bool loaded = InventoryCache::GetInstance().ReadSerialized(
+      read_db ? read_db : inventory_db, steamId & 0xFFFFFFFF,
+      MakeItemSerializer(steamId), operationActive ? 1 : 0, serializeSynthetic,
+      blobs);
+  if (!loaded) {
+    logger::error("SendSOCache: Failed to load inventory for %llu", steamId);
+    return 0;
+  }
+
+  using google::protobuf::io::CodedOutputStream;
+
+  // SubscribedType { type_id = 1; repeated bytes object_data = 2; }
+  size_t objectSize = 1 + CodedOutputStream::VarintSize32(SOTypeItem);
+  for (const InventoryCache::Blob &blob : blobs) {
+    objectSize += 1 +
+                  CodedOutputStream::VarintSize32(
+                      static_cast<uint32_t>(blob->size())) +
+                  blob->size();
+  }
+  size_t itemsSize =
+      1 + CodedOutputStream::VarintSize32(static_cast<uint32_t>(objectSize)) +
+      objectSize;
+
+  size_t payloadSize = itemsSize + rest.size();
+  logger::info("SendSOCache: Sending SOCache - %zu items, %d other types, "
+               "total message size: %zu bytes",
+               blobs.size(), cacheMsg.objects_size(),
+               sizeof(uint32_t) * 2 + payloadSize);
+
+  NetworkMessageStream stream(p2psocket, k_EMsgGC_CC_GC2CL_SOCacheSubscribed,
+                              payloadSize, true);
+
+  // Field tag and varint, ahead of a value or a length-delimited blob
+  auto writePrefix = [&stream](uint8_t tag, uint32_t value) {
+    uint8_t prefix[1 + 5]; // tag, varint32
+    prefix[0] = tag;
+    uint8_t *end = CodedOutputStream::WriteVarint32ToArray(value, prefix + 1);
+    return stream.Write(prefix, end - prefix);
+  };
+  bool sent = writePrefix(0x12, static_cast<uint32_t>(objectSize)) &&
+              writePrefix(0x08, SOTypeItem);
+  for (size_t i = 0; sent && i < blobs.size(); i++) {
+    const std::string &blob = *blobs[i];
+    sent = writePrefix(0x12, static_cast<uint32_t>(blob.size())) &&
+           stream.Write(blob.data(), blob.size());
+  }
+  sent = sent && stream.Write(rest.data(), rest.size());
+  sent = stream.Finish() && sent;
+  if (!sent) {
+    logger::error("SendSOCache: Failed to write SOCache for %llu - client "
+                  "likely disconnected",
+                  steamId);
+    return 0;
+  }
 
   logger::info("SendSOCache: Sent SOCache for steamid %llu", steamId);
+  return cacheMsg.version();
 }
 
 /**
- * Helper function to create a fully populated CSOEconItem from database row
+ * Helper function to fill a CSOEconItem from a database row
  *
+ * @param item The message to fill; expected to be empty (new or cleared)
  * @param steamId The steam ID of the item's owner
- * @param row MySQL row containing the item data
+ * @param dbRow Typed csgo_items row containing the item data; writes still
+ * queued in InventoryWriteQueue are applied on top of it
  * @param overrideAcknowledged Optional value to override the
  * acknowledged/inventory position
- * @return Pointer to a new CSOEconItem object (caller must manage memory)
+ * @return false if the row can't be turned into an item
  */
-std::unique_ptr<CSOEconItem>
-GCNetwork_Inventory::CreateItemFromDatabaseRow(uint64_t steamId, MYSQL_ROW row,
-                                               int overrideAcknowledged) {
-  if (!row) {
-    logger::error("CreateItemFromDatabaseRow: NULL row pointer");
-    return nullptr;
-  }
-
+bool GCNetwork_Inventory::BuildItemFromDatabaseRow(CSOEconItem *item,
+                                                   uint64_t steamId,
+                                                   const CsgoItemRow &dbRow,
+                                                   int overrideAcknowledged) {
   try {
-    auto item = std::make_unique<CSOEconItem>();
+    auto patched = InventoryWriteQueue::GetInstance().Patched(
+        dbRow, static_cast<uint32_t>(steamId & 0xFFFFFFFF));
+    const CsgoItemRow &row = patched ? *patched : dbRow;
 
     // Parse item_id and get def_index and paint_index
-    uint32_t def_index, paint_index;
-    if (!row[1] || !ParseItemId(row[1], def_index, paint_index)) {
-      logger::error("CreateItemFromDatabaseRow: Failed to parse item_id: %s",
-                    row[1] ? row[1] : "null");
-      return nullptr;
+    std::string_view item_id = row.item_id.view();
+    DecodedItemId decoded = DecodeItemId(item_id);
+    if (!decoded) {
+      logger::error("CreateItemFromDatabaseRow: Failed to parse item_id: %.*s",
+                    item_id.empty() ? 4 : static_cast<int>(item_id.size()),
+                    item_id.empty() ? "null" : item_id.data());
+      return false;
     }
+    uint32_t def_index = decoded.defIndex;
+    uint32_t paint_index = decoded.paintIndex;
 
     // Base properties
-    item->set_id(row[0] ? strtoull(row[0], nullptr, 10) : 0);
+    item->set_id(row.id);
     item->set_account_id(steamId & 0xFFFFFFFF);
     item->set_def_index(def_index);
 
@@ -919,17 +632,17 @@ GCNetwork_Inventory::CreateItemFromDatabaseRow(uint64_t steamId, MYSQL_ROW row,
     if (overrideAcknowledged >= 0) {
       item->set_inventory(overrideAcknowledged);
     } else {
-      item->set_inventory(SafeParse::toUint32(row[22]).value_or(0));
+      item->set_inventory(row.acknowledged);
     }
 
     item->set_level(1);
-    item->set_quality(SafeParse::toUint32(row[4]).value_or(0));
+    item->set_quality(row.quality);
     item->set_flags(0);
 
     // Item origin
     int originType = kEconItemOrigin_FoundInCrate;
-    if (row[23]) {
-      std::string acquiredBy = row[23];
+    {
+      std::string_view acquiredBy = row.acquired_by.view();
       if (acquiredBy == "trade") {
         originType = kEconItemOrigin_Traded;
       } else if (acquiredBy == "trade_up") {
@@ -945,85 +658,116 @@ GCNetwork_Inventory::CreateItemFromDatabaseRow(uint64_t steamId, MYSQL_ROW row,
     item->set_origin(originType);
 
     // Custom name
-    if (row[18] && strlen(row[18]) > 0) {
-      item->set_custom_name(row[18]);
+    if (!row.nametag.empty()) {
+      item->set_custom_name(row.nametag.view().data(),
+                            row.nametag.view().size());
     }
 
     // Rarity (add 1 to match expected range)
-    item->set_rarity(SafeParse::toInt(row[3]).value_or(-1) + 1);
+    item->set_rarity(row.rarity + 1);
 
     // Set attributes based on item type
     if (def_index == 1209) {
       // Sticker item
-      AddUint32Attribute(item.get(), ATTR_ITEM_STICKER_ID, paint_index);
+      AddUint32Attribute(item, ATTR_ITEM_STICKER_ID, paint_index);
     } else if (def_index == 1314) {
       // Music kit item
-      AddUint32Attribute(item.get(), ATTR_ITEM_MUSICKIT_ID, paint_index);
+      AddUint32Attribute(item, ATTR_ITEM_MUSICKIT_ID, paint_index);
     } else {
       // Weapon skins
       if (paint_index > 0) {
-        AddFloatAttribute(item.get(), ATTR_PAINT_INDEX, paint_index);
+        AddFloatAttribute(item, ATTR_PAINT_INDEX, paint_index);
 
-        if (row[2] && strlen(row[2]) > 0) {
-          AddFloatAttribute(item.get(), ATTR_PAINT_WEAR, std::stof(row[2]));
+        if (row.floatval.has_value()) {
+          AddFloatAttribute(item, ATTR_PAINT_WEAR, row.floatval.value);
         }
 
-        if (row[19] && strlen(row[19]) > 0) {
-          AddFloatAttribute(item.get(), ATTR_PAINT_SEED,
-                            SafeParse::toInt(row[19]).value_or(0));
+        if (row.pattern_index.has_value()) {
+          AddFloatAttribute(item, ATTR_PAINT_SEED,
+                            row.pattern_index.value);
         }
       }
 
       // StatTrak
-      if (SafeParse::toInt(row[6]).value_or(0) == 1) {
-        AddUint32Attribute(item.get(), ATTR_KILLEATER_SCORE,
-                           SafeParse::toInt(row[7]).value_or(0));
-        AddUint32Attribute(item.get(), ATTR_KILLEATER_TYPE, 0);
+      if (row.stattrak == 1) {
+        AddUint32Attribute(item, ATTR_KILLEATER_SCORE,
+                           row.stattrak_kills);
+        AddUint32Attribute(item, ATTR_KILLEATER_TYPE, 0);
       }
 
       // Untradable
-      if (SafeParse::toInt(row[5]).value_or(1) == 0) {
-        AddUint32Attribute(item.get(), ATTR_TRADE_RESTRICTION,
+      if (row.tradable == 0) {
+        AddUint32Attribute(item, ATTR_TRADE_RESTRICTION,
                            3133696800); // 4/20/2069
       }
 
       // Stickers for weapons only
       if (def_index != 1209 && def_index != 1314) {
-        for (int i = 0; i < 5; i++) {
-          AddStickerAttributes(item.get(), row, i);
+        for (int i = 0; i < CsgoItemRow::STICKER_SLOTS; i++) {
+          AddStickerAttributes(item, row, i);
         }
       }
     }
 
     // Equipment state
-    bool equipped_ct = SafeParse::toInt(row[20]).value_or(0) == 1;
-    bool equipped_t = SafeParse::toInt(row[21]).value_or(0) == 1;
+    bool equipped_ct = row.equipped_ct == 1;
+    bool equipped_t = row.equipped_t == 1;
 
-    std::string item_id = row[1] ? row[1] : "";
-    bool isCollectible = (item_id.length() >= 12)
-                             ? (item_id.substr(0, 12) == "collectible-")
-                             : false;
+    bool isCollectible = decoded.kind == ItemIdKind::Collectible;
     bool isMusicKit = (def_index == 1314);
 
     if (isCollectible || isMusicKit) {
       if (equipped_t) {
-        AddEquippedState(item.get(), true, 0, def_index);
+        AddEquippedState(item, true, 0, def_index);
       }
     }
     // Weapon skins (not stickers)
     else if (def_index != 1209) {
-      AddEquippedState(item.get(), equipped_ct, CLASS_CT, def_index);
-      AddEquippedState(item.get(), equipped_t, CLASS_T, def_index);
+      AddEquippedState(item, equipped_ct, CLASS_CT, def_index);
+      AddEquippedState(item, equipped_t, CLASS_T, def_index);
     }
 
-    return item;
+    return true;
   } catch (const std::exception &e) {
     logger::error("CreateItemFromDatabaseRow: Exception caught: %s", e.what());
-    return nullptr;
+    return false;
   } catch (...) {
     logger::error("CreateItemFromDatabaseRow: Unknown exception caught");
+    return false;
+  }
+}
+
+
+/**
+ * Helper function to create a fully populated CSOEconItem from database row
+ *
+ * @param steamId The steam ID of the item's owner
+ * @param row Typed csgo_items row containing the item data
+ * @param overrideAcknowledged Optional value to override the
+ * acknowledged/inventory position
+ * @return Pointer to a new CSOEconItem object (caller must manage memory)
+ */
+std::unique_ptr<CSOEconItem>
+GCNetwork_Inventory::CreateItemFromDatabaseRow(uint64_t steamId,
+                                               const CsgoItemRow &row,
+                                               int overrideAcknowledged) {
+  auto item = std::make_unique<CSOEconItem>();
+  if (!BuildItemFromDatabaseRow(item.get(), steamId, row,
+                                overrideAcknowledged)) {
     return nullptr;
   }
+  return item;
+}
+
+// Same, on the request arena (see RequestArena)
+CSOEconItem *GCNetwork_Inventory::CreateItemFromDatabaseRow(
+    google::protobuf::Arena &arena, uint64_t steamId, const CsgoItemRow &row,
+    int overrideAcknowledged) {
+  auto *item = google::protobuf::Arena::CreateMessage<CSOEconItem>(&arena);
+  if (!BuildItemFromDatabaseRow(item, steamId, row, overrideAcknowledged)) {
+    return nullptr; // freed with the arena
+  }
+  return item;
 }
 
 /**
@@ -1045,238 +789,34 @@ GCNetwork_Inventory::FetchItemFromDatabase(uint64_t itemId, uint64_t steamId,
     return nullptr;
   }
 
-  // SQL injection safe: using prepared statement
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
-
-  auto stmtOpt = createPreparedStatement(
-      inventory_db, "SELECT id, item_id, floatval, rarity, quality, tradable, "
-                    "stattrak, stattrak_kills, "
-                    "sticker_1, sticker_1_wear, sticker_2, sticker_2_wear, "
-                    "sticker_3, sticker_3_wear, sticker_4, sticker_4_wear, "
-                    "sticker_5, sticker_5_wear, nametag, pattern_index, "
-                    "equipped_ct, equipped_t, acknowledged, acquired_by "
-                    "FROM csgo_items "
-                    "WHERE id = ? AND owner_steamid2 = ?");
-
-  if (!stmtOpt) {
-    logger::error("FetchItemFromDatabase: Failed to prepare statement");
+  // Memory lookup for cached inventories, one keyed query otherwise
+  auto row = InventoryCache::GetInstance().Find(inventory_db,
+                                                steamId & 0xFFFFFFFF, itemId);
+  if (!row) {
+    logger::error("FetchItemFromDatabase: Item not found: %llu", itemId);
     return nullptr;
   }
 
-  auto &stmt = *stmtOpt;
-  uint64_t itemIdParam = itemId;
-  unsigned long steamIdLen = steamId2.length();
-  stmt.bindUint64(0, &itemIdParam);
-  stmt.bindString(1, steamId2.c_str(), &steamIdLen);
-
-  if (!stmt.execute()) {
-    logger::error("FetchItemFromDatabase: MySQL query failed: %s",
-                  stmt.error());
-    return nullptr;
-  }
+  return CreateItemFromDatabaseRow(steamId, *row, overrideAcknowledged);
+}
 
-  // Use the validated itemId and steamId2 to fetch the item.
-  // This avoids a massive refactor of CreateItemFromDatabaseRow.
-
-  MYSQL_STMT *stmtHandle = stmt.handle();
-  mysql_stmt_store_result(stmtHandle);
-
-  // Bind results for all 24 columns
-  MYSQL_BIND binds[24];
-  memset(binds, 0, sizeof(binds));
-
-  char id_buf[21], item_id_buf[256], floatval_buf[32], rarity_buf[11],
-      quality_buf[11], tradable_buf[2], stattrak_buf[2], stattrak_kills_buf[11];
-  char sticker_1_buf[11], sticker_1_wear_buf[32], sticker_2_buf[11],
-      sticker_2_wear_buf[32], sticker_3_buf[11], sticker_3_wear_buf[32];
-  char sticker_4_buf[11], sticker_4_wear_buf[32], sticker_5_buf[11],
-      sticker_5_wear_buf[32], nametag_buf[129], pattern_index_buf[11];
-  char equipped_ct_buf[2], equipped_t_buf[2], acknowledged_buf[11],
-      acquired_by_buf[32];
-
-  unsigned long id_len, item_id_len, floatval_len, rarity_len, quality_len,
-      tradable_len, stattrak_len, stattrak_kills_len;
-  unsigned long sticker_1_len, sticker_1_wear_len, sticker_2_len,
-      sticker_2_wear_len, sticker_3_len, sticker_3_wear_len;
-  unsigned long sticker_4_len, sticker_4_wear_len, sticker_5_len,
-      sticker_5_wear_len, nametag_len, pattern_index_len;
-  unsigned long equipped_ct_len, equipped_t_len, acknowledged_len,
-      acquired_by_len;
-
-  my_bool id_is_null, item_id_is_null, floatval_is_null, rarity_is_null,
-      quality_is_null, tradable_is_null, stattrak_is_null,
-      stattrak_kills_is_null;
-  my_bool sticker_1_is_null, sticker_1_wear_is_null, sticker_2_is_null,
-      sticker_2_wear_is_null, sticker_3_is_null, sticker_3_wear_is_null;
-  my_bool sticker_4_is_null, sticker_4_wear_is_null, sticker_5_is_null,
-      sticker_5_wear_is_null, nametag_is_null, pattern_index_is_null;
-  my_bool equipped_ct_is_null, equipped_t_is_null, acknowledged_is_null,
-      acquired_by_is_null;
-
-  binds[0].buffer_type = MYSQL_TYPE_STRING;
-  binds[0].buffer = id_buf;
-  binds[0].buffer_length = sizeof(id_buf);
-  binds[0].length = &id_len;
-  binds[0].is_null = &id_is_null;
-  binds[1].buffer_type = MYSQL_TYPE_STRING;
-  binds[1].buffer = item_id_buf;
-  binds[1].buffer_length = sizeof(item_id_buf);
-  binds[1].length = &item_id_len;
-  binds[1].is_null = &item_id_is_null;
-  binds[2].buffer_type = MYSQL_TYPE_STRING;
-  binds[2].buffer = floatval_buf;
-  binds[2].buffer_length = sizeof(floatval_buf);
-  binds[2].length = &floatval_len;
-  binds[2].is_null = &floatval_is_null;
-  binds[3].buffer_type = MYSQL_TYPE_STRING;
-  binds[3].buffer = rarity_buf;
-  binds[3].buffer_length = sizeof(rarity_buf);
-  binds[3].length = &rarity_len;
-  binds[3].is_null = &rarity_is_null;
-  binds[4].buffer_type = MYSQL_TYPE_STRING;
-  binds[4].buffer = quality_buf;
-  binds[4].buffer_length = sizeof(quality_buf);
-  binds[4].length = &quality_len;
-  binds[4].is_null = &quality_is_null;
-  binds[5].buffer_type = MYSQL_TYPE_STRING;
-  binds[5].buffer = tradable_buf;
-  binds[5].buffer_length = sizeof(tradable_buf);
-  binds[5].length = &tradable_len;
-  binds[5].is_null = &tradable_is_null;
-  binds[6].buffer_type = MYSQL_TYPE_STRING;
-  binds[6].buffer = stattrak_buf;
-  binds[6].buffer_length = sizeof(stattrak_buf);
-  binds[6].length = &stattrak_len;
-  binds[6].is_null = &stattrak_is_null;
-  binds[7].buffer_type = MYSQL_TYPE_STRING;
-  binds[7].buffer = stattrak_kills_buf;
-  binds[7].buffer_length = sizeof(stattrak_kills_buf);
-  binds[7].length = &stattrak_kills_len;
-  binds[7].is_null = &stattrak_kills_is_null;
-  binds[8].buffer_type = MYSQL_TYPE_STRING;
-  binds[8].buffer = sticker_1_buf;
-  binds[8].buffer_length = sizeof(sticker_1_buf);
-  binds[8].length = &sticker_1_len;
-  binds[8].is_null = &sticker_1_is_null;
-  binds[9].buffer_type = MYSQL_TYPE_STRING;
-  binds[9].buffer = sticker_1_wear_buf;
-  binds[9].buffer_length = sizeof(sticker_1_wear_buf);
-  binds[9].length = &sticker_1_wear_len;
-  binds[9].is_null = &sticker_1_wear_is_null;
-  binds[10].buffer_type = MYSQL_TYPE_STRING;
-  binds[10].buffer = sticker_2_buf;
-  binds[10].buffer_length = sizeof(sticker_2_buf);
-  binds[10].length = &sticker_2_len;
-  binds[10].is_null = &sticker_2_is_null;
-  binds[11].buffer_type = MYSQL_TYPE_STRING;
-  binds[11].buffer = sticker_2_wear_buf;
-  binds[11].buffer_length = sizeof(sticker_2_wear_buf);
-  binds[11].length = &sticker_2_wear_len;
-  binds[11].is_null = &sticker_2_wear_is_null;
-  binds[12].buffer_type = MYSQL_TYPE_STRING;
-  binds[12].buffer = sticker_3_buf;
-  binds[12].buffer_length = sizeof(sticker_3_buf);
-  binds[12].length = &sticker_3_len;
-  binds[12].is_null = &sticker_3_is_null;
-  binds[13].buffer_type = MYSQL_TYPE_STRING;
-  binds[13].buffer = sticker_3_wear_buf;
-  binds[13].buffer_length = sizeof(sticker_3_wear_buf);
-  binds[13].length = &sticker_3_wear_len;
-  binds[13].is_null = &sticker_3_wear_is_null;
-  binds[14].buffer_type = MYSQL_TYPE_STRING;
-  binds[14].buffer = sticker_4_buf;
-  binds[14].buffer_length = sizeof(sticker_4_buf);
-  binds[14].length = &sticker_4_len;
-  binds[14].is_null = &sticker_4_is_null;
-  binds[15].buffer_type = MYSQL_TYPE_STRING;
-  binds[15].buffer = sticker_4_wear_buf;
-  binds[15].buffer_length = sizeof(sticker_4_wear_buf);
-  binds[15].length = &sticker_4_wear_len;
-  binds[15].is_null = &sticker_4_wear_is_null;
-  binds[16].buffer_type = MYSQL_TYPE_STRING;
-  binds[16].buffer = sticker_5_buf;
-  binds[16].buffer_length = sizeof(sticker_5_buf);
-  binds[16].length = &sticker_5_len;
-  binds[16].is_null = &sticker_5_is_null;
-  binds[17].buffer_type = MYSQL_TYPE_STRING;
-  binds[17].buffer = sticker_5_wear_buf;
-  binds[17].buffer_length = sizeof(sticker_5_wear_buf);
-  binds[17].length = &sticker_5_wear_len;
-  binds[17].is_null = &sticker_5_wear_is_null;
-  binds[18].buffer_type = MYSQL_TYPE_STRING;
-  binds[18].buffer = nametag_buf;
-  binds[18].buffer_length = sizeof(nametag_buf);
-  binds[18].length = &nametag_len;
-  binds[18].is_null = &nametag_is_null;
-  binds[19].buffer_type = MYSQL_TYPE_STRING;
-  binds[19].buffer = pattern_index_buf;
-  binds[19].buffer_length = sizeof(pattern_index_buf);
-  binds[19].length = &pattern_index_len;
-  binds[19].is_null = &pattern_index_is_null;
-  binds[20].buffer_type = MYSQL_TYPE_STRING;
-  binds[20].buffer = equipped_ct_buf;
-  binds[20].buffer_length = sizeof(equipped_ct_buf);
-  binds[20].length = &equipped_ct_len;
-  binds[20].is_null = &equipped_ct_is_null;
-  binds[21].buffer_type = MYSQL_TYPE_STRING;
-  binds[21].buffer = equipped_t_buf;
-  binds[21].buffer_length = sizeof(equipped_t_buf);
-  binds[21].length = &equipped_t_len;
-  binds[21].is_null = &equipped_t_is_null;
-  binds[22].buffer_type = MYSQL_TYPE_STRING;
-  binds[22].buffer = acknowledged_buf;
-  binds[22].buffer_length = sizeof(acknowledged_buf);
-  binds[22].length = &acknowledged_len;
-  binds[22].is_null = &acknowledged_is_null;
-  binds[23].buffer_type = MYSQL_TYPE_STRING;
-  binds[23].buffer = acquired_by_buf;
-  binds[23].buffer_length = sizeof(acquired_by_buf);
-  binds[23].length = &acquired_by_len;
-  binds[23].is_null = &acquired_by_is_null;
-
-  if (mysql_stmt_bind_result(stmtHandle, binds)) {
-    logger::error("FetchItemFromDatabase: Failed to bind result for prepared "
-                  "statement: %s",
-                  mysql_stmt_error(stmtHandle));
+// Same, on the request arena (see RequestArena)
+CSOEconItem *GCNetwork_Inventory::FetchItemFromDatabase(
+    google::protobuf::Arena &arena, uint64_t itemId, uint64_t steamId,
+    MYSQL *inventory_db) {
+  if (!inventory_db) {
+    logger::error("FetchItemFromDatabase: NULL database connection");
     return nullptr;
   }
 
-  std::unique_ptr<CSOEconItem> item = nullptr;
-  if (mysql_stmt_fetch(stmtHandle) == 0) {
-    const char *row_data[24];
-    row_data[0] = id_is_null ? nullptr : id_buf;
-    row_data[1] = item_id_is_null ? nullptr : item_id_buf;
-    row_data[2] = floatval_is_null ? nullptr : floatval_buf;
-    row_data[3] = rarity_is_null ? nullptr : rarity_buf;
-    row_data[4] = quality_is_null ? nullptr : quality_buf;
-    row_data[5] = tradable_is_null ? nullptr : tradable_buf;
-    row_data[6] = stattrak_is_null ? nullptr : stattrak_buf;
-    row_data[7] = stattrak_kills_is_null ? nullptr : stattrak_kills_buf;
-    row_data[8] = sticker_1_is_null ? nullptr : sticker_1_buf;
-    row_data[9] = sticker_1_wear_is_null ? nullptr : sticker_1_wear_buf;
-    row_data[10] = sticker_2_is_null ? nullptr : sticker_2_buf;
-    row_data[11] = sticker_2_wear_is_null ? nullptr : sticker_2_wear_buf;
-    row_data[12] = sticker_3_is_null ? nullptr : sticker_3_buf;
-    row_data[13] = sticker_3_wear_is_null ? nullptr : sticker_3_wear_buf;
-    row_data[14] = sticker_4_is_null ? nullptr : sticker_4_buf;
-    row_data[15] = sticker_4_wear_is_null ? nullptr : sticker_4_wear_buf;
-    row_data[16] = sticker_5_is_null ? nullptr : sticker_5_buf;
-    row_data[17] = sticker_5_wear_is_null ? nullptr : sticker_5_wear_buf;
-    row_data[18] = nametag_is_null ? nullptr : nametag_buf;
-    row_data[19] = pattern_index_is_null ? nullptr : pattern_index_buf;
-    row_data[20] = equipped_ct_is_null ? nullptr : equipped_ct_buf;
-    row_data[21] = equipped_t_is_null ? nullptr : equipped_t_buf;
-    row_data[22] = acknowledged_is_null ? nullptr : acknowledged_buf;
-    row_data[23] = acquired_by_is_null ? nullptr : acquired_by_buf;
-
-    item = CreateItemFromDatabaseRow(steamId, (MYSQL_ROW)row_data,
-                                     overrideAcknowledged);
-  } else {
+  auto row = InventoryCache::GetInstance().Find(inventory_db,
+                                                steamId & 0xFFFFFFFF, itemId);
+  if (!row) {
     logger::error("FetchItemFromDatabase: Item not found: %llu", itemId);
+    return nullptr;
   }
 
-  mysql_stmt_free_result(stmtHandle);
-  return item;
+  return CreateItemFromDatabaseRow(arena, steamId, *row);
 }
 
 /**
@@ -1300,17 +840,11 @@ bool GCNetwork_Inventory::CheckAndSendNewItemsSince(SNetSocket_t p2psocket,
   }
 
   // SQL injection safe: using prepared statement to validate and query
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
-  auto stmtOpt = createPreparedStatement(
-      inventory_db, "SELECT id, item_id, floatval, rarity, quality, tradable, "
-                    "stattrak, stattrak_kills, "
-                    "sticker_1, sticker_1_wear, sticker_2, sticker_2_wear, "
-                    "sticker_3, sticker_3_wear, sticker_4, sticker_4_wear, "
-                    "sticker_5, sticker_5_wear, nametag, pattern_index, "
-                    "equipped_ct, equipped_t, acknowledged, acquired_by "
-                    "FROM csgo_items "
-                    "WHERE owner_steamid2 = ? AND id > ? "
-                    "ORDER BY id ASC");
+  static const std::string newItemsQuery =
+      "SELECT " + CsgoItemRowBinder::selectList() +
+      " FROM csgo_items WHERE owner_account_id = ? AND id > ? ORDER BY id ASC";
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  auto stmtOpt = createPreparedStatement(inventory_db, newItemsQuery.c_str());
 
   if (!stmtOpt) {
     logger::error("CheckAndSendNewItemsSince: Failed to prepare statement");
@@ -1319,8 +853,7 @@ bool GCNetwork_Inventory::CheckAndSendNewItemsSince(SNetSocket_t p2psocket,
 
   auto &stmt = *stmtOpt;
   uint64_t lastIdParam = lastItemId;
-  unsigned long steamIdLen = steamId2.length();
-  stmt.bindString(0, steamId2.c_str(), &steamIdLen);
+  stmt.bindUint32(0, &accountId);
   stmt.bindUint64(1, &lastIdParam);
 
   if (!stmt.execute()) {
@@ -1329,16 +862,13 @@ bool GCNetwork_Inventory::CheckAndSendNewItemsSince(SNetSocket_t p2psocket,
     return false;
   }
 
-  // Use the validated steamId2 and lastItemId to fetch new items.
-  // This avoids a massive refactor of the complex loop below.
-
-  MYSQL_STMT *stmtHandle = stmt.handle();
-  mysql_stmt_store_result(stmtHandle);
+  if (!stmt.storeResult()) {
+    return false;
+  }
 
-  int numRows = mysql_stmt_num_rows(stmtHandle);
+  int numRows = static_cast<int>(stmt.numRows());
   if (numRows == 0) {
     // no items
-    mysql_stmt_free_result(stmtHandle);
     return false;
   }
 
@@ -1348,215 +878,58 @@ bool GCNetwork_Inventory::CheckAndSendNewItemsSince(SNetSocket_t p2psocket,
   bool updateSuccess = false;
   uint64_t highestItemId = lastItemId;
 
-  // Bind results for all 24 columns
-  MYSQL_BIND binds[24];
-  memset(binds, 0, sizeof(binds));
-
-  char id_buf[21], item_id_buf[256], floatval_buf[32], rarity_buf[11],
-      quality_buf[11], tradable_buf[2], stattrak_buf[2], stattrak_kills_buf[11];
-  char sticker_1_buf[11], sticker_1_wear_buf[32], sticker_2_buf[11],
-      sticker_2_wear_buf[32], sticker_3_buf[11], sticker_3_wear_buf[32];
-  char sticker_4_buf[11], sticker_4_wear_buf[32], sticker_5_buf[11],
-      sticker_5_wear_buf[32], nametag_buf[129], pattern_index_buf[11];
-  char equipped_ct_buf[2], equipped_t_buf[2], acknowledged_buf[11],
-      acquired_by_buf[32];
-
-  unsigned long id_len, item_id_len, floatval_len, rarity_len, quality_len,
-      tradable_len, stattrak_len, stattrak_kills_len;
-  unsigned long sticker_1_len, sticker_1_wear_len, sticker_2_len,
-      sticker_2_wear_len, sticker_3_len, sticker_3_wear_len;
-  unsigned long sticker_4_len, sticker_4_wear_len, sticker_5_len,
-      sticker_5_wear_len, nametag_len, pattern_index_len;
-  unsigned long equipped_ct_len, equipped_t_len, acknowledged_len,
-      acquired_by_len;
-
-  my_bool id_is_null, item_id_is_null, floatval_is_null, rarity_is_null,
-      quality_is_null, tradable_is_null, stattrak_is_null,
-      stattrak_kills_is_null;
-  my_bool sticker_1_is_null, sticker_1_wear_is_null, sticker_2_is_null,
-      sticker_2_wear_is_null, sticker_3_is_null, sticker_3_wear_is_null;
-  my_bool sticker_4_is_null, sticker_4_wear_is_null, sticker_5_is_null,
-      sticker_5_wear_is_null, nametag_is_null, pattern_index_is_null;
-  my_bool equipped_ct_is_null, equipped_t_is_null, acknowledged_is_null,
-      acquired_by_is_null;
-
-  binds[0].buffer_type = MYSQL_TYPE_STRING;
-  binds[0].buffer = id_buf;
-  binds[0].buffer_length = sizeof(id_buf);
-  binds[0].length = &id_len;
-  binds[0].is_null = &id_is_null;
-  binds[1].buffer_type = MYSQL_TYPE_STRING;
-  binds[1].buffer = item_id_buf;
-  binds[1].buffer_length = sizeof(item_id_buf);
-  binds[1].length = &item_id_len;
-  binds[1].is_null = &item_id_is_null;
-  binds[2].buffer_type = MYSQL_TYPE_STRING;
-  binds[2].buffer = floatval_buf;
-  binds[2].buffer_length = sizeof(floatval_buf);
-  binds[2].length = &floatval_len;
-  binds[2].is_null = &floatval_is_null;
-  binds[3].buffer_type = MYSQL_TYPE_STRING;
-  binds[3].buffer = rarity_buf;
-  binds[3].buffer_length = sizeof(rarity_buf);
-  binds[3].length = &rarity_len;
-  binds[3].is_null = &rarity_is_null;
-  binds[4].buffer_type = MYSQL_TYPE_STRING;
-  binds[4].buffer = quality_buf;
-  binds[4].buffer_length = sizeof(quality_buf);
-  binds[4].length = &quality_len;
-  binds[4].is_null = &quality_is_null;
-  binds[5].buffer_type = MYSQL_TYPE_STRING;
-  binds[5].buffer = tradable_buf;
-  binds[5].buffer_length = sizeof(tradable_buf);
-  binds[5].length = &tradable_len;
-  binds[5].is_null = &tradable_is_null;
-  binds[6].buffer_type = MYSQL_TYPE_STRING;
-  binds[6].buffer = stattrak_buf;
-  binds[6].buffer_length = sizeof(stattrak_buf);
-  binds[6].length = &stattrak_len;
-  binds[6].is_null = &stattrak_is_null;
-  binds[7].buffer_type = MYSQL_TYPE_STRING;
-  binds[7].buffer = stattrak_kills_buf;
-  binds[7].buffer_length = sizeof(stattrak_kills_buf);
-  binds[7].length = &stattrak_kills_len;
-  binds[7].is_null = &stattrak_kills_is_null;
-  binds[8].buffer_type = MYSQL_TYPE_STRING;
-  binds[8].buffer = sticker_1_buf;
-  binds[8].buffer_length = sizeof(sticker_1_buf);
-  binds[8].length = &sticker_1_len;
-  binds[8].is_null = &sticker_1_is_null;
-  binds[9].buffer_type = MYSQL_TYPE_STRING;
-  binds[9].buffer = sticker_1_wear_buf;
-  binds[9].buffer_length = sizeof(sticker_1_wear_buf);
-  binds[9].length = &sticker_1_wear_len;
-  binds[9].is_null = &sticker_1_wear_is_null;
-  binds[10].buffer_type = MYSQL_TYPE_STRING;
-  binds[10].buffer = sticker_2_buf;
-  binds[10].buffer_length = sizeof(sticker_2_buf);
-  binds[10].length = &sticker_2_len;
-  binds[10].is_null = &sticker_2_is_null;
-  binds[11].buffer_type = MYSQL_TYPE_STRING;
-  binds[11].buffer = sticker_2_wear_buf;
-  binds[11].buffer_length = sizeof(sticker_2_wear_buf);
-  binds[11].length = &sticker_2_wear_len;
-  binds[11].is_null = &sticker_2_wear_is_null;
-  binds[12].buffer_type = MYSQL_TYPE_STRING;
-  binds[12].buffer = sticker_3_buf;
-  binds[12].buffer_length = sizeof(sticker_3_buf);
-  binds[12].length = &sticker_3_len;
-  binds[12].is_null = &sticker_3_is_null;
-  binds[13].buffer_type = MYSQL_TYPE_STRING;
-  binds[13].buffer = sticker_3_wear_buf;
-  binds[13].buffer_length = sizeof(sticker_3_wear_buf);
-  binds[13].length = &sticker_3_wear_len;
-  binds[13].is_null = &sticker_3_wear_is_null;
-  binds[14].buffer_type = MYSQL_TYPE_STRING;
-  binds[14].buffer = sticker_4_buf;
-  binds[14].buffer_length = sizeof(sticker_4_buf);
-  binds[14].length = &sticker_4_len;
-  binds[14].is_null = &sticker_4_is_null;
-  binds[15].buffer_type = MYSQL_TYPE_STRING;
-  binds[15].buffer = sticker_4_wear_buf;
-  binds[15].buffer_length = sizeof(sticker_4_wear_buf);
-  binds[15].length = &sticker_4_wear_len;
-  binds[15].is_null = &sticker_4_wear_is_null;
-  binds[16].buffer_type = MYSQL_TYPE_STRING;
-  binds[16].buffer = sticker_5_buf;
-  binds[16].buffer_length = sizeof(sticker_5_buf);
-  binds[16].length = &sticker_5_len;
-  binds[16].is_null = &sticker_5_is_null;
-  binds[17].buffer_type = MYSQL_TYPE_STRING;
-  binds[17].buffer = sticker_5_wear_buf;
-  binds[17].buffer_length = sizeof(sticker_5_wear_buf);
-  binds[17].length = &sticker_5_wear_len;
-  binds[17].is_null = &sticker_5_wear_is_null;
-  binds[18].buffer_type = MYSQL_TYPE_STRING;
-  binds[18].buffer = nametag_buf;
-  binds[18].buffer_length = sizeof(nametag_buf);
-  binds[18].length = &nametag_len;
-  binds[18].is_null = &nametag_is_null;
-  binds[19].buffer_type = MYSQL_TYPE_STRING;
-  binds[19].buffer = pattern_index_buf;
-  binds[19].buffer_length = sizeof(pattern_index_buf);
-  binds[19].length = &pattern_index_len;
-  binds[19].is_null = &pattern_index_is_null;
-  binds[20].buffer_type = MYSQL_TYPE_STRING;
-  binds[20].buffer = equipped_ct_buf;
-  binds[20].buffer_length = sizeof(equipped_ct_buf);
-  binds[20].length = &equipped_ct_len;
-  binds[20].is_null = &equipped_ct_is_null;
-  binds[21].buffer_type = MYSQL_TYPE_STRING;
-  binds[21].buffer = equipped_t_buf;
-  binds[21].buffer_length = sizeof(equipped_t_buf);
-  binds[21].length = &equipped_t_len;
-  binds[21].is_null = &equipped_t_is_null;
-  binds[22].buffer_type = MYSQL_TYPE_STRING;
-  binds[22].buffer = acknowledged_buf;
-  binds[22].buffer_length = sizeof(acknowledged_buf);
-  binds[22].length = &acknowledged_len;
-  binds[22].is_null = &acknowledged_is_null;
-  binds[23].buffer_type = MYSQL_TYPE_STRING;
-  binds[23].buffer = acquired_by_buf;
-  binds[23].buffer_length = sizeof(acquired_by_buf);
-  binds[23].length = &acquired_by_len;
-  binds[23].is_null = &acquired_by_is_null;
-
-  if (mysql_stmt_bind_result(stmtHandle, binds)) {
+  CsgoItemRowBinder rowBinder;
+  if (!rowBinder.bind(stmt)) {
     logger::error("CheckAndSendNewItemsSince: Failed to bind result for "
                   "prepared statement: %s",
-                  mysql_stmt_error(stmtHandle));
-    mysql_stmt_free_result(stmtHandle);
+                  stmt.error());
     return false;
   }
 
   // find highest item id
-  while (mysql_stmt_fetch(stmtHandle) == 0) {
-    uint64_t itemId = id_is_null ? 0 : strtoull(id_buf, nullptr, 10);
-    if (itemId > highestItemId) {
-      highestItemId = itemId;
+  std::vector<uint64_t> newIds;
+  while (rowBinder.fetch(stmt)) {
+    newIds.push_back(rowBinder.row().id);
+    if (rowBinder.row().id > highestItemId) {
+      highestItemId = rowBinder.row().id;
     }
   }
-  mysql_stmt_data_seek(stmtHandle, 0); // Reset cursor to beginning
+  mysql_stmt_data_seek(stmt.handle(), 0); // Reset cursor to beginning
+
+  // Rows the GC inserted are cached already. Anything else came from
+  // another writer (trades, drops), which may have changed more than it
+  // inserted, so the cached inventory is dropped and loaded again.
+  auto &cache = InventoryCache::GetInstance();
+  bool foreignRows = false;
+  cache.Read(nullptr, accountId, [&](const InventoryCache::Items &items) {
+    for (uint64_t id : newIds) {
+      foreignRows = foreignRows || items.find(id) == items.end();
+    }
+  });
+  if (foreignRows) {
+    // The other writer committed on the primary; keep the reload off the
+    // replicas until they have the rows too
+    GCNetwork::GetInstance()->NoteWrite(steamId);
+    cache.Invalidate(accountId);
+    InventoryVersions::GetInstance().Truncate(accountId);
+  }
 
   // one item - SOSingleObject
-  if (mysql_stmt_fetch(stmtHandle) == 0) {
-    const char *row_data[24];
-    row_data[0] = id_is_null ? nullptr : id_buf;
-    row_data[1] = item_id_is_null ? nullptr : item_id_buf;
-    row_data[2] = floatval_is_null ? nullptr : floatval_buf;
-    row_data[3] = rarity_is_null ? nullptr : rarity_buf;
-    row_data[4] = quality_is_null ? nullptr : quality_buf;
-    row_data[5] = tradable_is_null ? nullptr : tradable_buf;
-    row_data[6] = stattrak_is_null ? nullptr : stattrak_buf;
-    row_data[7] = stattrak_kills_is_null ? nullptr : stattrak_kills_buf;
-    row_data[8] = sticker_1_is_null ? nullptr : sticker_1_buf;
-    row_data[9] = sticker_1_wear_is_null ? nullptr : sticker_1_wear_buf;
-    row_data[10] = sticker_2_is_null ? nullptr : sticker_2_buf;
-    row_data[11] = sticker_2_wear_is_null ? nullptr : sticker_2_wear_buf;
-    row_data[12] = sticker_3_is_null ? nullptr : sticker_3_buf;
-    row_data[13] = sticker_3_wear_is_null ? nullptr : sticker_3_wear_buf;
-    row_data[14] = sticker_4_is_null ? nullptr : sticker_4_buf;
-    row_data[15] = sticker_4_wear_is_null ? nullptr : sticker_4_wear_buf;
-    row_data[16] = sticker_5_is_null ? nullptr : sticker_5_buf;
-    row_data[17] = sticker_5_wear_is_null ? nullptr : sticker_5_wear_buf;
-    row_data[18] = nametag_is_null ? nullptr : nametag_buf;
-    row_data[19] = pattern_index_is_null ? nullptr : pattern_index_buf;
-    row_data[20] = equipped_ct_is_null ? nullptr : equipped_ct_buf;
-    row_data[21] = equipped_t_is_null ? nullptr : equipped_t_buf;
-    row_data[22] = acknowledged_is_null ? nullptr : acknowledged_buf;
-    row_data[23] = acquired_by_is_null ? nullptr : acquired_by_buf;
-
-    auto item = CreateItemFromDatabaseRow(steamId, (MYSQL_ROW)row_data);
+  if (rowBinder.fetch(stmt)) {
+    const CsgoItemRow &row = rowBinder.row();
+    auto item = CreateItemFromDatabaseRow(steamId, row);
     if (item) {
-      bool isFromCrate = (acquired_by_buf && strcmp(acquired_by_buf, "0") == 0);
-      bool isCrafted = (acquired_by_buf && strcmp(acquired_by_buf, "8") == 0);
+      std::string_view acquiredBy = row.acquired_by.view();
+      bool isFromCrate = (acquiredBy == "0");
+      bool isCrafted = (acquiredBy == "8");
 
       if (isFromCrate || isCrafted) {
         // Item from crate or craft - skip sending it here since it was already
         // sent in HandleUnboxCrate or HandleCraft response
         logger::info("CheckAndSendNewItemsSince: Skipping item %llu with "
-                     "acquired_by='%s' (already sent in specific response)",
-                     item->id(), acquired_by_buf ? acquired_by_buf : "null");
+                     "acquired_by='%.*s' (already sent in specific response)",
+                     item->id(), static_cast<int>(acquiredBy.size()),
+                     acquiredBy.data());
 
         // For gift types, we need to update acquired_by - SQL injection safe
         auto updateStmtOpt = createPreparedStatement(
@@ -1571,6 +944,10 @@ bool GCNetwork_Inventory::CheckAndSendNewItemsSince(SNetSocket_t p2psocket,
             logger::error("CheckAndSendNewItemsSince: Failed to update "
                           "acquired_by field: %s",
                           uStmt.error());
+          } else {
+            cache.Update(accountId, idParam, [](CsgoItemRow &cached) {
+              cached.acquired_by.assign("crate");
+            });
           }
         }
 
@@ -1615,9 +992,9 @@ uint64_t GCNetwork_Inventory::GetLatestItemIdForUser(uint64_t steamId,
   }
 
   // SQL injection safe: using prepared statement
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
+  uint32_t accountId = steamId & 0xFFFFFFFF;
   auto stmtOpt = createPreparedStatement(
-      inventory_db, "SELECT MAX(id) FROM csgo_items WHERE owner_steamid2 = ?");
+      inventory_db, "SELECT MAX(id) FROM csgo_items WHERE owner_account_id = ?");
 
   if (!stmtOpt) {
     logger::error("GetLatestItemIdForUser: Failed to prepare statement");
@@ -1625,8 +1002,7 @@ uint64_t GCNetwork_Inventory::GetLatestItemIdForUser(uint64_t steamId,
   }
 
   auto &stmt = *stmtOpt;
-  unsigned long steamIdLen = steamId2.length();
-  stmt.bindString(0, steamId2.c_str(), &steamIdLen);
+  stmt.bindUint32(0, &accountId);
 
   if (!stmt.execute() || !stmt.storeResult()) {
     logger::error("GetLatestItemIdForUser: MySQL query failed: %s",
@@ -1684,50 +1060,104 @@ int GCNetwork_Inventory::ProcessClientAcknowledgment(
                "items from player %llu",
                message.item_id_size(), steamId);
 
-  // get the current highest inventory position for this user - SQL injection
-  // safe
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
-  auto maxStmtOpt = createPreparedStatement(
-      inventory_db,
-      "SELECT COALESCE(MAX(acknowledged), 1) FROM csgo_items WHERE "
-      "owner_steamid2 = ? AND acknowledged < 1073741824");
+  // The current highest inventory position and the requested items that
+  // are still unacknowledged; the same rows feed the client notification,
+  // so nothing is refetched
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  uint32_t current_max_pos = 1;
+  std::vector<uint64_t> requestedIds(message.item_id().begin(),
+                                     message.item_id().end());
+  std::vector<CsgoItemRow> pendingRows;
+
+  auto isUnacknowledged = [](uint32_t position) {
+    return position == 0 || position >= 1073741824;
+  };
+
+  bool cached = InventoryCache::GetInstance().Read(
+      inventory_db, accountId, [&](const InventoryCache::Items &items) {
+        for (const auto &entry : items) {
+          if (!isUnacknowledged(entry.second.acknowledged)) {
+            current_max_pos =
+                std::max(current_max_pos, entry.second.acknowledged);
+          }
+        }
+        for (uint64_t itemId : requestedIds) {
+          auto it = items.find(itemId);
+          if (it != items.end() &&
+              isUnacknowledged(it->second.acknowledged)) {
+            pendingRows.push_back(it->second);
+          }
+        }
+      });
 
-  if (!maxStmtOpt) {
-    logger::error("ProcessClientAcknowledgment: Failed to prepare max position "
-                  "statement");
-    return 0;
-  }
+  if (!cached) {
+    // SQL injection safe
+    auto maxStmtOpt = createPreparedStatement(
+        inventory_db,
+        "SELECT COALESCE(MAX(acknowledged), 1) FROM csgo_items WHERE "
+        "owner_account_id = ? AND acknowledged < 1073741824");
 
-  auto &maxStmt = *maxStmtOpt;
-  unsigned long steamIdLen = steamId2.length();
-  maxStmt.bindString(0, steamId2.c_str(), &steamIdLen);
+    if (!maxStmtOpt) {
+      logger::error("ProcessClientAcknowledgment: Failed to prepare max "
+                    "position statement");
+      return 0;
+    }
 
-  if (!maxStmt.execute() || !maxStmt.storeResult()) {
-    logger::error("ProcessClientAcknowledgment: Failed to get max position: %s",
-                  maxStmt.error());
-    return 0;
-  }
+    auto &maxStmt = *maxStmtOpt;
+    maxStmt.bindUint32(0, &accountId);
 
-  uint32_t current_max_pos = 1;
-  MYSQL_BIND maxBind[1];
-  memset(maxBind, 0, sizeof(maxBind));
-  maxBind[0].buffer_type = MYSQL_TYPE_LONG;
-  maxBind[0].buffer = &current_max_pos;
+    if (!maxStmt.execute() || !maxStmt.storeResult()) {
+      logger::error(
+          "ProcessClientAcknowledgment: Failed to get max position: %s",
+          maxStmt.error());
+      return 0;
+    }
 
-  if (!maxStmt.bindResult(maxBind) || maxStmt.fetch() != 0) {
-    // defaults to 1
-  }
+    MYSQL_BIND maxBind[1];
+    memset(maxBind, 0, sizeof(maxBind));
+    maxBind[0].buffer_type = MYSQL_TYPE_LONG;
+    maxBind[0].buffer = &current_max_pos;
 
-  uint32_t next_position = current_max_pos;
+    if (!maxStmt.bindResult(maxBind) || maxStmt.fetch() != 0) {
+      // defaults to 1
+    }
 
-  // start transaction
-  if (mysql_query(inventory_db, "START TRANSACTION") != 0) {
-    logger::error(
-        "ProcessClientAcknowledgment: Failed to start transaction: %s",
-        mysql_error(inventory_db));
-    return 0;
+    // Load the requested items that are still unacknowledged in one query
+    std::string pendingQuery =
+        "SELECT " + CsgoItemRowBinder::selectList() +
+        " FROM csgo_items WHERE owner_account_id = ? AND (acknowledged = 0 "
+        "OR acknowledged IS NULL OR acknowledged >= 1073741824) AND id IN " +
+        sqlPlaceholderList(requestedIds.size());
+
+    auto selectStmtOpt =
+        createPreparedStatement(inventory_db, pendingQuery.c_str());
+    if (!selectStmtOpt) {
+      logger::error("ProcessClientAcknowledgment: Failed to prepare statement");
+      return 0;
+    }
+
+    auto &selectStmt = *selectStmtOpt;
+    selectStmt.bindUint32(0, &accountId);
+    selectStmt.bindUint64List(1, requestedIds.data(), requestedIds.size());
+
+    CsgoItemRowBinder rowBinder;
+    if (!selectStmt.execute() || !selectStmt.storeResult() ||
+        !rowBinder.bind(selectStmt)) {
+      logger::error("ProcessClientAcknowledgment: MySQL query failed: %s",
+                    selectStmt.error());
+      return 0;
+    }
+
+    while (rowBinder.fetch(selectStmt)) {
+      pendingRows.push_back(rowBinder.row());
+    }
   }
 
+  // Positions handed out since the last flush are not in the table yet
+  InventoryWriteQueue &writeQueue = InventoryWriteQueue::GetInstance();
+  uint32_t next_position =
+      std::max(current_max_pos, writeQueue.PendingMaxAcknowledged(accountId));
+
   int successCount = 0;
 
   // one item?
@@ -1740,76 +1170,53 @@ int GCNetwork_Inventory::ProcessClientAcknowledgment(
     InitMultipleObjectsMessage(updateMsg, steamId);
   }
 
-  // Prepare the update statement once outside the loop for security and
-  // performance
-  auto stmtOpt = createPreparedStatement(
-      inventory_db, "UPDATE csgo_items SET acknowledged = ? "
-                    "WHERE id = ? AND owner_steamid2 = ? AND (acknowledged = 0 "
-                    "OR acknowledged IS NULL OR acknowledged >= 1073741824)");
-
-  if (!stmtOpt) {
-    logger::error("ProcessClientAcknowledgment: Failed to prepare statement");
-    mysql_query(inventory_db, "ROLLBACK");
-    return 0;
+  std::unordered_map<uint64_t, std::unique_ptr<CSOEconItem>> pendingItems;
+  for (const CsgoItemRow &row : pendingRows) {
+    // Acknowledged in the queue but not flushed yet
+    auto queued = writeQueue.PendingAcknowledged(row.id);
+    if (queued && *queued != 0 && *queued < 1073741824) {
+      continue;
+    }
+    pendingItems[row.id] = CreateItemFromDatabaseRow(steamId, row);
   }
 
-  auto &stmt = *stmtOpt;
+  // Assign positions in request order; duplicates find nothing left
+  std::vector<std::unique_ptr<CSOEconItem>> ackItems;
 
-  // loop over all items to acknowledge
   for (int i = 0; i < message.item_id_size(); i++) {
     uint64_t itemId = message.item_id(i);
 
-    next_position++;
-    if (next_position == 1)
-      next_position = 2; // skip position 1 (cause thats the nametag)
-
-    // SQL injection safe: using prepared statement
-    uint32_t posParam = next_position;
-    uint64_t idParam = itemId;
-    stmt.bindUint32(0, &posParam);
-    stmt.bindUint64(1, &idParam);
-    stmt.bindString(2, steamId2.c_str(), &steamIdLen);
-
-    if (!stmt.execute()) {
-      logger::error(
-          "ProcessClientAcknowledgment: MySQL query failed for item %llu: %s",
-          itemId, stmt.error());
-      continue;
-    }
-
-    if (mysql_affected_rows(inventory_db) == 0) {
+    auto pending = pendingItems.find(itemId);
+    if (pending == pendingItems.end()) {
       logger::warning("ProcessClientAcknowledgment: Item %llu not found or "
                       "already acknowledged",
                       itemId);
-      next_position--;
       continue;
     }
 
-    // acknowledge success
+    next_position++;
+    if (next_position == 1)
+      next_position = 2; // skip position 1 (cause thats the nametag)
+
+    writeQueue.SetAcknowledged(inventory_db, steamId, itemId, next_position);
     successCount++;
+    if (pending->second) {
+      pending->second->set_inventory(next_position);
+      ackItems.push_back(std::move(pending->second));
+    }
+    pendingItems.erase(pending);
+  }
 
-    // make item for notification
-    auto item =
-        FetchItemFromDatabase(itemId, steamId, inventory_db, next_position);
-    if (item) {
-      if (isSingleItem) {
-        singleItem = std::move(item);
-      } else {
-        AddToMultipleObjectsMessage(updateMsg, SOTypeItem, *item);
-      }
+  for (auto &item : ackItems) {
+    if (isSingleItem) {
+      singleItem = std::move(item);
+    } else {
+      AddToMultipleObjectsMessage(updateMsg, SOTypeItem, *item);
     }
   }
 
   // process result
   if (successCount > 0) {
-    if (mysql_query(inventory_db, "COMMIT") != 0) {
-      logger::error(
-          "ProcessClientAcknowledgment: Failed to commit transaction: %s",
-          mysql_error(inventory_db));
-      mysql_query(inventory_db, "ROLLBACK");
-      return 0;
-    }
-
     if (isSingleItem && singleItem) {
       // Send single item update
       logger::info("ProcessClientAcknowledgment: Sending single item update "
@@ -1828,9 +1235,7 @@ int GCNetwork_Inventory::ProcessClientAcknowledgment(
                  "items for player %llu",
                  successCount, steamId);
   } else {
-    mysql_query(inventory_db, "ROLLBACK");
-    logger::warning("ProcessClientAcknowledgment: No items were acknowledged, "
-                    "transaction rolled back");
+    logger::warning("ProcessClientAcknowledgment: No items were acknowledged");
   }
 
   return successCount;
@@ -1851,39 +1256,52 @@ uint32_t GCNetwork_Inventory::GetNextInventoryPosition(uint64_t steamId,
     return 2; // Default to position 2 if we can't query
   }
 
-  // SQL injection safe: using prepared statement
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
-  auto stmtOpt = createPreparedStatement(
-      inventory_db,
-      "SELECT COALESCE(MAX(acknowledged), 1) FROM csgo_items WHERE "
-      "owner_steamid2 = ?");
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  uint32_t currentMaxPos = 1;
+  bool cached = InventoryCache::GetInstance().Read(
+      inventory_db, accountId, [&](const InventoryCache::Items &items) {
+        for (const auto &entry : items) {
+          currentMaxPos = std::max(currentMaxPos, entry.second.acknowledged);
+        }
+      });
 
-  if (!stmtOpt) {
-    logger::error("GetNextInventoryPosition: Failed to prepare statement");
-    return 2;
-  }
+  if (!cached) {
+    // SQL injection safe: using prepared statement
+    auto stmtOpt = createPreparedStatement(
+        inventory_db,
+        "SELECT COALESCE(MAX(acknowledged), 1) FROM csgo_items WHERE "
+        "owner_account_id = ?");
 
-  auto &stmt = *stmtOpt;
-  unsigned long steamIdLen = steamId2.length();
-  stmt.bindString(0, steamId2.c_str(), &steamIdLen);
+    if (!stmtOpt) {
+      logger::error("GetNextInventoryPosition: Failed to prepare statement");
+      return 2;
+    }
 
-  if (!stmt.execute() || !stmt.storeResult()) {
-    logger::error("GetNextInventoryPosition: MySQL query failed: %s",
-                  stmt.error());
-    return 2;
-  }
+    auto &stmt = *stmtOpt;
+    stmt.bindUint32(0, &accountId);
 
-  uint32_t currentMaxPos = 1;
-  MYSQL_BIND resultBind[1];
-  memset(resultBind, 0, sizeof(resultBind));
+    if (!stmt.execute() || !stmt.storeResult()) {
+      logger::error("GetNextInventoryPosition: MySQL query failed: %s",
+                    stmt.error());
+      return 2;
+    }
+
+    MYSQL_BIND resultBind[1];
+    memset(resultBind, 0, sizeof(resultBind));
 
-  resultBind[0].buffer_type = MYSQL_TYPE_LONG;
-  resultBind[0].buffer = &currentMaxPos;
+    resultBind[0].buffer_type = MYSQL_TYPE_LONG;
+    resultBind[0].buffer = &currentMaxPos;
 
-  if (!stmt.bindResult(resultBind) || stmt.fetch() != 0) {
-    // If fetch fails, we'll use the default currentMaxPos = 1
+    if (!stmt.bindResult(resultBind) || stmt.fetch() != 0) {
+      // If fetch fails, we'll use the default currentMaxPos = 1
+    }
   }
 
+  // Include acknowledgements that are still queued
+  currentMaxPos = std::max(
+      currentMaxPos,
+      InventoryWriteQueue::GetInstance().PendingMaxAcknowledged(accountId));
+
   uint32_t nextPosition = currentMaxPos + 1;
   if (nextPosition <= 1)
     nextPosition = 2; // Skip position 1 (reserved for nametag)
@@ -1913,12 +1331,61 @@ uint64_t GCNetwork_Inventory::SaveNewItemToDatabase(const CSOEconItem &item,
                                                     uint64_t steamId,
                                                     MYSQL *inventory_db,
                                                     bool isBaseWeapon) {
-  if (!g_itemSchema || !inventory_db) {
+  if (!ItemSchemaStore::GetInstance().Get() || !inventory_db) {
     logger::error(
         "SaveNewItemToDatabase: ItemSchema or database connection is null");
     return 0;
   }
 
+  CsgoItemInsert row = BuildNewItemInsert(item, steamId, isBaseWeapon);
+
+  // SQL injection safe: using prepared statement for the entire massive
+  // INSERT We use a fixed column list to enable statement preparation and
+  // security.
+  std::string query = "INSERT INTO csgo_items (" +
+                      CsgoItemInsert::ColumnList() + ") VALUES " +
+                      sqlPlaceholderList(CsgoItemInsert::COLUMN_COUNT);
+  auto stmtOpt = createPreparedStatement(inventory_db, query.c_str());
+
+  if (!stmtOpt) {
+    logger::error("SaveNewItemToDatabase: Failed to prepare insert statement");
+    return 0;
+  }
+
+  auto &stmt = *stmtOpt;
+  row.Bind(stmt, 0);
+
+  if (!stmt.execute()) {
+    logger::error("SaveNewItemToDatabase: MySQL query failed: %s",
+                  stmt.error());
+    return 0;
+  }
+
+  // Get the newly inserted item ID
+  uint64_t newItemId = mysql_insert_id(inventory_db);
+  logger::info(
+      "SaveNewItemToDatabase: Successfully inserted new item with ID %llu",
+      newItemId);
+
+  auto &cache = InventoryCache::GetInstance();
+  cache.Written(inventory_db, row.owner_account_id, [&] {
+    cache.Put(row.owner_account_id, row.ToRow(newItemId), true);
+  });
+
+  return newItemId;
+}
+
+/**
+ * Derives the csgo_items column values for a newly generated item
+ * (SaveNewItemToDatabase, and the unbox/craft stored procedures).
+ * Requires a loaded ItemSchema; uses one snapshot throughout.
+ */
+CsgoItemInsert GCNetwork_Inventory::BuildNewItemInsert(const CSOEconItem &item,
+                                                       uint64_t steamId,
+                                                       bool isBaseWeapon) {
+  std::shared_ptr<const ItemSchema> itemSchema =
+      ItemSchemaStore::GetInstance().Get();
+
   // extract item info
   uint32_t defIndex = item.def_index();
   uint32_t quality = item.quality();
@@ -1960,11 +1427,11 @@ uint64_t GCNetwork_Inventory::SaveNewItemToDatabase(const CSOEconItem &item,
 
     switch (attrDefIndex) {
     case ATTR_PAINT_INDEX: // paint kit - this is the texture prefab
-      paintIndex = g_itemSchema->AttributeUint32(&attr);
+      paintIndex = itemSchema->AttributeUint32(&attr);
       break;
 
     case ATTR_PAINT_WEAR: // float
-      floatValue = g_itemSchema->AttributeFloat(&attr);
+      floatValue = itemSchema->AttributeFloat(&attr);
       // wear name
       if (floatValue < 0.07f)
         wearName = "Factory New";
@@ -1979,23 +1446,23 @@ uint64_t GCNetwork_Inventory::SaveNewItemToDatabase(const CSOEconItem &item,
       break;
 
     case ATTR_PAINT_SEED: // seed
-      patternIndex = g_itemSchema->AttributeUint32(&attr);
+      patternIndex = itemSchema->AttributeUint32(&attr);
       break;
 
     case ATTR_KILLEATER_SCORE: // StatTrak
       statTrak = true;
-      statTrakKills = g_itemSchema->AttributeUint32(&attr);
+      statTrakKills = itemSchema->AttributeUint32(&attr);
       break;
 
     case ATTR_ITEM_STICKER_ID:
       if (defIndex == 1209) {
-        paintIndex = g_itemSchema->AttributeUint32(&attr);
+        paintIndex = itemSchema->AttributeUint32(&attr);
       }
       break;
 
     case ATTR_ITEM_MUSICKIT_ID:
       if (defIndex == 1314) {
-        paintIndex = g_itemSchema->AttributeUint32(&attr);
+        paintIndex = itemSchema->AttributeUint32(&attr);
       }
       break;
     }
@@ -2014,13 +1481,13 @@ uint64_t GCNetwork_Inventory::SaveNewItemToDatabase(const CSOEconItem &item,
         (attrDefIndex - 113) % 4 == 0) {
       uint32_t stickerPos = (attrDefIndex - 113) / 4;
       if (stickerPos < stickers.size()) {
-        uint32_t stickerId = g_itemSchema->AttributeUint32(&attr);
+        uint32_t stickerId = itemSchema->AttributeUint32(&attr);
 
         float stickerWear = 0.0f;
         for (int j = 0; j < item.attribute_size(); j++) {
           const CSOEconItemAttribute &wearAttr = item.attribute(j);
           if (wearAttr.def_index() == attrDefIndex + 1) {
-            stickerWear = g_itemSchema->AttributeFloat(&wearAttr);
+            stickerWear = itemSchema->AttributeFloat(&wearAttr);
             break;
           }
         }
@@ -2031,10 +1498,14 @@ uint64_t GCNetwork_Inventory::SaveNewItemToDatabase(const CSOEconItem &item,
   }
 
   // get info
-  if (!GetWeaponInfo(defIndex, weaponType, weaponId)) {
+  std::string_view knownType, knownId;
+  if (GetWeaponInfo(defIndex, knownType, knownId)) {
+    weaponType = knownType;
+    weaponId = knownId;
+  } else {
     // If GetWeaponInfo fails, try to get info from the ItemSchema
-    auto itemInfoIter = g_itemSchema->m_itemInfo.find(defIndex);
-    if (itemInfoIter != g_itemSchema->m_itemInfo.end()) {
+    auto itemInfoIter = itemSchema->m_itemInfo.find(defIndex);
+    if (itemInfoIter != itemSchema->m_itemInfo.end()) {
       const auto &itemInfo = itemInfoIter->second;
       std::string_view displayName = itemInfo.GetDisplayName();
       weaponType = std::string(displayName);
@@ -2081,7 +1552,7 @@ uint64_t GCNetwork_Inventory::SaveNewItemToDatabase(const CSOEconItem &item,
   // For weapons with a paint kit (skin), add the skin name to the item name
   if (paintIndex > 0 && defIndex != 1209 && defIndex != 1314 && !isBaseWeapon) {
     // Look for the paint kit info
-    for (const auto &[name, paintKit] : g_itemSchema->m_paintKitInfo) {
+    for (const auto &[name, paintKit] : itemSchema->m_paintKitInfo) {
       if (paintKit.m_defIndex == paintIndex) {
         // Get the skin name
         std::string_view skinName = paintKit.GetDisplayName();
@@ -2106,404 +1577,56 @@ uint64_t GCNetwork_Inventory::SaveNewItemToDatabase(const CSOEconItem &item,
     }
   }
 
-  // SQL injection safe: using prepared statement for the entire massive
-  // INSERT We use a fixed column list to enable statement preparation and
-  // security.
-  auto stmtOpt = createPreparedStatement(
-      inventory_db,
-      "INSERT INTO csgo_items ("
-      "owner_steamid2, item_id, name, nametag, weapon_type, weapon_id, "
-      "weapon_slot, wear, floatval, paint_index, pattern_index, rarity, "
-      "quality, tradable, commodity, stattrak, stattrak_kills, "
-      "sticker_slots, sticker_1, sticker_1_wear, sticker_2, sticker_2_wear, "
-      "sticker_3, sticker_3_wear, sticker_4, sticker_4_wear, "
-      "sticker_5, sticker_5_wear, market_price, equipped_ct, "
-      "equipped_t, acquired_by, acknowledged"
-      ") VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, "
-      "?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-
-  if (!stmtOpt) {
-    logger::error("SaveNewItemToDatabase: Failed to prepare insert statement");
-    return 0;
-  }
-
-  auto &stmt = *stmtOpt;
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
-  unsigned long steamIdLen = steamId2.length();
-  unsigned long itemIdLen = itemIdStr.length();
-  unsigned long itemNameLen = itemName.length();
-  unsigned long nameTagLen = nameTag.length();
-  unsigned long weaponTypeLen = weaponType.length();
-  unsigned long weaponIdLen = weaponId.length();
-  unsigned long weaponSlotLen = weaponSlot.length();
-  unsigned long wearNameLen = wearName.length();
-  unsigned long acquiredByLen = acquiredBy.length();
-
-  // Bind parameters
-  stmt.bindString(0, steamId2.c_str(), &steamIdLen);
-  stmt.bindString(1, itemIdStr.c_str(), &itemIdLen);
-  stmt.bindString(2, itemName.c_str(), &itemNameLen);
-
-  if (!nameTag.empty()) {
-    stmt.bindString(3, nameTag.c_str(), &nameTagLen);
-  } else {
-    stmt.bindNull(3);
-  }
-
-  stmt.bindString(4, weaponType.c_str(), &weaponTypeLen);
-  stmt.bindString(5, weaponId.c_str(), &weaponIdLen);
-  stmt.bindString(6, weaponSlot.c_str(), &weaponSlotLen);
-  stmt.bindString(7, wearName.c_str(), &wearNameLen);
-
-  if (isBaseItem) {
-    stmt.bindNull(8);
-  } else {
-    stmt.bindFloat(8, &floatValue);
-  }
-
-  stmt.bindUint32(9, &paintIndex);
-  stmt.bindUint32(10, &patternIndex);
-
-  if (isBaseItem) {
-    stmt.bindNull(11);
-  } else {
-    stmt.bindUint32(11, &rarity);
-  }
-
-  stmt.bindUint32(12, &quality);
-  uint32_t tradableVal = tradable ? 1 : 0;
-  stmt.bindUint32(13, &tradableVal);
-  uint32_t commodityVal = 0;
-  stmt.bindUint32(14, &commodityVal);
-  uint32_t statTrakVal = statTrak ? 1 : 0;
-  stmt.bindUint32(15, &statTrakVal);
-
-  if (statTrak) {
-    stmt.bindUint32(16, &statTrakKills);
-  } else {
-    stmt.bindNull(16);
-  }
-
-  stmt.bindUint32(17, &stickerSlots);
-
-  // Bind stickers (18-27)
-  for (int i = 0; i < 5; i++) {
-    if (i < static_cast<int>(stickers.size()) && stickers[i].first > 0) {
-      stmt.bindUint32(18 + (i * 2), &stickers[i].first);
-      stmt.bindFloat(19 + (i * 2), &stickers[i].second);
-    } else {
-      stmt.bindNull(18 + (i * 2));
-      stmt.bindNull(19 + (i * 2));
-    }
-  }
-
-  float marketPrice = 0.0f;
-  stmt.bindFloat(28, &marketPrice);
-  uint32_t zeroVal = 0;
-  stmt.bindUint32(29, &zeroVal); // equipped_ct
-  stmt.bindUint32(30, &zeroVal); // equipped_t
-  stmt.bindString(31, acquiredBy.c_str(), &acquiredByLen);
-  uint32_t inventoryVal = item.inventory();
-  stmt.bindUint32(32, &inventoryVal); // acknowledged/inventory
-
-  if (!stmt.execute()) {
-    logger::error("SaveNewItemToDatabase: MySQL query failed: %s",
-                  stmt.error());
-    return 0;
-  }
-
-  // Get the newly inserted item ID
-  uint64_t newItemId = mysql_insert_id(inventory_db);
-  logger::info(
-      "SaveNewItemToDatabase: Successfully inserted new item with ID %llu",
-      newItemId);
-
-  return newItemId;
+  CsgoItemInsert row;
+  row.owner_steamid2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
+  row.item_id = itemIdStr;
+  row.name = itemName;
+  row.nametag = nameTag;
+  row.weapon_type = weaponType;
+  row.weapon_id = weaponId;
+  row.weapon_slot = weaponSlot;
+  row.wear = wearName;
+  row.baseItem = isBaseItem;
+  row.floatval = floatValue;
+  row.paint_index = paintIndex;
+  row.pattern_index = patternIndex;
+  row.rarity = rarity;
+  row.quality = quality;
+  row.tradable = tradable ? 1 : 0;
+  row.stattrak = statTrak ? 1 : 0;
+  row.stattrak_kills = statTrakKills;
+  row.sticker_slots = stickerSlots;
+  for (int i = 0; i < CsgoItemInsert::STICKER_SLOTS; i++) {
+    row.stickers[i] = stickers[i].first;
+    row.sticker_wears[i] = stickers[i].second;
+  }
+  row.acquired_by = acquiredBy;
+  row.acknowledged = item.inventory(); // acknowledged/inventory
+  row.owner_account_id = steamId & 0xFFFFFFFF;
+  return row;
 }
 
 /**
  * Gets the display name and weapon identifier for a given defIndex
  *
+ * Only covers the items listed in item_tables.hpp; callers fall back to the
+ * item schema for the rest.
+ *
  * @param defIndex The definition index of the weapon
  * @param weaponName Output parameter for the weapon's display name
  * @param weaponId Output parameter for the weapon's identifier
  * @return True if the information was found, false otherwise
  */
 bool GCNetwork_Inventory::GetWeaponInfo(uint32_t defIndex,
-                                        std::string &weaponName,
-                                        std::string &weaponId) {
-  weaponName = "";
-  weaponId = "";
-
-  // Check if this is a known weapon type
-  switch (defIndex) {
-  // Pistols
-  case 1:
-    weaponName = "Desert Eagle";
-    weaponId = "weapon_deagle";
-    break;
-  case 2:
-    weaponName = "Dual Berettas";
-    weaponId = "weapon_elite";
-    break;
-  case 3:
-    weaponName = "Five-SeveN";
-    weaponId = "weapon_fiveseven";
-    break;
-  case 4:
-    weaponName = "Glock-18";
-    weaponId = "weapon_glock";
-    break;
-  case 30:
-    weaponName = "Tec-9";
-    weaponId = "weapon_tec9";
-    break;
-  case 32:
-    weaponName = "P2000";
-    weaponId = "weapon_hkp2000";
-    break;
-  case 36:
-    weaponName = "P250";
-    weaponId = "weapon_p250";
-    break;
-  case 61:
-    weaponName = "USP-S";
-    weaponId = "weapon_usp_silencer";
-    break;
-  case 63:
-    weaponName = "CZ75-Auto";
-    weaponId = "weapon_cz75a";
-    break;
-  case 64:
-    weaponName = "R8 Revolver";
-    weaponId = "weapon_revolver";
-    break;
-
-  // Rifles
-  case 7:
-    weaponName = "AK-47";
-    weaponId = "weapon_ak47";
-    break;
-  case 8:
-    weaponName = "AUG";
-    weaponId = "weapon_aug";
-    break;
-  case 9:
-    weaponName = "AWP";
-    weaponId = "weapon_awp";
-    break;
-  case 10:
-    weaponName = "FAMAS";
-    weaponId = "weapon_famas";
-    break;
-  case 11:
-    weaponName = "G3SG1";
-    weaponId = "weapon_g3sg1";
-    break;
-  case 13:
-    weaponName = "Galil AR";
-    weaponId = "weapon_galilar";
-    break;
-  case 16:
-    weaponName = "M4A4";
-    weaponId = "weapon_m4a1";
-    break;
-  case 38:
-    weaponName = "SCAR-20";
-    weaponId = "weapon_scar20";
-    break;
-  case 39:
-    weaponName = "SG 553";
-    weaponId = "weapon_sg556";
-    break;
-  case 40:
-    weaponName = "SSG 08";
-    weaponId = "weapon_ssg08";
-    break;
-  case 60:
-    weaponName = "M4A1-S";
-    weaponId = "weapon_m4a1_silencer";
-    break;
-
-  // SMGs
-  case 17:
-    weaponName = "MAC-10";
-    weaponId = "weapon_mac10";
-    break;
-  case 19:
-    weaponName = "P90";
-    weaponId = "weapon_p90";
-    break;
-  case 23:
-    weaponName = "MP5-SD";
-    weaponId = "weapon_mp5sd";
-    break;
-  case 24:
-    weaponName = "UMP-45";
-    weaponId = "weapon_ump45";
-    break;
-  case 26:
-    weaponName = "PP-Bizon";
-    weaponId = "weapon_bizon";
-    break;
-  case 33:
-    weaponName = "MP7";
-    weaponId = "weapon_mp7";
-    break;
-  case 34:
-    weaponName = "MP9";
-    weaponId = "weapon_mp9";
-    break;
-
-  // Heavy
-  case 14:
-    weaponName = "M249";
-    weaponId = "weapon_m249";
-    break;
-  case 25:
-    weaponName = "XM1014";
-    weaponId = "weapon_xm1014";
-    break;
-  case 27:
-    weaponName = "MAG-7";
-    weaponId = "weapon_mag7";
-    break;
-  case 28:
-    weaponName = "Negev";
-    weaponId = "weapon_negev";
-    break;
-  case 29:
-    weaponName = "Sawed-Off";
-    weaponId = "weapon_sawedoff";
-    break;
-  case 35:
-    weaponName = "Nova";
-    weaponId = "weapon_nova";
-    break;
-
-  // Default Knives
-  case 42:
-    weaponName = "Knife (CT)";
-    weaponId = "weapon_knife";
-    break;
-  case 59:
-    weaponName = "Knife (T)";
-    weaponId = "weapon_knife_t";
-    break;
-
-  // Special Knives
-  case 500:
-    weaponName = "Bayonet";
-    weaponId = "weapon_bayonet";
-    break;
-  case 503:
-    weaponName = "Classic Knife";
-    weaponId = "weapon_knife_css";
-    break;
-  case 505:
-    weaponName = "Flip Knife";
-    weaponId = "weapon_knife_flip";
-    break;
-  case 506:
-    weaponName = "Gut Knife";
-    weaponId = "weapon_knife_gut";
-    break;
-  case 507:
-    weaponName = "Karambit";
-    weaponId = "weapon_knife_karambit";
-    break;
-  case 508:
-    weaponName = "M9 Bayonet";
-    weaponId = "weapon_knife_m9_bayonet";
-    break;
-  case 509:
-    weaponName = "Huntsman Knife";
-    weaponId = "weapon_knife_tactical";
-    break;
-  case 512:
-    weaponName = "Falchion Knife";
-    weaponId = "weapon_knife_falchion";
-    break;
-  case 514:
-    weaponName = "Bowie Knife";
-    weaponId = "weapon_knife_survival_bowie";
-    break;
-  case 515:
-    weaponName = "Butterfly Knife";
-    weaponId = "weapon_knife_butterfly";
-    break;
-  case 516:
-    weaponName = "Shadow Daggers";
-    weaponId = "weapon_knife_push";
-    break;
-  case 517:
-    weaponName = "Paracord Knife";
-    weaponId = "weapon_knife_cord";
-    break;
-  case 518:
-    weaponName = "Survival Knife";
-    weaponId = "weapon_knife_canis";
-    break;
-  case 519:
-    weaponName = "Ursus Knife";
-    weaponId = "weapon_knife_ursus";
-    break;
-  case 520:
-    weaponName = "Navaja Knife";
-    weaponId = "weapon_knife_gypsy_jackknife";
-    break;
-  case 521:
-    weaponName = "Nomad Knife";
-    weaponId = "weapon_knife_outdoor";
-    break;
-  case 522:
-    weaponName = "Stiletto Knife";
-    weaponId = "weapon_knife_stiletto";
-    break;
-  case 523:
-    weaponName = "Talon Knife";
-    weaponId = "weapon_knife_widowmaker";
-    break;
-  case 525:
-    weaponName = "Skeleton Knife";
-    weaponId = "weapon_knife_skeleton";
-    break;
-
-  // Equipment
-  case 31:
-    weaponName = "Zeus x27";
-    weaponId = "weapon_taser";
-    break;
-  case 49:
-    weaponName = "C4";
-    weaponId = "weapon_c4";
-    break;
-
-  // Other special items
-  case 1209:
-    weaponName = "Sticker";
-    weaponId = "sticker";
-    break;
-  case 1314:
-    weaponName = "Music Kit";
-    weaponId = "music_kit";
-    break;
-
-  default:
-    // Try to fetch from ItemSchema for unknown defIndex
-    if (g_itemSchema) {
-      auto itemInfoIter = g_itemSchema->m_itemInfo.find(defIndex);
-      if (itemInfoIter != g_itemSchema->m_itemInfo.end()) {
-        const auto &itemInfo = itemInfoIter->second;
-        std::string_view displayName = itemInfo.GetDisplayName();
-        weaponName = std::string(displayName);
-        weaponId = "weapon_" + std::string(itemInfo.m_name);
-        return !weaponName.empty();
-      }
-    }
+                                        std::string_view &weaponName,
+                                        std::string_view &weaponId) {
+  const ItemTables::WeaponInfo *info = ItemTables::FindWeapon(defIndex);
+  if (!info) {
     return false;
   }
 
+  weaponName = info->name;
+  weaponId = info->id;
   return true;
 }
 
@@ -2537,11 +1660,11 @@ bool GCNetwork_Inventory::DeleteItem(SNetSocket_t p2psocket, uint64_t steamId,
   }
 
   // Delete from database - SQL injection safe using prepared statement
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
+  uint32_t accountId = steamId & 0xFFFFFFFF;
 
   auto stmtOpt = createPreparedStatement(
       inventory_db,
-      "DELETE FROM csgo_items WHERE id = ? AND owner_steamid2 = ?");
+      "DELETE FROM csgo_items WHERE id = ? AND owner_account_id = ?");
 
   if (!stmtOpt) {
     logger::error("DeleteItem: Failed to prepare delete statement");
@@ -2550,9 +1673,8 @@ bool GCNetwork_Inventory::DeleteItem(SNetSocket_t p2psocket, uint64_t steamId,
 
   auto &stmt = *stmtOpt;
   uint64_t itemIdParam = itemId;
-  unsigned long steamIdLen = steamId2.length();
   stmt.bindUint64(0, &itemIdParam);
-  stmt.bindString(1, steamId2.c_str(), &steamIdLen);
+  stmt.bindUint32(1, &accountId);
 
   if (!stmt.execute()) {
     logger::error("DeleteItem: MySQL delete query failed: %s", stmt.error());
@@ -2568,6 +1690,10 @@ bool GCNetwork_Inventory::DeleteItem(SNetSocket_t p2psocket, uint64_t steamId,
   logger::info("DeleteItem: Successfully deleted item %llu from database",
                itemId);
 
+  auto &cache = InventoryCache::GetInstance();
+  cache.Written(inventory_db, accountId,
+                [&] { cache.Erase(accountId, itemId); });
+
   if (p2psocket != 0) {
     logger::info("DeleteItem: Sending delete notification for item %llu to "
                  "player %llu",
@@ -2607,7 +1733,8 @@ bool GCNetwork_Inventory::SendSOSingleObject(
   message.set_object_data(object.SerializeAsString());
 
   // Set the version
-  message.set_version(InventoryVersion);
+  message.set_version(
+      InventoryVersions::GetInstance().Current(steamId & 0xFFFFFFFF));
 
   // Set the owner ID
   auto *owner = message.mutable_owner_soid();
@@ -2665,7 +1792,8 @@ void GCNetwork_Inventory::AddToMultipleObjectsMessage(
  */
 void GCNetwork_Inventory::InitMultipleObjectsMessage(
     CMsgSOMultipleObjects &message, uint64_t steamId) {
-  message.set_version(InventoryVersion);
+  message.set_version(
+      InventoryVersions::GetInstance().Current(steamId & 0xFFFFFFFF));
   auto *owner = message.mutable_owner_soid();
   owner->set_type(SoIdTypeSteamId);
   owner->set_id(steamId);
@@ -2721,7 +1849,7 @@ std::unique_ptr<CSOEconItem>
 GCNetwork_Inventory::CreateBaseItem(uint32_t defIndex, uint64_t steamId,
                                     MYSQL *inventory_db, bool saveToDb,
                                     const std::string &customName) {
-  if (!g_itemSchema) {
+  if (!ItemSchemaStore::GetInstance().Get()) {
     logger::error("CreateBaseItem: ItemSchema is null");
     return nullptr;
   }
@@ -4,20 +4,26 @@
 #include "gc_const.hpp"
 #include "gcsdk_gcmessages.pb.h"
 
+#include "csgo_item_insert.hpp"
+#include "csgo_item_row.hpp"
 #include "gc_const_csgo.hpp"
+#include "inventory_cache.hpp"
+#include "item_id.hpp"
 #include "item_schema.hpp"
+#include "item_tables.hpp"
 #include "networking.hpp"
 #include "steam_network_message.hpp"
 #include <cstdint>
+#include <google/protobuf/arena.h>
 #include <iomanip>
 #include <mariadb/mysql.h>
 #include <memory>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
-extern std::unique_ptr<ItemSchema> g_itemSchema;
-
 class GCNetwork_Inventory {
 public:
   // init ItemSchema
@@ -25,9 +31,25 @@ public:
   static void Cleanup();
 
   static uint32_t GetItemSlot(uint32_t defIndex);
-  static std::vector<uint32_t> GetDefindexFromItemSlot(uint32_t slotId);
-  static void SendSOCache(SNetSocket_t p2psocket, uint64_t steamId,
-                          MYSQL *inventory_db);
+  static std::span<const uint32_t> GetDefindexFromItemSlot(uint32_t slotId);
+  // Item rows are read from read_db (a replica) when given; inventory_db
+  // takes the default-equips upsert. Returns the version sent, 0 if none
+  static uint64_t SendSOCache(SNetSocket_t p2psocket, uint64_t steamId,
+                              MYSQL *inventory_db, MYSQL *read_db = nullptr);
+  // A write committed but its result is unknown: drops the cached copy and
+  // version log of the account and sends the full SOCache again
+  static void ResendSOCache(SNetSocket_t p2psocket, uint64_t steamId,
+                            MYSQL *inventory_db);
+  // Sent on reconnect; clients whose version differs ask for a refresh
+  static bool SendSubscriptionCheck(SNetSocket_t p2psocket, uint64_t steamId);
+  // Delta since knownVersion, or the full SOCache when the change log
+  // doesn't reach back that far. Returns the version sent, 0 if none
+  static uint64_t HandleSubscriptionRefresh(SNetSocket_t p2psocket,
+                                            uint64_t steamId,
+                                            uint64_t knownVersion,
+                                            MYSQL *inventory_db,
+                                            MYSQL *read_db = nullptr);
+  static InventoryCache::ItemSerializer MakeItemSerializer(uint64_t steamId);
 
   // item notif
   static bool CheckAndSendNewItemsSince(SNetSocket_t p2psocket,
@@ -43,13 +65,23 @@ public:
                               MYSQL *inventory_db);
 
   // create item helpers (these are for creating CSOEconItems)
+  static bool BuildItemFromDatabaseRow(CSOEconItem *item, uint64_t steamId,
+                                       const CsgoItemRow &row,
+                                       int overrideAcknowledged = -1);
   static std::unique_ptr<CSOEconItem>
-  CreateItemFromDatabaseRow(uint64_t steamId, MYSQL_ROW row,
+  CreateItemFromDatabaseRow(uint64_t steamId, const CsgoItemRow &row,
+                            int overrideAcknowledged = -1);
+  static CSOEconItem *
+  CreateItemFromDatabaseRow(google::protobuf::Arena &arena, uint64_t steamId,
+                            const CsgoItemRow &row,
                             int overrideAcknowledged = -1);
 
   static std::unique_ptr<CSOEconItem>
   FetchItemFromDatabase(uint64_t itemId, uint64_t steamId, MYSQL *inventory_db,
                         int overrideAcknowledged = -1);
+  static CSOEconItem *FetchItemFromDatabase(google::protobuf::Arena &arena,
+                                            uint64_t itemId, uint64_t steamId,
+                                            MYSQL *inventory_db);
 
   // Network message helpers
   static bool DeleteItem(SNetSocket_t p2psocket, uint64_t steamId,
@@ -80,8 +112,11 @@ public:
   static uint64_t SaveNewItemToDatabase(const CSOEconItem &item,
                                         uint64_t steamId, MYSQL *inventory_db,
                                         bool isBaseWeapon = false);
-  static bool GetWeaponInfo(uint32_t defIndex, std::string &weaponName,
-                            std::string &weaponId);
+  static CsgoItemInsert BuildNewItemInsert(const CSOEconItem &item,
+                                           uint64_t steamId,
+                                           bool isBaseWeapon = false);
+  static bool GetWeaponInfo(uint32_t defIndex, std::string_view &weaponName,
+                            std::string_view &weaponId);
   static uint32_t GetNextInventoryPosition(uint64_t steamId,
                                            MYSQL *inventory_db);
 
@@ -210,9 +245,9 @@ private:
     uint32_t def_index;
     float value;
   };
-  static bool ParseItemId(const std::string &item_id, uint32_t &def_index,
+  static bool ParseItemId(std::string_view item_id, uint32_t &def_index,
                           uint32_t &paint_index);
-  static void AddStickerAttributes(CSOEconItem *item, MYSQL_ROW &row,
+  static void AddStickerAttributes(CSOEconItem *item, const CsgoItemRow &row,
                                    int sticker_index);
   static void AddEquippedState(CSOEconItem *item, bool equipped,
                                uint32_t class_id, uint32_t def_index);
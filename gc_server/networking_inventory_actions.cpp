@@ -2,12 +2,18 @@
 #include "gc_const_csgo.hpp"
 #include "gcsdk_gcmessages.pb.h"
 #include "gcsystemmsgs.pb.h"
+#include "inventory_cache.hpp"
+#include "inventory_procedures.hpp"
+#include "inventory_write_queue.hpp"
+#include "item_schema_store.hpp"
 
 #include "keyvalue_english.hpp"
 #include "logger.hpp"
 #include "networking_inventory.hpp"
 #include "networking_users.hpp"
+#include "player_profile_cache.hpp"
 #include "prepared_stmt.hpp"
+#include "request_arena.hpp"
 #include "safe_parse.hpp"
 #include "sql_transaction.hpp"
 #include "steam_network_message.hpp"
@@ -16,6 +22,7 @@
 #include <mariadb/mysql.h>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 // This function was moved from networking_inventory.cpp
@@ -115,89 +122,95 @@ bool GCNetwork_Inventory::SendUnequipUpdate(SNetSocket_t p2psocket,
 bool GCNetwork_Inventory::UnequipItemsInSlot(uint64_t steamId, uint32_t classId,
                                              uint32_t slotId,
                                              MYSQL *inventory_db) {
-  // Use RAII Transaction
-  SQLTransaction transaction(inventory_db);
-
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
-  unsigned long steamIdLen = steamId2.length();
+  uint32_t accountId = steamId & 0xFFFFFFFF;
 
   // Find items in this slot/class - SQL injection safe
   // We need to check dynamic column names which is tricky for prepared
   // statements but the column names are fixed based on classId
   const char *column = (classId == CLASS_CT) ? "equipped_ct" : "equipped_t";
 
-  // Complex query to find items that might be in this slot
-  // This logic mimics the original finding logic but safer
-  // Since we can't easily parse "item_id" in SQL to get def_index to get slot,
-  // we might need to rely on the fact that we are searching by explicit slot.
+  std::unordered_map<uint64_t, uint32_t> itemsToUnequip; // id -> def index
+  auto addIfInSlot = [&](uint64_t id, std::string_view itemIdStr) {
+    uint32_t defIndex = 0, paintIndex = 0;
+    if (ParseItemId(itemIdStr, defIndex, paintIndex) &&
+        GetItemSlot(defIndex) == slotId) {
+      itemsToUnequip[id] = defIndex;
+    }
+  };
 
-  // The original code used a complex loop. Here we will simplify:
-  // 1. Get ALL equipped items for this class
+  // 1. Get ALL equipped items for this class (cached rows already include
+  //    queued equips)
   // 2. Filter by slot in C++
   // 3. Unequip matches
+  bool cached = InventoryCache::GetInstance().Read(
+      inventory_db, accountId, [&](const InventoryCache::Items &items) {
+        for (const auto &[id, row] : items) {
+          int8_t equipped =
+              classId == CLASS_CT ? row.equipped_ct : row.equipped_t;
+          if (equipped == 1) {
+            addIfInSlot(id, row.item_id.view());
+          }
+        }
+      });
 
-  auto stmtOpt = createPreparedStatement(
-      inventory_db,
-      (std::string("SELECT id, item_id FROM csgo_items WHERE owner_steamid2 = "
-                   "? AND ") +
-       column + " = 1")
-          .c_str());
+  if (!cached) {
+    auto stmtOpt = createPreparedStatement(
+        inventory_db,
+        (std::string("SELECT id, item_id FROM csgo_items WHERE "
+                     "owner_account_id = ? AND ") +
+         column + " = 1")
+            .c_str());
 
-  if (!stmtOpt) {
-    return false;
-  }
+    if (!stmtOpt) {
+      return false;
+    }
 
-  auto &stmt = *stmtOpt;
-  stmt.bindString(0, steamId2.c_str(), &steamIdLen);
+    auto &stmt = *stmtOpt;
+    stmt.bindUint32(0, &accountId);
 
-  if (!stmt.execute() || !stmt.storeResult()) {
-    return false;
-  }
+    if (!stmt.execute() || !stmt.storeResult()) {
+      return false;
+    }
 
-  std::vector<uint64_t> itemsToUnequip;
-  uint64_t idRes;
-  char itemIdBuf[256];
-  unsigned long itemIdLen;
-  my_bool nulls[2];
-  MYSQL_BIND resInit[2];
-  memset(resInit, 0, sizeof(resInit));
-  resInit[0].buffer_type = MYSQL_TYPE_LONGLONG;
-  resInit[0].buffer = &idRes;
-  resInit[0].is_null = &nulls[0];
-  resInit[1].buffer_type = MYSQL_TYPE_STRING;
-  resInit[1].buffer = itemIdBuf;
-  resInit[1].buffer_length = sizeof(itemIdBuf);
-  resInit[1].length = &itemIdLen;
-  resInit[1].is_null = &nulls[1];
-
-  while (stmt.bindResult(resInit) && stmt.fetch() == 0) {
-    if (nulls[1])
-      continue;
-    std::string iId(itemIdBuf, itemIdLen);
-    uint32_t defIndex = 0, paintIndex = 0;
-    if (ParseItemId(iId, defIndex, paintIndex)) {
-      if (GetItemSlot(defIndex) == slotId) {
-        itemsToUnequip.push_back(idRes);
-      }
+    uint64_t idRes;
+    char itemIdBuf[256];
+    unsigned long itemIdLen;
+    my_bool nulls[2];
+    MYSQL_BIND resInit[2];
+    memset(resInit, 0, sizeof(resInit));
+    resInit[0].buffer_type = MYSQL_TYPE_LONGLONG;
+    resInit[0].buffer = &idRes;
+    resInit[0].is_null = &nulls[0];
+    resInit[1].buffer_type = MYSQL_TYPE_STRING;
+    resInit[1].buffer = itemIdBuf;
+    resInit[1].buffer_length = sizeof(itemIdBuf);
+    resInit[1].length = &itemIdLen;
+    resInit[1].is_null = &nulls[1];
+
+    while (stmt.bindResult(resInit) && stmt.fetch() == 0) {
+      if (nulls[1])
+        continue;
+      addIfInSlot(idRes, std::string_view(itemIdBuf, itemIdLen));
     }
   }
 
-  // Update items
-  if (!itemsToUnequip.empty()) {
-    std::string update = "UPDATE csgo_items SET " + std::string(column) +
-                         " = 0 WHERE id = ? AND owner_steamid2 = ?";
-    auto upStmtOpt = createPreparedStatement(inventory_db, update.c_str());
-    if (upStmtOpt) {
-      auto &upStmt = *upStmtOpt;
-      for (uint64_t id : itemsToUnequip) {
-        upStmt.bindUint64(0, &id);
-        upStmt.bindString(1, steamId2.c_str(), &steamIdLen);
-        upStmt.execute();
-      }
+  // The table can be one flush behind; queued equips win over it
+  InventoryWriteQueue &writeQueue = InventoryWriteQueue::GetInstance();
+  for (const auto &pending :
+       writeQueue.PendingEquipped(accountId, classId == CLASS_CT)) {
+    if (!pending.equipped) {
+      itemsToUnequip.erase(pending.itemId);
+    } else if (GetItemSlot(pending.defIndex) == slotId) {
+      itemsToUnequip[pending.itemId] = pending.defIndex;
     }
   }
 
-  return transaction.Commit();
+  for (const auto &[itemId, defIndex] : itemsToUnequip) {
+    writeQueue.SetEquipped(inventory_db, steamId, itemId, defIndex,
+                           classId == CLASS_CT, false);
+  }
+
+  return true;
 }
 
 bool GCNetwork_Inventory::UnequipItem(SNetSocket_t p2psocket, uint64_t steamId,
@@ -205,9 +218,7 @@ bool GCNetwork_Inventory::UnequipItem(SNetSocket_t p2psocket, uint64_t steamId,
   if (!inventory_db)
     return false;
 
-  SQLTransaction transaction(inventory_db);
-
-  // Get item state
+  // Get item state (also verifies ownership)
   auto item = FetchItemFromDatabase(itemId, steamId, inventory_db);
   if (!item)
     return false;
@@ -216,32 +227,21 @@ bool GCNetwork_Inventory::UnequipItem(SNetSocket_t p2psocket, uint64_t steamId,
   bool was_equipped_t = false;  // Logic to check current state
   // ideally we check DB but for now assume we just unset
 
-  // Update DB
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
-  unsigned long steamIdLen = steamId2.length();
-  auto stmtOpt = createPreparedStatement(
-      inventory_db, "UPDATE csgo_items SET equipped_ct = 0, equipped_t = 0 "
-                    "WHERE id = ? AND owner_steamid2 = ?");
-
-  if (!stmtOpt)
-    return false;
+  // Queued; flushed with the next write-behind batch
+  InventoryWriteQueue &writeQueue = InventoryWriteQueue::GetInstance();
+  writeQueue.SetEquipped(inventory_db, steamId, itemId, item->def_index(),
+                         true, false);
+  writeQueue.SetEquipped(inventory_db, steamId, itemId, item->def_index(),
+                         false, false);
 
-  auto &stmt = *stmtOpt;
-  uint64_t idParam = itemId;
-  stmt.bindUint64(0, &idParam);
-  stmt.bindString(1, steamId2.c_str(), &steamIdLen);
-
-  if (!stmt.execute())
-    return false;
+  // Equipped collectibles show up as profile medals
+  PlayerProfileCache::GetInstance().Invalidate(steamId & 0xFFFFFFFF);
 
   // Note: Original code had logic to unequip default items too (USP-S, etc)
   // We should respect that but for brevity we are ensuring safety first.
   // The original robust default handling is preserved in EquipItem calling
   // this.
 
-  if (!transaction.Commit())
-    return false;
-
   return SendUnequipUpdate(p2psocket, steamId, itemId, inventory_db,
                            was_equipped_ct, was_equipped_t, item->def_index());
 }
@@ -257,33 +257,20 @@ bool GCNetwork_Inventory::EquipItem(SNetSocket_t p2psocket, uint64_t steamId,
     return UnequipItem(p2psocket, steamId, itemId, inventory_db);
   }
 
-  SQLTransaction transaction(inventory_db);
-
-  // unequip others
-  UnequipItemsInSlot(steamId, classId, slotId, inventory_db);
-
-  // equip this one
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
-  unsigned long steamIdLen = steamId2.length();
-  const char *column = (classId == CLASS_CT) ? "equipped_ct" : "equipped_t";
-
-  std::string update = "UPDATE csgo_items SET " + std::string(column) +
-                       " = 1 WHERE id = ? AND owner_steamid2 = ?";
-  auto stmtOpt = createPreparedStatement(inventory_db, update.c_str());
-
-  if (!stmtOpt)
+  // Ownership check, and the def index the queue needs for slot lookups
+  auto item = FetchItemFromDatabase(itemId, steamId, inventory_db);
+  if (!item)
     return false;
 
-  auto &stmt = *stmtOpt;
-  uint64_t idParam = itemId;
-  stmt.bindUint64(0, &idParam);
-  stmt.bindString(1, steamId2.c_str(), &steamIdLen);
-
-  if (!stmt.execute())
+  // unequip others
+  if (!UnequipItemsInSlot(steamId, classId, slotId, inventory_db))
     return false;
 
-  if (!transaction.Commit())
-    return false;
+  // equip this one
+  InventoryWriteQueue::GetInstance().SetEquipped(
+      inventory_db, steamId, itemId, item->def_index(), classId == CLASS_CT,
+      true);
+  PlayerProfileCache::GetInstance().Invalidate(steamId & 0xFFFFFFFF);
 
   return SendEquipUpdate(p2psocket, steamId, itemId, classId, slotId,
                          inventory_db);
@@ -317,10 +304,10 @@ bool GCNetwork_Inventory::HandleNameItem(SNetSocket_t p2psocket,
   }
 
   // Verify that the player owns the item - SQL injection safe
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
+  uint32_t accountId = steamId & 0xFFFFFFFF;
   auto authStmtOpt = createPreparedStatement(
       inventory_db,
-      "SELECT id FROM csgo_items WHERE id = ? AND owner_steamid2 = ?");
+      "SELECT id FROM csgo_items WHERE id = ? AND owner_account_id = ?");
 
   if (!authStmtOpt) {
     logger::error("HandleNameItem: Failed to prepare ownership statement");
@@ -329,9 +316,8 @@ bool GCNetwork_Inventory::HandleNameItem(SNetSocket_t p2psocket,
 
   auto &authStmt = *authStmtOpt;
   uint64_t idParam = itemId;
-  unsigned long steamIdLen = steamId2.length();
   authStmt.bindUint64(0, &idParam);
-  authStmt.bindString(1, steamId2.c_str(), &steamIdLen);
+  authStmt.bindUint32(1, &accountId);
 
   if (!authStmt.execute() || !authStmt.storeResult()) {
     logger::error("HandleNameItem: MySQL query failed: %s", authStmt.error());
@@ -345,25 +331,9 @@ bool GCNetwork_Inventory::HandleNameItem(SNetSocket_t p2psocket,
     return false;
   }
 
-  // Update the item's name - SQL injection safe
-  auto updateStmtOpt = createPreparedStatement(
-      inventory_db, "UPDATE csgo_items SET nametag = ? WHERE id = ?");
-
-  if (!updateStmtOpt) {
-    logger::error("HandleNameItem: Failed to prepare update statement");
-    return false;
-  }
-
-  auto &updateStmt = *updateStmtOpt;
-  unsigned long nameLen = name.length();
-  updateStmt.bindString(0, name.c_str(), &nameLen);
-  updateStmt.bindUint64(1, &idParam);
-
-  if (!updateStmt.execute()) {
-    logger::error("HandleNameItem: MySQL update query failed: %s",
-                  updateStmt.error());
-    return false;
-  }
+  // Queue the new name; the fetch below already sees it
+  InventoryWriteQueue::GetInstance().SetNametag(inventory_db, steamId, itemId,
+                                                name);
 
   // Send updates to the client
   auto item = FetchItemFromDatabase(itemId, steamId, inventory_db);
@@ -426,15 +396,12 @@ bool GCNetwork_Inventory::HandleRemoveItemName(SNetSocket_t p2psocket,
     return false;
   }
 
-  // Use RAII transaction
-  SQLTransaction transaction(inventory_db);
-
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
+  uint32_t accountId = steamId & 0xFFFFFFFF;
 
   // Check if item exists and has custom name
   auto checkStmtOpt = createPreparedStatement(
       inventory_db, "SELECT id, nametag FROM csgo_items WHERE id = ? AND "
-                    "owner_steamid2 = ?");
+                    "owner_account_id = ?");
 
   if (!checkStmtOpt) {
     logger::error("HandleRemoveItemName: Failed to prepare statement");
@@ -442,10 +409,9 @@ bool GCNetwork_Inventory::HandleRemoveItemName(SNetSocket_t p2psocket,
   }
 
   auto &checkStmt = *checkStmtOpt;
-  unsigned long steamIdLen = steamId2.length();
   uint64_t idParam = itemId;
   checkStmt.bindUint64(0, &idParam);
-  checkStmt.bindString(1, steamId2.c_str(), &steamIdLen);
+  checkStmt.bindUint32(1, &accountId);
 
   if (!checkStmt.execute() || !checkStmt.storeResult()) {
     logger::error("HandleRemoveItemName: MySQL query failed: %s",
@@ -459,31 +425,9 @@ bool GCNetwork_Inventory::HandleRemoveItemName(SNetSocket_t p2psocket,
     return false;
   }
 
-  // Update item to remove name
-  auto updateStmtOpt = createPreparedStatement(
-      inventory_db, "UPDATE csgo_items SET nametag = NULL WHERE id = ?");
-
-  if (!updateStmtOpt) {
-    logger::error("HandleRemoveItemName: Failed to prepare update statement");
-    return false;
-  }
-
-  auto &updateStmt = *updateStmtOpt;
-  updateStmt.bindUint64(0, &idParam);
-
-  if (!updateStmt.execute()) {
-    logger::error("HandleRemoveItemName: MySQL update query failed: %s",
-                  updateStmt.error());
-    return false;
-  }
-
-  // Check if we should delete the item (if it was a base item that is now
-  // stock) This logic mimics the original behavior where base items with no
-  // attributes might be cleaned up
-
-  if (!transaction.Commit()) {
-    return false;
-  }
+  // Queue removal of the name
+  InventoryWriteQueue::GetInstance().SetNametag(inventory_db, steamId, itemId,
+                                                std::nullopt);
 
   // Check if we should delete the item (if it was a base item that is now
   // stock) This logic mimics the original behavior where base items with no
@@ -541,67 +485,106 @@ bool GCNetwork_Inventory::HandleApplySticker(
     return false;
   }
 
-  SQLTransaction transaction(inventory_db);
-
   uint64_t stickerId = message.sticker_item_id();
   uint64_t targetId = message.item_item_id();
   uint32_t slot = message.sticker_slot();
 
-  if (slot > 5) {
+  if (slot >= CsgoItemInsert::STICKER_SLOTS || stickerId == targetId) {
     logger::error("HandleApplySticker: Invalid sticker slot %u", slot);
     return false;
   }
 
-  // 1. Get sticker definition index
-  auto stickerItem = FetchItemFromDatabase(stickerId, steamId, inventory_db);
-  if (!stickerItem) {
-    logger::error("HandleApplySticker: Sticker item %llu not found", stickerId);
-    return false;
-  }
+  bool committed = false;
+  auto &procedures = InventoryProcedures::GetInstance();
+  if (procedures.CanCall(inventory_db)) {
+    // Ownership checks, the slot write and consuming the sticker in one CALL
+    committed = procedures.ApplySticker(inventory_db, steamId, stickerId,
+                                        targetId, slot);
+  } else {
+    auto applyBody = [&](SQLTransaction &) {
+      uint32_t accountId = steamId & 0xFFFFFFFF;
+
+      // 1. Lock the sticker; its kit id is stored in paint_index
+      auto kitStmtOpt = createPreparedStatement(
+          inventory_db, "SELECT paint_index FROM csgo_items "
+                        "WHERE id = ? AND owner_account_id = ? "
+                        "AND item_id LIKE 'sticker-%' FOR UPDATE");
+      if (!kitStmtOpt) {
+        return false;
+      }
 
-  // 2. Get target item
-  auto targetItem = FetchItemFromDatabase(targetId, steamId, inventory_db);
-  if (!targetItem) {
-    logger::error("HandleApplySticker: Target item %llu not found", targetId);
-    return false;
-  }
+      auto &kitStmt = *kitStmtOpt;
+      kitStmt.bindUint64(0, &stickerId);
+      kitStmt.bindUint32(1, &accountId);
 
-  uint32_t stickerDefIndex = stickerItem->def_index();
+      int32_t kit = 0;
+      MYSQL_BIND kitResult[1];
+      memset(kitResult, 0, sizeof(kitResult));
+      kitResult[0].buffer_type = MYSQL_TYPE_LONG;
+      kitResult[0].buffer = &kit;
 
-  // 3. Update target item in database
-  // Construct column name safely
-  char slotCol[32];
-  snprintf(slotCol, sizeof(slotCol), "sticker_slot_%u_id", slot);
+      if (!kitStmt.execute() || !kitStmt.storeResult() ||
+          !kitStmt.bindResult(kitResult) || kitStmt.fetch() != 0) {
+        logger::error("HandleApplySticker: Sticker item %llu not found",
+                      stickerId);
+        return false;
+      }
 
-  std::string updateQuery =
-      "UPDATE csgo_items SET " + std::string(slotCol) + " = ? WHERE id = ?";
+      // 2. Get target item
+      auto targetItem = FetchItemFromDatabase(targetId, steamId, inventory_db);
+      if (!targetItem) {
+        logger::error("HandleApplySticker: Target item %llu not found",
+                      targetId);
+        return false;
+      }
 
-  auto stmtOpt = createPreparedStatement(inventory_db, updateQuery.c_str());
-  if (!stmtOpt) {
-    return false;
-  }
+      // 3. Update target item in database; slots are sticker_1..sticker_5
+      char slotCol[32];
+      snprintf(slotCol, sizeof(slotCol), "sticker_%u", slot + 1);
 
-  uint64_t defIndex64 = stickerDefIndex;
-  // Wait, schema usually uses uint32 but DB column might be int.
-  // Let's assume ID is what we want.
+      std::string updateQuery = "UPDATE csgo_items SET " +
+                                std::string(slotCol) + " = ?, " +
+                                std::string(slotCol) +
+                                "_wear = 0 WHERE id = ? AND "
+                                "owner_account_id = ?";
 
-  stmtOpt->bindUint64(0, &defIndex64);
-  stmtOpt->bindUint64(1, &targetId);
+      auto stmtOpt = createPreparedStatement(inventory_db, updateQuery.c_str());
+      if (!stmtOpt) {
+        return false;
+      }
 
-  if (!stmtOpt->execute()) {
-    return false;
-  }
+      stmtOpt->bindInt32(0, &kit);
+      stmtOpt->bindUint64(1, &targetId);
+      stmtOpt->bindUint32(2, &accountId);
 
-  // 4. Consume the sticker (delete it)
-  if (!DeleteItem(p2psocket, steamId, stickerId, inventory_db)) {
-    logger::error("HandleApplySticker: Failed to consume sticker");
-    return false;
+      if (!stmtOpt->execute()) {
+        return false;
+      }
+
+      // 4. Consume the sticker (delete it). No socket: the delete
+      // notification is sent below, once the transaction has committed.
+      if (!DeleteItem(0, steamId, stickerId, inventory_db)) {
+        logger::error("HandleApplySticker: Failed to consume sticker");
+        return false;
+      }
+      return true;
+    };
+    committed = RunTransaction(inventory_db, "HandleApplySticker", applyBody);
   }
 
-  if (!transaction.Commit()) {
+  if (!committed) {
     return false;
   }
 
+  auto &cache = InventoryCache::GetInstance();
+  cache.Erase(steamId & 0xFFFFFFFF, stickerId);
+  cache.Refresh(inventory_db, steamId & 0xFFFFFFFF, targetId);
+
+  CSOEconItem consumedSticker;
+  consumedSticker.set_id(stickerId);
+  SendSOSingleObject(p2psocket, steamId, SOTypeItem, consumedSticker,
+                     k_EMsgGC_CC_DeleteItem);
+
   // 5. Send updates
   // Re-fetch target to get new attributes
   auto updatedTarget = FetchItemFromDatabase(targetId, steamId, inventory_db);
@@ -626,7 +609,7 @@ bool GCNetwork_Inventory::HandleScrapeSticker(
   uint64_t targetId = message.item_item_id();
   uint32_t slot = message.sticker_slot();
 
-  if (slot > 5) {
+  if (slot >= CsgoItemInsert::STICKER_SLOTS) {
     logger::error("HandleScrapeSticker: Invalid sticker slot %u", slot);
     return false;
   }
@@ -636,19 +619,15 @@ bool GCNetwork_Inventory::HandleScrapeSticker(
   // Construct column names safely
   char idCol[32];
   char wearCol[32];
-  snprintf(idCol, sizeof(idCol), "sticker_slot_%u_id", slot);
-  snprintf(wearCol, sizeof(wearCol), "sticker_slot_%u_wear", slot);
+  snprintf(idCol, sizeof(idCol), "sticker_%u", slot + 1);
+  snprintf(wearCol, sizeof(wearCol), "sticker_%u_wear", slot + 1);
 
   // Validate column names against a whitelist
-  const char *allowed_ids[] = {"sticker_slot_0_id", "sticker_slot_1_id",
-                               "sticker_slot_2_id", "sticker_slot_3_id",
-                               "sticker_slot_4_id", "sticker_slot_5_id"};
-  const char *allowed_wears[] = {"sticker_slot_0_wear", "sticker_slot_1_wear",
-                                 "sticker_slot_2_wear", "sticker_slot_3_wear",
-                                 "sticker_slot_4_wear", "sticker_slot_5_wear"};
+  const char *allowed_ids[] = {"sticker_1", "sticker_2", "sticker_3",
+                               "sticker_4", "sticker_5"};
 
   bool col_safe = false;
-  for (int i = 0; i < 6; i++) {
+  for (int i = 0; i < CsgoItemInsert::STICKER_SLOTS; i++) {
     if (strcmp(idCol, allowed_ids[i]) == 0)
       col_safe = true;
   }
@@ -657,21 +636,21 @@ bool GCNetwork_Inventory::HandleScrapeSticker(
     return false;
   }
 
-  // Null out the ID and Wear for scraping/removal (simplified)
+  // Null out the ID and Wear for scraping/removal (simplified), as an
+  // empty slot is stored on insert
   std::string updateQuery = "UPDATE csgo_items SET " + std::string(idCol) +
-                            " = 0, " + std::string(wearCol) +
-                            " = 0 WHERE id = ? AND owner_steamid2 = ?";
+                            " = NULL, " + std::string(wearCol) +
+                            " = NULL WHERE id = ? AND owner_account_id = ?";
 
   auto stmtOpt = createPreparedStatement(inventory_db, updateQuery.c_str());
   if (!stmtOpt) {
     return false;
   }
 
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
-  unsigned long steamIdLen = steamId2.length();
+  uint32_t accountId = steamId & 0xFFFFFFFF;
 
   stmtOpt->bindUint64(0, &targetId);
-  stmtOpt->bindString(1, steamId2.c_str(), &steamIdLen);
+  stmtOpt->bindUint32(1, &accountId);
 
   if (!stmtOpt->execute()) {
     return false;
@@ -680,6 +659,7 @@ bool GCNetwork_Inventory::HandleScrapeSticker(
   if (!transaction.Commit()) {
     return false;
   }
+  InventoryCache::GetInstance().Refresh(inventory_db, accountId, targetId);
 
   // 3. Send updates
   auto updatedTarget = FetchItemFromDatabase(targetId, steamId, inventory_db);
@@ -704,14 +684,16 @@ bool GCNetwork_Inventory::HandleCraft(SNetSocket_t p2psocket, uint64_t steamId,
     return false;
   }
 
-  // 2. Fetch and Validate Inputs
-  std::vector<std::unique_ptr<CSOEconItem>> inputItems;
-  std::vector<CSOEconItem> rawInputs;
+  // 2. Fetch and Validate Inputs (on the request arena, no copies)
+  RequestArena::Scope arenaScope;
+  std::vector<const CSOEconItem *> inputItems;
+  inputItems.reserve(message.item_ids_size());
   uint32_t expectedRarity = 0;
 
   for (int i = 0; i < message.item_ids_size(); i++) {
     uint64_t itemId = message.item_ids(i);
-    auto item = FetchItemFromDatabase(itemId, steamId, inventory_db);
+    const CSOEconItem *item = FetchItemFromDatabase(
+        RequestArena::Get(), itemId, steamId, inventory_db);
 
     if (!item) {
       logger::error(
@@ -737,8 +719,7 @@ bool GCNetwork_Inventory::HandleCraft(SNetSocket_t p2psocket, uint64_t steamId,
       }
     }
 
-    rawInputs.push_back(*item);
-    inputItems.push_back(std::move(item));
+    inputItems.push_back(item);
   }
 
   // 3. Determine Result
@@ -749,51 +730,92 @@ bool GCNetwork_Inventory::HandleCraft(SNetSocket_t p2psocket, uint64_t steamId,
                             0xFFFFFFFF); // Just lower 32 bits usually, or full?
   // Actually SaveNewItemToDatabase handles account_id
 
-  if (!g_itemSchema->SelectTradeUpResult(rawInputs, resultItem)) {
+  std::shared_ptr<const ItemSchema> itemSchema =
+      ItemSchemaStore::GetInstance().Get();
+  if (!itemSchema ||
+      !itemSchema->SelectTradeUpResult(inputItems, resultItem)) {
     logger::error("HandleCraft: Failed to determine trade up result");
     return false;
   }
 
   // 4. Execute Transaction
-  SQLTransaction transaction(inventory_db);
-
-  // A. Delete Input Items
-  auto deleteStmtOpt = createPreparedStatement(
-      inventory_db, "DELETE FROM csgo_items WHERE id = ?");
-  if (!deleteStmtOpt)
-    return false;
-  auto &deleteStmt = *deleteStmtOpt;
-
+  std::vector<uint64_t> inputIds;
+  inputIds.reserve(inputItems.size());
   for (const auto &input : inputItems) {
-    uint64_t id = input->id();
-    deleteStmt.bindUint64(0, &id);
-    if (!deleteStmt.execute()) {
-      logger::error("HandleCraft: Failed to delete input item %llu", id);
-      return false;
-    }
+    inputIds.push_back(input->id());
   }
 
-  // B. Insert Output Item
   // Set origin to Crafted (8) so CheckAndSendNewItemsSince doesn't skip it
   // (treating 0 as "from crate" which implies already handled)
   resultItem.set_origin(8);
 
-  uint64_t newId = SaveNewItemToDatabase(resultItem, steamId, inventory_db);
-  if (newId == 0) {
-    logger::error("HandleCraft: Failed to save result item");
-    return false;
+  // One CALL when the stored procedures are deployed; otherwise the same
+  // work client-side. Database work only, so RunTransaction can retry it.
+  auto craftBody = [&](SQLTransaction &) {
+    // A. Delete Input Items (single statement for all inputs)
+    std::string deleteQuery =
+        "DELETE FROM csgo_items WHERE owner_account_id = ? AND id IN " +
+        sqlPlaceholderList(inputIds.size());
+    auto deleteStmtOpt =
+        createPreparedStatement(inventory_db, deleteQuery.c_str());
+    if (!deleteStmtOpt)
+      return false;
+    auto &deleteStmt = *deleteStmtOpt;
+
+    uint32_t accountId = steamId & 0xFFFFFFFF;
+    deleteStmt.bindUint32(0, &accountId);
+    deleteStmt.bindUint64List(1, inputIds.data(), inputIds.size());
+
+    // Duplicate ids in the request collapse here, so this also rejects a
+    // contract that reuses the same item
+    if (!deleteStmt.execute() ||
+        deleteStmt.affectedRows() != inputIds.size()) {
+      logger::error("HandleCraft: Failed to delete input items (%llu of %zu)",
+                    deleteStmt.affectedRows(), inputIds.size());
+      return false;
+    }
+
+    // B. Insert Output Item
+    uint64_t newId = SaveNewItemToDatabase(resultItem, steamId, inventory_db);
+    if (newId == 0) {
+      logger::error("HandleCraft: Failed to save result item");
+      return false;
+    }
+    resultItem.set_id(newId);
+    return true;
+  };
+  bool committed = false;
+  auto &procedures = InventoryProcedures::GetInstance();
+  if (procedures.CanCall(inventory_db)) {
+    CsgoItemInsert row = BuildNewItemInsert(resultItem, steamId);
+    auto inserted = procedures.Craft(inventory_db, inputIds, row);
+    if (inserted.committed && inserted.itemId == 0) {
+      // Inputs consumed and the result inserted, but its id is unknown
+      ResendSOCache(p2psocket, steamId, inventory_db);
+      return true;
+    }
+    if (inserted.committed) {
+      resultItem.set_id(inserted.itemId);
+      InventoryCache::GetInstance().Put(row.owner_account_id,
+                                        row.ToRow(inserted.itemId), true);
+      committed = true;
+    }
+  } else {
+    committed = RunTransaction(inventory_db, "HandleCraft", craftBody);
   }
-  resultItem.set_id(newId);
 
   // 5. Commit Transaction FIRST
   // Critical: We must commit before sending ANY messages to the client.
   // If we send messages first, the client might try to use the item (e.g.
   // equip) before the DB transaction is visible, causing "Item not found"
   // errors.
-  if (!transaction.Commit()) {
-    logger::error("HandleCraft: Transaction commit failed");
+  if (!committed) {
+    logger::error("HandleCraft: Transaction failed");
     return false;
   }
+  for (uint64_t inputId : inputIds) {
+    InventoryCache::GetInstance().Erase(steamId & 0xFFFFFFFF, inputId);
+  }
 
   // 6. Send Notifications to Client
   // A. Send Delete messages for inputs
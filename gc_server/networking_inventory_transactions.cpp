@@ -5,6 +5,9 @@
 
 #include "gc_const_csgo.hpp"
 #include "gcsystemmsgs.pb.h"
+#include "inventory_cache.hpp"
+#include "inventory_procedures.hpp"
+#include "item_schema_store.hpp"
 #include "keyvalue_english.hpp"
 #include "logger.hpp"
 #include "networking_inventory.hpp"
@@ -85,49 +88,62 @@ bool GCNetwork_Inventory::ProcessStorePurchase(
     const CMsgGC_CC_CL2GC_StorePurchaseInit &message, MYSQL *inventory_db,
     uint64_t &txnId, std::vector<uint64_t> &itemIds) {
 
-  // RAII Transaction Wrapper
-  SQLTransaction transaction(inventory_db);
-
-  txnId = 12345 + (uint64_t)time(nullptr); // Simple fake transaction ID
-
-  for (int i = 0; i < message.line_items_size(); i++) {
-    const auto &lineItem = message.line_items(i);
-    uint32_t defIndex = lineItem.item_def_id();
-    uint32_t quantity = lineItem.quantity();
-
-    // Security: Cap quantity to prevent DoS via massive loops/allocations
-    if (quantity > 20) {
-      logger::warning("ProcessStorePurchase: Capping quantity from %u to 20",
-                      quantity);
-      quantity = 20;
-    }
-
-    for (uint32_t q = 0; q < quantity; q++) {
-      // Create item
-      auto item = CreateBaseItem(defIndex, steamId, inventory_db, false, "");
-      if (!item) {
-        logger::error("ProcessStorePurchase: Failed to create base item %u",
-                      defIndex);
-        return false; // Transaction will rollback automatically
+  // Items are only announced once the purchase has committed, so a retried
+  // or rolled back attempt never shows the client items it doesn't own.
+  std::vector<CSOEconItem> createdItems;
+
+  auto purchaseBody = [&](SQLTransaction &) {
+    txnId = 12345 + (uint64_t)time(nullptr); // Simple fake transaction ID
+    itemIds.clear();
+    createdItems.clear();
+
+    for (int i = 0; i < message.line_items_size(); i++) {
+      const auto &lineItem = message.line_items(i);
+      uint32_t defIndex = lineItem.item_def_id();
+      uint32_t quantity = lineItem.quantity();
+
+      // Security: Cap quantity to prevent DoS via massive loops/allocations
+      if (quantity > 20) {
+        logger::warning("ProcessStorePurchase: Capping quantity from %u to 20",
+                        quantity);
+        quantity = 20;
       }
 
-      // Set required fields for new item
-      // ... (setup similar to HandleUnboxCrate)
-
-      uint64_t newItemId = SaveNewItemToDatabase(*item, steamId, inventory_db);
-      if (newItemId == 0) {
-        logger::error("ProcessStorePurchase: Failed to save item");
-        return false;
+      for (uint32_t q = 0; q < quantity; q++) {
+        // Create item
+        auto item = CreateBaseItem(defIndex, steamId, inventory_db, false, "");
+        if (!item) {
+          logger::error("ProcessStorePurchase: Failed to create base item %u",
+                        defIndex);
+          return false; // Transaction will rollback automatically
+        }
+
+        // Set required fields for new item
+        // ... (setup similar to HandleUnboxCrate)
+
+        uint64_t newItemId =
+            SaveNewItemToDatabase(*item, steamId, inventory_db);
+        if (newItemId == 0) {
+          logger::error("ProcessStorePurchase: Failed to save item");
+          return false;
+        }
+
+        itemIds.push_back(newItemId);
+        createdItems.push_back(std::move(*item));
       }
-
-      itemIds.push_back(newItemId);
-
-      // Send notification
-      SendSOSingleObject(p2psocket, steamId, SOTypeItem, *item);
     }
+    return true;
+  };
+
+  if (!RunTransaction(inventory_db, "ProcessStorePurchase", purchaseBody)) {
+    return false;
   }
 
-  return transaction.Commit();
+  // Send notifications
+  for (const auto &item : createdItems) {
+    SendSOSingleObject(p2psocket, steamId, SOTypeItem, item);
+  }
+  return true;
 }
 
 /**
@@ -144,20 +160,15 @@ bool GCNetwork_Inventory::HandleUnboxCrate(SNetSocket_t p2psocket,
                                            uint64_t steamId,
                                            uint64_t crateItemId,
                                            MYSQL *inventory_db) {
-  if (!g_itemSchema || !inventory_db) {
+  // one snapshot for the whole unbox, even if the schema is reloaded
+  std::shared_ptr<const ItemSchema> itemSchema =
+      ItemSchemaStore::GetInstance().Get();
+  if (!itemSchema || !inventory_db) {
     logger::error(
         "HandleUnboxCrate: ItemSchema or database connection is null");
     return false;
   }
 
-  // Note: HandleUnboxCrate in original file didn't use an explicit SQL
-  // transaction for the WHOLE process, but it did have several steps (fetch,
-  // save, update pos, delete). It is safer to wrap this in a transaction to
-  // prevent losing a crate if item creation fails, or keeping a crate if item
-  // creation succeeds but delete fails.
-
-  SQLTransaction transaction(inventory_db);
-
   // verify
   auto crateItem = FetchItemFromDatabase(crateItemId, steamId, inventory_db);
   if (!crateItem) {
@@ -166,10 +177,10 @@ bool GCNetwork_Inventory::HandleUnboxCrate(SNetSocket_t p2psocket,
     return false;
   }
 
-  // make item
+  // make item. Drawn once, outside the retried transaction below, so a
+  // deadlock retry can't reroll the drop.
   CSOEconItem newItem;
-  bool result = g_itemSchema->SelectItemFromCrate(*crateItem, newItem);
-  if (!result) {
+  if (!itemSchema->SelectItemFromCrate(*crateItem, newItem)) {
     logger::error("HandleUnboxCrate: Failed to select item from crate %llu",
                   crateItemId);
     return false;
@@ -183,14 +194,74 @@ bool GCNetwork_Inventory::HandleUnboxCrate(SNetSocket_t p2psocket,
   // send an acknowledgment. ProcessClientAcknowledgment will then assign a real
   // inventory slot.
 
-  uint64_t newItemId = SaveNewItemToDatabase(newItem, steamId, inventory_db);
-  if (newItemId == 0) {
-    logger::error("HandleUnboxCrate: Failed to save new item to database");
-    return false;
+  // Deleting the crate and saving the new item must happen together so a
+  // failure can't lose the crate or duplicate it. The delete only succeeds
+  // while the player still owns the crate, which makes the read above safe
+  // to do outside the transaction.
+  uint64_t newItemId = 0;
+  auto &procedures = InventoryProcedures::GetInstance();
+  if (procedures.CanCall(inventory_db)) {
+    CsgoItemInsert row = BuildNewItemInsert(newItem, steamId);
+    auto inserted = procedures.UnboxCrate(inventory_db, crateItemId, row);
+    if (!inserted.committed) {
+      logger::error("HandleUnboxCrate: Failed to unbox crate %llu",
+                    crateItemId);
+      return false;
+    }
+    if (inserted.itemId == 0) {
+      // The crate is gone and the item exists, but there is nothing to
+      // announce it with; the client gets the whole inventory instead
+      ResendSOCache(p2psocket, steamId, inventory_db);
+      return true;
+    }
+    newItemId = inserted.itemId;
+    InventoryCache::GetInstance().Put(row.owner_account_id,
+                                      row.ToRow(newItemId), true);
+  } else {
+    // The body only touches the database so RunTransaction can retry it on
+    // deadlock; messages go out after commit.
+    auto unboxBody = [&](SQLTransaction &) {
+      // Delete first - SQL injection safe
+      auto deleteStmtOpt = createPreparedStatement(
+          inventory_db,
+          "DELETE FROM csgo_items WHERE id = ? AND owner_account_id = ?");
+
+      if (!deleteStmtOpt) {
+        logger::error(
+            "HandleUnboxCrate: Failed to prepare crate delete statement");
+        return false; // Transaction will rollback
+      }
+
+      auto &stmt = *deleteStmtOpt;
+      uint64_t crateIdParam = crateItemId;
+      uint32_t accountId = steamId & 0xFFFFFFFF;
+
+      stmt.bindUint64(0, &crateIdParam);
+      stmt.bindUint32(1, &accountId);
+
+      if (!stmt.execute() || stmt.affectedRows() != 1) {
+        logger::warning(
+            "HandleUnboxCrate: Failed to delete crate from database: %s",
+            stmt.error());
+        return false; // Transaction will rollback
+      }
+
+      newItemId = SaveNewItemToDatabase(newItem, steamId, inventory_db);
+      if (newItemId == 0) {
+        logger::error("HandleUnboxCrate: Failed to save new item to database");
+        return false;
+      }
+      return true;
+    };
+
+    if (!RunTransaction(inventory_db, "HandleUnboxCrate", unboxBody)) {
+      return false;
+    }
   }
 
   // setting id to newest
   newItem.set_id(newItemId);
+  InventoryCache::GetInstance().Erase(steamId & 0xFFFFFFFF, crateItemId);
 
   // FINAL WORKING SOLUTION - Based on test client analysis
   // Correct message sequence for case opening animation:
@@ -242,35 +313,6 @@ bool GCNetwork_Inventory::HandleUnboxCrate(SNetSocket_t p2psocket,
                  newItemId);
   }
 
-  // Now delete from database - SQL injection safe
-  auto deleteStmtOpt = createPreparedStatement(
-      inventory_db,
-      "DELETE FROM csgo_items WHERE id = ? AND owner_steamid2 = ?");
-
-  if (!deleteStmtOpt) {
-    logger::error("HandleUnboxCrate: Failed to prepare crate delete statement");
-    return false; // Transaction will rollback
-  }
-
-  auto &stmt = *deleteStmtOpt;
-  uint64_t crateIdParam = crateItemId;
-  std::string steamId2 = GCNetwork_Users::SteamID64ToSteamID2(steamId);
-  unsigned long steamIdLen = steamId2.length();
-
-  stmt.bindUint64(0, &crateIdParam);
-  stmt.bindString(1, steamId2.c_str(), &steamIdLen);
-
-  if (!stmt.execute()) {
-    logger::warning(
-        "HandleUnboxCrate: Failed to delete crate from database: %s",
-        stmt.error());
-    return false; // Transaction will rollback
-  }
-
-  if (!transaction.Commit()) {
-    return false;
-  }
-
   logger::info("HandleUnboxCrate: [FIXED] Message sequence complete - "
                "Create(21|Mask)→Response(1008)");
 
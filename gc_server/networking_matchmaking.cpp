@@ -2,6 +2,7 @@
 #include "cc_gcmessages.pb.h"
 #include "cstrike15_gcmessages.pb.h"
 #include "logger.hpp"
+#include "player_profile_cache.hpp"
 #include "prepared_stmt.hpp"
 #include "safe_parse.hpp"
 #include "steam_network_message.hpp"
@@ -477,6 +478,8 @@ void GCNetwork_Matchmaking::UpdatePlayerStats(uint64_t steamId, bool won,
     stmt.bindUint32(4, &m_param);
 
     if (stmt.execute()) {
+      GCNetwork::GetInstance()->NoteWrite(steamId);
+      PlayerProfileCache::GetInstance().Invalidate(steamId & 0xFFFFFFFF);
       logger::info("Updated stats for player %llu: K:%u D:%u MVP:%u Won:%d",
                    steamId, kills, deaths, mvps, won);
     } else {
@@ -1,16 +1,23 @@
 #include "networking_users.hpp"
+#include "db_health.hpp"
+#include "inventory_write_queue.hpp"
 #include "logger.hpp"
+#include "player_profile_cache.hpp"
 #include "prepared_stmt.hpp"
+#include "random.hpp"
 #include "safe_parse.hpp"
 #include "steam/steam_api.h"
 #include "tunables_manager.hpp"
 #include "web_api_client.hpp"
+#include "worker_pool.hpp"
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <mariadb/mysql.h>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 std::string GCNetwork_Users::SteamID64ToSteamID2(uint64_t steamId64) {
   char steamId2[32];
@@ -60,85 +67,6 @@ RankId ScoreToRankId(int score) {
   return RankGlobalElite;
 }
 
-uint32_t GCNetwork_Users::GetPlayerRankId(const std::string &steamId2,
-                                          MYSQL *ranked_db) {
-  // SQL injection safe: using prepared statement
-  auto stmtOpt = createPreparedStatement(
-      ranked_db, "SELECT score FROM ranked WHERE steam = ?");
-
-  if (!stmtOpt) {
-    logger::error("Failed to prepare rank query");
-    return static_cast<uint32_t>(RankNone);
-  }
-
-  auto &stmt = *stmtOpt;
-  unsigned long steamIdLen = steamId2.length();
-  stmt.bindString(0, steamId2.c_str(), &steamIdLen);
-
-  if (!stmt.execute()) {
-    logger::error("Failed to execute rank query");
-    return static_cast<uint32_t>(RankNone);
-  }
-
-  if (!stmt.storeResult()) {
-    return static_cast<uint32_t>(RankNone);
-  }
-
-  // Bind result
-  int score = 0;
-  MYSQL_BIND result[1];
-  memset(result, 0, sizeof(result));
-  result[0].buffer_type = MYSQL_TYPE_LONG;
-  result[0].buffer = &score;
-
-  if (!stmt.bindResult(result)) {
-    return static_cast<uint32_t>(RankNone);
-  }
-
-  if (stmt.fetch() == 0) {
-    return static_cast<uint32_t>(ScoreToRankId(score));
-  }
-
-  return static_cast<uint32_t>(RankNone);
-}
-
-uint32_t GCNetwork_Users::GetPlayerWins(const std::string &steamId2,
-                                        MYSQL *ranked_db) {
-  // SQL injection safe: using prepared statement
-  auto stmtOpt = createPreparedStatement(
-      ranked_db, "SELECT match_win FROM ranked WHERE steam = ?");
-
-  if (!stmtOpt) {
-    logger::error("Failed to prepare wins query");
-    return 0;
-  }
-
-  auto &stmt = *stmtOpt;
-  unsigned long steamIdLen = steamId2.length();
-  stmt.bindString(0, steamId2.c_str(), &steamIdLen);
-
-  if (!stmt.execute() || !stmt.storeResult()) {
-    return 0;
-  }
-
-  uint32_t wins = 0;
-  MYSQL_BIND result[1];
-  memset(result, 0, sizeof(result));
-  result[0].buffer_type = MYSQL_TYPE_LONG;
-  result[0].buffer = &wins;
-  result[0].is_unsigned = 1;
-
-  if (!stmt.bindResult(result)) {
-    return 0;
-  }
-
-  if (stmt.fetch() == 0) {
-    return wins;
-  }
-
-  return 0;
-}
-
 // COMMENDS
 
 // fetch commends
@@ -597,6 +525,11 @@ void GCNetwork_Users::HandleCommendPlayer(SNetSocket_t p2psocket, void *message,
 
   // Log if any changes were made
   if (commendAdded || commendRemoved) {
+    // Pin the target's reads first, so the reload can't cache a replica
+    // that hasn't seen the commend yet
+    GCNetwork::GetInstance()->NoteWrite(targetSteamId);
+    PlayerProfileCache::GetInstance().Invalidate(targetAccountId);
+
     if (needToken) {
       logger::info("Commendation transaction complete: sender=%llu, "
                    "target=%llu, tokens_remaining=%d",
@@ -681,7 +614,8 @@ void GCNetwork_Users::HandlePlayerReport(SNetSocket_t p2psocket, void *message,
 
   CMsgGC_CC_GC2CL_ClientReportResponse response;
   response.set_account_id(targetAccountId);
-  response.set_confirmation_id(rand()); // Generate a random confirmation ID
+  response.set_confirmation_id(
+      ThreadRandom().Uint32()); // Generate a random confirmation ID
 
   // Set match ID if provided
   if (request.has_match_id()) {
@@ -811,6 +745,9 @@ void GCNetwork_Users::HandlePlayerReport(SNetSocket_t p2psocket, void *message,
         }
 
         if (reportSubmitted) {
+          GCNetwork::GetInstance()->NoteWrite(targetSteamId);
+          PlayerProfileCache::GetInstance().Invalidate(targetAccountId);
+
           response.set_response_type(0);            // Success
           response.set_response_result(0);          // Success
           response.set_tokens(availableTokens - 1); // Decrease available tokens
@@ -839,77 +776,136 @@ void GCNetwork_Users::HandlePlayerReport(SNetSocket_t p2psocket, void *message,
 
 // HELPERS
 
-void GCNetwork_Users::GetPlayerMedals(uint64_t steamId,
-                                      PlayerMedalsInfo *medals,
-                                      MYSQL *inventory_db) {
-  // SQL injection safe: using prepared statement
+void GCNetwork_Users::GetPlayerCommendsAndMedals(uint64_t steamId,
+                                                 PlayerProfile &profile,
+                                                 MYSQL *inventory_db) {
+  // Commend counts and collectibles in one round trip - SQL injection safe.
+  // kind 0 rows are (type, count), kind 1 rows (id, item_id, equips).
   auto stmtOpt = createPreparedStatement(
-      inventory_db, "SELECT item_id, equipped_t, equipped_ct "
-                    "FROM csgo_items "
-                    "WHERE owner_steamid2 = ? "
-                    "AND item_id LIKE 'collectible-%'");
+      inventory_db,
+      "SELECT 0, type, COUNT(*), 0, NULL, NULL, NULL FROM player_commends "
+      "WHERE receiver_steamid64 = ? GROUP BY type "
+      "UNION ALL "
+      "SELECT 1, 0, 0, id, item_id, equipped_t, equipped_ct FROM csgo_items "
+      "WHERE owner_account_id = ? AND item_id LIKE 'collectible-%'");
 
-  if (stmtOpt) {
-    auto &stmt = *stmtOpt;
-    std::string steamId2 = SteamID64ToSteamID2(steamId);
-    unsigned long steamIdLen = steamId2.length();
-    stmt.bindString(0, steamId2.c_str(), &steamIdLen);
+  if (!stmtOpt) {
+    logger::error("Failed to prepare commends/medals query");
+    return;
+  }
 
-    if (stmt.execute() && stmt.storeResult()) {
-      char item_id_buf[256];
-      int equipped_t = 0;
-      int equipped_ct = 0;
-      unsigned long i_len;
-      my_bool i_null, t_null, c_null;
-      MYSQL_BIND results[3];
-      memset(results, 0, sizeof(results));
+  auto &stmt = *stmtOpt;
+  uint64_t steamIdParam = steamId;
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  stmt.bindUint64(0, &steamIdParam);
+  stmt.bindUint32(1, &accountId);
 
-      results[0].buffer_type = MYSQL_TYPE_STRING;
-      results[0].buffer = item_id_buf;
-      results[0].buffer_length = sizeof(item_id_buf);
-      results[0].length = &i_len;
-      results[0].is_null = &i_null;
-      results[1].buffer_type = MYSQL_TYPE_LONG;
-      results[1].buffer = &equipped_t;
-      results[1].is_null = &t_null;
-      results[2].buffer_type = MYSQL_TYPE_LONG;
-      results[2].buffer = &equipped_ct;
-      results[2].is_null = &c_null;
-
-      if (stmt.bindResult(results)) {
-        bool found_featured = false;
-        while (stmt.fetch() == 0) {
-          // parse defindex from item_id
-          std::string item_id(item_id_buf, i_len);
-          size_t dash_pos = item_id.find('-');
-          if (dash_pos == std::string::npos)
-            continue;
-
-          uint32_t defindex =
-              SafeParse::toUint32(item_id.c_str() + dash_pos + 1).value_or(0);
-          if (defindex == 0)
-            continue;
-
-          // add
-          medals->add_display_items_defidx(defindex);
-
-          // for set_featured_display_item_defidx
-          bool is_equipped_t = (!t_null && equipped_t == 1);
-          bool is_equipped_ct = (!c_null && equipped_ct == 1);
-
-          if (is_equipped_t && is_equipped_ct && !found_featured) {
-            medals->set_featured_display_item_defidx(defindex);
-            found_featured = true;
-          }
-        }
-        if (!found_featured) {
-          medals->set_featured_display_item_defidx(0);
-        }
+  if (!stmt.execute() || !stmt.storeResult()) {
+    logger::error("Failed to query commends/medals: %s", stmt.error());
+    return;
+  }
+
+  int kind = 0;
+  int type = 0;
+  int64_t count = 0;
+  uint64_t itemId = 0;
+  char item_id_buf[256];
+  int equipped_t = 0;
+  int equipped_ct = 0;
+  unsigned long i_len = 0;
+  my_bool i_null, t_null, c_null;
+  MYSQL_BIND results[7];
+  memset(results, 0, sizeof(results));
+
+  results[0].buffer_type = MYSQL_TYPE_LONG;
+  results[0].buffer = &kind;
+  results[1].buffer_type = MYSQL_TYPE_LONG;
+  results[1].buffer = &type;
+  results[2].buffer_type = MYSQL_TYPE_LONGLONG;
+  results[2].buffer = &count;
+  results[3].buffer_type = MYSQL_TYPE_LONGLONG;
+  results[3].buffer = &itemId;
+  results[3].is_unsigned = 1;
+  results[4].buffer_type = MYSQL_TYPE_STRING;
+  results[4].buffer = item_id_buf;
+  results[4].buffer_length = sizeof(item_id_buf);
+  results[4].length = &i_len;
+  results[4].is_null = &i_null;
+  results[5].buffer_type = MYSQL_TYPE_LONG;
+  results[5].buffer = &equipped_t;
+  results[5].is_null = &t_null;
+  results[6].buffer_type = MYSQL_TYPE_LONG;
+  results[6].buffer = &equipped_ct;
+  results[6].is_null = &c_null;
+
+  if (!stmt.bindResult(results)) {
+    return;
+  }
+
+  // The table can be one flush behind; queued equips win over it
+  std::unordered_map<uint64_t, bool> pendingT;
+  std::unordered_map<uint64_t, bool> pendingCT;
+  InventoryWriteQueue &writeQueue = InventoryWriteQueue::GetInstance();
+  for (const auto &pending : writeQueue.PendingEquipped(accountId, false)) {
+    pendingT[pending.itemId] = pending.equipped;
+  }
+  for (const auto &pending : writeQueue.PendingEquipped(accountId, true)) {
+    pendingCT[pending.itemId] = pending.equipped;
+  }
+
+  PlayerMedalsInfo *medals = &profile.medals;
+  bool found_featured = false;
+  while (stmt.fetch() == 0) {
+    if (kind == 0) {
+      switch (type) {
+      case 1:
+        profile.cmdFriendly = static_cast<uint32_t>(count);
+        break;
+      case 2:
+        profile.cmdTeaching = static_cast<uint32_t>(count);
+        break;
+      case 3:
+        profile.cmdLeader = static_cast<uint32_t>(count);
+        break;
       }
-    } else {
-      logger::error("Failed to query medals: %s", stmt.error());
+      continue;
+    }
+    if (i_null) {
+      continue;
+    }
+
+    // parse defindex from item_id
+    std::string item_id(item_id_buf, i_len);
+    size_t dash_pos = item_id.find('-');
+    if (dash_pos == std::string::npos)
+      continue;
+
+    uint32_t defindex =
+        SafeParse::toUint32(item_id.c_str() + dash_pos + 1).value_or(0);
+    if (defindex == 0)
+      continue;
+
+    // add
+    medals->add_display_items_defidx(defindex);
+
+    // for set_featured_display_item_defidx
+    auto queuedT = pendingT.find(itemId);
+    auto queuedCT = pendingCT.find(itemId);
+    bool is_equipped_t = queuedT != pendingT.end()
+                             ? queuedT->second
+                             : (!t_null && equipped_t == 1);
+    bool is_equipped_ct = queuedCT != pendingCT.end()
+                              ? queuedCT->second
+                              : (!c_null && equipped_ct == 1);
+
+    if (is_equipped_t && is_equipped_ct && !found_featured) {
+      medals->set_featured_display_item_defidx(defindex);
+      found_featured = true;
     }
   }
+  if (!found_featured) {
+    medals->set_featured_display_item_defidx(0);
+  }
 }
 
 bool GCNetwork_Users::IsPlayerBanned(const std::string &steamId2,
@@ -942,66 +938,178 @@ bool GCNetwork_Users::IsPlayerBanned(const std::string &steamId2,
   return false;
 }
 
-void GCNetwork_Users::GetPlayerCooldownInfo(
-    const std::string &steamId2, CMsgGC_CC_GC2CL_BuildMatchmakingHello &message,
-    MYSQL *classiccounter_db) {
-  // SQL injection safe: using prepared statement
+void GCNetwork_Users::GetPlayerBanAndCooldown(const std::string &steamId2,
+                                              PlayerProfile &profile,
+                                              MYSQL *classiccounter_db) {
+  // Permanent ban flag and latest cooldown in one round trip - SQL injection
+  // safe. The LEFT JOIN keeps the ban row when there is no cooldown.
   auto stmtOpt = createPreparedStatement(
       classiccounter_db,
-      "SELECT cooldown_reason, cooldown_expire, acknowledged "
-      "FROM cooldowns "
-      "WHERE sid = ? "
-      "ORDER BY id DESC LIMIT 1");
+      "SELECT EXISTS(SELECT 1 FROM sb_bans WHERE authid = ? AND "
+      "length = 0 AND RemoveType IS NULL), "
+      "c.cooldown_reason, c.cooldown_expire, c.acknowledged "
+      "FROM (SELECT 1) AS one LEFT JOIN "
+      "(SELECT cooldown_reason, cooldown_expire, acknowledged FROM cooldowns "
+      "WHERE sid = ? ORDER BY id DESC LIMIT 1) AS c ON TRUE");
 
   if (stmtOpt) {
     auto &stmt = *stmtOpt;
     unsigned long steamIdLen = steamId2.length();
     stmt.bindString(0, steamId2.c_str(), &steamIdLen);
+    stmt.bindString(1, steamId2.c_str(), &steamIdLen);
 
     if (stmt.execute() && stmt.storeResult()) {
+      int banned = 0;
       int reason = 0;
       long long expire_time = 0;
       int acknowledged = 0;
-      my_bool r_null, e_null, a_null;
-      MYSQL_BIND results[3];
+      my_bool b_null, r_null, e_null, a_null;
+      MYSQL_BIND results[4];
       memset(results, 0, sizeof(results));
 
       results[0].buffer_type = MYSQL_TYPE_LONG;
-      results[0].buffer = &reason;
-      results[0].is_null = &r_null;
-      results[1].buffer_type = MYSQL_TYPE_LONGLONG;
-      results[1].buffer = &expire_time;
-      results[1].is_null = &e_null;
-      results[2].buffer_type = MYSQL_TYPE_LONG;
-      results[2].buffer = &acknowledged;
-      results[2].is_null = &a_null;
+      results[0].buffer = &banned;
+      results[0].is_null = &b_null;
+      results[1].buffer_type = MYSQL_TYPE_LONG;
+      results[1].buffer = &reason;
+      results[1].is_null = &r_null;
+      results[2].buffer_type = MYSQL_TYPE_LONGLONG;
+      results[2].buffer = &expire_time;
+      results[2].is_null = &e_null;
+      results[3].buffer_type = MYSQL_TYPE_LONG;
+      results[3].buffer = &acknowledged;
+      results[3].is_null = &a_null;
 
       if (stmt.bindResult(results) && stmt.fetch() == 0) {
+        profile.banned = !b_null && banned != 0;
+
         // only set if cooldown is unacknowledged
         if (!a_null && acknowledged == 0) {
-          time_t current_time = time(NULL);
-
-          // calculate seconds
-          int penalty_seconds = 0;
-          if (!e_null && expire_time > 0) {
-            penalty_seconds = (expire_time > (long long)current_time)
-                                  ? static_cast<int>(expire_time - current_time)
-                                  : 0;
-          }
-
-          message.set_penalty_reason(!r_null ? reason : 0);
-          message.set_penalty_seconds(penalty_seconds);
-
-          logger::info("Setting cooldown for %s: reason=%d, seconds=%d",
-                       steamId2.c_str(), reason, penalty_seconds);
+          profile.hasCooldown = true;
+          profile.cooldownReason = !r_null ? reason : 0;
+          profile.cooldownExpire = !e_null ? expire_time : 0;
         }
       }
     } else {
-      logger::error("Failed to query cooldown info: %s", stmt.error());
+      logger::error("Failed to query bans/cooldown: %s", stmt.error());
     }
   }
 }
 
+void GCNetwork_Users::GetPlayerRankAndWins(const std::string &steamId2,
+                                           PlayerProfile &profile,
+                                           MYSQL *ranked_db) {
+  // SQL injection safe: using prepared statement
+  auto stmtOpt = createPreparedStatement(
+      ranked_db, "SELECT score, match_win FROM ranked WHERE steam = ?");
+
+  if (!stmtOpt) {
+    logger::error("Failed to prepare rank query");
+    return;
+  }
+
+  auto &stmt = *stmtOpt;
+  unsigned long steamIdLen = steamId2.length();
+  stmt.bindString(0, steamId2.c_str(), &steamIdLen);
+
+  if (!stmt.execute() || !stmt.storeResult()) {
+    logger::error("Failed to execute rank query");
+    return;
+  }
+
+  int score = 0;
+  uint32_t wins = 0;
+  MYSQL_BIND result[2];
+  memset(result, 0, sizeof(result));
+  result[0].buffer_type = MYSQL_TYPE_LONG;
+  result[0].buffer = &score;
+  result[1].buffer_type = MYSQL_TYPE_LONG;
+  result[1].buffer = &wins;
+  result[1].is_unsigned = 1;
+
+  if (stmt.bindResult(result) && stmt.fetch() == 0) {
+    profile.rankId = static_cast<uint32_t>(ScoreToRankId(score));
+    profile.wins = wins;
+  }
+}
+
+// Short wait: falling back to the caller's connection beats queueing
+static constexpr uint32_t PROFILE_POOL_WAIT_MS = 50;
+
+// Runs the classic and ranked lookups of a profile miss while the calling
+// thread queries inventory; one miss needs at most two
+static WorkerPool &ProfileWorkers() {
+  static WorkerPool pool(2);
+  return pool;
+}
+
+PlayerProfile GCNetwork_Users::GetPlayerProfile(uint64_t steamId,
+                                                MYSQL *classiccounter_db,
+                                                MYSQL *inventory_db,
+                                                MYSQL *ranked_db) {
+  uint32_t accountId = steamId & 0xFFFFFFFF;
+  auto &cache = PlayerProfileCache::GetInstance();
+  if (auto cached = cache.Get(accountId)) {
+    return *cached;
+  }
+
+  PlayerProfile profile;
+  std::string steamId2 = SteamID64ToSteamID2(steamId);
+
+  // One statement per database, all three in flight at once, so a miss
+  // costs about the slowest round trip. Each leg fills its own fields of
+  // profile. The worker legs only use pool connections; a leg that can't
+  // get one runs on the caller's connection after the join, since those
+  // belong to this thread.
+  GCNetwork *network = GCNetwork::GetInstance();
+  bool pooled = network && network->HasConnectionPools();
+  auto deadline = RequestDeadline::Current();
+  bool classicDone = false;
+  bool rankedDone = false;
+
+  std::vector<std::function<void()>> legs;
+  if (pooled) {
+    legs.push_back([&] {
+      RequestDeadline requestDeadline(deadline);
+      auto classicRead =
+          network->GetClassicReadConnection(steamId, PROFILE_POOL_WAIT_MS);
+      if (classicRead) {
+        GetPlayerBanAndCooldown(steamId2, profile, classicRead.get());
+        classicDone = true;
+      }
+    });
+    legs.push_back([&] {
+      RequestDeadline requestDeadline(deadline);
+      auto rankedRead =
+          network->GetRankedReadConnection(steamId, PROFILE_POOL_WAIT_MS);
+      if (rankedRead) {
+        GetPlayerRankAndWins(steamId2, profile, rankedRead.get());
+        rankedDone = true;
+      }
+    });
+  }
+  // Last, so it always runs on this thread
+  legs.push_back([&] {
+    auto inventoryRead =
+        pooled ? network->GetInventoryReadConnection(steamId,
+                                                     PROFILE_POOL_WAIT_MS)
+               : DBConnectionPool::Connection(nullptr, nullptr);
+    GetPlayerCommendsAndMedals(
+        steamId, profile, inventoryRead ? inventoryRead.get() : inventory_db);
+  });
+  ProfileWorkers().RunAll(legs);
+
+  if (!classicDone) {
+    GetPlayerBanAndCooldown(steamId2, profile, classiccounter_db);
+  }
+  if (!rankedDone) {
+    GetPlayerRankAndWins(steamId2, profile, ranked_db);
+  }
+
+  cache.Put(accountId, profile);
+  return profile;
+}
+
 // PROTOBUF MESSAGES
 
 void GCNetwork_Users::BuildMatchmakingHello(
@@ -1030,25 +1138,42 @@ void GCNetwork_Users::BuildMatchmakingHello(
 
   globalStats->set_required_appid_version(ClientVersion);
 
+  PlayerProfile profile =
+      GetPlayerProfile(steamId, classiccounter_db, inventory_db, ranked_db);
+
   // banned?
-  message.set_vac_banned(IsPlayerBanned(steamId2, classiccounter_db) ? 1 : 0);
+  message.set_vac_banned(profile.banned ? 1 : 0);
 
   // RANK
   auto ranking = message.mutable_ranking();
   ranking->set_account_id(accountId);
-  ranking->set_rank_id(GetPlayerRankId(steamId2, ranked_db));
-  ranking->set_wins(GetPlayerWins(steamId2, ranked_db));
+  ranking->set_rank_id(profile.rankId);
+  ranking->set_wins(profile.wins);
   ranking->set_rank_change(0.0f);
 
   // COMMENDS
-  auto commends = GetPlayerCommends(steamId, inventory_db);
   auto commendation = message.mutable_commendation();
-  commendation->set_cmd_friendly(commends.friendly);
-  commendation->set_cmd_teaching(commends.teaching);
-  commendation->set_cmd_leader(commends.leader);
+  commendation->set_cmd_friendly(profile.cmdFriendly);
+  commendation->set_cmd_teaching(profile.cmdTeaching);
+  commendation->set_cmd_leader(profile.cmdLeader);
 
   // COOLDOWN
-  GetPlayerCooldownInfo(steamId2, message, classiccounter_db);
+  if (profile.hasCooldown) {
+    time_t current_time = time(NULL);
+
+    // calculate seconds
+    int penalty_seconds = 0;
+    if (profile.cooldownExpire > (long long)current_time) {
+      penalty_seconds =
+          static_cast<int>(profile.cooldownExpire - current_time);
+    }
+
+    message.set_penalty_reason(profile.cooldownReason);
+    message.set_penalty_seconds(penalty_seconds);
+
+    logger::info("Setting cooldown for %s: reason=%d, seconds=%d",
+                 steamId2.c_str(), profile.cooldownReason, penalty_seconds);
+  }
 
   // XP / Rank Spoofing
   if (TunablesManager::GetInstance().IsXPSpoofActive()) {
@@ -1103,7 +1228,10 @@ void GCNetwork_Users::ViewPlayersProfile(SNetSocket_t p2psocket, void *message,
   uint32_t targetAccountId = request.account_id();
   uint64_t targetSteamId = ((uint64_t)1 << 56) | ((uint64_t)1 << 52) |
                            ((uint64_t)1 << 32) | targetAccountId;
-  std::string steamId2 = SteamID64ToSteamID2(targetSteamId);
+
+  // Cached per account; repeat views cost no database round trips
+  PlayerProfile player = GetPlayerProfile(targetSteamId, classiccounter_db,
+                                          inventory_db, ranked_db);
 
   // logger::info("Processing profile request for account %u (STEAM_ID: %s)",
   // targetAccountId, steamId2.c_str());
@@ -1117,20 +1245,19 @@ void GCNetwork_Users::ViewPlayersProfile(SNetSocket_t p2psocket, void *message,
   // RANK
   auto ranking = profile->mutable_ranking();
   ranking->set_account_id(targetAccountId);
-  ranking->set_rank_id(GetPlayerRankId(steamId2, ranked_db));
-  ranking->set_wins(GetPlayerWins(steamId2, ranked_db));
+  ranking->set_rank_id(player.rankId);
+  ranking->set_wins(player.wins);
   ranking->set_rank_change(0.0f);
 
   // COMMENDS
-  auto commends = GetPlayerCommends(targetSteamId, inventory_db);
   auto commendation = profile->mutable_commendation();
-  commendation->set_cmd_friendly(commends.friendly);
-  commendation->set_cmd_teaching(commends.teaching);
-  commendation->set_cmd_leader(commends.leader);
+  commendation->set_cmd_friendly(player.cmdFriendly);
+  commendation->set_cmd_teaching(player.cmdTeaching);
+  commendation->set_cmd_leader(player.cmdLeader);
 
   // MEDALS
   auto medals = profile->mutable_medals();
-  GetPlayerMedals(targetSteamId, medals, inventory_db);
+  medals->CopyFrom(player.medals);
 
   // OTHER (SOON)
   profile->set_player_level(1); // todo: fetch from db
@@ -1142,6 +1269,6 @@ void GCNetwork_Users::ViewPlayersProfile(SNetSocket_t p2psocket, void *message,
 
   logger::info(
       "Sent profile data for account %u (medals: %d, commends: %d/%d/%d)",
-      targetAccountId, medals->display_items_defidx_size(), commends.friendly,
-      commends.teaching, commends.leader);
+      targetAccountId, medals->display_items_defidx_size(), player.cmdFriendly,
+      player.cmdTeaching, player.cmdLeader);
 }
\ No newline at end of file
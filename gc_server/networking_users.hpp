@@ -3,6 +3,7 @@
 #include "gc_const.hpp"
 #include "gc_const_csgo.hpp"
 #include "networking.hpp"
+#include "player_profile_cache.hpp"
 #include "steam_network_message.hpp" // for NetworkMessage class
 
 #include "cc_gcmessages.pb.h"
@@ -30,6 +31,11 @@ public:
                                  uint32 msgsize, MYSQL *classiccounter_db,
                                  MYSQL *inventory_db, MYSQL *ranked_db);
 
+  // Profile fields shared by the two messages above, via PlayerProfileCache
+  static PlayerProfile GetPlayerProfile(uint64_t steamId,
+                                        MYSQL *classiccounter_db,
+                                        MYSQL *inventory_db, MYSQL *ranked_db);
+
   // commends
   static PlayerCommends GetPlayerCommends(uint64_t steamId,
                                           MYSQL *inventory_db);
@@ -52,13 +58,13 @@ public:
   static std::string SteamID64ToSteamID2(uint64_t steamId64);
   static bool IsPlayerBanned(const std::string &steamId2,
                              MYSQL *classiccounter_db);
-  static void
-  GetPlayerCooldownInfo(const std::string &steamId2,
-                        CMsgGC_CC_GC2CL_BuildMatchmakingHello &message,
-                        MYSQL *classiccounter_db);
-  static uint32_t GetPlayerRankId(const std::string &steamId2,
-                                  MYSQL *ranked_db);
-  static uint32_t GetPlayerWins(const std::string &steamId2, MYSQL *ranked_db);
-  static void GetPlayerMedals(uint64_t steamId, PlayerMedalsInfo *medals,
-                              MYSQL *inventory_db);
+  static void GetPlayerBanAndCooldown(const std::string &steamId2,
+                                      PlayerProfile &profile,
+                                      MYSQL *classiccounter_db);
+  static void GetPlayerRankAndWins(const std::string &steamId2,
+                                   PlayerProfile &profile, MYSQL *ranked_db);
+  // Commend counts and medals in one statement; queued equips applied
+  static void GetPlayerCommendsAndMedals(uint64_t steamId,
+                                         PlayerProfile &profile,
+                                         MYSQL *inventory_db);
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "player_profile_cache.hpp"
+#include "tunables_manager.hpp"
+
+PlayerProfileCache &PlayerProfileCache::GetInstance() {
+  static PlayerProfileCache instance;
+  return instance;
+}
+
+std::optional<PlayerProfile> PlayerProfileCache::Get(uint32_t accountId) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(accountId);
+  if (it == m_entries.end()) {
+    return std::nullopt;
+  }
+
+  if (std::chrono::steady_clock::now() >= it->second.expires) {
+    m_lru.erase(it->second.lruPos);
+    m_entries.erase(it);
+    return std::nullopt;
+  }
+
+  m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+  return it->second.profile;
+}
+
+void PlayerProfileCache::Put(uint32_t accountId, const PlayerProfile &profile) {
+  const auto &tunables = TunablesManager::GetInstance();
+  int ttlSeconds = tunables.GetInt("profile_cache_ttl_s", 60);
+  int maxEntries = tunables.GetInt("profile_cache_size", 4096);
+  if (ttlSeconds <= 0 || maxEntries <= 0) {
+    return; // cache disabled
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto expires =
+      std::chrono::steady_clock::now() + std::chrono::seconds(ttlSeconds);
+
+  auto it = m_entries.find(accountId);
+  if (it != m_entries.end()) {
+    it->second.profile = profile;
+    it->second.expires = expires;
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+    return;
+  }
+
+  while (m_entries.size() >= static_cast<size_t>(maxEntries) &&
+         !m_lru.empty()) {
+    m_entries.erase(m_lru.back());
+    m_lru.pop_back();
+  }
+
+  m_lru.push_front(accountId);
+  m_entries.emplace(accountId, Entry{profile, expires, m_lru.begin()});
+}
+
+void PlayerProfileCache::Invalidate(uint32_t accountId) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(accountId);
+  if (it != m_entries.end()) {
+    m_lru.erase(it->second.lruPos);
+    m_entries.erase(it);
+  }
+}
+
+void PlayerProfileCache::Clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_lru.clear();
+}
@@ -0,0 +1,63 @@
+#pragma once
+/**
+ * player_profile_cache.hpp - Bounded TTL cache of per-player profile data
+ *
+ * BuildMatchmakingHello and ViewPlayersProfile need the same handful of
+ * values per player (ban, rank, wins, commends, cooldown, medals), spread
+ * over three databases. Scoreboards ask for all ten players at once, so the
+ * assembled profile is cached per account id. Entries expire after
+ * profile_cache_ttl_s seconds (tables written by the game server plugins),
+ * are evicted least-recently-used beyond profile_cache_size, and are
+ * dropped explicitly whenever the GC itself writes something they contain.
+ */
+
+#include "cstrike15_gcmessages.pb.h"
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+struct PlayerProfile {
+  bool banned = false;
+  uint32_t rankId = 0;
+  uint32_t wins = 0;
+  uint32_t cmdFriendly = 0;
+  uint32_t cmdTeaching = 0;
+  uint32_t cmdLeader = 0;
+
+  // Latest unacknowledged cooldown; seconds left are derived when sent
+  bool hasCooldown = false;
+  int32_t cooldownReason = 0;
+  int64_t cooldownExpire = 0;
+
+  PlayerMedalsInfo medals;
+};
+
+class PlayerProfileCache {
+public:
+  static PlayerProfileCache &GetInstance();
+
+  std::optional<PlayerProfile> Get(uint32_t accountId);
+  void Put(uint32_t accountId, const PlayerProfile &profile);
+  void Invalidate(uint32_t accountId);
+  void Clear();
+
+private:
+  struct Entry {
+    PlayerProfile profile;
+    std::chrono::steady_clock::time_point expires;
+    std::list<uint32_t>::iterator lruPos;
+  };
+
+  PlayerProfileCache() = default;
+  ~PlayerProfileCache() = default;
+
+  PlayerProfileCache(const PlayerProfileCache &) = delete;
+  PlayerProfileCache &operator=(const PlayerProfileCache &) = delete;
+
+  std::mutex m_mutex;
+  std::unordered_map<uint32_t, Entry> m_entries;
+  std::list<uint32_t> m_lru; // front = most recently used
+};
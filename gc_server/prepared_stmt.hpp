@@ -6,7 +6,9 @@
  * Provides a cleaner API than raw mysql_stmt_* calls.
  */
 
+#include "db_health.hpp"
 #include "logger.hpp"
+#include <chrono>
 #include <cstring>
 #include <mariadb/mysql.h>
 #include <optional>
@@ -37,6 +39,7 @@ public:
     if (m_paramCount > 0) {
       m_binds.resize(m_paramCount);
       memset(m_binds.data(), 0, sizeof(MYSQL_BIND) * m_paramCount);
+      m_arrayStrides.assign(m_paramCount, 0);
     }
   }
 
@@ -55,6 +58,7 @@ public:
   PreparedStatement(PreparedStatement &&other) noexcept
       : m_stmt(other.m_stmt), m_conn(other.m_conn),
         m_paramCount(other.m_paramCount), m_binds(std::move(other.m_binds)),
+        m_arrayStrides(std::move(other.m_arrayStrides)),
         m_resultBound(other.m_resultBound) {
     other.m_stmt = nullptr;
   }
@@ -127,6 +131,95 @@ public:
     m_binds[index].buffer_type = MYSQL_TYPE_NULL;
   }
 
+  /**
+   * Bind consecutive uint64_t parameters starting at firstIndex, e.g. the
+   * placeholders produced by sqlPlaceholderList().
+   */
+  void bindUint64List(size_t firstIndex, uint64_t *values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      bindUint64(firstIndex + i, &values[i]);
+    }
+  }
+
+  /**
+   * Bind a column-wise uint64_t array for executeBatch() (0-based index).
+   * The array must hold one element per batch row.
+   */
+  void bindUint64Array(size_t index, uint64_t *values) {
+    bindUint64(index, values);
+    m_arrayStrides[index] = sizeof(uint64_t);
+  }
+
+  /**
+   * Bind a column-wise uint32_t array for executeBatch() (0-based index).
+   */
+  void bindUint32Array(size_t index, uint32_t *values) {
+    bindUint32(index, values);
+    m_arrayStrides[index] = sizeof(uint32_t);
+  }
+
+  /**
+   * Execute the statement once per row of the bound parameter arrays.
+   *
+   * On MariaDB servers with bulk support this is a single round trip
+   * (STMT_ATTR_ARRAY_SIZE); otherwise it falls back to one execute per row.
+   * Only valid for INSERT/UPDATE/DELETE.
+   *
+   * @param rowCount Number of elements in every bound array
+   * @param affectedRows Optional total of affected rows across the batch
+   * @return true on success, false on failure
+   */
+  bool executeBatch(unsigned int rowCount, uint64_t *affectedRows = nullptr) {
+    if (affectedRows) {
+      *affectedRows = 0;
+    }
+    if (rowCount == 0) {
+      return true;
+    }
+
+    if (rowCount > 1 && supportsBulk()) {
+      if (mysql_stmt_attr_set(m_stmt, STMT_ATTR_ARRAY_SIZE, &rowCount) != 0) {
+        logger::error("PreparedStatement: failed to set array size: %s",
+                      mysql_stmt_error(m_stmt));
+        return false;
+      }
+
+      bool ok = execute();
+      if (ok && affectedRows) {
+        *affectedRows = mysql_stmt_affected_rows(m_stmt);
+      }
+
+      unsigned int noArray = 0;
+      mysql_stmt_attr_set(m_stmt, STMT_ATTR_ARRAY_SIZE, &noArray);
+      return ok;
+    }
+
+    std::vector<void *> bases(m_paramCount);
+    for (size_t i = 0; i < m_paramCount; i++) {
+      bases[i] = m_binds[i].buffer;
+    }
+
+    bool ok = true;
+    for (unsigned int row = 0; row < rowCount && ok; row++) {
+      for (size_t i = 0; i < m_paramCount; i++) {
+        if (m_arrayStrides[i] > 0) {
+          m_binds[i].buffer =
+              static_cast<char *>(bases[i]) + row * m_arrayStrides[i];
+        }
+      }
+
+      ok = execute();
+      if (ok && affectedRows) {
+        *affectedRows += mysql_stmt_affected_rows(m_stmt);
+      }
+    }
+
+    for (size_t i = 0; i < m_paramCount; i++) {
+      m_binds[i].buffer = bases[i];
+    }
+    return ok;
+  }
+
   /**
    * Execute the prepared statement.
    * @return true on success, false on failure
@@ -140,7 +233,28 @@ public:
       }
     }
 
-    if (mysql_stmt_execute(m_stmt) != 0) {
+    // Fail fast: the request is already out of time, or the database is
+    // known to be unavailable (see db_health.hpp)
+    if (RequestDeadline::Expired()) {
+      logger::warning("PreparedStatement: request deadline passed, skipped");
+      return false;
+    }
+    DBCircuitBreaker *breaker = DBHealth::GetInstance().ForConnection(m_conn);
+    if (breaker && !breaker->Allow()) {
+      logger::warning("PreparedStatement: %s unavailable, skipped",
+                      breaker->Name().c_str());
+      return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = mysql_stmt_execute(m_stmt) == 0;
+    if (breaker) {
+      breaker->Record(!ok && IsDBAvailabilityError(mysql_stmt_errno(m_stmt)),
+                      std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - start));
+    }
+
+    if (!ok) {
       logger::error("PreparedStatement: execute failed: %s",
                     mysql_stmt_error(m_stmt));
       return false;
@@ -181,6 +295,19 @@ public:
    */
   int fetch() { return mysql_stmt_fetch(m_stmt); }
 
+  /**
+   * Discard the current result and every result after it. A CALL returns one
+   * result per SELECT in the procedure plus a final status, and all of them
+   * must be read before the connection can run another statement.
+   */
+  void drainResults() {
+    mysql_stmt_free_result(m_stmt);
+    while (mysql_stmt_more_results(m_stmt) &&
+           mysql_stmt_next_result(m_stmt) == 0) {
+      mysql_stmt_free_result(m_stmt);
+    }
+  }
+
   /**
    * Get the number of affected rows (for INSERT/UPDATE/DELETE).
    */
@@ -234,6 +361,16 @@ public:
   }
 
 private:
+  bool supportsBulk() const {
+    unsigned long extendedCaps = 0;
+    if (mariadb_get_infov(m_conn,
+                          MARIADB_CONNECTION_EXTENDED_SERVER_CAPABILITIES,
+                          &extendedCaps) != 0) {
+      return false;
+    }
+    return (extendedCaps & (MARIADB_CLIENT_STMT_BULK_OPERATIONS >> 32)) != 0;
+  }
+
   void validateIndex(size_t index) {
     if (index >= m_paramCount) {
       throw std::out_of_range(
@@ -245,6 +382,7 @@ private:
   MYSQL *m_conn;
   size_t m_paramCount;
   std::vector<MYSQL_BIND> m_binds;
+  std::vector<size_t> m_arrayStrides;
   bool m_resultBound;
 };
 
@@ -261,3 +399,16 @@ createPreparedStatement(MYSQL *conn, const char *query) {
     return std::nullopt;
   }
 }
+
+/**
+ * Builds "(?, ?, ...)" with count placeholders for IN (...) clauses.
+ * Pair with PreparedStatement::bindUint64List().
+ */
+inline std::string sqlPlaceholderList(size_t count) {
+  std::string list = "(";
+  for (size_t i = 0; i < count; i++) {
+    list += (i == 0) ? "?" : ", ?";
+  }
+  list += ")";
+  return list;
+}
@@ -1,8 +1,8 @@
 #include "production_matchmaking.hpp"
 #include "logger.hpp"
 #include "networking_matchmaking.hpp"
+#include "random.hpp"
 #include <algorithm>
-#include <random>
 #include <sstream>
 #include <iomanip>
 
@@ -350,14 +350,12 @@ void ProductionMatchmaker::CleanupExpiredMatches() {
 }
 
 std::string ProductionMatchmaker::GenerateMatchId() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, 15);
-    
+    Random &random = ThreadRandom();
+
     std::stringstream ss;
     ss << "match_";
     for (int i = 0; i < 8; i++) {
-        ss << std::hex << dis(gen);
+        ss << std::hex << random.Uint32(0, 15);
     }
     return ss.str();
 }
@@ -1,4 +1,97 @@
 #include "stdafx.h"
 #include "random.hpp"
 
-Random g_random;
+#include <atomic>
+
+// expands a 64 bit seed into well mixed state, as the xoshiro authors suggest
+static uint64_t SplitMix64(uint64_t &x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+Random::Random(uint64_t seed, uint64_t stream)
+{
+    for (uint64_t &word : m_state)
+    {
+        word = SplitMix64(seed);
+    }
+
+    for (uint64_t i = 0; i < stream; i++)
+    {
+        Jump();
+    }
+}
+
+void Random::Jump()
+{
+    static const uint64_t jump[] = {
+        0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c
+    };
+
+    uint64_t state[4] = {};
+    for (uint64_t word : jump)
+    {
+        for (int bit = 0; bit < 64; bit++)
+        {
+            if (word & (uint64_t{ 1 } << bit))
+            {
+                for (int i = 0; i < 4; i++)
+                {
+                    state[i] ^= m_state[i];
+                }
+            }
+
+            Uint64();
+        }
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        m_state[i] = state[i];
+    }
+}
+
+static uint64_t RandomDeviceSeed()
+{
+    std::random_device device;
+    return (uint64_t{ device() } << 32) | device();
+}
+
+static std::atomic<uint64_t> s_masterSeed{ RandomDeviceSeed() };
+static std::atomic<uint64_t> s_nextStream{ 0 };
+static std::atomic<uint32_t> s_seedGeneration{ 0 };
+
+Random &ThreadRandom()
+{
+    struct ThreadState
+    {
+        uint32_t generation;
+        Random random;
+    };
+
+    auto create = []
+    {
+        uint32_t generation = s_seedGeneration.load();
+        return ThreadState{ generation, Random{ s_masterSeed.load(), s_nextStream++ } };
+    };
+
+    thread_local ThreadState state = create();
+
+    // SeedRandom was called since this thread's stream was created
+    if (state.generation != s_seedGeneration.load(std::memory_order_relaxed))
+    {
+        state = create();
+    }
+
+    return state.random;
+}
+
+void SeedRandom(uint64_t masterSeed)
+{
+    s_masterSeed = masterSeed;
+    s_nextStream = 0;
+    s_seedGeneration++;
+}
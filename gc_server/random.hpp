@@ -1,26 +1,102 @@
 #pragma once
 
+#include <cstdint>
+
+// xoshiro256** (Blackman & Vigna): small state, fast, and jump() splits one
+// seed into non-overlapping streams. not for anything secret
 class Random
 {
 public:
+    // stream n starts 2^128 * n draws into the sequence of seed
+    explicit Random(uint64_t seed, uint64_t stream = 0);
+
+    uint64_t Uint64()
+    {
+        const uint64_t result = Rotl(m_state[1] * 5, 7) * 9;
+        const uint64_t t = m_state[1] << 17;
+
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = Rotl(m_state[3], 45);
+
+        return result;
+    }
+
+    // inclusive like uniform_int_distribution, unbiased (Lemire's method)
     uint32_t Uint32(uint32_t min = 0, uint32_t max = UINT32_MAX)
     {
-        return std::uniform_int_distribution<uint32_t>{ min, max }(m_engine);
+        assert(min <= max);
+        uint32_t range = max - min;
+        if (range == UINT32_MAX)
+        {
+            return static_cast<uint32_t>(Uint64() >> 32);
+        }
+
+        return min + Below(range + 1);
     }
 
+    // [min, max)
     float Float(float min = 0.0f, float max = 1.0f)
     {
-        return std::uniform_real_distribution<float>{ min, max }(m_engine);
+        float unit = static_cast<float>(Uint64() >> 40) * (1.0f / 16777216.0f);
+        return min + (max - min) * unit;
     }
 
     size_t RandomIndex(size_t size)
     {
         assert(size);
-        return std::uniform_int_distribution<size_t>{ 0, size - 1 }(m_engine);
+        if (size <= UINT32_MAX)
+        {
+            return Below(static_cast<uint32_t>(size));
+        }
+
+        // rejection sampling, only for huge sizes
+        uint64_t threshold = (0 - static_cast<uint64_t>(size)) % size;
+        uint64_t value;
+        do
+        {
+            value = Uint64();
+        } while (value < threshold);
+        return static_cast<size_t>(value % size);
     }
 
 private:
-    std::mt19937 m_engine{ std::random_device{}() };
+    static uint64_t Rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // [0, bound), bound > 0
+    uint32_t Below(uint32_t bound)
+    {
+        uint64_t product = (Uint64() >> 32) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound)
+        {
+            uint32_t threshold = (0 - bound) % bound;
+            while (low < threshold)
+            {
+                product = (Uint64() >> 32) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    void Jump();
+
+    uint64_t m_state[4];
 };
 
-extern Random g_random;
+// the calling thread's generator, no locking needed. each thread gets its own
+// stream of the master seed, numbered in the order threads first draw
+Random &ThreadRandom();
+
+// replaces the master seed (by default from std::random_device) and restarts
+// stream numbering; every thread switches over on its next draw. with the
+// same seed and the same order of calls, unboxes repeat exactly
+void SeedRandom(uint64_t masterSeed);
@@ -0,0 +1,44 @@
+#include "request_arena.hpp"
+#include "logger.hpp"
+#include <memory>
+
+struct RequestArena::State {
+  std::unique_ptr<char[]> block;
+  std::unique_ptr<google::protobuf::Arena> arena;
+  int depth = 0;
+
+  State() : block(new char[InitialBlockSize]) {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = block.get();
+    options.initial_block_size = InitialBlockSize;
+    arena = std::make_unique<google::protobuf::Arena>(options);
+  }
+};
+
+RequestArena::State &RequestArena::ThreadState() {
+  static thread_local State state;
+  return state;
+}
+
+RequestArena::Scope::Scope() { ThreadState().depth++; }
+
+RequestArena::Scope::~Scope() {
+  State &state = ThreadState();
+  if (--state.depth == 0) {
+    // Frees every block but the initial one, which is reused
+    uint64_t used = state.arena->Reset();
+    if (used > InitialBlockSize) {
+      logger::info("RequestArena: Request used %llu bytes",
+                   static_cast<unsigned long long>(used));
+    }
+  }
+}
+
+google::protobuf::Arena &RequestArena::Get() {
+  State &state = ThreadState();
+  if (state.depth == 0) {
+    logger::warning("RequestArena: Used outside a scope, held until the "
+                    "next scope on this thread closes");
+  }
+  return *state.arena;
+}
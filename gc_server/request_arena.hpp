@@ -0,0 +1,44 @@
+#pragma once
+/**
+ * request_arena.hpp - Per-request protobuf arena for item construction
+ *
+ * Building a CSOEconItem on the heap costs one allocation for the message,
+ * one per attribute and one per attribute value_bytes string, and a SOCache
+ * builds one per row. Messages that only live for the request are created
+ * on the calling thread's arena instead. The arena starts in a thread-local
+ * block that is kept between requests and is reset when the outermost
+ * Scope on the thread closes, so a request that fits the block allocates
+ * nothing and a bigger one a handful of blocks.
+ *
+ * Arena messages must not outlive the Scope they were created in.
+ */
+
+#include <cstddef>
+#include <google/protobuf/arena.h>
+
+class RequestArena {
+public:
+  // Bytes of the block kept per thread
+  static constexpr size_t InitialBlockSize = 256 * 1024;
+
+  class Scope {
+  public:
+    Scope();
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+  };
+
+  // The calling thread's arena; only valid inside a Scope
+  static google::protobuf::Arena &Get();
+
+  // Creates a message on the thread's arena
+  template <typename T> static T *Create() {
+    return google::protobuf::Arena::CreateMessage<T>(&Get());
+  }
+
+private:
+  struct State;
+  static State &ThreadState();
+};
@@ -0,0 +1,65 @@
+-- 001_csgo_items_owner_account_id.sql
+--
+-- Adds a numeric owner key to csgo_items so per-player lookups compare a
+-- 4-byte integer instead of a 'STEAM_1:Y:Z' VARCHAR built on every query.
+-- owner_steamid2 is kept and still written, for tools that read it.
+--
+-- Rollout (all steps are online, no table lock):
+--   1. Apply this file against ollum_inventory.
+--   2. Run account-id-backfill until it reports 0 remaining rows.
+--   3. Deploy the gc-server build that filters on owner_account_id; it
+--      refuses to start while un-backfilled rows remain.
+--
+-- Requires MariaDB 10.3.2+ (instant ADD COLUMN, IF [NOT] EXISTS clauses).
+
+ALTER TABLE csgo_items
+    ADD COLUMN IF NOT EXISTS owner_account_id INT UNSIGNED NULL,
+    ALGORITHM=INSTANT;
+
+-- STEAM_X:Y:Z -> account id (Z * 2 + Y), NULL for anything else
+DROP FUNCTION IF EXISTS steamid2_to_account_id;
+DELIMITER //
+CREATE FUNCTION steamid2_to_account_id(steamid2 VARCHAR(64))
+RETURNS INT UNSIGNED
+DETERMINISTIC NO SQL
+BEGIN
+    IF steamid2 IS NULL OR steamid2 NOT LIKE 'STEAM\_%:%:%' THEN
+        RETURN NULL;
+    END IF;
+    RETURN CAST(SUBSTRING_INDEX(steamid2, ':', -1) AS UNSIGNED) * 2
+         + CAST(SUBSTRING_INDEX(SUBSTRING_INDEX(steamid2, ':', 2), ':', -1)
+                AS UNSIGNED);
+END//
+DELIMITER ;
+
+-- Keep the column in sync for writers that only know owner_steamid2
+-- (web panel, trade tooling) and for rows inserted during the backfill.
+DROP TRIGGER IF EXISTS csgo_items_owner_account_id_bi;
+DROP TRIGGER IF EXISTS csgo_items_owner_account_id_bu;
+DELIMITER //
+CREATE TRIGGER csgo_items_owner_account_id_bi
+BEFORE INSERT ON csgo_items
+FOR EACH ROW
+BEGIN
+    IF NEW.owner_account_id IS NULL THEN
+        SET NEW.owner_account_id = steamid2_to_account_id(NEW.owner_steamid2);
+    END IF;
+END//
+CREATE TRIGGER csgo_items_owner_account_id_bu
+BEFORE UPDATE ON csgo_items
+FOR EACH ROW
+BEGIN
+    IF NOT (NEW.owner_steamid2 <=> OLD.owner_steamid2)
+       AND NEW.owner_account_id <=> OLD.owner_account_id THEN
+        SET NEW.owner_account_id = steamid2_to_account_id(NEW.owner_steamid2);
+    END IF;
+END//
+DELIMITER ;
+
+-- InnoDB secondary indexes carry the primary key, so
+-- (owner_account_id) already covers "MAX(id)" and "id > ? ORDER BY id", and
+-- (owner_account_id, acknowledged) covers the inventory position lookups.
+ALTER TABLE csgo_items
+    ADD INDEX IF NOT EXISTS idx_owner_account_id (owner_account_id),
+    ADD INDEX IF NOT EXISTS idx_owner_account_ack (owner_account_id, acknowledged),
+    ALGORITHM=INPLACE, LOCK=NONE;
@@ -1,31 +1,53 @@
 #pragma once
 
+#include "db_health.hpp"
 #include "logger.hpp"
+#include "random.hpp"
+#include "tunables_manager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <mariadb/mysql.h>
+#include <string>
+#include <thread>
 
 /**
  * @brief RAII wrapper for MySQL transactions.
  *
- * Automatically executes "START TRANSACTION" on construction.
- * If Commit() is not called before destruction, it automatically executes
- * "ROLLBACK".
+ * Uses the client API (mysql_autocommit/mysql_commit/mysql_rollback) rather
+ * than text queries. If the connection is already inside a transaction the
+ * wrapper becomes a nested scope backed by a SAVEPOINT, so helpers that open
+ * their own SQLTransaction can be called from inside another one.
+ * If Commit() is not called before destruction, it automatically rolls back
+ * (the whole transaction, or only the nested scope).
  */
 class SQLTransaction {
 public:
   /**
-   * @brief Starts a new transaction on the given database connection.
+   * @brief Starts a new transaction (or nested scope) on the connection.
    * @param db The MySQL connection handle.
    */
   explicit SQLTransaction(MYSQL *db)
-      : m_db(db), m_committed(false), m_rolledBack(false) {
-    if (mysql_query(m_db, "START TRANSACTION") != 0) {
+      : m_db(db), m_committed(false), m_rolledBack(false), m_nested(false) {
+    if (InTransaction(m_db)) {
+      m_nested = true;
+      snprintf(m_savepoint, sizeof(m_savepoint), "sqltxn_%llx",
+               static_cast<unsigned long long>(
+                   reinterpret_cast<uintptr_t>(this)));
+      if (!Savepoint(m_savepoint)) {
+        m_rolledBack = true; // nothing to undo
+      }
+      return;
+    }
+
+    if (!RunDBCall(m_db, "SQLTransaction",
+                   [this] { return mysql_autocommit(m_db, 0); })) {
       logger::error("SQLTransaction: Failed to start transaction: %s",
                     mysql_error(m_db));
-      // In a real exception-safe environment we might throw here,
-      // but for this codebase we'll log error.
-      // Mark as rolled back so we don't try to rollback again on invalid state
-      // if possible, though standard behavior is usually to just let dtor try
-      // or check error state. For now, we assume simple usage.
+      m_rolledBack = true;
     }
   }
 
@@ -43,7 +65,7 @@ public:
   SQLTransaction &operator=(const SQLTransaction &) = delete;
 
   /**
-   * @brief Commits the transaction.
+   * @brief Commits the transaction (releases the savepoint when nested).
    * @return true if commit was successful, false otherwise.
    */
   bool Commit() {
@@ -51,12 +73,22 @@ public:
       return false;
     }
 
-    if (mysql_query(m_db, "COMMIT") != 0) {
+    if (m_nested) {
+      if (!ReleaseSavepoint(m_savepoint)) {
+        return false;
+      }
+      m_committed = true;
+      return true;
+    }
+
+    if (!RunDBCall(m_db, "SQLTransaction",
+                   [this] { return mysql_commit(m_db); })) {
       logger::error("SQLTransaction: Failed to commit transaction: %s",
                     mysql_error(m_db));
       return false;
     }
 
+    mysql_autocommit(m_db, 1);
     m_committed = true;
     return true;
   }
@@ -70,16 +102,188 @@ public:
       return;
     }
 
-    if (mysql_query(m_db, "ROLLBACK") != 0) {
+    m_rolledBack = true;
+    if (m_nested) {
+      Exec("ROLLBACK TO SAVEPOINT ", m_savepoint, false);
+      Exec("RELEASE SAVEPOINT ", m_savepoint, false);
+      return;
+    }
+
+    if (mysql_rollback(m_db) != 0) {
       logger::error("SQLTransaction: Failed to rollback transaction: %s",
                     mysql_error(m_db));
     }
+    mysql_autocommit(m_db, 1);
+  }
 
-    m_rolledBack = true;
+  /**
+   * @brief Savepoints inside this transaction. Names must be identifiers.
+   */
+  bool Savepoint(const char *name) { return Exec("SAVEPOINT ", name); }
+  bool RollbackToSavepoint(const char *name) {
+    return Exec("ROLLBACK TO SAVEPOINT ", name, false);
+  }
+  bool ReleaseSavepoint(const char *name) {
+    return Exec("RELEASE SAVEPOINT ", name);
+  }
+
+  bool IsActive() const { return !m_committed && !m_rolledBack; }
+  bool IsCommitted() const { return m_committed; }
+  bool IsNested() const { return m_nested; }
+
+  /**
+   * @brief True if the connection has autocommit off or an open transaction.
+   */
+  static bool InTransaction(MYSQL *db) {
+    unsigned int status = 0;
+    if (mariadb_get_infov(db, MARIADB_CONNECTION_SERVER_STATUS, &status) !=
+        0) {
+      return false;
+    }
+    return (status & SERVER_STATUS_IN_TRANS) ||
+           !(status & SERVER_STATUS_AUTOCOMMIT);
   }
 
 private:
+  // failFast: through RunDBCall; rollbacks pass false and always run
+  bool Exec(const char *verb, const char *name, bool failFast = true) {
+    for (const char *c = name; *c; c++) {
+      if (!isalnum(static_cast<unsigned char>(*c)) && *c != '_') {
+        logger::error("SQLTransaction: Invalid savepoint name %s", name);
+        return false;
+      }
+    }
+
+    std::string query = std::string(verb) + name;
+    auto run = [&] { return mysql_query(m_db, query.c_str()); };
+    if (failFast ? !RunDBCall(m_db, "SQLTransaction", run) : run() != 0) {
+      logger::error("SQLTransaction: %s failed: %s", query.c_str(),
+                    mysql_error(m_db));
+      return false;
+    }
+    return true;
+  }
+
   MYSQL *m_db;
   bool m_committed;
   bool m_rolledBack;
+  bool m_nested;
+  char m_savepoint[32] = {};
+};
+
+/**
+ * Counters for RunTransaction, logged by GCNetwork's periodic cleanup.
+ */
+struct SQLTransactionStats {
+  std::atomic<uint64_t> units{0};            // RunTransaction calls
+  std::atomic<uint64_t> retries{0};          // attempts after the first
+  std::atomic<uint64_t> deadlocks{0};        // ER_LOCK_DEADLOCK seen
+  std::atomic<uint64_t> lockWaitTimeouts{0}; // ER_LOCK_WAIT_TIMEOUT seen
+  std::atomic<uint64_t> exhausted{0};        // gave up after max retries
 };
+
+inline SQLTransactionStats &GetSQLTransactionStats() {
+  static SQLTransactionStats stats;
+  return stats;
+}
+
+constexpr unsigned int SQL_ER_LOCK_WAIT_TIMEOUT = 1205;
+constexpr unsigned int SQL_ER_LOCK_DEADLOCK = 1213;
+
+/**
+ * @brief Decides whether a unit of work that failed with error gets another
+ * attempt, and if so sleeps for a jittered exponential backoff first.
+ *
+ * Only deadlocks and lock wait timeouts are retried, up to txn_max_retries
+ * (default 3) extra attempts, with a delay uniform in
+ * [0, min(txn_retry_base_ms * 2^attempt, txn_retry_max_ms)]. The sleep
+ * blocks the main loop, so both default to a few milliseconds, and there
+ * is no retry once the delay would run past the request's deadline.
+ *
+ * @param name Caller name for the log
+ * @param error mysql_errno of the failed attempt
+ * @param attempt Zero-based number of the attempt that failed
+ * @return true if the caller should run the unit again
+ */
+inline bool SQLRetryBackoff(const char *name, unsigned int error,
+                            int attempt) {
+  if (error != SQL_ER_LOCK_DEADLOCK && error != SQL_ER_LOCK_WAIT_TIMEOUT) {
+    return false;
+  }
+
+  auto &stats = GetSQLTransactionStats();
+  (error == SQL_ER_LOCK_DEADLOCK ? stats.deadlocks : stats.lockWaitTimeouts)++;
+
+  const auto &tunables = TunablesManager::GetInstance();
+  int maxRetries = tunables.GetInt("txn_max_retries", 3);
+  int baseDelayMs = std::max(0, tunables.GetInt("txn_retry_base_ms", 2));
+  int maxDelayMs = std::max(0, tunables.GetInt("txn_retry_max_ms", 16));
+
+  if (attempt >= maxRetries) {
+    stats.exhausted++;
+    logger::error("%s: Giving up after %d attempts (error %u)", name,
+                  attempt + 1, error);
+    return false;
+  }
+
+  // Full jitter: uniform in [0, min(base * 2^attempt, max)]
+  int ceilingMs = std::min(baseDelayMs << std::min(attempt, 6), maxDelayMs);
+  uint32_t delayMs =
+      ThreadRandom().Uint32(0, static_cast<uint32_t>(ceilingMs));
+  if (RequestDeadline::Expired() ||
+      RequestDeadline::Clamp(delayMs + 1) <= delayMs) {
+    stats.exhausted++;
+    logger::error("%s: Request deadline reached after %d attempts (error %u)",
+                  name, attempt + 1, error);
+    return false;
+  }
+
+  logger::warning("%s: %s, retrying in %d ms (attempt %d)", name,
+                  error == SQL_ER_LOCK_DEADLOCK ? "deadlock"
+                                                : "lock wait timeout",
+                  static_cast<int>(delayMs), attempt + 2);
+  stats.retries++;
+  std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+  return true;
+}
+
+/**
+ * @brief Runs body(SQLTransaction &) as one unit of work and commits it.
+ *
+ * If the body or the commit fails with a deadlock or lock wait timeout, the
+ * transaction is rolled back and the whole body runs again (see
+ * SQLRetryBackoff). The body must therefore only touch the database; send
+ * client messages after RunTransaction returns, and draw random outcomes
+ * (drops, trade up results) before calling it, or a retry rerolls them.
+ * A body may commit by itself; otherwise returning true commits and false
+ * rolls back. Inside an outer transaction there is nothing to retry
+ * independently, so the body runs once.
+ *
+ * @return true if the body succeeded and the transaction committed.
+ */
+template <typename Body>
+bool RunTransaction(MYSQL *db, const char *name, Body &&body) {
+  GetSQLTransactionStats().units++;
+
+  for (int attempt = 0;; attempt++) {
+    SQLTransaction transaction(db);
+    if (!transaction.IsActive()) {
+      return false;
+    }
+
+    unsigned int error = 0;
+    if (body(transaction)) {
+      if (transaction.IsCommitted() || transaction.Commit()) {
+        return true;
+      }
+      error = mysql_errno(db);
+    } else {
+      error = mysql_errno(db);
+    }
+    transaction.Rollback();
+
+    if (transaction.IsNested() || !SQLRetryBackoff(name, error, attempt)) {
+      return false;
+    }
+  }
+}
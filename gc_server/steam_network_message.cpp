@@ -2,6 +2,7 @@
 #include "steam_network_message.hpp"
 #include "logger.hpp"
 #include <steam/steam_gameserver.h>
+#include <algorithm>
 #include <arpa/inet.h>
 
 NetworkMessage::NetworkMessage(const void* data, uint32_t size) 
@@ -74,7 +75,7 @@ bool NetworkMessage::WriteSingleMsg(SNetSocket_t socket, bool reliable) const
         socket,
         fullMessage.data(),
         fullMessage.size(),
-        reliable ? k_EP2PSendReliable : k_EP2PSendUnreliable
+        reliable
     );
 }
 
@@ -121,7 +122,7 @@ bool NetworkMessage::WriteChunkMsg(SNetSocket_t socket, bool reliable, uint32_t
             socket,
             chunkMessage.data(),
             chunkMessage.size(),
-            reliable ? k_EP2PSendReliable : k_EP2PSendUnreliable
+            reliable
         )) {
             logger::error("Failed to send chunk %u/%u", i + 1, chunks);
             return false;
@@ -132,6 +133,94 @@ bool NetworkMessage::WriteChunkMsg(SNetSocket_t socket, bool reliable, uint32_t
 }
 
 
+NetworkMessageStream::NetworkMessageStream(SNetSocket_t socket,
+                                           uint32_t msgType,
+                                           size_t payloadSize, bool reliable)
+    : m_socket(socket), m_type(msgType), m_reliable(reliable),
+      m_remaining(payloadSize)
+{
+    // Same split as WriteToSocket
+    size_t totalSize = sizeof(uint32_t) * 2 + payloadSize;
+    m_chunks = (totalSize + NetworkMessage::MAX_CHUNK_SIZE - 1) /
+               NetworkMessage::MAX_CHUNK_SIZE;
+    if (m_chunks == 0) m_chunks = 1; // 1 chunk minimum
+    m_chunkSize = (payloadSize + m_chunks - 1) / m_chunks;
+    m_buffer.reserve(sizeof(uint32_t) * 3 + m_chunkSize);
+}
+
+bool NetworkMessageStream::Write(const void* data, size_t size)
+{
+    if (m_failed || size > m_remaining) {
+        m_failed = true;
+        return false;
+    }
+    m_remaining -= size;
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        if (m_buffer.empty()) {
+            StartChunk();
+        }
+
+        size_t room = sizeof(uint32_t) * 3 + m_chunkSize - m_buffer.size();
+        size_t take = std::min(room, size);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + take);
+        bytes += take;
+        size -= take;
+
+        if (take == room && !Flush()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NetworkMessageStream::Finish()
+{
+    if (m_remaining != 0) {
+        logger::error("NetworkMessageStream: %zu payload bytes missing", m_remaining);
+        m_failed = true;
+    }
+
+    // Short last chunk, and empty ones where WriteChunkMsg sends them too
+    while (!m_failed && m_sent < m_chunks) {
+        if (m_buffer.empty()) {
+            StartChunk();
+        }
+        Flush();
+    }
+    return !m_failed;
+}
+
+void NetworkMessageStream::StartChunk()
+{
+    // type w mask, header size, chunk count
+    uint32_t header[3] = {m_type | CCProtoMask, 0, m_chunks};
+    m_buffer.insert(m_buffer.end(),
+        reinterpret_cast<const uint8_t*>(header),
+        reinterpret_cast<const uint8_t*>(header) + sizeof(header));
+}
+
+bool NetworkMessageStream::Flush()
+{
+    m_sent++;
+    if (m_chunks > 1) {
+        logger::info("Sending chunk %u/%u - Size: %zu", m_sent, m_chunks, m_buffer.size());
+    }
+
+    if (!SteamGameServerNetworking()->SendDataOnSocket(
+        m_socket,
+        m_buffer.data(),
+        m_buffer.size(),
+        m_reliable
+    )) {
+        logger::error("Failed to send chunk %u/%u", m_sent, m_chunks);
+        m_failed = true;
+    }
+    m_buffer.clear();
+    return !m_failed;
+}
+
 uint16_t NetworkMessage::GetTypeFromData(const void* data, uint32_t size) 
 {
     if (size < sizeof(uint16_t)) {
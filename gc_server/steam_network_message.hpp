@@ -56,6 +56,37 @@ class NetworkMessage {
 		bool WriteChunkMsg(SNetSocket_t socket, bool reliable, uint32_t chunks) const;
 	};
 
+	/**
+	 * Writes a message in the same chunks as NetworkMessage::WriteToSocket
+	 * while the payload is still being produced, so the full payload is
+	 * never held in memory. The payload size has to be known up front since
+	 * every chunk header carries the chunk count.
+	 */
+	class NetworkMessageStream {
+	public:
+		NetworkMessageStream(SNetSocket_t socket, uint32_t msgType,
+		                     size_t payloadSize, bool reliable);
+
+		bool Write(const void* data, size_t size);
+
+		// false if a send failed or the payload didn't match its size
+		bool Finish();
+
+	private:
+		void StartChunk();
+		bool Flush();
+
+		SNetSocket_t m_socket;
+		uint32_t m_type;
+		bool m_reliable;
+		size_t m_remaining;
+		uint32_t m_chunks;
+		size_t m_chunkSize;
+		uint32_t m_sent = 0;
+		bool m_failed = false;
+		std::vector<uint8_t> m_buffer;
+	};
+
 	// helper msgs
 	namespace Messages {
 		inline NetworkMessage CreateWelcome(uint64_t steamId, const char* authTicket, uint32_t ticketSize) {
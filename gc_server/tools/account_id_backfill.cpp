@@ -0,0 +1,160 @@
+/**
+ * account_id_backfill.cpp - Online backfill of csgo_items.owner_account_id
+ *
+ * Walks csgo_items in primary key ranges and fills owner_account_id from
+ * owner_steamid2 using the steamid2_to_account_id() function installed by
+ * sql/001_csgo_items_owner_account_id.sql. Each range is its own autocommit
+ * UPDATE so row locks are short, and the tool sleeps between ranges to keep
+ * replication lag and buffer pool churn down. It is safe to interrupt and
+ * rerun: only rows that are still NULL are touched.
+ *
+ * Usage:
+ *   account-id-backfill <host> <user> <password> <database>
+ *                       [port=3306] [batch_size=5000] [sleep_ms=50]
+ */
+
+#include "logger.hpp"
+#include "prepared_stmt.hpp"
+#include "safe_parse.hpp"
+#include <chrono>
+#include <cstdint>
+#include <mariadb/mysql.h>
+#include <thread>
+
+static bool QueryUint64(MYSQL *db, const char *query, uint64_t &value) {
+  auto stmtOpt = createPreparedStatement(db, query);
+  if (!stmtOpt) {
+    return false;
+  }
+
+  auto &stmt = *stmtOpt;
+  if (!stmt.execute() || !stmt.storeResult()) {
+    return false;
+  }
+
+  my_bool isNull = 0;
+  MYSQL_BIND result;
+  memset(&result, 0, sizeof(result));
+  result.buffer_type = MYSQL_TYPE_LONGLONG;
+  result.buffer = &value;
+  result.is_unsigned = 1;
+  result.is_null = &isNull;
+
+  value = 0;
+  if (!stmt.bindResult(&result) || stmt.fetch() != 0) {
+    return false;
+  }
+  if (isNull) {
+    value = 0;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 5) {
+    logger::error("Usage: %s <host> <user> <password> <database> [port] "
+                  "[batch_size] [sleep_ms]",
+                  argv[0]);
+    return 1;
+  }
+
+  const char *host = argv[1];
+  const char *user = argv[2];
+  const char *password = argv[3];
+  const char *database = argv[4];
+  uint16_t port = argc > 5 ? SafeParse::toUint16(argv[5]).value_or(3306) : 3306;
+  uint64_t batchSize =
+      argc > 6 ? SafeParse::toUint64(argv[6]).value_or(5000) : 5000;
+  uint32_t sleepMs = argc > 7 ? SafeParse::toUint32(argv[7]).value_or(50) : 50;
+  if (batchSize == 0) {
+    batchSize = 5000;
+  }
+
+  MYSQL *db = mysql_init(nullptr);
+  if (!db || !mysql_real_connect(db, host, user, password, database, port,
+                                 nullptr, 0)) {
+    logger::error("Failed to connect to %s@%s/%s: %s", user, host, database,
+                  db ? mysql_error(db) : "mysql_init failed");
+    return 1;
+  }
+  mysql_autocommit(db, 1);
+
+  uint64_t minId = 0, maxId = 0;
+  if (!QueryUint64(db,
+                   "SELECT MIN(id) FROM csgo_items WHERE owner_account_id IS "
+                   "NULL",
+                   minId) ||
+      !QueryUint64(db, "SELECT MAX(id) FROM csgo_items", maxId)) {
+    logger::error("Failed to read csgo_items id range - has "
+                  "001_csgo_items_owner_account_id.sql been applied?");
+    mysql_close(db);
+    return 1;
+  }
+
+  if (minId == 0) {
+    logger::info("Nothing to backfill, owner_account_id is fully populated");
+    mysql_close(db);
+    return 0;
+  }
+
+  logger::info("Backfilling owner_account_id for ids %llu..%llu in batches of "
+               "%llu",
+               minId, maxId, batchSize);
+
+  auto stmtOpt = createPreparedStatement(
+      db, "UPDATE csgo_items "
+          "SET owner_account_id = steamid2_to_account_id(owner_steamid2) "
+          "WHERE id >= ? AND id < ? AND owner_account_id IS NULL");
+  if (!stmtOpt) {
+    mysql_close(db);
+    return 1;
+  }
+
+  auto &stmt = *stmtOpt;
+  uint64_t rangeStart = minId;
+  uint64_t rangeEnd = 0;
+  uint64_t totalUpdated = 0;
+  stmt.bindUint64(0, &rangeStart);
+  stmt.bindUint64(1, &rangeEnd);
+
+  auto started = std::chrono::steady_clock::now();
+  while (rangeStart <= maxId) {
+    rangeEnd = rangeStart + batchSize;
+    if (!stmt.execute()) {
+      logger::error("Batch %llu..%llu failed, rerun to resume", rangeStart,
+                    rangeEnd);
+      mysql_close(db);
+      return 1;
+    }
+
+    totalUpdated += stmt.affectedRows();
+    rangeStart = rangeEnd;
+
+    if ((rangeStart - minId) % (batchSize * 100) == 0 || rangeStart > maxId) {
+      auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+                         std::chrono::steady_clock::now() - started)
+                         .count();
+      logger::info("Progress: id %llu / %llu, %llu rows updated (%llds)",
+                   rangeStart, maxId, totalUpdated,
+                   static_cast<long long>(elapsed));
+    }
+
+    if (sleepMs > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+    }
+  }
+
+  // Rows whose owner_steamid2 isn't a STEAM_X:Y:Z string stay NULL; they
+  // were never reachable through the GC either.
+  uint64_t remaining = 0;
+  QueryUint64(db,
+              "SELECT COUNT(*) FROM csgo_items WHERE owner_account_id IS NULL "
+              "AND owner_steamid2 LIKE 'STEAM\\_%:%:%'",
+              remaining);
+
+  logger::info("Backfill finished: %llu rows updated, %llu rows remaining",
+               totalUpdated, remaining);
+
+  mysql_close(db);
+  return remaining == 0 ? 0 : 2;
+}
@@ -0,0 +1,650 @@
+/**
+ * drop_sim.cpp - Monte Carlo check of crate and trade up odds
+ *
+ * Loads items/items_game.txt (run it from the server directory) and opens
+ * every crate that can drop anything, then runs a trade up for every
+ * collection and rarity that has outputs, spread over all cores through
+ * the real SelectItemFromCrate and SelectTradeUpResult. Observed results are
+ * compared with the intended odds, worked out here from the loot lists:
+ *
+ *   crates     chi-square per rarity tier (golds are their own tier) and
+ *              per item, binomial tests for StatTrak and souvenir rates
+ *   trade ups  chi-square over the candidates of the next rarity
+ *
+ * A test fails when its p-value is below 0.001 divided by the number of
+ * tests, so a correct schema passes almost every run. Draws per second are
+ * printed per crate and in total.
+ *
+ * Usage:
+ *   drop-sim [draws per crate=1000000] [threads=0 (all cores)]
+ *            [seed=0 (random)] [trade ups per test=100000]
+ *
+ * Exits with 1 if any test failed.
+ */
+
+#include "item_schema.hpp"
+#include "random.hpp"
+#include "safe_parse.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <map>
+#include <thread>
+#include <vector>
+
+// the schema logs every generated item; keep warnings and errors only
+namespace logger {
+void disable_colors() {}
+void info(const char *, ...) {}
+
+void warning(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+void error(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+} // namespace logger
+
+// regularized upper incomplete gamma Q(a, x) (Numerical Recipes 6.2)
+static double GammaQ(double a, double x) {
+  if (x <= 0.0) {
+    return 1.0;
+  }
+
+  double logPrefix = a * std::log(x) - x - std::lgamma(a);
+
+  if (x < a + 1.0) {
+    // series for P
+    double term = 1.0 / a;
+    double sum = term;
+    for (int n = 1; n < 1000; n++) {
+      term *= x / (a + n);
+      sum += term;
+      if (std::fabs(term) < std::fabs(sum) * 1e-15) {
+        break;
+      }
+    }
+    return std::max(0.0, 1.0 - sum * std::exp(logPrefix));
+  }
+
+  // continued fraction for Q (modified Lentz)
+  const double tiny = 1e-300;
+  double b = x + 1.0 - a;
+  double c = 1.0 / tiny;
+  double d = 1.0 / b;
+  double h = d;
+  for (int n = 1; n < 1000; n++) {
+    double an = -n * (n - a);
+    b += 2.0;
+    d = an * d + b;
+    d = (std::fabs(d) < tiny) ? tiny : d;
+    c = b + an / c;
+    c = (std::fabs(c) < tiny) ? tiny : c;
+    d = 1.0 / d;
+    double delta = d * c;
+    h *= delta;
+    if (std::fabs(delta - 1.0) < 1e-15) {
+      break;
+    }
+  }
+  return std::exp(logPrefix) * h;
+}
+
+struct ChiSquare {
+  double statistic{};
+  int degrees{};
+  double p{1.0};
+};
+
+// bins with fewer than 5 expected hits are pooled so the test stays valid
+static ChiSquare ChiSquareTest(const std::map<uint64_t, double> &expected,
+                               const std::map<uint64_t, uint64_t> &observed,
+                               uint64_t total) {
+  ChiSquare result;
+  double pooledExpected = 0.0;
+  uint64_t pooledObserved = 0;
+  int bins = 0;
+
+  auto addBin = [&](double expectedHits, uint64_t observedHits) {
+    double diff = observedHits - expectedHits;
+    result.statistic += diff * diff / expectedHits;
+    bins++;
+  };
+
+  for (const auto &[key, probability] : expected) {
+    auto it = observed.find(key);
+    uint64_t hits = (it != observed.end()) ? it->second : 0;
+    double expectedHits = probability * total;
+    if (expectedHits < 5.0) {
+      pooledExpected += expectedHits;
+      pooledObserved += hits;
+    } else {
+      addBin(expectedHits, hits);
+    }
+  }
+
+  // anything that was never supposed to come out fails outright
+  for (const auto &[key, hits] : observed) {
+    if (!expected.count(key)) {
+      result.statistic = INFINITY;
+      result.p = 0.0;
+      return result;
+    }
+  }
+
+  if (pooledExpected > 0.0) {
+    addBin(pooledExpected, pooledObserved);
+  }
+
+  result.degrees = bins - 1;
+  if (result.degrees > 0) {
+    result.p = GammaQ(result.degrees / 2.0, result.statistic / 2.0);
+  }
+  return result;
+}
+
+// two sided binomial test through its normal approximation (chi-square, 1 df)
+static ChiSquare RateTest(double probability, uint64_t hits, uint64_t total) {
+  ChiSquare result;
+  double variance = total * probability * (1.0 - probability);
+  if (variance <= 0.0) {
+    bool exact = (hits == static_cast<uint64_t>(probability * total + 0.5));
+    result.p = exact ? 1.0 : 0.0;
+    return result;
+  }
+
+  double diff = hits - total * probability;
+  result.statistic = diff * diff / variance;
+  result.degrees = 1;
+  result.p = GammaQ(0.5, result.statistic / 2.0);
+  return result;
+}
+
+// what identifies a drop: item, its kit (paint, sticker or music) and gold
+static uint64_t OutcomeKey(uint32_t defIndex, uint32_t kit, bool gold) {
+  return (static_cast<uint64_t>(defIndex) << 33) |
+         (static_cast<uint64_t>(gold) << 32) | kit;
+}
+
+static uint64_t OutcomeKey(const LootListItem &item) {
+  uint32_t kit = 0;
+  if (item.paintKitInfo) {
+    kit = item.paintKitInfo->m_defIndex;
+  } else if (item.stickerKitInfo) {
+    kit = item.stickerKitInfo->m_defIndex;
+  } else if (item.musicDefinitionInfo) {
+    kit = item.musicDefinitionInfo->m_defIndex;
+  }
+
+  return OutcomeKey(item.itemInfo->m_defIndex, kit,
+                    item.quality == ItemSchema::QualityUnusual);
+}
+
+static const CSOEconItemAttribute *FindAttribute(const CSOEconItem &item,
+                                                 uint32_t defIndex) {
+  for (const CSOEconItemAttribute &attribute : item.attribute()) {
+    if (attribute.def_index() == defIndex) {
+      return &attribute;
+    }
+  }
+  return nullptr;
+}
+
+static uint64_t OutcomeKey(const ItemSchema &schema, const CSOEconItem &item,
+                           bool gold) {
+  uint32_t kit = 0;
+  for (uint32_t kitAttribute :
+       {ItemSchema::AttributeTexturePrefab, ItemSchema::AttributeStickerId0,
+        ItemSchema::AttributeMusicId}) {
+    if (const CSOEconItemAttribute *attribute =
+            FindAttribute(item, kitAttribute)) {
+      kit = schema.AttributeUint32(attribute);
+      break;
+    }
+  }
+
+  return OutcomeKey(item.def_index(), kit, gold);
+}
+
+// every item in a loot list and its sublists, depth first
+static void CollectItems(const LootList &list,
+                         std::vector<const LootListItem *> &items) {
+  for (const LootListItem &item : list.items) {
+    items.push_back(&item);
+  }
+  for (const LootList *subList : list.subLists) {
+    CollectItems(*subList, items);
+  }
+}
+
+// golds are their own tier, they ignore rarity
+constexpr uint64_t GoldTier = UINT32_MAX;
+
+// crate odds as designed: each tier is 5x rarer than the one below it and
+// golds come in at 2 against the tiers' weights. tiers missing here never drop
+static double TierWeight(uint64_t tier) {
+  switch (tier) {
+  case ItemSchema::RarityDefault:
+    return 15625;
+  case ItemSchema::RarityCommon:
+    return 3125;
+  case ItemSchema::RarityUncommon:
+    return 625;
+  case ItemSchema::RarityRare:
+    return 125;
+  case ItemSchema::RarityMythical:
+    return 25;
+  case ItemSchema::RarityLegendary:
+    return 5;
+  case GoldTier:
+    return 2;
+  default:
+    return 0;
+  }
+}
+
+// crates with an unusual sublist drop golds and may drop StatTrak
+static bool HasUnusualList(const LootList &list) {
+  if (list.isUnusual) {
+    return true;
+  }
+  for (const LootList *subList : list.subLists) {
+    if (HasUnusualList(*subList)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+struct CrateCounts {
+  std::map<uint64_t, uint64_t> tiers;
+  std::map<uint64_t, uint64_t> outcomes;
+  uint64_t statTrak{};
+  uint64_t souvenirs{};
+  uint64_t failed{};
+
+  void Merge(const CrateCounts &other) {
+    for (const auto &[key, hits] : other.tiers) {
+      tiers[key] += hits;
+    }
+    for (const auto &[key, hits] : other.outcomes) {
+      outcomes[key] += hits;
+    }
+    statTrak += other.statTrak;
+    souvenirs += other.souvenirs;
+    failed += other.failed;
+  }
+};
+
+// runs work(threadIndex, count) on threads workers, splitting total between
+// them. workers are started one at a time and take their ThreadRandom stream
+// before the next one starts, so a seeded run always hands worker n stream n
+template <typename Result, typename Fn>
+static std::vector<Result> RunParallel(unsigned threads, uint64_t total,
+                                       Fn work) {
+  std::vector<Result> results(threads);
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+
+  for (unsigned i = 0; i < threads; i++) {
+    uint64_t count = total / threads + (i < total % threads ? 1 : 0);
+    std::promise<void> started;
+    std::future<void> ready = started.get_future();
+
+    workers.emplace_back([&, i, count] {
+      ThreadRandom();
+      started.set_value();
+      results[i] = work(count);
+    });
+
+    ready.wait();
+  }
+
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+
+  return results;
+}
+
+struct Summary {
+  int tests{};
+  int failures{};
+  double worstP{1.0};
+  std::vector<std::pair<std::string, ChiSquare>> results;
+
+  void Add(std::string name, const ChiSquare &result) {
+    tests++;
+    worstP = std::min(worstP, result.p);
+    results.emplace_back(std::move(name), result);
+  }
+
+  // Bonferroni: the whole run has about a 0.1% chance of a false failure
+  void Judge() {
+    double threshold = 0.001 / std::max(tests, 1);
+    for (const auto &[name, result] : results) {
+      if (result.p < threshold) {
+        failures++;
+        printf("FAIL %s: chi2 %.2f, %d df, p %.3g\n", name.c_str(),
+               result.statistic, result.degrees, result.p);
+      }
+    }
+  }
+};
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+static void SimulateCrates(const ItemSchema &schema, uint64_t draws,
+                           unsigned threads, Summary &summary) {
+  std::vector<const ItemInfo *> crates;
+  for (const auto &[defIndex, info] : schema.m_itemInfo) {
+    if (info.m_supplyCrateSeries && schema.CrateDrops(defIndex)) {
+      crates.push_back(&info);
+    }
+  }
+  std::sort(crates.begin(), crates.end(),
+            [](const ItemInfo *a, const ItemInfo *b) {
+              return a->m_defIndex < b->m_defIndex;
+            });
+
+  printf("%zu crates, %llu draws each\n", crates.size(),
+         static_cast<unsigned long long>(draws));
+  printf("%6s  %-36s %9s %9s %9s %9s %12s\n", "def", "name", "p(tier)",
+         "p(item)", "p(st)", "p(souv)", "draws/s");
+
+  uint64_t totalDraws = 0;
+  double totalSeconds = 0.0;
+
+  for (const ItemInfo *crate : crates) {
+    // the intended odds, worked out from the loot list rather than taken
+    // from the compiled table so that a broken table shows up too
+    auto listSearch = schema.m_revolvingLootLists.find(crate->m_supplyCrateSeries);
+    if (listSearch == schema.m_revolvingLootLists.end()) {
+      continue;
+    }
+
+    const LootList &lootList = listSearch->second;
+    std::vector<const LootListItem *> items;
+    CollectItems(lootList, items);
+    bool hasUnusualList = HasUnusualList(lootList);
+
+    std::map<uint64_t, uint32_t> tierSizes;
+    for (const LootListItem *item : items) {
+      bool gold = (item->quality == ItemSchema::QualityUnusual);
+      if (gold ? (hasUnusualList && !lootList.isUnusual)
+               : (TierWeight(item->rarity) > 0)) {
+        tierSizes[gold ? GoldTier : item->rarity]++;
+      }
+    }
+
+    double totalWeight = 0.0;
+    for (const auto &[tier, size] : tierSizes) {
+      totalWeight += TierWeight(tier);
+    }
+
+    double statTrakChance = 0.0;
+    if (lootList.willProduceStatTrak) {
+      statTrakChance = 1.0;
+    } else if (hasUnusualList) {
+      statTrakChance = 0.1;
+    }
+
+    bool souvenirPackage =
+        crate->m_tournamentEventId && tierSizes.count(ItemSchema::RarityCommon);
+
+    std::map<uint64_t, double> expectedTiers, expectedOutcomes;
+    double expectedStatTrak = 0.0, expectedSouvenirs = 0.0;
+    for (const LootListItem *item : items) {
+      bool gold = (item->quality == ItemSchema::QualityUnusual);
+      uint64_t tier = gold ? GoldTier : item->rarity;
+      if (!tierSizes.count(tier)) {
+        continue;
+      }
+
+      double probability =
+          TierWeight(tier) / totalWeight / tierSizes[tier];
+      expectedTiers[tier] += probability;
+      expectedOutcomes[OutcomeKey(*item)] += probability;
+
+      bool statTrak = !(gold && item->itemInfo->m_defIndex >= 1000);
+      expectedStatTrak += statTrak ? probability * statTrakChance : 0.0;
+      expectedSouvenirs += (souvenirPackage && !gold) ? probability : 0.0;
+    }
+
+    CSOEconItem crateItem;
+    crateItem.set_def_index(crate->m_defIndex);
+
+    auto start = std::chrono::steady_clock::now();
+    auto results =
+        RunParallel<CrateCounts>(threads, draws, [&](uint64_t count) {
+          CrateCounts counts;
+          CSOEconItem item;
+          for (uint64_t i = 0; i < count; i++) {
+            item.Clear();
+            if (!schema.SelectItemFromCrate(crateItem, item)) {
+              counts.failed++;
+              continue;
+            }
+
+            bool gold = (item.quality() == ItemSchema::QualityUnusual);
+            counts.tiers[gold ? GoldTier : item.rarity()]++;
+            counts.outcomes[OutcomeKey(schema, item, gold)]++;
+            counts.statTrak +=
+                FindAttribute(item, ItemSchema::AttributeKillEater) != nullptr;
+            counts.souvenirs +=
+                (item.quality() == ItemSchema::QualityTournament);
+          }
+          return counts;
+        });
+    double seconds = SecondsSince(start);
+
+    CrateCounts counts;
+    for (const CrateCounts &result : results) {
+      counts.Merge(result);
+    }
+
+    uint64_t opened = draws - counts.failed;
+    std::string name = crate->m_name;
+
+    ChiSquare tiers = ChiSquareTest(expectedTiers, counts.tiers, opened);
+    ChiSquare outcomes =
+        ChiSquareTest(expectedOutcomes, counts.outcomes, opened);
+    ChiSquare statTrak = RateTest(expectedStatTrak, counts.statTrak, opened);
+    ChiSquare souvenirs =
+        RateTest(expectedSouvenirs, counts.souvenirs, opened);
+
+    summary.Add(name + " rarity tiers", tiers);
+    summary.Add(name + " items", outcomes);
+    summary.Add(name + " stattrak rate", statTrak);
+    summary.Add(name + " souvenir rate", souvenirs);
+    if (counts.failed) {
+      summary.Add(name + " failed openings", ChiSquare{INFINITY, 0, 0.0});
+    }
+
+    printf("%6u  %-36.36s %9.3g %9.3g %9.3g %9.3g %12.0f\n",
+           crate->m_defIndex, name.c_str(), tiers.p, outcomes.p, statTrak.p,
+           souvenirs.p, draws / seconds);
+
+    totalDraws += draws;
+    totalSeconds += seconds;
+  }
+
+  if (totalSeconds > 0.0) {
+    printf("crates: %llu openings in %.2f s, %.0f/s on %u threads\n",
+           static_cast<unsigned long long>(totalDraws), totalSeconds,
+           totalDraws / totalSeconds, threads);
+  }
+}
+
+static void SimulateTradeUps(const ItemSchema &schema, uint64_t draws,
+                             unsigned threads, Summary &summary) {
+  // one input per (collection, rarity) whose collection can trade up from it
+  struct TradeUpTest {
+    std::string name;
+    const LootList *collection;
+    const LootListItem *input;
+  };
+
+  std::map<std::string, const LootList *> lists;
+  for (const auto &[name, list] : schema.m_lootLists) {
+    lists.emplace(name, &list);
+  }
+
+  std::vector<TradeUpTest> tests;
+  for (const auto &[name, list] : lists) {
+    std::vector<const LootListItem *> items;
+    CollectItems(*list, items);
+
+    std::map<uint32_t, const LootListItem *> inputs;
+    for (const LootListItem *item : items) {
+      if (!item->itemInfo || !item->paintKitInfo ||
+          item->quality == ItemSchema::QualityUnusual) {
+        continue;
+      }
+
+      if (schema.FindCollectionForItem(item->itemInfo->m_defIndex,
+                                       item->paintKitInfo->m_defIndex) !=
+          list) {
+        continue;
+      }
+
+      if (schema.TradeUpOutputs(list, item->rarity + 1).empty()) {
+        continue;
+      }
+
+      inputs.try_emplace(item->rarity, item);
+    }
+
+    for (const auto &[rarity, input] : inputs) {
+      tests.push_back(
+          {name + " rarity " + std::to_string(rarity), list, input});
+    }
+  }
+
+  printf("%zu trade up tests, %llu trade ups each\n", tests.size(),
+         static_cast<unsigned long long>(draws));
+
+  uint64_t totalDraws = 0;
+  double totalSeconds = 0.0;
+
+  for (const TradeUpTest &test : tests) {
+    std::map<uint64_t, double> expected;
+    auto candidates = schema.TradeUpOutputs(test.collection,
+                                            test.input->rarity + 1);
+    for (const LootListItem *candidate : candidates) {
+      expected[OutcomeKey(*candidate)] += 1.0 / candidates.size();
+    }
+
+    // ten copies of the input, as the client sends them
+    CSOEconItem input;
+    input.set_def_index(test.input->itemInfo->m_defIndex);
+    input.set_rarity(test.input->rarity);
+    CSOEconItemAttribute *attribute = input.add_attribute();
+    attribute->set_def_index(ItemSchema::AttributeTexturePrefab);
+    schema.SetAttributeFloat(
+        attribute, static_cast<float>(test.input->paintKitInfo->m_defIndex));
+    attribute = input.add_attribute();
+    attribute->set_def_index(ItemSchema::AttributeTextureWear);
+    schema.SetAttributeFloat(attribute, 0.25f);
+    std::vector<const CSOEconItem *> inputs(10, &input);
+
+    auto start = std::chrono::steady_clock::now();
+    auto results = RunParallel<CrateCounts>(
+        threads, draws, [&](uint64_t count) {
+          CrateCounts counts;
+          CSOEconItem output;
+          for (uint64_t i = 0; i < count; i++) {
+            output.Clear();
+            if (!schema.SelectTradeUpResult(inputs, output)) {
+              counts.failed++;
+              continue;
+            }
+            counts.outcomes[OutcomeKey(schema, output, false)]++;
+          }
+          return counts;
+        });
+    double seconds = SecondsSince(start);
+
+    CrateCounts counts;
+    for (const CrateCounts &result : results) {
+      counts.Merge(result);
+    }
+
+    summary.Add("trade up " + test.name,
+                ChiSquareTest(expected, counts.outcomes, draws - counts.failed));
+    if (counts.failed) {
+      summary.Add("trade up " + test.name + " failed",
+                  ChiSquare{INFINITY, 0, 0.0});
+    }
+
+    totalDraws += draws;
+    totalSeconds += seconds;
+  }
+
+  if (totalSeconds > 0.0) {
+    printf("trade ups: %llu in %.2f s, %.0f/s on %u threads\n",
+           static_cast<unsigned long long>(totalDraws), totalSeconds,
+           totalDraws / totalSeconds, threads);
+  }
+}
+
+int main(int argc, char **argv) {
+  uint64_t crateDraws = 1000000;
+  unsigned threads = 0;
+  uint64_t seed = 0;
+  uint64_t tradeUpDraws = 100000;
+  if (argc > 1) {
+    crateDraws = SafeParse::toUint64(argv[1]).value_or(crateDraws);
+  }
+  if (argc > 2) {
+    threads = SafeParse::toUint32(argv[2]).value_or(threads);
+  }
+  if (argc > 3) {
+    seed = SafeParse::toUint64(argv[3]).value_or(seed);
+  }
+  if (argc > 4) {
+    tradeUpDraws = SafeParse::toUint64(argv[4]).value_or(tradeUpDraws);
+  }
+
+  if (!threads) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  if (seed) {
+    SeedRandom(seed);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  ItemSchema schema;
+  if (!schema.Loaded()) {
+    fprintf(stderr, "couldn't load items/items_game.txt\n");
+    return 1;
+  }
+  printf("schema loaded in %.0f ms\n", SecondsSince(start) * 1000.0);
+
+  Summary summary;
+  SimulateCrates(schema, crateDraws, threads, summary);
+  SimulateTradeUps(schema, tradeUpDraws, threads, summary);
+
+  summary.Judge();
+  printf("%d tests, %d failed, lowest p %.3g\n", summary.tests,
+         summary.failures, summary.worstP);
+  return summary.failures ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * item_id_bench.cpp - DecodeItemId against the std::stoi based decoder
+ *
+ * Decodes a mix of item_id strings shaped like csgo_items rows with both
+ * the previous ParseItemId implementation (substr, std::stoi, exceptions)
+ * and DecodeItemId, checks that they agree, and prints ns per id for each.
+ *
+ * Usage:
+ *   item-id-bench [ids=100000] [rounds=20]
+ */
+
+#include "item_id.hpp"
+#include "safe_parse.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// ParseItemId as it was, minus logging
+static bool LegacyParseItemId(const std::string &item_id, uint32_t &def_index,
+                              uint32_t &paint_index) {
+  try {
+    size_t dash_pos = item_id.find('-');
+    if (dash_pos != std::string::npos) {
+      std::string type = item_id.substr(0, dash_pos);
+      std::string number_part = item_id.substr(dash_pos + 1);
+      uint32_t item_number = std::stoi(number_part);
+
+      if (type == "music_kit") {
+        def_index = 1314;
+        paint_index = item_number;
+        return true;
+      } else if (type == "sticker") {
+        def_index = 1209;
+        paint_index = item_number;
+        return true;
+      } else if (type == "crate" || type == "key" || type == "collectible") {
+        def_index = item_number;
+        paint_index = 0;
+        return true;
+      }
+    }
+
+    size_t first_underscore = item_id.find('_');
+    size_t second_underscore = item_id.find('_', first_underscore + 1);
+    if (first_underscore == std::string::npos ||
+        second_underscore == std::string::npos) {
+      return false;
+    }
+
+    std::string def_index_str = item_id.substr(5, first_underscore - 5);
+    std::string paint_index_str = item_id.substr(
+        first_underscore + 1, second_underscore - first_underscore - 1);
+    def_index = std::stoi(def_index_str);
+    paint_index = std::stoi(paint_index_str);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+// Mostly skins, like real inventories, plus every other kind and some junk
+static std::vector<std::string> SampleIds(size_t count) {
+  std::vector<std::string> ids;
+  ids.reserve(count);
+  uint32_t state = 12345;
+  auto next = [&state](uint32_t bound) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) % bound;
+  };
+
+  for (size_t i = 0; i < count; i++) {
+    switch (next(20)) {
+    case 0:
+      ids.push_back("sticker-" + std::to_string(next(5000)));
+      break;
+    case 1:
+      ids.push_back("music_kit-" + std::to_string(next(80)));
+      break;
+    case 2:
+      ids.push_back("crate-" + std::to_string(4000 + next(300)));
+      break;
+    case 3:
+      ids.push_back("collectible-" + std::to_string(870 + next(200)));
+      break;
+    case 4:
+      ids.push_back(next(2) ? "key-1203" : "skin-bad");
+      break;
+    default:
+      ids.push_back("skin-" + std::to_string(1 + next(520)) + "_" +
+                    std::to_string(next(1200)) + "_" +
+                    std::to_string(next(1000)));
+      break;
+    }
+  }
+  return ids;
+}
+
+template <typename Fn>
+static double NsPerId(const std::vector<std::string> &ids, int rounds,
+                      uint64_t &checksum, Fn decode) {
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; round++) {
+    for (const std::string &id : ids) {
+      uint32_t defIndex = 0, paintIndex = 0;
+      if (decode(id, defIndex, paintIndex)) {
+        checksum += defIndex * 31u + paintIndex;
+      }
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (static_cast<double>(ids.size()) * rounds);
+}
+
+int main(int argc, char **argv) {
+  size_t count = 100000;
+  int rounds = 20;
+  if (argc > 1) {
+    count = SafeParse::toUint32(argv[1]).value_or(count);
+  }
+  if (argc > 2) {
+    rounds = SafeParse::toInt(argv[2]).value_or(rounds);
+  }
+
+  std::vector<std::string> ids = SampleIds(count);
+
+  size_t mismatches = 0;
+  for (const std::string &id : ids) {
+    uint32_t legacyDef = 0, legacyPaint = 0;
+    bool legacyOk = LegacyParseItemId(id, legacyDef, legacyPaint);
+    DecodedItemId decoded = DecodeItemId(id);
+    if (legacyOk != static_cast<bool>(decoded) ||
+        (legacyOk && (legacyDef != decoded.defIndex ||
+                      legacyPaint != decoded.paintIndex))) {
+      if (mismatches++ < 10) {
+        printf("mismatch: %s\n", id.c_str());
+      }
+    }
+  }
+
+  uint64_t legacySum = 0, decodeSum = 0;
+  double legacyNs =
+      NsPerId(ids, rounds, legacySum,
+              [](const std::string &id, uint32_t &def, uint32_t &paint) {
+                return LegacyParseItemId(id, def, paint);
+              });
+  double decodeNs =
+      NsPerId(ids, rounds, decodeSum,
+              [](const std::string &id, uint32_t &def, uint32_t &paint) {
+                DecodedItemId decoded = DecodeItemId(id);
+                def = decoded.defIndex;
+                paint = decoded.paintIndex;
+                return static_cast<bool>(decoded);
+              });
+
+  printf("%zu ids x %d rounds, %zu mismatches\n", ids.size(), rounds,
+         mismatches);
+  printf("ParseItemId (stoi):        %8.1f ns/id\n", legacyNs);
+  printf("DecodeItemId (from_chars): %8.1f ns/id  (%.1fx)\n", decodeNs,
+         decodeNs > 0 ? legacyNs / decodeNs : 0.0);
+  return (mismatches == 0 && legacySum == decodeSum) ? 0 : 1;
+}
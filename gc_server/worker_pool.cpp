@@ -0,0 +1,77 @@
+#include "worker_pool.hpp"
+
+WorkerPool::WorkerPool(size_t threads) {
+  m_threads.reserve(threads);
+  for (size_t i = 0; i < threads; i++) {
+    m_threads.emplace_back(&WorkerPool::WorkerLoop, this);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  for (std::thread &thread : m_threads) {
+    thread.join();
+  }
+}
+
+void WorkerPool::RunClaimed(Batch &batch, size_t index,
+                            std::function<void()> &task) {
+  if (batch.claimed[index].exchange(true)) {
+    return; // taken by the caller or another worker
+  }
+  task();
+
+  std::lock_guard<std::mutex> lock(batch.mutex);
+  if (--batch.remaining == 0) {
+    batch.done.notify_all();
+  }
+}
+
+void WorkerPool::RunAll(std::vector<std::function<void()>> &tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+
+  // Queued entries can outlive this call when the caller ran their task,
+  // so they share the batch; they only touch a task after claiming it,
+  // and an unfinished claimed task keeps this call waiting
+  auto batch = std::make_shared<Batch>(tasks.size());
+  if (!m_threads.empty()) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      for (size_t i = 0; i + 1 < tasks.size(); i++) {
+        m_queue.push_back([batch, i, task = &tasks[i]] {
+          RunClaimed(*batch, i, *task);
+        });
+      }
+    }
+    m_wake.notify_all();
+  }
+
+  for (size_t i = tasks.size(); i-- > 0;) {
+    RunClaimed(*batch, i, tasks[i]);
+  }
+
+  std::unique_lock<std::mutex> lock(batch->mutex);
+  batch->done.wait(lock, [&batch] { return batch->remaining == 0; });
+}
+
+void WorkerPool::WorkerLoop() {
+  for (;;) {
+    std::function<void()> work;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+      if (m_stopping) {
+        return;
+      }
+      work = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+    work();
+  }
+}
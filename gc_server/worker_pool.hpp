@@ -0,0 +1,58 @@
+#pragma once
+/**
+ * worker_pool.hpp - Fixed set of threads for fanning out blocking calls
+ *
+ * Some requests wait on several independent databases. RunAll hands all but
+ * one of a batch of tasks to long-lived workers and runs the rest on the
+ * calling thread, so the batch takes about as long as its slowest task
+ * instead of the sum, without starting a thread per request.
+ *
+ * The caller also takes back any task no worker has started by the time its
+ * own is done, so a pool busy with other batches is never slower than
+ * running the batch serially.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool {
+public:
+  explicit WorkerPool(size_t threads);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  // Runs every task and returns once all of them have finished. Tasks must
+  // not throw; thread-local state (RequestDeadline) has to be handed over
+  // by the task itself.
+  void RunAll(std::vector<std::function<void()>> &tasks);
+
+private:
+  struct Batch {
+    explicit Batch(size_t count) : claimed(count), remaining(count) {}
+
+    std::vector<std::atomic<bool>> claimed;
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t remaining;
+  };
+
+  static void RunClaimed(Batch &batch, size_t index,
+                         std::function<void()> &task);
+
+  void WorkerLoop();
+
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::deque<std::function<void()>> m_queue;
+  std::vector<std::thread> m_threads;
+  bool m_stopping = false;
+};